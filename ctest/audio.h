@@ -128,4 +128,55 @@ PyCSDL2Test_AudioDeviceUnpause(PyObject *module, PyObject *args)
     Py_RETURN_NONE;
 }
 
+/**
+ * \brief SDL Audio callback for PyCSDL2Test_AudioCallbackCapsule()
+ *
+ * Fills the stream with silence and increments the SDL_atomic_t pointed to
+ * by userdata.
+ */
+static void SDLCALL
+PyCSDL2Test_AudioCountCallback(void *userdata, Uint8 *stream, int len)
+{
+    SDL_memset(stream, 0, len);
+    SDL_AtomicAdd((SDL_atomic_t*) userdata, 1);
+}
+
+/**
+ * \brief Returns a PyCapsule wrapping a native SDL_AudioCallback.
+ *
+ * The callback increments the native int pointed to by its userdata.
+ *
+ * \code{.py}
+ * audio_callback_capsule() -> PyCapsule
+ * \endcode
+ */
+static PyObject *
+PyCSDL2Test_AudioCallbackCapsule(PyObject *module, PyObject *args)
+{
+    return PyCapsule_New((void*) PyCSDL2Test_AudioCountCallback,
+                         "SDL_AudioCallback", NULL);
+}
+
+/**
+ * \brief Pushes data into a SDL_AudioRingBuffer like a capture device does.
+ *
+ * \code{.py}
+ * audio_ring_capture(ring: SDL_AudioRingBuffer, data: buffer) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2Test_AudioRingCapture(PyObject *module, PyObject *args)
+{
+    PyObject *ring;
+    Py_buffer data;
+
+    if (!PyArg_ParseTuple(args, "Oy*", &ring, &data))
+        return NULL;
+
+    PyCSDL2_AudioRingBufferCapture(ring, data.buf, (int) data.len);
+
+    PyBuffer_Release(&data);
+    Py_RETURN_NONE;
+}
+
 #endif /* _PYCSDL2TEST_AUDIO_H_ */
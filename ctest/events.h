@@ -111,4 +111,47 @@ PyCSDL2Test_EventSetType(PyObject *module, PyObject *args)
     Py_RETURN_NONE;
 }
 
+/**
+ * \brief Pushes user events through the C API without holding the GIL.
+ *
+ * Each event has user.code set to its index and user.data1 set to its index
+ * plus one.
+ *
+ * \code{.py}
+ * push_user_events(type: int, n: int) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2Test_PushUserEvents(PyObject *module, PyObject *args)
+{
+    Uint32 type;
+    Sint32 codes[16];
+    void *data1[16];
+    int n, i, ret;
+
+    if (!PyArg_ParseTuple(args, "Ii", &type, &n))
+        return NULL;
+
+    if (n < 0 || n > 16) {
+        PyErr_SetString(PyExc_ValueError, "n must be between 0 and 16");
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        codes[i] = i;
+        data1[i] = (void*) (size_t) (i + 1);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_PushUserEvents(type, codes, data1, n);
+    Py_END_ALLOW_THREADS
+
+    if (ret < 0) {
+        PyErr_SetString(PyExc_RuntimeError, SDL_GetError());
+        return NULL;
+    }
+
+    return PyLong_FromLong(ret);
+}
+
 #endif /* _PYCSDL2TEST_EVENTS_H_ */
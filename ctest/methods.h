@@ -69,6 +69,18 @@ static PyMethodDef PyCSDL2Test_Methods[] = {
      "audio_device_unpause(dev: SDL_AudioDevice) -> None"
     },
 
+    {"audio_callback_capsule",
+     PyCSDL2Test_AudioCallbackCapsule,
+     METH_VARARGS,
+     "audio_callback_capsule() -> PyCapsule"
+    },
+
+    {"audio_ring_capture",
+     PyCSDL2Test_AudioRingCapture,
+     METH_VARARGS,
+     "audio_ring_capture(ring: SDL_AudioRingBuffer, data: buffer) -> None"
+    },
+
     /* events.h */
 
     {"mouse_motion_event",
@@ -95,6 +107,12 @@ static PyMethodDef PyCSDL2Test_Methods[] = {
      "event_set_type(ev: SDL_Event) -> None"
     },
 
+    {"push_user_events",
+     PyCSDL2Test_PushUserEvents,
+     METH_VARARGS,
+     "push_user_events(type: int, n: int) -> int"
+    },
+
     /* pixels.h */
 
     {"palette",
@@ -2031,6 +2031,9 @@ typedef PyObject *(*PyCSDL2_AudioDeviceCreate_pfn)(SDL_AudioDeviceID id);
 /** \brief Function pointer type of PyCSDL2_AudioDeviceID() */
 typedef int (*PyCSDL2_AudioDeviceID_pfn)(PyObject*, SDL_AudioDeviceID*);
 
+/** \brief Function pointer type of PyCSDL2_AudioRingBufferCapture() */
+typedef void (*PyCSDL2_AudioRingBufferCapture_pfn)(void*, Uint8*, int);
+
 /* src/events.h */
 
 /** \brief Function pointer type of PyCSDL2_MouseMotionEventCreate() */
@@ -2047,6 +2050,10 @@ typedef PyObject *(*PyCSDL2_EventCreate_pfn)(const SDL_Event*);
 /** \brief Function pointer type of PyCSDL2_EventPtr() */
 typedef int (*PyCSDL2_EventPtr_pfn)(PyObject*, SDL_Event**);
 
+/** \brief Function pointer type of PyCSDL2_PushUserEvents() */
+typedef int (*PyCSDL2_PushUserEvents_pfn)(Uint32, const Sint32*,
+                                          void *const*, int);
+
 /* src/pixels.h */
 
 /** \brief Function pointer type of PyCSDL2_PaletteCreate() */
@@ -3311,6 +3318,16 @@ typedef struct PyCSDL2_CAPI {
     PyCSDL2_WindowCreate_pfn _PyCSDL2_WindowCreate;
     /** \brief Pointer to PyCSDL2_WindowPtr() */
     PyCSDL2_WindowPtr_pfn _PyCSDL2_WindowPtr;
+/*
+ * Entries added later go below, so that extensions built against an older
+ * version of this header keep working.
+ */
+/* src/audio.h */
+    /** \brief Pointer to PyCSDL2_AudioRingBufferCapture() */
+    PyCSDL2_AudioRingBufferCapture_pfn _PyCSDL2_AudioRingBufferCapture;
+/* src/events.h */
+    /** \brief Pointer to PyCSDL2_PushUserEvents() */
+    PyCSDL2_PushUserEvents_pfn _PyCSDL2_PushUserEvents;
 } PyCSDL2_CAPI;
 
 #ifndef PYCSDL2_MODULE
@@ -5586,6 +5603,10 @@ static const PyCSDL2_CAPI *PyCSDL2_Import(void)
 /** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_AudioDeviceID) */
 #define PyCSDL2_AudioDeviceID PYCSDL2_FUNC(PyCSDL2_AudioDeviceID)
 
+/** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_AudioRingBufferCapture) */
+#define PyCSDL2_AudioRingBufferCapture \
+    PYCSDL2_FUNC(PyCSDL2_AudioRingBufferCapture)
+
 /* src/events.h */
 
 /** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_MouseMotionEventCreate) */
@@ -5601,6 +5622,9 @@ static const PyCSDL2_CAPI *PyCSDL2_Import(void)
 /** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_EventPtr) */
 #define PyCSDL2_EventPtr PYCSDL2_FUNC(PyCSDL2_EventPtr)
 
+/** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_PushUserEvents) */
+#define PyCSDL2_PushUserEvents PYCSDL2_FUNC(PyCSDL2_PushUserEvents)
+
 /* src/pixels.h */
 
 /** \brief Redirects calls to PYCSDL2_FUNC(PyCSDL2_PaletteCreate) */
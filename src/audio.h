@@ -30,10 +30,12 @@
 #define _PYCSDL2_AUDIO_H_
 #include <Python.h>
 #include <SDL_audio.h>
+#include <SDL_timer.h>
 #include "../include/pycsdl2.h"
 #include "util.h"
 #include "error.h"
 #include "rwops.h"
+#include "audiocvt.h"
 
 /**
  * \defgroup csdl2_SDL_AudioSpec csdl2.SDL_AudioSpec
@@ -326,6 +328,14 @@ typedef struct PyCSDL2_AudioCVT {
     SDL_AudioCVT cvt;
     /** \brief Python buffer for the SDL_AudioCVT buf field */
     Py_buffer buf;
+    /** \brief src_channels passed to SDL_BuildAudioCVT() */
+    Uint8 src_channels;
+    /** \brief dst_channels passed to SDL_BuildAudioCVT() */
+    Uint8 dst_channels;
+    /** \brief src_rate passed to SDL_BuildAudioCVT() */
+    int src_rate;
+    /** \brief dst_rate passed to SDL_BuildAudioCVT() */
+    int dst_rate;
 } PyCSDL2_AudioCVT;
 
 /** \brief tp_new for PyCSDL2_AudioCVTType */
@@ -482,169 +492,300 @@ static PyTypeObject PyCSDL2_AudioCVTType = {
 /** @} */
 
 /**
- * \defgroup csdl2_SDL_AudioDevice csdl2.SDL_AudioDevice
+ * \defgroup csdl2_SDL_AudioRingBuffer csdl2.SDL_AudioRingBuffer
+ *
+ * \brief Single-producer single-consumer audio ring buffer.
+ *
+ * When used as the callback of a SDL_AudioSpec, the audio device is fed
+ * from the ring buffer by PyCSDL2_AudioRingBufferCallback(), which runs
+ * purely in C and never takes the GIL. Python code pushes audio data into
+ * the ring buffer with SDL_AudioRingBufferWrite().
+ *
+ * With a capture device the roles are swapped. The audio thread pushes the
+ * captured audio data with PyCSDL2_AudioRingBufferCapture(), and Python code
+ * reads it in place with SDL_AudioRingBufferPeek() and
+ * SDL_AudioRingBufferConsume(). The ring buffer keeps track of the
+ * memoryviews returned by SDL_AudioRingBufferPeek(), and releases them
+ * before the audio thread may overwrite the data they point to.
+ *
+ * The head and tail are free-running byte counters which are only ever
+ * advanced by the producer and the consumer respectively, so no locking is
+ * required. Since Python code must hold the GIL, there is always only a
+ * single producer and a single consumer.
  *
  * @{
  */
 
-/** \brief Instance data for PyCSDL2_AudioDeviceType */
-typedef struct PyCSDL2_AudioDevice {
+/** \brief Maximum capacity of a PyCSDL2_AudioRingBuffer in bytes */
+#define PYCSDL2_AUDIORINGBUFFER_MAXSIZE (1 << 30)
+
+/** \brief Instance data for PyCSDL2_AudioRingBufferType */
+typedef struct PyCSDL2_AudioRingBuffer {
     PyObject_HEAD
     /** \brief Head of weakref list */
     PyObject *in_weakreflist;
-    /** \brief SDL_AudioDeviceID that this instance owns */
-    SDL_AudioDeviceID id;
-    /** \brief Audio device's callback Python object */
-    PyObject *callback;
-    /** \brief Audio device's userdata Python object */
-    PyObject *userdata;
-    /** \brief buffer object used for passing stream data in callbacks */
-    PyCSDL2_Buffer *callback_buf;
-} PyCSDL2_AudioDevice;
+    /** \brief Ring storage. Its size is a power of two. */
+    Uint8 *buf;
+    /** \brief Capacity of buf in bytes */
+    Uint32 size;
+    /** \brief Total number of bytes written by the producer */
+    SDL_atomic_t head;
+    /** \brief Total number of bytes read by the consumer */
+    SDL_atomic_t tail;
+    /** \brief Number of callbacks that did not get enough data */
+    SDL_atomic_t underruns;
+    /** \brief Number of capture callbacks that did not fit in the buffer */
+    SDL_atomic_t overruns;
+    /** \brief Largest number of bytes queued after a write */
+    SDL_atomic_t high_water;
+    /** \brief Non-zero if the ring buffer is in use by an audio device */
+    SDL_atomic_t attached;
+    /** \brief Non-zero if the audio device is a capture device */
+    int capture;
+    /** \brief Value used to fill the stream on underrun */
+    Uint8 silence;
+    /**
+     * \brief Data handed out by SDL_AudioRingBufferPeek()
+     *
+     * List of (PyCSDL2_Buffer, weakref to memoryview) tuples, or NULL.
+     */
+    PyObject *peeked;
+} PyCSDL2_AudioRingBuffer;
 
-static PyTypeObject PyCSDL2_AudioDeviceType;
+/** \brief tp_new for PyCSDL2_AudioRingBufferType */
+static PyCSDL2_AudioRingBuffer *
+PyCSDL2_AudioRingBufferNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_AudioRingBuffer *self;
+    Uint32 size, capacity = 1;
+    static char *kwlist[] = {"size", NULL};
 
-/** \brief Traversal function for PyCSDL2_AudioDeviceType */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT, kwlist, &size))
+        return NULL;
+
+    if (!size || size > PYCSDL2_AUDIORINGBUFFER_MAXSIZE) {
+        PyErr_Format(PyExc_ValueError, "size must be between 1 and %d",
+                     PYCSDL2_AUDIORINGBUFFER_MAXSIZE);
+        return NULL;
+    }
+
+    while (capacity < size)
+        capacity <<= 1;
+
+    self = (PyCSDL2_AudioRingBuffer*) type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    self->buf = PyMem_Malloc(capacity);
+    if (!self->buf) {
+        Py_DECREF(self);
+        return (PyCSDL2_AudioRingBuffer*) PyErr_NoMemory();
+    }
+
+    self->size = capacity;
+
+    return self;
+}
+
+/** \brief Traversal function for PyCSDL2_AudioRingBufferType */
 static int
-PyCSDL2_AudioDeviceTraverse(PyCSDL2_AudioDevice *self, visitproc visit,
-                            void *arg)
+PyCSDL2_AudioRingBufferTraverse(PyCSDL2_AudioRingBuffer *self,
+                                visitproc visit, void *arg)
 {
-    Py_VISIT(self->callback);
-    Py_VISIT(self->userdata);
-    Py_VISIT(self->callback_buf);
+    Py_VISIT(self->peeked);
     return 0;
 }
 
-/** \brief Clear function for PyCSDL2_AudioDeviceType */
+/** \brief Clear function for PyCSDL2_AudioRingBufferType */
 static int
-PyCSDL2_AudioDeviceClear(PyCSDL2_AudioDevice *self)
+PyCSDL2_AudioRingBufferClear(PyCSDL2_AudioRingBuffer *self)
 {
-    Py_CLEAR(self->callback);
-    Py_CLEAR(self->userdata);
-    Py_CLEAR(self->callback_buf);
+    Py_CLEAR(self->peeked);
     return 0;
 }
 
+/** \brief tp_dealloc for PyCSDL2_AudioRingBufferType */
+static void
+PyCSDL2_AudioRingBufferDealloc(PyCSDL2_AudioRingBuffer *self)
+{
+    PyObject_GC_UnTrack(self);
+    PyCSDL2_AudioRingBufferClear(self);
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyMem_Free(self->buf);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Returns the number of bytes queued in the ring buffer */
+static Uint32
+PyCSDL2_AudioRingBufferQueued(PyCSDL2_AudioRingBuffer *self)
+{
+    return (Uint32) SDL_AtomicGet(&self->head) -
+           (Uint32) SDL_AtomicGet(&self->tail);
+}
+
 /**
- * \brief Check if the PyCSDL2_AudioDevice is valid.
+ * \brief Writes data into the ring buffer.
  *
- * \returns 1 if dev is valid, 0 otherwise.
+ * Must only be called by the producer.
+ *
+ * \returns The number of bytes written, which may be less than len if the
+ *          ring buffer does not have enough free space.
  */
-static int
-PyCSDL2_AudioDeviceValid(PyCSDL2_AudioDevice *dev)
+static Uint32
+PyCSDL2_AudioRingBufferPush(PyCSDL2_AudioRingBuffer *self, const Uint8 *data,
+                            Uint32 len)
 {
-    if (!PyCSDL2_Assert(dev))
-        return 0;
+    Uint32 head = (Uint32) SDL_AtomicGet(&self->head);
+    Uint32 tail = (Uint32) SDL_AtomicGet(&self->tail);
+    Uint32 mask = self->size - 1, space, first;
 
-    if (Py_TYPE(dev) != &PyCSDL2_AudioDeviceType) {
-        PyCSDL2_RaiseTypeError(NULL, "SDL_AudioDevice", (PyObject*)dev);
-        return 0;
-    }
+    SDL_MemoryBarrierAcquire();
 
-    if (!dev->id) {
-        PyErr_SetString(PyExc_ValueError, "invalid SDL_AudioDevice");
-        return 0;
-    }
+    space = self->size - (head - tail);
+    if (len > space)
+        len = space;
 
-    return 1;
-}
+    first = self->size - (head & mask);
+    if (first > len)
+        first = len;
 
-/**
- * \brief Detaches the SDL_AudioDeviceID from the PyCSDL2_AudioDevice
- */
-static SDL_AudioDeviceID
-PyCSDL2_AudioDeviceDetach(PyCSDL2_AudioDevice *self)
-{
-    SDL_AudioDeviceID id;
+    SDL_memcpy(self->buf + (head & mask), data, first);
+    SDL_memcpy(self->buf, data + first, len - first);
 
-    if (!PyCSDL2_AudioDeviceValid(self))
-        return 0;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&self->head, (int) (head + len));
 
-    id = self->id;
-    PyCSDL2_AudioDeviceClear(self);
-    self->id = 0;
+    /* Only the producer writes high_water */
+    if (head + len - tail > (Uint32) SDL_AtomicGet(&self->high_water))
+        SDL_AtomicSet(&self->high_water, (int) (head + len - tail));
 
-    return id;
+    return len;
 }
 
 /**
- * \brief Attaches the SDL_AudioDeviceID to the PyCSDL2_AudioDevice
+ * \brief SDL-facing callback handler for PyCSDL2_AudioRingBuffer
  *
+ * Drains the ring buffer into the audio stream, filling the remainder with
+ * silence if not enough data is queued. Does not touch the GIL.
  */
 static void
-PyCSDL2_AudioDeviceAttach(PyCSDL2_AudioDevice *self, SDL_AudioDeviceID id,
-                          PyObject *callback, PyObject *userdata)
+PyCSDL2_AudioRingBufferCallback(void *userdata, Uint8 *stream, int len)
 {
-    assert(!self->id);
-    assert(!self->callback);
-    assert(!self->userdata);
+    PyCSDL2_AudioRingBuffer *self = userdata;
+    Uint32 head = (Uint32) SDL_AtomicGet(&self->head);
+    Uint32 tail = (Uint32) SDL_AtomicGet(&self->tail);
+    Uint32 mask = self->size - 1, n, first;
 
-    self->id = id;
-    PyCSDL2_Set(self->callback, callback);
-    PyCSDL2_Set(self->userdata, userdata);
+    SDL_MemoryBarrierAcquire();
+
+    n = head - tail;
+    if (n > (Uint32) len)
+        n = len;
+
+    first = self->size - (tail & mask);
+    if (first > n)
+        first = n;
+
+    SDL_memcpy(stream, self->buf + (tail & mask), first);
+    SDL_memcpy(stream + first, self->buf, n - first);
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&self->tail, (int) (tail + n));
+
+    if (n < (Uint32) len) {
+        SDL_memset(stream + n, self->silence, len - n);
+        SDL_AtomicAdd(&self->underruns, 1);
+    }
 }
 
-/** \brief Destructor for PyCSDL2_AudioDevice */
-static void
-PyCSDL2_AudioDeviceDealloc(PyCSDL2_AudioDevice *self)
+/** \brief Getter for SDL_AudioRingBuffer.queued */
+static PyObject *
+PyCSDL2_AudioRingBufferGetQueued(PyCSDL2_AudioRingBuffer *self, void *closure)
 {
-    PyCSDL2_AudioDeviceClear(self);
-    PyObject_ClearWeakRefs((PyObject*) self);
-    if (self->id) {
-        SDL_AudioDeviceID id = self->id;
-        self->id = 0;
-        Py_BEGIN_ALLOW_THREADS
-        SDL_CloseAudioDevice(id);
-        Py_END_ALLOW_THREADS
-    }
-    Py_TYPE(self)->tp_free((PyObject*) self);
+    return PyLong_FromUnsignedLong(PyCSDL2_AudioRingBufferQueued(self));
 }
 
-/** \brief SDL-facing callback handler for PyCSDL2_AudioDeviceType */
+/**
+ * \brief SDL audio callback which pushes captured audio into the ring buffer.
+ *
+ * Audio data that does not fit is dropped, and counted as an overrun.
+ *
+ * \param userdata The PyCSDL2_AudioRingBuffer.
+ * \param stream Captured audio data.
+ * \param len Length of stream in bytes.
+ */
 static void
-PyCSDL2_AudioDeviceCallback(void *userdata, Uint8 *stream, int len)
+PyCSDL2_AudioRingBufferCapture(void *userdata, Uint8 *stream, int len)
 {
-    PyGILState_STATE gstate = PyGILState_Ensure();
-    PyCSDL2_AudioDevice *self = userdata;
-    PyCSDL2_Buffer *buf = self->callback_buf;
-    PyObject *ret;
-
-    /*
-     * We may be called in-between when the PyCSDL2_AudioDevice was invalidated
-     * and SDL_CloseAudioDevice() is actually called. As such, don't treat this
-     * as an error.
-     */
-    if (!PyCSDL2_AudioDeviceValid(self)) {
-        PyErr_Clear();
-        goto finish;
-    }
+    PyCSDL2_AudioRingBuffer *self = userdata;
 
-    PyCSDL2_BufferInit(buf, CTYPE_UCHAR, stream, len, 0);
+    if (PyCSDL2_AudioRingBufferPush(self, stream, (Uint32) len) <
+        (Uint32) len)
+        SDL_AtomicAdd(&self->overruns, 1);
+}
 
-    ret = PyObject_CallFunction(self->callback, "OOi",
-                                self->userdata ? self->userdata : Py_None,
-                                buf, len);
-    if (!ret)
-        PyErr_Print();
+/** \brief Getter for SDL_AudioRingBuffer.underruns */
+static PyObject *
+PyCSDL2_AudioRingBufferGetUnderruns(PyCSDL2_AudioRingBuffer *self,
+                                    void *closure)
+{
+    return PyLong_FromUnsignedLong((Uint32) SDL_AtomicGet(&self->underruns));
+}
 
-    Py_XDECREF(ret);
+/** \brief Getter for SDL_AudioRingBuffer.overruns */
+static PyObject *
+PyCSDL2_AudioRingBufferGetOverruns(PyCSDL2_AudioRingBuffer *self,
+                                   void *closure)
+{
+    return PyLong_FromUnsignedLong((Uint32) SDL_AtomicGet(&self->overruns));
+}
 
-    if (buf->num_exports)
-        Py_FatalError("audio data buffer is still exported");
+/** \brief Getter for SDL_AudioRingBuffer.high_water */
+static PyObject *
+PyCSDL2_AudioRingBufferGetHighWater(PyCSDL2_AudioRingBuffer *self,
+                                    void *closure)
+{
+    return PyLong_FromUnsignedLong((Uint32) SDL_AtomicGet(&self->high_water));
+}
 
-    buf->buf = NULL;
+/** \brief tp_members for PyCSDL2_AudioRingBufferType */
+static PyMemberDef PyCSDL2_AudioRingBufferMembers[] = {
+    {"size", Uint32_TYPE, offsetof(PyCSDL2_AudioRingBuffer, size), READONLY,
+     "(readonly) Capacity of the ring buffer in bytes."},
+    {"silence", T_UBYTE, offsetof(PyCSDL2_AudioRingBuffer, silence), READONLY,
+     "(readonly) Value used to fill the audio stream on underrun."},
+    {NULL}
+};
 
-finish:
-    PyGILState_Release(gstate);
-}
+/** \brief tp_getset for PyCSDL2_AudioRingBufferType */
+static PyGetSetDef PyCSDL2_AudioRingBufferGetSetters[] = {
+    {"queued",
+     (getter) PyCSDL2_AudioRingBufferGetQueued,
+     (setter) NULL,
+     "(readonly) Number of bytes waiting to be read."},
+    {"underruns",
+     (getter) PyCSDL2_AudioRingBufferGetUnderruns,
+     (setter) NULL,
+     "(readonly) Number of audio callbacks that had to be padded with "
+     "silence."},
+    {"overruns",
+     (getter) PyCSDL2_AudioRingBufferGetOverruns,
+     (setter) NULL,
+     "(readonly) Number of capture callbacks whose audio data did not fit."},
+    {"high_water",
+     (getter) PyCSDL2_AudioRingBufferGetHighWater,
+     (setter) NULL,
+     "(readonly) Largest number of bytes ever queued."},
+    {NULL}
+};
 
-/** \brief Type definition of csdl2.SDL_AudioSpec */
-static PyTypeObject PyCSDL2_AudioDeviceType = {
+/** \brief Type definition of csdl2.SDL_AudioRingBuffer */
+static PyTypeObject PyCSDL2_AudioRingBufferType = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    /* tp_name           */ "csdl2.SDL_AudioDevice",
-    /* tp_basicsize      */ sizeof(PyCSDL2_AudioDevice),
+    /* tp_name           */ "csdl2.SDL_AudioRingBuffer",
+    /* tp_basicsize      */ sizeof(PyCSDL2_AudioRingBuffer),
     /* tp_itemsize       */ 0,
-    /* tp_dealloc        */ (destructor) PyCSDL2_AudioDeviceDealloc,
+    /* tp_dealloc        */ (destructor) PyCSDL2_AudioRingBufferDealloc,
     /* tp_print          */ 0,
     /* tp_getattr        */ 0,
     /* tp_setattr        */ 0,
@@ -661,56 +802,77 @@ static PyTypeObject PyCSDL2_AudioDeviceType = {
     /* tp_as_buffer      */ 0,
     /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
     /* tp_doc            */
-    "An opened audio device.\n"
+    "Lock-free ring buffer that feeds an audio device without the GIL.\n"
     "\n"
-    "This is an opaque handle that cannot be directly constructed. Use \n"
-    "SDL_OpenAudioDevice() to create one.\n",
-    /* tp_traverse       */ (traverseproc) PyCSDL2_AudioDeviceTraverse,
-    /* tp_clear          */ (inquiry) PyCSDL2_AudioDeviceClear,
+    "Use it as the callback of a SDL_AudioSpec, and push audio data into\n"
+    "it with SDL_AudioRingBufferWrite(). With a capture device, read the\n"
+    "captured audio data with SDL_AudioRingBufferPeek().\n",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_AudioRingBufferTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_AudioRingBufferClear,
     /* tp_richcompare    */ 0,
-    /* tp_weaklistoffset */ offsetof(PyCSDL2_AudioDevice, in_weakreflist)
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_AudioRingBuffer, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_AudioRingBufferMembers,
+    /* tp_getset         */ PyCSDL2_AudioRingBufferGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_AudioRingBufferNew
 };
 
 /**
- * \brief Creates an instance of PyCSDL2_AudioDeviceType
+ * \brief Claims the ring buffer for use by an audio device.
+ *
+ * The audio device becomes the consumer of a playback ring buffer, or the
+ * producer of a capture ring buffer, so it can only be attached to one
+ * audio device at a time.
+ *
+ * \param self The ring buffer.
+ * \param format The audio format of the device, used to compute the silence
+ *               value.
+ * \param capture Non-zero if the audio device is a capture device.
+ * \returns 1 on success, 0 with an exception set on failure.
  */
-static PyObject *
-PyCSDL2_AudioDeviceCreate(SDL_AudioDeviceID id)
+static int
+PyCSDL2_AudioRingBufferAttach(PyCSDL2_AudioRingBuffer *self, Uint16 format,
+                              int capture)
 {
-    PyCSDL2_AudioDevice *self;
-    PyTypeObject *type = &PyCSDL2_AudioDeviceType;
-
-    self = (PyCSDL2_AudioDevice*)type->tp_alloc(type, 0);
-    if (!self)
-        return NULL;
-
-    self->callback_buf = PyCSDL2_BufferCreate(CTYPE_UCHAR, NULL, 0, 0, NULL);
-    if (!self->callback_buf) {
-        Py_DECREF(self);
-        return NULL;
+    if (!SDL_AtomicCAS(&self->attached, 0, 1)) {
+        PyErr_SetString(PyExc_ValueError, "SDL_AudioRingBuffer is already "
+                        "attached to an audio device");
+        return 0;
     }
 
-    PyCSDL2_AudioDeviceAttach(self, id, NULL, NULL);
-    return (PyObject*)self;
+    self->capture = capture;
+    self->silence = format == AUDIO_U8 ? 0x80 : 0x00;
+    return 1;
 }
 
 /**
- * \brief Borrow the SDL_AudioDeviceID managed by the PyCSDL2_AudioDevice
+ * \brief Checks that Python code may act as producer or consumer.
  *
- * \param obj The PyCSDL2_AudioDevice object.
- * \param[out] out Output pointer.
- * \returns 1 on success, 0 if an exception occurred.
+ * \param self The ring buffer.
+ * \param capture Non-zero to check for the consumer role, which is taken by
+ *                the audio device of a playback ring buffer. Zero to check
+ *                for the producer role, which is taken by the audio device
+ *                of a capture ring buffer.
+ * \returns 1 if the role is free, 0 with an exception set otherwise.
  */
 static int
-PyCSDL2_AudioDeviceID(PyObject *obj, SDL_AudioDeviceID *out)
+PyCSDL2_AudioRingBufferCheckRole(PyCSDL2_AudioRingBuffer *self, int capture)
 {
-    PyCSDL2_AudioDevice *self = (PyCSDL2_AudioDevice*)obj;
-
-    if (!PyCSDL2_AudioDeviceValid(self))
+    if (SDL_AtomicGet(&self->attached) && self->capture != capture) {
+        PyErr_SetString(PyExc_ValueError, capture ?
+                        "SDL_AudioRingBuffer is used by a playback device" :
+                        "SDL_AudioRingBuffer is used by a capture device");
         return 0;
-
-    if (out)
-        *out = self->id;
+    }
 
     return 1;
 }
@@ -718,85 +880,529 @@ PyCSDL2_AudioDeviceID(PyObject *obj, SDL_AudioDeviceID *out)
 /** @} */
 
 /**
- * \defgroup csdl2_SDL_WAVBuf csdl2.SDL_WAVBuf
+ * \defgroup csdl2_SDL_AudioMixer csdl2.SDL_AudioMixer
  *
- * \brief Manages the buffer returned by SDL_LoadWAV() and SDL_LoadWAV_RW()
+ * \brief Native multi-voice mixer.
+ *
+ * When used as the callback of a SDL_AudioSpec, the audio device is fed by
+ * PyCSDL2_AudioMixerCallback(), which sums all playing voices in C without
+ * taking the GIL.
+ *
+ * Python code never touches the voice state used by the audio thread.
+ * Instead, it pushes commands into a single-producer single-consumer queue
+ * which the audio thread drains at the start of every callback. Buffers
+ * that are no longer used by a voice are only released once the audio thread
+ * has processed the command that replaced or stopped them.
+ *
+ * While the mixer is not attached to an audio device, there is no audio
+ * thread, so commands are applied as soon as they are pushed.
  *
  * @{
  */
 
-/** \brief Instance data for PyCSDL2_WAVBufType */
-typedef struct PyCSDL2_WAVBuf {
-    PyCSDL2_BufferHEAD
+/** \brief Capacity of the PyCSDL2_AudioMixer command queue */
+#define PYCSDL2_AUDIOMIXER_NUMCMDS 256
+
+/** \brief Number of frames mixed at a time into the scratch buffer */
+#define PYCSDL2_AUDIOMIXER_CHUNK 256
+
+/** \brief Maximum number of voices of a PyCSDL2_AudioMixer */
+#define PYCSDL2_AUDIOMIXER_MAXVOICES 1024
+
+/** \brief PyCSDL2_AudioMixerCmd types */
+enum PyCSDL2_AudioMixerCmdType {
+    PYCSDL2_AUDIOMIXER_PLAY,
+    PYCSDL2_AUDIOMIXER_STOP,
+    PYCSDL2_AUDIOMIXER_PARAMS
+};
+
+/** \brief A command sent from Python to the audio thread */
+typedef struct PyCSDL2_AudioMixerCmd {
+    /** \brief One of PyCSDL2_AudioMixerCmdType */
+    int type;
+    /** \brief Index of the voice */
+    int voice;
+    /** \brief (PLAY) Audio data */
+    const Uint8 *data;
+    /** \brief (PLAY) Number of frames in data */
+    Uint32 frames;
+    /** \brief (PLAY) Number of channels in data */
+    int channels;
+    /** \brief (PLAY) Non-zero if the voice loops */
+    int loop;
+    /** \brief (PLAY) First frame of the loop */
+    Uint32 loop_start;
+    /** \brief (PLAY) One past the last frame of the loop */
+    Uint32 loop_end;
+    /** \brief (PLAY, PARAMS) Left channel gain */
+    float gain_l;
+    /** \brief (PLAY, PARAMS) Right channel gain */
+    float gain_r;
+} PyCSDL2_AudioMixerCmd;
+
+/** \brief Voice state. Only accessed by the audio thread. */
+typedef struct PyCSDL2_AudioVoice {
+    /** \brief Audio data. NULL if the voice is not playing. */
+    const Uint8 *data;
+    /** \brief Number of frames in data */
+    Uint32 frames;
+    /** \brief Number of channels in data */
+    int channels;
+    /** \brief Current frame */
+    Uint32 pos;
+    /** \brief Non-zero if the voice loops */
+    int loop;
+    /** \brief First frame of the loop */
+    Uint32 loop_start;
+    /** \brief One past the last frame of the loop */
+    Uint32 loop_end;
+    /** \brief Left channel gain */
+    float gain_l;
+    /** \brief Right channel gain */
+    float gain_r;
+} PyCSDL2_AudioVoice;
+
+/** \brief A buffer waiting for the audio thread to stop using it */
+typedef struct PyCSDL2_AudioMixerRetired {
+    /** \brief The buffer */
+    Py_buffer view;
+    /** \brief The buffer can be released once this many commands are done */
+    Uint32 seq;
+} PyCSDL2_AudioMixerRetired;
+
+/** \brief Instance data for PyCSDL2_AudioMixerType */
+typedef struct PyCSDL2_AudioMixer {
+    PyObject_HEAD
     /** \brief Head of weakref list */
     PyObject *in_weakreflist;
-} PyCSDL2_WAVBuf;
-
-/**
- * \brief Checks if the PyCSDL2_WAVBuf is valid
- */
+    /** \brief Output audio format. Either AUDIO_S16SYS or AUDIO_F32SYS */
+    Uint16 format;
+    /** \brief Number of output channels. Either 1 or 2 */
+    Uint8 channels;
+    /** \brief Number of voices */
+    int num_voices;
+    /** \brief Voice state used by the audio thread */
+    PyCSDL2_AudioVoice *voices;
+    /** \brief Whether each voice is playing, as seen by the audio thread */
+    SDL_atomic_t *playing;
+    /** \brief Buffer used by each voice, owned by the Python side */
+    Py_buffer *views;
+    /** \brief Buffers waiting to be released */
+    PyCSDL2_AudioMixerRetired *retired;
+    /** \brief Number of items in retired */
+    Py_ssize_t num_retired;
+    /** \brief Allocated capacity of retired */
+    Py_ssize_t max_retired;
+    /** \brief Command queue */
+    PyCSDL2_AudioMixerCmd cmds[PYCSDL2_AUDIOMIXER_NUMCMDS];
+    /** \brief Total number of commands pushed */
+    SDL_atomic_t cmd_head;
+    /** \brief Total number of commands processed */
+    SDL_atomic_t cmd_tail;
+    /** \brief Non-zero if the mixer is in use by an audio device */
+    SDL_atomic_t attached;
+} PyCSDL2_AudioMixer;
+
+/** \brief Returns the size of a sample of the given mixer format */
 static int
-PyCSDL2_WAVBufValid(PyCSDL2_WAVBuf *buf)
+PyCSDL2_AudioMixerSampleSize(Uint16 format)
 {
-    if (!PyCSDL2_Assert(buf))
-        return 0;
+    return format == AUDIO_F32SYS ? 4 : 2;
+}
 
-    if (!buf->buf) {
-        PyErr_SetString(PyExc_ValueError, "Invalid SDL_WAVBuf");
-        return 0;
+/** \brief tp_new for PyCSDL2_AudioMixerType */
+static PyCSDL2_AudioMixer *
+PyCSDL2_AudioMixerNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_AudioMixer *self;
+    int voices;
+    Uint16 format = AUDIO_S16SYS;
+    Uint8 channels = 2;
+    static char *kwlist[] = {"voices", "format", "channels", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|" Uint16_UNIT "b", kwlist,
+                                     &voices, &format, &channels))
+        return NULL;
+
+    if (voices <= 0 || voices > PYCSDL2_AUDIOMIXER_MAXVOICES) {
+        PyErr_Format(PyExc_ValueError, "voices must be between 1 and %d",
+                     PYCSDL2_AUDIOMIXER_MAXVOICES);
+        return NULL;
     }
 
-    return 1;
-}
+    if (format != AUDIO_S16SYS && format != AUDIO_F32SYS) {
+        PyErr_SetString(PyExc_ValueError, "format must be AUDIO_S16SYS or "
+                        "AUDIO_F32SYS");
+        return NULL;
+    }
 
-/**
- * \brief Detaches the buffer from the PyCSDL2_WAVBuf.
+    if (channels != 1 && channels != 2) {
+        PyErr_SetString(PyExc_ValueError, "channels must be 1 or 2");
+        return NULL;
+    }
+
+    self = (PyCSDL2_AudioMixer*) type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    self->format = format;
+    self->channels = channels;
+    self->voices = PyMem_Malloc(voices * sizeof(PyCSDL2_AudioVoice));
+    self->playing = PyMem_Malloc(voices * sizeof(SDL_atomic_t));
+    self->views = PyMem_Malloc(voices * sizeof(Py_buffer));
+    if (!self->voices || !self->playing || !self->views) {
+        Py_DECREF(self);
+        return (PyCSDL2_AudioMixer*) PyErr_NoMemory();
+    }
+    SDL_memset(self->voices, 0, voices * sizeof(PyCSDL2_AudioVoice));
+    SDL_memset(self->playing, 0, voices * sizeof(SDL_atomic_t));
+    SDL_memset(self->views, 0, voices * sizeof(Py_buffer));
+    self->num_voices = voices;
+
+    return self;
+}
+
+/** \brief tp_dealloc for PyCSDL2_AudioMixerType */
+static void
+PyCSDL2_AudioMixerDealloc(PyCSDL2_AudioMixer *self)
+{
+    Py_ssize_t i;
+
+    PyObject_ClearWeakRefs((PyObject*) self);
+
+    /* An attached mixer is kept alive by its audio device. */
+    for (i = 0; self->views && i < self->num_voices; i++)
+        PyBuffer_Release(&self->views[i]);
+    for (i = 0; i < self->num_retired; i++)
+        PyBuffer_Release(&self->retired[i].view);
+
+    PyMem_Free(self->voices);
+    PyMem_Free(self->playing);
+    PyMem_Free(self->views);
+    PyMem_Free(self->retired);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/**
+ * \brief Releases retired buffers that the audio thread is done with.
  *
- * Transfers ownership of the buffer from the PyCSDL2_WAVBuf object to the
- * caller. The caller will thus now be responsible for freeing the buffer.
+ * Must be called with the GIL held.
+ */
+static void
+PyCSDL2_AudioMixerCollect(PyCSDL2_AudioMixer *self)
+{
+    Uint32 tail = (Uint32) SDL_AtomicGet(&self->cmd_tail);
+    Py_ssize_t i, j = 0;
+
+    for (i = 0; i < self->num_retired; i++) {
+        if ((Sint32) (tail - self->retired[i].seq) >= 0)
+            PyBuffer_Release(&self->retired[i].view);
+        else
+            self->retired[j++] = self->retired[i];
+    }
+    self->num_retired = j;
+}
+
+/**
+ * \brief Hands over the buffer of a voice to the retired list.
  *
- * \param self PyCSDL2_WAVBuf object to detach the buffer from
- * \param[out] len Will be filled with the size of the buffer in bytes
- * \returns The buffer managed by the PyCSDL2_WAVBuf object, or NULL with an
- *          exception set on error.
+ * \param self The mixer.
+ * \param voice Index of the voice.
+ * \param seq The buffer is released once this many commands are processed.
+ * \returns 1 on success, 0 with an exception set on failure.
  */
-static Uint8*
-PyCSDL2_WAVBufDetach(PyCSDL2_WAVBuf *self, Uint32 *len)
+static int
+PyCSDL2_AudioMixerRetire(PyCSDL2_AudioMixer *self, int voice, Uint32 seq)
 {
-    Uint8 *buf;
+    Py_buffer *view = &self->views[voice];
 
-    if (!PyCSDL2_WAVBufValid(self))
-        return NULL;
+    if (!view->obj)
+        return 1;
 
-    if (self->num_exports) {
-        PyErr_SetString(PyExc_ValueError, "SDL_WAVBuf is exporting a buffer");
-        return NULL;
+    if (self->num_retired >= self->max_retired) {
+        Py_ssize_t max = self->max_retired ? self->max_retired * 2 : 16;
+        PyCSDL2_AudioMixerRetired *retired;
+
+        retired = PyMem_Realloc(self->retired, max * sizeof(*retired));
+        if (!retired) {
+            PyErr_NoMemory();
+            return 0;
+        }
+        self->retired = retired;
+        self->max_retired = max;
     }
 
-    buf = self->buf;
-    if (len)
-        *len = (Uint32) self->len;
-    self->buf = NULL;
-    return buf;
+    self->retired[self->num_retired].view = *view;
+    self->retired[self->num_retired].seq = seq;
+    self->num_retired++;
+    SDL_memset(view, 0, sizeof(Py_buffer));
+    return 1;
 }
 
-/** \brief Destructor for PyCSDL2_WAVBufType */
+/** \brief Applies all pending commands. Called by the consumer. */
 static void
-PyCSDL2_WAVBufDealloc(PyCSDL2_WAVBuf *self)
+PyCSDL2_AudioMixerProcess(PyCSDL2_AudioMixer *self)
 {
-    PyObject_ClearWeakRefs((PyObject*) self);
-    if (self->buf)
-        SDL_FreeWAV(self->buf);
-    Py_TYPE(self)->tp_free((PyObject*) self);
+    Uint32 head = (Uint32) SDL_AtomicGet(&self->cmd_head);
+    Uint32 tail = (Uint32) SDL_AtomicGet(&self->cmd_tail);
+
+    SDL_MemoryBarrierAcquire();
+
+    for (; tail != head; tail++) {
+        const PyCSDL2_AudioMixerCmd *cmd;
+        PyCSDL2_AudioVoice *v;
+
+        cmd = &self->cmds[tail % PYCSDL2_AUDIOMIXER_NUMCMDS];
+        v = &self->voices[cmd->voice];
+
+        switch (cmd->type) {
+        case PYCSDL2_AUDIOMIXER_PLAY:
+            v->data = cmd->data;
+            v->frames = cmd->frames;
+            v->channels = cmd->channels;
+            v->pos = 0;
+            v->loop = cmd->loop;
+            v->loop_start = cmd->loop_start;
+            v->loop_end = cmd->loop_end;
+            v->gain_l = cmd->gain_l;
+            v->gain_r = cmd->gain_r;
+            SDL_AtomicSet(&self->playing[cmd->voice], 1);
+            break;
+        case PYCSDL2_AUDIOMIXER_STOP:
+            v->data = NULL;
+            SDL_AtomicSet(&self->playing[cmd->voice], 0);
+            break;
+        case PYCSDL2_AUDIOMIXER_PARAMS:
+            v->gain_l = cmd->gain_l;
+            v->gain_r = cmd->gain_r;
+            break;
+        }
+    }
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&self->cmd_tail, (int) tail);
 }
 
-/** \brief Type definition for csdl2.SDL_WAVBuf */
-static PyTypeObject PyCSDL2_WAVBufType = {
+/**
+ * \brief Pushes a command into the command queue.
+ *
+ * Must be called with the GIL held. If the command replaces the buffer of a
+ * voice, view is the new buffer, which the mixer takes ownership of. If the
+ * mixer is not attached to an audio device, the command is applied at once.
+ *
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_AudioMixerPush(PyCSDL2_AudioMixer *self,
+                       const PyCSDL2_AudioMixerCmd *cmd, Py_buffer *view)
+{
+    Uint32 head = (Uint32) SDL_AtomicGet(&self->cmd_head);
+    Uint32 tail;
+
+    /*
+     * Mixers are only attached with the GIL held, so without an audio
+     * device nothing else consumes the queue meanwhile. Commands left over
+     * from a closed audio device are applied here.
+     */
+    if (!SDL_AtomicGet(&self->attached))
+        PyCSDL2_AudioMixerProcess(self);
+    PyCSDL2_AudioMixerCollect(self);
+    tail = (Uint32) SDL_AtomicGet(&self->cmd_tail);
+    SDL_MemoryBarrierAcquire();
+
+    if (head - tail >= PYCSDL2_AUDIOMIXER_NUMCMDS) {
+        PyErr_SetString(PyExc_RuntimeError, "SDL_AudioMixer command queue "
+                        "is full");
+        return 0;
+    }
+
+    if (cmd->type != PYCSDL2_AUDIOMIXER_PARAMS &&
+        !PyCSDL2_AudioMixerRetire(self, cmd->voice, head + 1))
+        return 0;
+
+    if (view) {
+        self->views[cmd->voice] = *view;
+        SDL_memset(view, 0, sizeof(Py_buffer));
+    }
+
+    self->cmds[head % PYCSDL2_AUDIOMIXER_NUMCMDS] = *cmd;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&self->cmd_head, (int) (head + 1));
+
+    if (!SDL_AtomicGet(&self->attached)) {
+        PyCSDL2_AudioMixerProcess(self);
+        PyCSDL2_AudioMixerCollect(self);
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Adds frames of a voice into the stereo accumulator.
+ *
+ * \param v The voice.
+ * \param format Sample format of the voice data.
+ * \param acc Stereo float accumulator.
+ * \param n Number of frames to add. Must not go past the end of the voice.
+ */
+static void
+PyCSDL2_AudioVoiceAccumulate(PyCSDL2_AudioVoice *v, Uint16 format,
+                             float *acc, Uint32 n)
+{
+    float gl = v->gain_l, gr = v->gain_r;
+    Uint32 i;
+
+    if (format == AUDIO_F32SYS) {
+        const float *src = (const float*) v->data + v->pos * v->channels;
+
+        if (v->channels == 1) {
+            for (i = 0; i < n; i++) {
+                acc[2 * i] += src[i] * gl;
+                acc[2 * i + 1] += src[i] * gr;
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                acc[2 * i] += src[2 * i] * gl;
+                acc[2 * i + 1] += src[2 * i + 1] * gr;
+            }
+        }
+    } else {
+        const Sint16 *src = (const Sint16*) v->data + v->pos * v->channels;
+
+        gl *= 1.0f / 32768.0f;
+        gr *= 1.0f / 32768.0f;
+        if (v->channels == 1) {
+            for (i = 0; i < n; i++) {
+                acc[2 * i] += src[i] * gl;
+                acc[2 * i + 1] += src[i] * gr;
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                acc[2 * i] += src[2 * i] * gl;
+                acc[2 * i + 1] += src[2 * i + 1] * gr;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Mixes a voice into the stereo accumulator.
+ *
+ * Handles looping, and stops the voice once it reaches the end of its data.
+ */
+static void
+PyCSDL2_AudioMixerMixVoice(PyCSDL2_AudioMixer *self, int voice, float *acc,
+                           Uint32 n)
+{
+    PyCSDL2_AudioVoice *v = &self->voices[voice];
+
+    while (n) {
+        Uint32 end = v->loop ? v->loop_end : v->frames;
+        Uint32 count;
+
+        if (v->pos >= end) {
+            if (!v->loop) {
+                v->data = NULL;
+                SDL_AtomicSet(&self->playing[voice], 0);
+                return;
+            }
+            v->pos = v->loop_start;
+        }
+
+        count = end - v->pos;
+        if (count > n)
+            count = n;
+
+        PyCSDL2_AudioVoiceAccumulate(v, self->format, acc, count);
+        v->pos += count;
+        acc += 2 * count;
+        n -= count;
+    }
+}
+
+/**
+ * \brief Renders the mixer output into stream.
+ *
+ * Must only be called by the consumer.
+ */
+static void
+PyCSDL2_AudioMixerRender(PyCSDL2_AudioMixer *self, Uint8 *stream, Uint32 len)
+{
+    float acc[PYCSDL2_AUDIOMIXER_CHUNK * 2];
+    int frame_size = PyCSDL2_AudioMixerSampleSize(self->format) *
+                     self->channels;
+    Uint32 frames = len / frame_size;
+    int i;
+
+    PyCSDL2_AudioMixerProcess(self);
+
+    while (frames) {
+        Uint32 n = frames < PYCSDL2_AUDIOMIXER_CHUNK ?
+                   frames : PYCSDL2_AUDIOMIXER_CHUNK;
+        Uint32 j;
+
+        SDL_memset(acc, 0, sizeof(float) * 2 * n);
+        for (i = 0; i < self->num_voices; i++)
+            if (self->voices[i].data)
+                PyCSDL2_AudioMixerMixVoice(self, i, acc, n);
+
+        if (self->channels == 1)
+            for (j = 0; j < n; j++)
+                acc[j] = (acc[2 * j] + acc[2 * j + 1]) * 0.5f;
+
+        if (self->format == AUDIO_F32SYS) {
+            float *out = (float*) stream;
+
+            for (j = 0; j < n * self->channels; j++)
+                out[j] = acc[j] > 1.0f ? 1.0f :
+                         acc[j] < -1.0f ? -1.0f : acc[j];
+        } else {
+            Sint16 *out = (Sint16*) stream;
+
+            for (j = 0; j < n * self->channels; j++) {
+                float x = acc[j] * 32768.0f;
+
+                out[j] = x >= 32767.0f ? 32767 :
+                         x <= -32768.0f ? -32768 : (Sint16) x;
+            }
+        }
+
+        stream += n * frame_size;
+        frames -= n;
+    }
+
+    SDL_memset(stream, 0, len % frame_size);
+}
+
+/**
+ * \brief SDL-facing callback handler for PyCSDL2_AudioMixer
+ *
+ * Does not touch the GIL.
+ */
+static void
+PyCSDL2_AudioMixerCallback(void *userdata, Uint8 *stream, int len)
+{
+    PyCSDL2_AudioMixerRender(userdata, stream, len);
+}
+
+/** \brief tp_members for PyCSDL2_AudioMixerType */
+static PyMemberDef PyCSDL2_AudioMixerMembers[] = {
+    {"voices", T_INT, offsetof(PyCSDL2_AudioMixer, num_voices), READONLY,
+     "(readonly) Number of voices."},
+    {"format", Uint16_TYPE, offsetof(PyCSDL2_AudioMixer, format), READONLY,
+     "(readonly) Output audio format."},
+    {"channels", T_UBYTE, offsetof(PyCSDL2_AudioMixer, channels), READONLY,
+     "(readonly) Number of output channels."},
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_AudioMixer */
+static PyTypeObject PyCSDL2_AudioMixerType = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    /* tp_name           */ "csdl2.SDL_WAVBuf",
-    /* tp_basicsize      */ sizeof(PyCSDL2_WAVBuf),
+    /* tp_name           */ "csdl2.SDL_AudioMixer",
+    /* tp_basicsize      */ sizeof(PyCSDL2_AudioMixer),
     /* tp_itemsize       */ 0,
-    /* tp_dealloc        */ (destructor) PyCSDL2_WAVBufDealloc,
+    /* tp_dealloc        */ (destructor) PyCSDL2_AudioMixerDealloc,
     /* tp_print          */ 0,
     /* tp_getattr        */ 0,
     /* tp_setattr        */ 0,
@@ -810,490 +1416,3597 @@ static PyTypeObject PyCSDL2_WAVBufType = {
     /* tp_str            */ 0,
     /* tp_getattro       */ 0,
     /* tp_setattro       */ 0,
-    /* tp_as_buffer      */ &PyCSDL2_BufferAsBuffer,
+    /* tp_as_buffer      */ 0,
     /* tp_flags          */ Py_TPFLAGS_DEFAULT,
-    /* tp_doc            */ "Buffer containing WAVE data.",
+    /* tp_doc            */
+    "Multi-voice mixer that feeds an audio device without the GIL.\n"
+    "\n"
+    "Use it as the callback of a SDL_AudioSpec, and control its voices\n"
+    "with SDL_AudioMixerPlay(), SDL_AudioMixerStop() and\n"
+    "SDL_AudioMixerSetParams().\n",
     /* tp_traverse       */ 0,
     /* tp_clear          */ 0,
     /* tp_richcompare    */ 0,
-    /* tp_weaklistoffset */ offsetof(PyCSDL2_WAVBuf, in_weakreflist)
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_AudioMixer, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_AudioMixerMembers,
+    /* tp_getset         */ 0,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_AudioMixerNew
 };
 
 /**
- * \brief Creates an instance of PyCSDL2_WAVBufType
+ * \brief Claims the mixer for use by an audio device.
  *
- * \param buf Audio buffer to take ownership of.
- * \param len Length of the buffer.
+ * \returns 1 on success, 0 with an exception set on failure.
  */
-static PyCSDL2_WAVBuf *
-PyCSDL2_WAVBufCreate(Uint8 *buf, Uint32 len)
+static int
+PyCSDL2_AudioMixerAttach(PyCSDL2_AudioMixer *self)
 {
-    PyCSDL2_WAVBuf *self;
-    PyTypeObject *type = &PyCSDL2_WAVBufType;
+    if (!SDL_AtomicCAS(&self->attached, 0, 1)) {
+        PyErr_SetString(PyExc_ValueError, "SDL_AudioMixer is already "
+                        "attached to an audio device");
+        return 0;
+    }
 
-    self = (PyCSDL2_WAVBuf*)type->tp_alloc(type, 0);
+    return 1;
+}
+
+/**
+ * \brief Checks the voice index and computes the channel gains.
+ *
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_AudioMixerVoiceParams(PyCSDL2_AudioMixer *self,
+                              PyCSDL2_AudioMixerCmd *cmd, float gain,
+                              float pan)
+{
+    if (cmd->voice < 0 || cmd->voice >= self->num_voices) {
+        PyErr_SetString(PyExc_ValueError, "voice index out of range");
+        return 0;
+    }
+
+    if (pan < -1.0f || pan > 1.0f) {
+        PyErr_SetString(PyExc_ValueError, "pan must be between -1 and 1");
+        return 0;
+    }
+
+    cmd->gain_l = pan > 0.0f ? gain * (1.0f - pan) : gain;
+    cmd->gain_r = pan < 0.0f ? gain * (1.0f + pan) : gain;
+    return 1;
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_AudioResampler csdl2.SDL_AudioResampler
+ *
+ * \brief Streaming polyphase resampler.
+ *
+ * Converts between arbitrary sample rates with a bank of Kaiser-windowed sinc
+ * filters. When dst_rate / src_rate is up / down in lowest terms, output
+ * frame n lies at input position n * down / up, and the fractional part of
+ * that position selects one of up filter phases. The input frames that are
+ * still needed by future output frames are kept in a history buffer, so the
+ * audio can be fed in chunks of any size.
+ *
+ * The resampler can be used offline with SDL_AudioResamplerProcess(), or as
+ * the callback of a SDL_AudioSpec, in which case the audio thread pulls its
+ * input from a SDL_AudioRingBuffer without taking the GIL.
+ *
+ * @{
+ */
+
+/** \brief Maximum number of filter phases of a PyCSDL2_AudioResampler */
+#define PYCSDL2_AUDIORESAMPLER_MAXPHASES 1024
+
+/** \brief Maximum number of taps per phase, after widening for decimation */
+#define PYCSDL2_AUDIORESAMPLER_MAXTAPS 1024
+
+/** \brief Maximum number of channels of a PyCSDL2_AudioResampler */
+#define PYCSDL2_AUDIORESAMPLER_MAXCHANNELS 8
+
+/** \brief Number of input frames pulled from the source at a time */
+#define PYCSDL2_AUDIORESAMPLER_CHUNK 256
+
+/** \brief Number of input frames the history holds in addition to a window */
+#define PYCSDL2_AUDIORESAMPLER_HISTORY 4096
+
+/** \brief Instance data for PyCSDL2_AudioResamplerType */
+typedef struct PyCSDL2_AudioResampler {
+    PyObject_HEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief Input and output format. Either AUDIO_S16SYS or AUDIO_F32SYS */
+    Uint16 format;
+    /** \brief Number of channels */
+    Uint8 channels;
+    /** \brief Input sample rate */
+    int src_rate;
+    /** \brief Output sample rate */
+    int dst_rate;
+    /** \brief dst_rate divided by the GCD of the rates */
+    Uint32 up;
+    /** \brief src_rate divided by the GCD of the rates */
+    Uint32 down;
+    /** \brief Number of filter phases */
+    Uint32 nphases;
+    /** \brief Number of taps per filter phase */
+    int taps;
+    /** \brief Filter bank of nphases * taps coefficients */
+    float *coeffs;
+    /** \brief Dot product kernel */
+    PyCSDL2_AudioDotKernel dot;
+    /** \brief Input history, one plane of cap frames per channel */
+    float *hist;
+    /** \brief Capacity of each history plane in frames */
+    Uint32 cap;
+    /** \brief Number of frames in the history */
+    Uint32 len;
+    /** \brief Index of the first history frame used by the next output */
+    Uint32 pos;
+    /** \brief Fractional input position of the next output, in 1/up units */
+    Uint32 frac;
+    /** \brief Ring buffer which provides the input of the audio callback */
+    PyCSDL2_AudioRingBuffer *source;
+    /**
+     * \brief Non-zero if the resampler is in use.
+     *
+     * It is in use while attached to an audio device, or while
+     * SDL_AudioResamplerProcess() runs without the GIL.
+     */
+    SDL_atomic_t attached;
+} PyCSDL2_AudioResampler;
+
+/** \brief Resets the history of the resampler to silence. */
+static void
+PyCSDL2_AudioResamplerInitHistory(PyCSDL2_AudioResampler *self)
+{
+    SDL_memset(self->hist, 0,
+               (size_t) self->channels * self->cap * sizeof(float));
+    /* Prime the history so that output frame 0 lies at input frame 0 */
+    self->len = self->taps / 2 - 1;
+    self->pos = 0;
+    self->frac = 0;
+}
+
+/** \brief tp_new for PyCSDL2_AudioResamplerType */
+static PyCSDL2_AudioResampler *
+PyCSDL2_AudioResamplerNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_AudioResampler *self;
+    int src_rate, dst_rate, a, b, taps = 32;
+    Uint8 channels;
+    Uint16 format = AUDIO_F32SYS;
+    PyObject *source = Py_None;
+    Uint32 up, down;
+    double ratio;
+    static char *kwlist[] = {"src_rate", "dst_rate", "channels", "format",
+                             "taps", "source", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iib|" Uint16_UNIT "iO",
+                                     kwlist, &src_rate, &dst_rate, &channels,
+                                     &format, &taps, &source))
+        return NULL;
+
+    if (src_rate <= 0 || dst_rate <= 0) {
+        PyErr_SetString(PyExc_ValueError, "rates must be positive");
+        return NULL;
+    }
+
+    if (!channels || channels > PYCSDL2_AUDIORESAMPLER_MAXCHANNELS) {
+        PyErr_Format(PyExc_ValueError, "channels must be between 1 and %d",
+                     PYCSDL2_AUDIORESAMPLER_MAXCHANNELS);
+        return NULL;
+    }
+
+    if (format != AUDIO_S16SYS && format != AUDIO_F32SYS) {
+        PyErr_SetString(PyExc_ValueError, "format must be AUDIO_S16SYS or "
+                        "AUDIO_F32SYS");
+        return NULL;
+    }
+
+    if (taps < 8 || taps > 256) {
+        PyErr_SetString(PyExc_ValueError, "taps must be between 8 and 256");
+        return NULL;
+    }
+
+    if (source != Py_None &&
+        Py_TYPE(source) != &PyCSDL2_AudioRingBufferType) {
+        PyCSDL2_RaiseTypeError("source", "SDL_AudioRingBuffer", source);
+        return NULL;
+    }
+
+    for (a = src_rate, b = dst_rate; b; ) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    up = (Uint32) (dst_rate / a);
+    down = (Uint32) (src_rate / a);
+
+    /* When decimating, widen the filter so the transition band keeps its
+     * width relative to the lower cutoff. */
+    ratio = (double) up / down;
+    if (ratio < 1.0)
+        taps = (int) SDL_min(SDL_ceil(taps / ratio),
+                             PYCSDL2_AUDIORESAMPLER_MAXTAPS);
+    taps = (taps + PYCSDL2_AUDIORESAMPLE_TAPALIGN - 1) &
+           ~(PYCSDL2_AUDIORESAMPLE_TAPALIGN - 1);
+
+    self = (PyCSDL2_AudioResampler*) type->tp_alloc(type, 0);
     if (!self)
         return NULL;
 
-    PyCSDL2_BufferInit((PyCSDL2_Buffer*) self, CTYPE_UCHAR, buf, len, 0);
+    self->format = format;
+    self->channels = channels;
+    self->src_rate = src_rate;
+    self->dst_rate = dst_rate;
+    self->up = up;
+    self->down = down;
+    self->nphases = SDL_min(up, PYCSDL2_AUDIORESAMPLER_MAXPHASES);
+    self->taps = taps;
+    self->cap = taps + PYCSDL2_AUDIORESAMPLER_HISTORY;
+    self->coeffs = PyMem_Malloc((size_t) self->nphases * taps *
+                                sizeof(float));
+    self->hist = PyMem_Malloc((size_t) channels * self->cap * sizeof(float));
+    if (!self->coeffs || !self->hist) {
+        Py_DECREF(self);
+        return (PyCSDL2_AudioResampler*) PyErr_NoMemory();
+    }
+
+    PyCSDL2_AudioResampleDesign(self->coeffs, self->nphases, taps,
+                                PYCSDL2_AUDIORESAMPLE_ROLLOFF *
+                                SDL_min(ratio, 1.0));
+    self->dot = PyCSDL2_AudioGetDotKernel();
+    PyCSDL2_AudioResamplerInitHistory(self);
+
+    if (source != Py_None) {
+        Py_INCREF(source);
+        self->source = (PyCSDL2_AudioRingBuffer*) source;
+    }
 
     return self;
 }
 
+/** \brief tp_dealloc for PyCSDL2_AudioResamplerType */
+static void
+PyCSDL2_AudioResamplerDealloc(PyCSDL2_AudioResampler *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    Py_XDECREF(self->source);
+    PyMem_Free(self->coeffs);
+    PyMem_Free(self->hist);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Returns the number of bytes in a frame of the resampler */
+static Uint32
+PyCSDL2_AudioResamplerFrameSize(PyCSDL2_AudioResampler *self)
+{
+    return self->channels * PyCSDL2_AudioMixerSampleSize(self->format);
+}
+
 /**
- * \brief Internal PyCSDL2_AudioDevice for legacy API.
+ * \brief Returns the number of output frames that can be produced.
  *
- * The legacy SDL audio API operates on a global audio device (with ID 1).
- * Since we need a PyCSDL2_AudioDevice object to store the related Python
- * objects, we internally keep a global PyCSDL2_AudioDevice object that
- * represents the global audio device.
+ * \param self The resampler.
+ * \param extra Number of input frames which will be added to the history.
  */
-static PyCSDL2_AudioDevice *PyCSDL2_GlobalAudioDevice;
+static Uint64
+PyCSDL2_AudioResamplerAvail(PyCSDL2_AudioResampler *self, Uint64 extra)
+{
+    Uint64 total = self->len + extra, end;
+
+    if (total < (Uint64) self->pos + self->taps)
+        return 0;
+
+    /* Output k is available while pos + (frac + k * down) / up + taps is at
+     * most total. */
+    end = (total - self->taps - self->pos + 1) * self->up - 1 - self->frac;
+    return end / self->down + 1;
+}
+
+/** \brief Discards history frames that are no longer needed. */
+static void
+PyCSDL2_AudioResamplerCompact(PyCSDL2_AudioResampler *self)
+{
+    Uint8 c;
+
+    if (!self->pos)
+        return;
+
+    for (c = 0; c < self->channels; c++) {
+        float *plane = self->hist + (size_t) c * self->cap;
+
+        SDL_memmove(plane, plane + self->pos,
+                    (self->len - self->pos) * sizeof(float));
+    }
+    self->len -= self->pos;
+    self->pos = 0;
+}
+
+/**
+ * \brief Appends interleaved input frames to the history.
+ *
+ * \param self The resampler.
+ * \param data Interleaved frames in the resampler format, or NULL to append
+ *             silence.
+ * \param frames Number of frames in data.
+ * \returns The number of frames appended, which is limited by the free space
+ *          in the history.
+ */
+static Uint32
+PyCSDL2_AudioResamplerFeed(PyCSDL2_AudioResampler *self, const Uint8 *data,
+                           Uint32 frames)
+{
+    Uint32 i, ch = self->channels;
+    Uint8 c;
+
+    frames = SDL_min(frames, self->cap - self->len);
+
+    for (c = 0; c < ch; c++) {
+        float *plane = self->hist + (size_t) c * self->cap + self->len;
+
+        if (!data)
+            SDL_memset(plane, 0, frames * sizeof(float));
+        else if (self->format == AUDIO_F32SYS)
+            for (i = 0; i < frames; i++)
+                plane[i] = ((const float *) data)[i * ch + c];
+        else
+            for (i = 0; i < frames; i++)
+                plane[i] = ((const Sint16 *) data)[i * ch + c] *
+                           PYCSDL2_DIVBY32767;
+    }
+
+    self->len += frames;
+    return frames;
+}
+
+/**
+ * \brief Produces output frames until the history runs out.
+ *
+ * \param self The resampler.
+ * \param out Output buffer for interleaved frames in the resampler format.
+ * \param max_frames Maximum number of frames to produce.
+ * \returns The number of frames produced.
+ */
+static Uint32
+PyCSDL2_AudioResamplerRun(PyCSDL2_AudioResampler *self, Uint8 *out,
+                          Uint32 max_frames)
+{
+    Uint32 n, ch = self->channels;
+    Uint8 c;
+
+    for (n = 0; n < max_frames && self->pos + self->taps <= self->len; n++) {
+        Uint32 phase = self->frac;
+        const float *h;
+        Uint64 step;
+
+        if (self->nphases != self->up)
+            phase = (Uint32) ((Uint64) self->frac * self->nphases / self->up);
+        h = self->coeffs + (size_t) phase * self->taps;
+
+        for (c = 0; c < ch; c++) {
+            const float *x = self->hist + (size_t) c * self->cap + self->pos;
+            float v = self->dot(x, h, self->taps);
+
+            if (self->format == AUDIO_F32SYS) {
+                ((float *) out)[n * ch + c] = v;
+            } else {
+                v = v > 1.0f ? 1.0f : v < -1.0f ? -1.0f : v;
+                ((Sint16 *) out)[n * ch + c] =
+                    (Sint16) (v * 32767.0f + (v < 0.0f ? -0.5f : 0.5f));
+            }
+        }
+
+        step = (Uint64) self->frac + self->down;
+        self->pos += (Uint32) (step / self->up);
+        self->frac = (Uint32) (step % self->up);
+    }
+
+    return n;
+}
+
+/**
+ * \brief Resamples interleaved input frames.
+ *
+ * Does not touch the GIL.
+ *
+ * \param self The resampler.
+ * \param in Input frames, or NULL for silence.
+ * \param in_frames Number of input frames.
+ * \param out Output buffer, which must be large enough for the number of
+ *            frames returned by PyCSDL2_AudioResamplerAvail().
+ * \returns The number of frames produced.
+ */
+static Uint64
+PyCSDL2_AudioResamplerProcessData(PyCSDL2_AudioResampler *self,
+                                  const Uint8 *in, Uint64 in_frames,
+                                  Uint8 *out)
+{
+    Uint32 fsize = PyCSDL2_AudioResamplerFrameSize(self), n;
+    Uint64 produced = 0;
+
+    for (;;) {
+        n = PyCSDL2_AudioResamplerRun(self, out + produced * fsize,
+                                      0xFFFFFFFF);
+        produced += n;
+        if (!in_frames)
+            break;
+
+        PyCSDL2_AudioResamplerCompact(self);
+        n = PyCSDL2_AudioResamplerFeed(self, in,
+                                       (Uint32) SDL_min(in_frames,
+                                                        0xFFFFFFFF));
+        if (in)
+            in += (size_t) n * fsize;
+        in_frames -= n;
+    }
+
+    return produced;
+}
+
+/**
+ * \brief SDL-facing callback handler for PyCSDL2_AudioResampler
+ *
+ * Pulls input frames from the source ring buffer as they are needed. Does not
+ * touch the GIL.
+ */
+static void
+PyCSDL2_AudioResamplerCallback(void *userdata, Uint8 *stream, int len)
+{
+    PyCSDL2_AudioResampler *self = userdata;
+    Uint8 in[PYCSDL2_AUDIORESAMPLER_CHUNK * PYCSDL2_AUDIORESAMPLER_MAXCHANNELS
+             * sizeof(float)];
+    Uint32 fsize = PyCSDL2_AudioResamplerFrameSize(self);
+    Uint32 frames = (Uint32) len / fsize, n;
+
+    SDL_memset(stream + frames * fsize, 0, len - frames * fsize);
+
+    while (frames) {
+        Uint64 last;
+
+        n = PyCSDL2_AudioResamplerRun(self, stream, frames);
+        stream += n * fsize;
+        frames -= n;
+        if (!frames)
+            break;
+
+        /* Pull just enough input for the remaining output frames, so that
+         * the latency stays low. */
+        PyCSDL2_AudioResamplerCompact(self);
+        last = ((Uint64) self->frac + (Uint64) (frames - 1) * self->down) /
+               self->up;
+        n = (Uint32) SDL_min(last + self->taps - self->len,
+                             PYCSDL2_AUDIORESAMPLER_CHUNK);
+        PyCSDL2_AudioRingBufferCallback(self->source, in, (int) (n * fsize));
+        PyCSDL2_AudioResamplerFeed(self, in, n);
+    }
+}
+
+/** \brief Getter for SDL_AudioResampler.source */
+static PyObject *
+PyCSDL2_AudioResamplerGetSource(PyCSDL2_AudioResampler *self, void *closure)
+{
+    return PyCSDL2_Get((PyObject*) self->source);
+}
+
+/** \brief tp_members for PyCSDL2_AudioResamplerType */
+static PyMemberDef PyCSDL2_AudioResamplerMembers[] = {
+    {"src_rate", T_INT, offsetof(PyCSDL2_AudioResampler, src_rate), READONLY,
+     "(readonly) Input sample rate."},
+    {"dst_rate", T_INT, offsetof(PyCSDL2_AudioResampler, dst_rate), READONLY,
+     "(readonly) Output sample rate."},
+    {"channels", T_UBYTE, offsetof(PyCSDL2_AudioResampler, channels),
+     READONLY,
+     "(readonly) Number of channels."},
+    {"format", Uint16_TYPE, offsetof(PyCSDL2_AudioResampler, format),
+     READONLY,
+     "(readonly) Input and output audio format."},
+    {"taps", T_INT, offsetof(PyCSDL2_AudioResampler, taps), READONLY,
+     "(readonly) Length of the interpolation filter in input frames."},
+    {NULL}
+};
+
+/** \brief tp_getset for PyCSDL2_AudioResamplerType */
+static PyGetSetDef PyCSDL2_AudioResamplerGetSetters[] = {
+    {"source",
+     (getter) PyCSDL2_AudioResamplerGetSource,
+     (setter) NULL,
+     "(readonly) SDL_AudioRingBuffer which feeds the audio callback."},
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_AudioResampler */
+static PyTypeObject PyCSDL2_AudioResamplerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_AudioResampler",
+    /* tp_basicsize      */ sizeof(PyCSDL2_AudioResampler),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_AudioResamplerDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */
+    "Streaming windowed-sinc sample rate converter.\n"
+    "\n"
+    "Feed it with SDL_AudioResamplerProcess(), or use it as the callback of\n"
+    "a SDL_AudioSpec to resample the audio of its source ring buffer.\n",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_AudioResampler, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_AudioResamplerMembers,
+    /* tp_getset         */ PyCSDL2_AudioResamplerGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_AudioResamplerNew
+};
+
+/**
+ * \brief Claims the resampler.
+ *
+ * \param self The resampler.
+ * \param device Non-zero if it is claimed by an audio device, in which case
+ *               its source ring buffer is claimed as well.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_AudioResamplerAttach(PyCSDL2_AudioResampler *self, int device)
+{
+    if (!SDL_AtomicCAS(&self->attached, 0, 1)) {
+        PyErr_SetString(PyExc_ValueError, "SDL_AudioResampler is in use");
+        return 0;
+    }
+
+    if (device &&
+        !PyCSDL2_AudioRingBufferAttach(self->source, self->format, 0)) {
+        SDL_AtomicSet(&self->attached, 0);
+        return 0;
+    }
+
+    return 1;
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_AudioDevice csdl2.SDL_AudioDevice
+ *
+ * @{
+ */
+
+/** \brief Number of linear sub-buckets per power of two in a histogram */
+#define PYCSDL2_AUDIOSTATS_SUBBUCKETS 8
+
+/** \brief Number of buckets of a duration histogram, covering 32 bits */
+#define PYCSDL2_AUDIOSTATS_BUCKETS (PYCSDL2_AUDIOSTATS_SUBBUCKETS * 30)
+
+/**
+ * \brief Timing statistics of the callback of an audio device.
+ *
+ * The audio thread is the only writer, and records the statistics without
+ * holding the GIL. It brackets its updates with a sequence counter, so that
+ * readers can take a consistent snapshot without ever making the audio
+ * thread wait. All durations are in microseconds.
+ */
+typedef struct PyCSDL2_AudioDeviceStats {
+    /** \brief Odd while the audio thread is updating the statistics */
+    SDL_atomic_t seq;
+    /** \brief Bytes played per second, or 0 if unknown */
+    Uint32 bytes_per_second;
+    /** \brief Number of callbacks which called into Python */
+    Uint64 callbacks;
+    /** \brief Number of callbacks which took longer than their buffer */
+    Uint64 overruns;
+    /** \brief Total time spent waiting for the GIL */
+    Uint64 gil_wait_total;
+    /** \brief Total time spent in the Python callable */
+    Uint64 call_total;
+    /** \brief Longest wait for the GIL */
+    Uint32 gil_wait_max;
+    /** \brief Longest call of the Python callable */
+    Uint32 call_max;
+    /** \brief Histogram of GIL waits */
+    Uint32 gil_wait_hist[PYCSDL2_AUDIOSTATS_BUCKETS];
+    /** \brief Histogram of Python callable durations */
+    Uint32 call_hist[PYCSDL2_AUDIOSTATS_BUCKETS];
+} PyCSDL2_AudioDeviceStats;
+
+/**
+ * \brief Returns the histogram bucket of a duration.
+ *
+ * Durations below PYCSDL2_AUDIOSTATS_SUBBUCKETS get a bucket each. Larger
+ * ones are split into PYCSDL2_AUDIOSTATS_SUBBUCKETS buckets per power of
+ * two, for a relative error below 1/8.
+ */
+static int
+PyCSDL2_AudioStatsBucket(Uint32 us)
+{
+    int e = 0;
+
+    if (us < PYCSDL2_AUDIOSTATS_SUBBUCKETS)
+        return (int) us;
+
+    while (us >> (e + 1))
+        e++;
+
+    return (e - 2) * PYCSDL2_AUDIOSTATS_SUBBUCKETS +
+           (int) ((us >> (e - 3)) & (PYCSDL2_AUDIOSTATS_SUBBUCKETS - 1));
+}
+
+/** \brief Returns the largest duration which falls into a bucket */
+static Uint32
+PyCSDL2_AudioStatsBucketMax(int bucket)
+{
+    int e = bucket / PYCSDL2_AUDIOSTATS_SUBBUCKETS + 2;
+    Uint64 low;
+
+    if (bucket < PYCSDL2_AUDIOSTATS_SUBBUCKETS)
+        return (Uint32) bucket;
+
+    low = (Uint64) (PYCSDL2_AUDIOSTATS_SUBBUCKETS +
+                    bucket % PYCSDL2_AUDIOSTATS_SUBBUCKETS) << (e - 3);
+    return (Uint32) (low + ((Uint64) 1 << (e - 3)) - 1);
+}
+
+/**
+ * \brief Returns an upper bound of the 99th percentile of a histogram.
+ *
+ * \param hist The histogram.
+ * \param count Number of samples in the histogram.
+ * \param max The largest sample, which bounds the result.
+ */
+static Uint32
+PyCSDL2_AudioStatsP99(const Uint32 *hist, Uint64 count, Uint32 max)
+{
+    Uint64 rank = count - count / 100, seen = 0;
+    int i;
+
+    if (!count)
+        return 0;
+
+    for (i = 0; i < PYCSDL2_AUDIOSTATS_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= rank)
+            break;
+    }
+
+    if (i == PYCSDL2_AUDIOSTATS_BUCKETS)
+        return max;
+
+    return PyCSDL2_AudioStatsBucketMax(i) < max ?
+           PyCSDL2_AudioStatsBucketMax(i) : max;
+}
+
+/** \brief Converts a performance counter interval to microseconds */
+static Uint32
+PyCSDL2_AudioStatsMicroseconds(Uint64 ticks, Uint64 freq)
+{
+    Uint64 us = ticks / freq * 1000000 + ticks % freq * 1000000 / freq;
+
+    return us > 0xFFFFFFFF ? 0xFFFFFFFF : (Uint32) us;
+}
+
+/**
+ * \brief Records a callback into the statistics.
+ *
+ * Called by the audio thread, which is the only writer, without the GIL.
+ *
+ * \param self The statistics.
+ * \param len Number of bytes requested by the callback.
+ * \param gil_wait Time spent waiting for the GIL.
+ * \param call Time spent in the Python callable.
+ */
+static void
+PyCSDL2_AudioDeviceStatsRecord(PyCSDL2_AudioDeviceStats *self, int len,
+                               Uint32 gil_wait, Uint32 call)
+{
+    Uint64 period = self->bytes_per_second ?
+                    (Uint64) len * 1000000 / self->bytes_per_second : 0;
+
+    SDL_AtomicAdd(&self->seq, 1);
+    SDL_MemoryBarrierRelease();
+
+    self->callbacks++;
+    if (period && (Uint64) gil_wait + call > period)
+        self->overruns++;
+    self->gil_wait_total += gil_wait;
+    self->call_total += call;
+    if (gil_wait > self->gil_wait_max)
+        self->gil_wait_max = gil_wait;
+    if (call > self->call_max)
+        self->call_max = call;
+    self->gil_wait_hist[PyCSDL2_AudioStatsBucket(gil_wait)]++;
+    self->call_hist[PyCSDL2_AudioStatsBucket(call)]++;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd(&self->seq, 1);
+}
+
+/**
+ * \brief Takes a consistent snapshot of the statistics.
+ *
+ * Retries while the audio thread is updating them, which only takes a few
+ * instructions. The audio thread never waits for the reader.
+ */
+static void
+PyCSDL2_AudioDeviceStatsSnapshot(PyCSDL2_AudioDeviceStats *self,
+                                 PyCSDL2_AudioDeviceStats *out)
+{
+    int seq;
+
+    for (;;) {
+        seq = SDL_AtomicGet(&self->seq);
+        if (seq & 1) {
+            SDL_Delay(0);
+            continue;
+        }
+        SDL_MemoryBarrierAcquire();
+        SDL_memcpy(out, self, sizeof(*out));
+        SDL_MemoryBarrierAcquire();
+        if (SDL_AtomicGet(&self->seq) == seq)
+            return;
+    }
+}
+
+/**
+ * \brief Clears the statistics.
+ *
+ * The caller must lock the audio device, so that the audio thread is not
+ * writing at the same time.
+ */
+static void
+PyCSDL2_AudioDeviceStatsReset(PyCSDL2_AudioDeviceStats *self)
+{
+    SDL_AtomicAdd(&self->seq, 1);
+    SDL_MemoryBarrierRelease();
+    SDL_memset(&self->callbacks, 0, sizeof(*self) -
+               offsetof(PyCSDL2_AudioDeviceStats, callbacks));
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd(&self->seq, 1);
+}
+
+/** \brief Instance data for PyCSDL2_AudioDeviceType */
+typedef struct PyCSDL2_AudioDevice {
+    PyObject_HEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief SDL_AudioDeviceID that this instance owns */
+    SDL_AudioDeviceID id;
+    /** \brief Audio device's callback Python object */
+    PyObject *callback;
+    /** \brief Audio device's userdata Python object */
+    PyObject *userdata;
+    /** \brief buffer object used for passing stream data in callbacks */
+    PyCSDL2_Buffer *callback_buf;
+    /**
+     * \brief Native callback object
+     *
+     * This is a SDL_AudioRingBuffer, a SDL_AudioMixer, a SDL_AudioResampler,
+     * or a (callback, userdata) tuple for foreign callback pointers. It is
+     * not cleared by tp_clear, as the audio thread uses it without holding
+     * the GIL. It is only released once the audio device has been closed.
+     */
+    PyObject *native;
+    /** \brief Buffer passed as userdata to a foreign callback pointer */
+    Py_buffer native_view;
+    /** \brief Callback run by PyCSDL2_AudioDeviceNativeCallback() */
+    SDL_AudioCallback native_callback;
+    /** \brief Userdata of native_callback */
+    void *native_userdata;
+    /** \brief Timing statistics of the callback */
+    PyCSDL2_AudioDeviceStats stats;
+} PyCSDL2_AudioDevice;
+
+static PyTypeObject PyCSDL2_AudioDeviceType;
+
+/** \brief Traversal function for PyCSDL2_AudioDeviceType */
+static int
+PyCSDL2_AudioDeviceTraverse(PyCSDL2_AudioDevice *self, visitproc visit,
+                            void *arg)
+{
+    Py_VISIT(self->callback);
+    Py_VISIT(self->userdata);
+    Py_VISIT(self->callback_buf);
+    return 0;
+}
+
+/** \brief Clear function for PyCSDL2_AudioDeviceType */
+static int
+PyCSDL2_AudioDeviceClear(PyCSDL2_AudioDevice *self)
+{
+    Py_CLEAR(self->callback);
+    Py_CLEAR(self->userdata);
+    Py_CLEAR(self->callback_buf);
+    return 0;
+}
+
+/**
+ * \brief Check if the PyCSDL2_AudioDevice is valid.
+ *
+ * \returns 1 if dev is valid, 0 otherwise.
+ */
+static int
+PyCSDL2_AudioDeviceValid(PyCSDL2_AudioDevice *dev)
+{
+    if (!PyCSDL2_Assert(dev))
+        return 0;
+
+    if (Py_TYPE(dev) != &PyCSDL2_AudioDeviceType) {
+        PyCSDL2_RaiseTypeError(NULL, "SDL_AudioDevice", (PyObject*)dev);
+        return 0;
+    }
+
+    if (!dev->id) {
+        PyErr_SetString(PyExc_ValueError, "invalid SDL_AudioDevice");
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Detaches the SDL_AudioDeviceID from the PyCSDL2_AudioDevice
+ *
+ * The objects used by the audio callback are kept alive, as the audio thread
+ * may still be running until SDL_CloseAudioDevice() returns. Call
+ * PyCSDL2_AudioDeviceRelease() after the audio device has been closed.
+ */
+static SDL_AudioDeviceID
+PyCSDL2_AudioDeviceDetach(PyCSDL2_AudioDevice *self)
+{
+    SDL_AudioDeviceID id;
+
+    if (!PyCSDL2_AudioDeviceValid(self))
+        return 0;
+
+    id = self->id;
+    self->id = 0;
+
+    return id;
+}
+
+/**
+ * \brief Releases the objects used by the audio callback.
+ *
+ * Must only be called once the audio device has been closed.
+ */
+static void
+PyCSDL2_AudioDeviceRelease(PyCSDL2_AudioDevice *self)
+{
+    PyCSDL2_AudioDeviceClear(self);
+
+    if (!self->native)
+        return;
+
+    if (Py_TYPE(self->native) == &PyCSDL2_AudioRingBufferType)
+        SDL_AtomicSet(&((PyCSDL2_AudioRingBuffer*)self->native)->attached, 0);
+    else if (Py_TYPE(self->native) == &PyCSDL2_AudioMixerType)
+        SDL_AtomicSet(&((PyCSDL2_AudioMixer*)self->native)->attached, 0);
+    else if (Py_TYPE(self->native) == &PyCSDL2_AudioResamplerType) {
+        PyCSDL2_AudioResampler *rs = (PyCSDL2_AudioResampler*) self->native;
+
+        SDL_AtomicSet(&rs->source->attached, 0);
+        SDL_AtomicSet(&rs->attached, 0);
+    }
+
+    PyBuffer_Release(&self->native_view);
+    Py_CLEAR(self->native);
+}
+
+/**
+ * \brief SDL-facing callback handler for native callbacks
+ *
+ * Runs the native callback of the PyCSDL2_AudioDevice and records how long
+ * it took. Does not touch the GIL.
+ */
+static void
+PyCSDL2_AudioDeviceNativeCallback(void *userdata, Uint8 *stream, int len)
+{
+    PyCSDL2_AudioDevice *self = userdata;
+    Uint64 start = SDL_GetPerformanceCounter(), ticks;
+
+    self->native_callback(self->native_userdata, stream, len);
+
+    ticks = SDL_GetPerformanceCounter() - start;
+    PyCSDL2_AudioDeviceStatsRecord(&self->stats, len, 0,
+                                   PyCSDL2_AudioStatsMicroseconds(ticks,
+                                   SDL_GetPerformanceFrequency()));
+}
+
+/**
+ * \brief Installs a foreign callback pointer on the PyCSDL2_AudioDevice
+ *
+ * \param self The audio device, which must not be opened yet.
+ * \param callback Foreign pointer object to the SDL_AudioCallback.
+ * \param ptr The SDL_AudioCallback extracted from callback.
+ * \param userdata The userdata object of the desired SDL_AudioSpec. It can be
+ *                 NULL or None, a foreign pointer object, or a writable
+ *                 buffer.
+ * \param spec The SDL_AudioSpec that will be passed to SDL.
+ * \returns 1 on success, -1 with an exception set on failure.
+ */
+static int
+PyCSDL2_AudioDeviceInstallForeign(PyCSDL2_AudioDevice *self,
+                                  PyObject *callback, void *ptr,
+                                  PyObject *userdata, SDL_AudioSpec *spec)
+{
+    void *userdata_ptr = NULL;
+    int ret;
+
+    if (!userdata)
+        userdata = Py_None;
+
+    if (userdata != Py_None) {
+        ret = PyCSDL2_ForeignPtr(userdata, NULL, &userdata_ptr);
+        if (ret < 0)
+            return -1;
+
+        if (!ret) {
+            if (!PyObject_CheckBuffer(userdata)) {
+                PyCSDL2_RaiseTypeError("userdata", "a foreign pointer or a "
+                                       "writable buffer", userdata);
+                return -1;
+            }
+            if (PyObject_GetBuffer(userdata, &self->native_view,
+                                   PyBUF_WRITABLE))
+                return -1;
+            userdata_ptr = self->native_view.buf;
+        }
+    }
+
+    self->native = Py_BuildValue("(OO)", callback, userdata);
+    if (!self->native) {
+        PyBuffer_Release(&self->native_view);
+        return -1;
+    }
+
+    spec->callback = (SDL_AudioCallback) ptr;
+    spec->userdata = userdata_ptr;
+    return 1;
+}
+
+/**
+ * \brief Installs a native callback object on the PyCSDL2_AudioDevice
+ *
+ * If obj is a SDL_AudioRingBuffer, SDL_AudioMixer or SDL_AudioResampler,
+ * claims it for the audio device and sets the callback and userdata of spec
+ * so that the audio thread runs it without the GIL. A ring buffer is filled
+ * by a capture device instead of feeding a playback device. If obj is a
+ * foreign pointer object, it is run as the audio callback. Either way, the
+ * callback is run through PyCSDL2_AudioDeviceNativeCallback(), which records
+ * its timing.
+ *
+ * \param self The audio device, which must not be opened yet.
+ * \param obj The callback object of the desired SDL_AudioSpec.
+ * \param userdata The userdata object of the desired SDL_AudioSpec.
+ * \param iscapture Non-zero if the audio device is a capture device.
+ * \param spec The SDL_AudioSpec that will be passed to SDL.
+ * \returns 1 if a native callback was installed, 0 if obj is not a native
+ *          callback object, -1 with an exception set on failure.
+ */
+static int
+PyCSDL2_AudioDeviceInstallNative(PyCSDL2_AudioDevice *self, PyObject *obj,
+                                 PyObject *userdata, int iscapture,
+                                 SDL_AudioSpec *spec)
+{
+    void *ptr;
+    int ret;
+
+    assert(!self->native);
+
+    if (!obj)
+        return 0;
+
+    ret = PyCSDL2_ForeignPtr(obj, "SDL_AudioCallback", &ptr);
+    if (ret < 0)
+        return -1;
+    else if (ret) {
+        if (PyCSDL2_AudioDeviceInstallForeign(self, obj, ptr, userdata,
+                                              spec) < 0)
+            return -1;
+        goto timed;
+    }
+
+    if (Py_TYPE(obj) == &PyCSDL2_AudioRingBufferType) {
+        PyCSDL2_AudioRingBuffer *ring = (PyCSDL2_AudioRingBuffer*) obj;
+
+        if (!PyCSDL2_AudioRingBufferAttach(ring, spec->format, iscapture))
+            return -1;
+
+        spec->callback = iscapture ? PyCSDL2_AudioRingBufferCapture :
+                         PyCSDL2_AudioRingBufferCallback;
+    } else if (Py_TYPE(obj) == &PyCSDL2_AudioMixerType) {
+        PyCSDL2_AudioMixer *mixer = (PyCSDL2_AudioMixer*) obj;
+
+        if (iscapture) {
+            PyErr_SetString(PyExc_ValueError, "SDL_AudioMixer cannot be "
+                            "used with capture devices");
+            return -1;
+        }
+
+        if (spec->format != mixer->format ||
+            spec->channels != mixer->channels) {
+            PyErr_SetString(PyExc_ValueError, "SDL_AudioSpec format and "
+                            "channels must match the SDL_AudioMixer");
+            return -1;
+        }
+
+        if (!PyCSDL2_AudioMixerAttach(mixer))
+            return -1;
+
+        spec->callback = PyCSDL2_AudioMixerCallback;
+    } else if (Py_TYPE(obj) == &PyCSDL2_AudioResamplerType) {
+        PyCSDL2_AudioResampler *rs = (PyCSDL2_AudioResampler*) obj;
+
+        if (iscapture) {
+            PyErr_SetString(PyExc_ValueError, "SDL_AudioResampler cannot be "
+                            "used with capture devices");
+            return -1;
+        }
+
+        if (!rs->source) {
+            PyErr_SetString(PyExc_ValueError, "SDL_AudioResampler has no "
+                            "source");
+            return -1;
+        }
+
+        if (spec->format != rs->format || spec->channels != rs->channels ||
+            spec->freq != rs->dst_rate) {
+            PyErr_SetString(PyExc_ValueError, "SDL_AudioSpec format, "
+                            "channels and freq must match the "
+                            "SDL_AudioResampler");
+            return -1;
+        }
+
+        if (!PyCSDL2_AudioResamplerAttach(rs, 1))
+            return -1;
+
+        spec->callback = PyCSDL2_AudioResamplerCallback;
+    } else {
+        return 0;
+    }
+
+    PyCSDL2_Set(self->native, obj);
+    spec->userdata = obj;
+
+timed:
+    self->native_callback = spec->callback;
+    self->native_userdata = spec->userdata;
+    spec->callback = PyCSDL2_AudioDeviceNativeCallback;
+    spec->userdata = self;
+    return 1;
+}
+
+/**
+ * \brief Updates the native callback object with the obtained audio format.
+ *
+ * \param self The audio device.
+ * \param obtained The obtained audio format, or NULL if SDL converts to the
+ *                 desired audio format.
+ * \returns 1 on success, 0 with an exception set if the native callback
+ *          object does not support the obtained audio format. The caller
+ *          should then close the audio device.
+ */
+static int
+PyCSDL2_AudioDeviceNativeOpened(PyCSDL2_AudioDevice *self,
+                                const SDL_AudioSpec *obtained)
+{
+    if (!self->native || !obtained)
+        return 1;
+
+    if (Py_TYPE(self->native) == &PyCSDL2_AudioRingBufferType) {
+        ((PyCSDL2_AudioRingBuffer*)self->native)->silence = obtained->silence;
+    } else if (Py_TYPE(self->native) == &PyCSDL2_AudioMixerType) {
+        PyCSDL2_AudioMixer *mixer = (PyCSDL2_AudioMixer*) self->native;
+
+        if (obtained->format != mixer->format ||
+            obtained->channels != mixer->channels) {
+            PyErr_SetString(PyExc_ValueError, "obtained audio format is not "
+                            "supported by the SDL_AudioMixer");
+            return 0;
+        }
+    } else if (Py_TYPE(self->native) == &PyCSDL2_AudioResamplerType) {
+        PyCSDL2_AudioResampler *rs = (PyCSDL2_AudioResampler*) self->native;
+
+        if (obtained->format != rs->format ||
+            obtained->channels != rs->channels ||
+            obtained->freq != rs->dst_rate) {
+            PyErr_SetString(PyExc_ValueError, "obtained audio format is not "
+                            "supported by the SDL_AudioResampler");
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Attaches the SDL_AudioDeviceID to the PyCSDL2_AudioDevice
+ *
+ * \param spec The audio format the device was opened with, or NULL if it is
+ *             not known.
+ */
+static void
+PyCSDL2_AudioDeviceAttach(PyCSDL2_AudioDevice *self, SDL_AudioDeviceID id,
+                          PyObject *callback, PyObject *userdata,
+                          const SDL_AudioSpec *spec)
+{
+    assert(!self->id);
+    assert(!self->callback);
+    assert(!self->userdata);
+
+    self->id = id;
+    PyCSDL2_Set(self->callback, callback);
+    PyCSDL2_Set(self->userdata, userdata);
+
+    /* The device starts paused, so the audio thread is not reading this */
+    if (spec)
+        self->stats.bytes_per_second = (Uint32) spec->freq * spec->channels *
+                                       (SDL_AUDIO_BITSIZE(spec->format) / 8);
+}
+
+/** \brief Destructor for PyCSDL2_AudioDevice */
+static void
+PyCSDL2_AudioDeviceDealloc(PyCSDL2_AudioDevice *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    if (self->id) {
+        SDL_AudioDeviceID id = self->id;
+        self->id = 0;
+        Py_BEGIN_ALLOW_THREADS
+        SDL_CloseAudioDevice(id);
+        Py_END_ALLOW_THREADS
+    }
+    PyCSDL2_AudioDeviceRelease(self);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief SDL-facing callback handler for PyCSDL2_AudioDeviceType */
+static void
+PyCSDL2_AudioDeviceCallback(void *userdata, Uint8 *stream, int len)
+{
+    Uint64 start = SDL_GetPerformanceCounter(), acquired, done, freq;
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    PyCSDL2_AudioDevice *self = userdata;
+    PyCSDL2_Buffer *buf = self->callback_buf;
+    PyObject *ret;
+    int valid;
+
+    acquired = SDL_GetPerformanceCounter();
+
+    /*
+     * We may be called in-between when the PyCSDL2_AudioDevice was invalidated
+     * and SDL_CloseAudioDevice() is actually called. As such, don't treat this
+     * as an error.
+     */
+    valid = PyCSDL2_AudioDeviceValid(self);
+    if (!valid) {
+        PyErr_Clear();
+        goto finish;
+    }
+
+    PyCSDL2_BufferInit(buf, CTYPE_UCHAR, stream, len, 0);
+
+    ret = PyObject_CallFunction(self->callback, "OOi",
+                                self->userdata ? self->userdata : Py_None,
+                                buf, len);
+    if (!ret)
+        PyErr_Print();
+
+    Py_XDECREF(ret);
+
+    if (buf->num_exports)
+        Py_FatalError("audio data buffer is still exported");
+
+    buf->buf = NULL;
+    done = SDL_GetPerformanceCounter();
+
+finish:
+    PyGILState_Release(gstate);
+
+    if (!valid)
+        return;
+
+    /*
+     * The audio device cannot be freed while its callback runs, so the
+     * statistics are recorded without holding up other threads on the GIL.
+     */
+    freq = SDL_GetPerformanceFrequency();
+    PyCSDL2_AudioDeviceStatsRecord(&self->stats, len,
+                                   PyCSDL2_AudioStatsMicroseconds(acquired -
+                                                                  start,
+                                                                  freq),
+                                   PyCSDL2_AudioStatsMicroseconds(done -
+                                                                  acquired,
+                                                                  freq));
+}
+
+/** \brief Type definition of csdl2.SDL_AudioSpec */
+static PyTypeObject PyCSDL2_AudioDeviceType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_AudioDevice",
+    /* tp_basicsize      */ sizeof(PyCSDL2_AudioDevice),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_AudioDeviceDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */
+    "An opened audio device.\n"
+    "\n"
+    "This is an opaque handle that cannot be directly constructed. Use \n"
+    "SDL_OpenAudioDevice() to create one.\n",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_AudioDeviceTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_AudioDeviceClear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_AudioDevice, in_weakreflist)
+};
+
+/**
+ * \brief Creates an instance of PyCSDL2_AudioDeviceType
+ */
+static PyObject *
+PyCSDL2_AudioDeviceCreate(SDL_AudioDeviceID id)
+{
+    PyCSDL2_AudioDevice *self;
+    PyTypeObject *type = &PyCSDL2_AudioDeviceType;
+
+    self = (PyCSDL2_AudioDevice*)type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    self->callback_buf = PyCSDL2_BufferCreate(CTYPE_UCHAR, NULL, 0, 0, NULL);
+    if (!self->callback_buf) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    PyCSDL2_AudioDeviceAttach(self, id, NULL, NULL, NULL);
+    return (PyObject*)self;
+}
+
+/**
+ * \brief Borrow the SDL_AudioDeviceID managed by the PyCSDL2_AudioDevice
+ *
+ * \param obj The PyCSDL2_AudioDevice object.
+ * \param[out] out Output pointer.
+ * \returns 1 on success, 0 if an exception occurred.
+ */
+static int
+PyCSDL2_AudioDeviceID(PyObject *obj, SDL_AudioDeviceID *out)
+{
+    PyCSDL2_AudioDevice *self = (PyCSDL2_AudioDevice*)obj;
+
+    if (!PyCSDL2_AudioDeviceValid(self))
+        return 0;
+
+    if (out)
+        *out = self->id;
+
+    return 1;
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_WAVBuf csdl2.SDL_WAVBuf
+ *
+ * \brief Manages the buffer returned by SDL_LoadWAV() and SDL_LoadWAV_RW()
+ *
+ * @{
+ */
+
+/** \brief Instance data for PyCSDL2_WAVBufType */
+typedef struct PyCSDL2_WAVBuf {
+    PyCSDL2_BufferHEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+} PyCSDL2_WAVBuf;
+
+/**
+ * \brief Checks if the PyCSDL2_WAVBuf is valid
+ */
+static int
+PyCSDL2_WAVBufValid(PyCSDL2_WAVBuf *buf)
+{
+    if (!PyCSDL2_Assert(buf))
+        return 0;
+
+    if (!buf->buf) {
+        PyErr_SetString(PyExc_ValueError, "Invalid SDL_WAVBuf");
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Detaches the buffer from the PyCSDL2_WAVBuf.
+ *
+ * Transfers ownership of the buffer from the PyCSDL2_WAVBuf object to the
+ * caller. The caller will thus now be responsible for freeing the buffer.
+ *
+ * \param self PyCSDL2_WAVBuf object to detach the buffer from
+ * \param[out] len Will be filled with the size of the buffer in bytes
+ * \returns The buffer managed by the PyCSDL2_WAVBuf object, or NULL with an
+ *          exception set on error.
+ */
+static Uint8*
+PyCSDL2_WAVBufDetach(PyCSDL2_WAVBuf *self, Uint32 *len)
+{
+    Uint8 *buf;
+
+    if (!PyCSDL2_WAVBufValid(self))
+        return NULL;
+
+    if (self->num_exports) {
+        PyErr_SetString(PyExc_ValueError, "SDL_WAVBuf is exporting a buffer");
+        return NULL;
+    }
+
+    buf = self->buf;
+    if (len)
+        *len = (Uint32) self->len;
+    self->buf = NULL;
+    return buf;
+}
+
+/** \brief Destructor for PyCSDL2_WAVBufType */
+static void
+PyCSDL2_WAVBufDealloc(PyCSDL2_WAVBuf *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    if (self->buf)
+        SDL_FreeWAV(self->buf);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Type definition for csdl2.SDL_WAVBuf */
+static PyTypeObject PyCSDL2_WAVBufType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_WAVBuf",
+    /* tp_basicsize      */ sizeof(PyCSDL2_WAVBuf),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_WAVBufDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ &PyCSDL2_BufferAsBuffer,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */ "Buffer containing WAVE data.",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_WAVBuf, in_weakreflist)
+};
+
+/**
+ * \brief Creates an instance of PyCSDL2_WAVBufType
+ *
+ * \param buf Audio buffer to take ownership of.
+ * \param len Length of the buffer.
+ */
+static PyCSDL2_WAVBuf *
+PyCSDL2_WAVBufCreate(Uint8 *buf, Uint32 len)
+{
+    PyCSDL2_WAVBuf *self;
+    PyTypeObject *type = &PyCSDL2_WAVBufType;
+
+    self = (PyCSDL2_WAVBuf*)type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    PyCSDL2_BufferInit((PyCSDL2_Buffer*) self, CTYPE_UCHAR, buf, len, 0);
+
+    return self;
+}
+
+/**
+ * \brief Internal PyCSDL2_AudioDevice for legacy API.
+ *
+ * The legacy SDL audio API operates on a global audio device (with ID 1).
+ * Since we need a PyCSDL2_AudioDevice object to store the related Python
+ * objects, we internally keep a global PyCSDL2_AudioDevice object that
+ * represents the global audio device.
+ */
+static PyCSDL2_AudioDevice *PyCSDL2_GlobalAudioDevice;
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_WAVStream csdl2.SDL_WAVStream
+ *
+ * \brief Reads the audio data of a WAVE file incrementally.
+ *
+ * SDL_LoadWAV_RW() reads the whole file into memory. A PyCSDL2_WAVStream
+ * parses the header once, and then reads the data chunk through a fixed-size
+ * read-ahead buffer as it is needed, so that long tracks can be played with
+ * constant memory.
+ *
+ * Only uncompressed PCM and IEEE float data can be streamed. ADPCM data still
+ * has to be decoded with SDL_LoadWAV_RW().
+ *
+ * @{
+ */
+
+/** \brief Default size of the read-ahead buffer in bytes */
+#define PYCSDL2_WAVSTREAM_BUFSIZE 65536
+
+/** \brief Maximum size of the read-ahead buffer in bytes */
+#define PYCSDL2_WAVSTREAM_MAXBUFSIZE (1 << 30)
+
+/** \brief WAVE format tag of integer PCM data */
+#define PYCSDL2_WAVE_PCM 0x0001
+
+/** \brief WAVE format tag of IEEE floating point data */
+#define PYCSDL2_WAVE_IEEE_FLOAT 0x0003
+
+/** \brief WAVE format tag whose actual tag is stored in the subformat GUID */
+#define PYCSDL2_WAVE_EXTENSIBLE 0xFFFE
+
+/** \brief Instance data for PyCSDL2_WAVStreamType */
+typedef struct PyCSDL2_WAVStream {
+    PyObject_HEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief Data source of the WAVE file */
+    PyCSDL2_RWops *src;
+    /** \brief Audio format of the data chunk */
+    SDL_AudioSpec spec;
+    /** \brief Number of bytes in a sample frame */
+    Uint32 frame_size;
+    /** \brief Offset of the data chunk in src */
+    Sint64 data_start;
+    /** \brief Size of the data chunk in bytes, rounded down to whole frames */
+    Uint64 data_len;
+    /** \brief Number of bytes of the data chunk which were read from src */
+    Uint64 consumed;
+    /** \brief Read-ahead buffer */
+    Uint8 *buf;
+    /** \brief Capacity of buf in bytes. It is a multiple of frame_size. */
+    Uint32 bufsize;
+    /** \brief Index of the first unread byte in buf */
+    Uint32 bufpos;
+    /** \brief Number of valid bytes in buf */
+    Uint32 buflen;
+    /** \brief Non-zero while the stream is being read without the GIL */
+    int busy;
+} PyCSDL2_WAVStream;
+
+/** \brief Reads a little-endian 16-bit integer */
+static Uint16
+PyCSDL2_WAVRead16(const Uint8 *p)
+{
+    return (Uint16) (p[0] | (p[1] << 8));
+}
+
+/** \brief Reads a little-endian 32-bit integer */
+static Uint32
+PyCSDL2_WAVRead32(const Uint8 *p)
+{
+    return (Uint32) p[0] | ((Uint32) p[1] << 8) | ((Uint32) p[2] << 16) |
+           ((Uint32) p[3] << 24);
+}
+
+/**
+ * \brief Seeks a Python data source forward.
+ *
+ * May be called without the GIL. Python data sources always have a seek
+ * callback, even if the stream behind them cannot seek, so an exception
+ * raised by the seek is cleared to let the caller read instead.
+ *
+ * \returns 1 on success, 0 if the data source could not seek.
+ */
+static int
+PyCSDL2_WAVSeekPy(SDL_RWops *rw, Uint64 len)
+{
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    int ret = 0;
+
+    /* Keep the exception of an earlier callback */
+    if (!PyErr_Occurred()) {
+        ret = SDL_RWseek(rw, (Sint64) len, RW_SEEK_CUR) >= 0;
+        if (PyErr_ExceptionMatches(PyExc_Exception))
+            PyErr_Clear();
+    }
+
+    PyGILState_Release(gstate);
+    return ret;
+}
+
+/**
+ * \brief Skips len bytes of a data source.
+ *
+ * Seeks if the data source can, and reads otherwise.
+ *
+ * \returns 1 on success, 0 if the data source ended.
+ */
+static int
+PyCSDL2_WAVSkip(SDL_RWops *rw, Uint64 len)
+{
+    Uint8 scratch[256];
+
+    if (rw->seek == PyCSDL2_RWSeekPyCall) {
+        if (PyCSDL2_WAVSeekPy(rw, len))
+            return 1;
+    } else if (rw->seek && SDL_RWseek(rw, (Sint64) len, RW_SEEK_CUR) >= 0)
+        return 1;
+
+    while (len) {
+        size_t n = len < sizeof(scratch) ? (size_t) len : sizeof(scratch);
+
+        if (SDL_RWread(rw, scratch, 1, n) != n)
+            return 0;
+        len -= n;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Parses the fmt chunk of a WAVE file.
+ *
+ * \param self The stream whose spec and frame_size will be filled in.
+ * \param fmt Contents of the fmt chunk.
+ * \param len Length of fmt. It is at least 16.
+ * \returns NULL on success, or an error message.
+ */
+static const char *
+PyCSDL2_WAVStreamParseFormat(PyCSDL2_WAVStream *self, const Uint8 *fmt,
+                             Uint32 len)
+{
+    Uint16 tag = PyCSDL2_WAVRead16(fmt);
+    Uint16 channels = PyCSDL2_WAVRead16(fmt + 2);
+    Uint32 freq = PyCSDL2_WAVRead32(fmt + 4);
+    Uint16 align = PyCSDL2_WAVRead16(fmt + 12);
+    Uint16 bits = PyCSDL2_WAVRead16(fmt + 14);
+
+    if (tag == PYCSDL2_WAVE_EXTENSIBLE) {
+        /* The subformat GUID starts with the actual format tag */
+        if (len < 26)
+            return "WAVE fmt chunk is too short";
+        tag = PyCSDL2_WAVRead16(fmt + 24);
+    }
+
+    if (tag == PYCSDL2_WAVE_PCM && bits == 8)
+        self->spec.format = AUDIO_U8;
+    else if (tag == PYCSDL2_WAVE_PCM && bits == 16)
+        self->spec.format = AUDIO_S16LSB;
+    else if (tag == PYCSDL2_WAVE_PCM && bits == 32)
+        self->spec.format = AUDIO_S32LSB;
+    else if (tag == PYCSDL2_WAVE_IEEE_FLOAT && bits == 32)
+        self->spec.format = AUDIO_F32LSB;
+    else
+        return "Only 8, 16 or 32-bit PCM and 32-bit float WAVE data can be "
+               "streamed";
+
+    if (!channels || channels > 255)
+        return "Invalid number of channels in WAVE file";
+
+    if (!freq || freq > 0x7FFFFFFF)
+        return "Invalid sample rate in WAVE file";
+
+    if (align != channels * (bits / 8))
+        return "Invalid block alignment in WAVE file";
+
+    self->spec.freq = (int) freq;
+    self->spec.channels = (Uint8) channels;
+    self->spec.samples = 4096;
+    self->frame_size = align;
+    return NULL;
+}
+
+/**
+ * \brief Parses the header of a WAVE file up to its data chunk.
+ *
+ * This may be called without the GIL. A Python data source may leave an
+ * exception set.
+ *
+ * \returns NULL on success, or an error message.
+ */
+static const char *
+PyCSDL2_WAVStreamParse(PyCSDL2_WAVStream *self)
+{
+    SDL_RWops *rw = self->src->rwops;
+    Uint8 hdr[12], fmt[40];
+    Uint32 size, len;
+    Sint64 offset = 12;
+    const char *err;
+    int have_fmt = 0;
+
+    if (SDL_RWread(rw, hdr, 1, 12) != 12 || SDL_memcmp(hdr, "RIFF", 4) ||
+        SDL_memcmp(hdr + 8, "WAVE", 4))
+        return "Not a WAVE file";
+
+    for (;;) {
+        if (SDL_RWread(rw, hdr, 1, 8) != 8)
+            return "WAVE file has no data chunk";
+        offset += 8;
+        size = PyCSDL2_WAVRead32(hdr + 4);
+
+        if (!SDL_memcmp(hdr, "data", 4)) {
+            if (!have_fmt)
+                return "WAVE data chunk precedes the fmt chunk";
+            self->data_start = offset;
+            self->data_len = size - size % self->frame_size;
+            return NULL;
+        }
+
+        len = 0;
+        if (!SDL_memcmp(hdr, "fmt ", 4)) {
+            if (size < 16)
+                return "WAVE fmt chunk is too short";
+            len = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (SDL_RWread(rw, fmt, 1, len) != len)
+                return "WAVE file is truncated";
+            err = PyCSDL2_WAVStreamParseFormat(self, fmt, len);
+            if (err)
+                return err;
+            have_fmt = 1;
+        }
+
+        /* Chunks are padded to an even size */
+        if (!PyCSDL2_WAVSkip(rw, (Uint64) size + (size & 1) - len))
+            return "WAVE file is truncated";
+        offset += (Sint64) size + (size & 1);
+    }
+}
+
+/**
+ * \brief Reads bytes of the data chunk from the data source.
+ *
+ * \returns The number of bytes read, which is 0 at the end of the data.
+ */
+static Uint32
+PyCSDL2_WAVStreamReadData(PyCSDL2_WAVStream *self, Uint8 *dst, Uint32 len)
+{
+    Uint64 left = self->data_len - self->consumed;
+    size_t n;
+
+    if (len > left)
+        len = (Uint32) left;
+    if (!len)
+        return 0;
+
+    n = SDL_RWread(self->src->rwops, dst, 1, len);
+    self->consumed += n;
+    return (Uint32) n;
+}
+
+/**
+ * \brief Reads sample frames from the stream.
+ *
+ * Small reads are served from the read-ahead buffer, while reads of at least
+ * a buffer's worth go to the data source directly. This may be called
+ * without the GIL.
+ *
+ * \param self The stream.
+ * \param out Output buffer of at least frames * frame_size bytes.
+ * \param frames Maximum number of frames to read.
+ * \returns The number of frames read, which is less than frames only at the
+ *          end of the data.
+ */
+static Uint32
+PyCSDL2_WAVStreamReadFrames(PyCSDL2_WAVStream *self, Uint8 *out,
+                            Uint32 frames)
+{
+    Uint32 want = frames * self->frame_size, got = 0, n;
+
+    while (got < want) {
+        if (self->bufpos == self->buflen) {
+            if (want - got >= self->bufsize) {
+                self->bufpos = self->buflen = 0;
+                n = PyCSDL2_WAVStreamReadData(self, out + got, want - got);
+                if (!n)
+                    break;
+                got += n;
+                continue;
+            }
+
+            self->bufpos = 0;
+            self->buflen = PyCSDL2_WAVStreamReadData(self, self->buf,
+                                                     self->bufsize);
+            if (!self->buflen)
+                break;
+        }
+
+        n = self->buflen - self->bufpos;
+        if (n > want - got)
+            n = want - got;
+        SDL_memcpy(out + got, self->buf + self->bufpos, n);
+        self->bufpos += n;
+        got += n;
+    }
+
+    /* A truncated file may end with a partial frame, which is dropped */
+    return got / self->frame_size;
+}
+
+/** \brief Returns the index of the next frame to be read */
+static Uint64
+PyCSDL2_WAVStreamTell(PyCSDL2_WAVStream *self)
+{
+    return (self->consumed - (self->buflen - self->bufpos)) / self->frame_size;
+}
+
+/**
+ * \brief Moves the stream to a frame.
+ *
+ * Seeks within the read-ahead buffer do not touch the data source. This may
+ * be called without the GIL.
+ *
+ * \returns 1 on success, 0 if the data source failed to seek.
+ */
+static int
+PyCSDL2_WAVStreamSeekFrame(PyCSDL2_WAVStream *self, Uint64 frame)
+{
+    Uint64 target = frame * self->frame_size;
+    Uint64 bufstart = self->consumed - self->buflen;
+
+    if (target >= bufstart && target <= self->consumed) {
+        self->bufpos = (Uint32) (target - bufstart);
+        return 1;
+    }
+
+    if (SDL_RWseek(self->src->rwops, self->data_start + (Sint64) target,
+                   RW_SEEK_SET) < 0)
+        return 0;
+
+    self->consumed = target;
+    self->bufpos = self->buflen = 0;
+    return 1;
+}
+
+/** \brief tp_traverse for PyCSDL2_WAVStreamType */
+static int
+PyCSDL2_WAVStreamTraverse(PyCSDL2_WAVStream *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->src);
+    return 0;
+}
+
+/** \brief tp_clear for PyCSDL2_WAVStreamType */
+static int
+PyCSDL2_WAVStreamClear(PyCSDL2_WAVStream *self)
+{
+    Py_CLEAR(self->src);
+    return 0;
+}
+
+/** \brief tp_dealloc for PyCSDL2_WAVStreamType */
+static void
+PyCSDL2_WAVStreamDealloc(PyCSDL2_WAVStream *self)
+{
+    PyObject_GC_UnTrack(self);
+    PyCSDL2_WAVStreamClear(self);
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyMem_Free(self->buf);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/**
+ * \brief Checks that the stream can be read.
+ *
+ * \returns 1 if the stream is valid and not in use by another thread, 0 with
+ *          an exception set otherwise.
+ */
+static int
+PyCSDL2_WAVStreamValid(PyCSDL2_WAVStream *self)
+{
+    if (!PyCSDL2_Assert(self->src))
+        return 0;
+
+    if (!PyCSDL2_RWopsValid(self->src))
+        return 0;
+
+    if (self->busy) {
+        PyErr_SetString(PyExc_ValueError, "SDL_WAVStream is in use");
+        return 0;
+    }
+
+    return 1;
+}
+
+/** \brief tp_new for PyCSDL2_WAVStreamType */
+static PyCSDL2_WAVStream *
+PyCSDL2_WAVStreamNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_WAVStream *self;
+    PyCSDL2_RWops *src;
+    Uint32 bufsize = PYCSDL2_WAVSTREAM_BUFSIZE;
+    const char *err;
+    static char *kwlist[] = {"src", "bufsize", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|" Uint32_UNIT, kwlist,
+                                     &PyCSDL2_RWopsType, &src, &bufsize))
+        return NULL;
+
+    if (!PyCSDL2_RWopsValid(src))
+        return NULL;
+
+    if (!src->rwops->read) {
+        PyErr_SetString(PyExc_ValueError, "src is not readable");
+        return NULL;
+    }
+
+    if (!bufsize || bufsize > PYCSDL2_WAVSTREAM_MAXBUFSIZE) {
+        PyErr_Format(PyExc_ValueError, "bufsize must be between 1 and %d",
+                     PYCSDL2_WAVSTREAM_MAXBUFSIZE);
+        return NULL;
+    }
+
+    self = (PyCSDL2_WAVStream*) type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    Py_INCREF(src);
+    self->src = src;
+
+    Py_BEGIN_ALLOW_THREADS
+    err = PyCSDL2_WAVStreamParse(self);
+    Py_END_ALLOW_THREADS
+
+    if (PyErr_Occurred()) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    if (err) {
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_ValueError, err);
+        return NULL;
+    }
+
+    /* Round the buffer up to whole frames */
+    bufsize += self->frame_size - 1;
+    bufsize -= bufsize % self->frame_size;
+    self->bufsize = bufsize;
+
+    self->buf = PyMem_Malloc(bufsize);
+    if (!self->buf) {
+        Py_DECREF(self);
+        return (PyCSDL2_WAVStream*) PyErr_NoMemory();
+    }
+
+    return self;
+}
+
+/** \brief Getter for SDL_WAVStream.spec */
+static PyObject *
+PyCSDL2_WAVStreamGetSpec(PyCSDL2_WAVStream *self, void *closure)
+{
+    return PyCSDL2_AudioSpecCreate(&self->spec);
+}
+
+/** \brief Getter for SDL_WAVStream.frames */
+static PyObject *
+PyCSDL2_WAVStreamGetFrames(PyCSDL2_WAVStream *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(self->data_len / self->frame_size);
+}
+
+/** \brief Getter for SDL_WAVStream.position */
+static PyObject *
+PyCSDL2_WAVStreamGetPosition(PyCSDL2_WAVStream *self, void *closure)
+{
+    return PyLong_FromUnsignedLongLong(PyCSDL2_WAVStreamTell(self));
+}
+
+/** \brief tp_members for PyCSDL2_WAVStreamType */
+static PyMemberDef PyCSDL2_WAVStreamMembers[] = {
+    {"src", T_OBJECT, offsetof(PyCSDL2_WAVStream, src), READONLY,
+     "(readonly) SDL_RWops the WAVE file is read from."},
+    {"frame_size", Uint32_TYPE, offsetof(PyCSDL2_WAVStream, frame_size),
+     READONLY,
+     "(readonly) Number of bytes in a sample frame."},
+    {"bufsize", Uint32_TYPE, offsetof(PyCSDL2_WAVStream, bufsize), READONLY,
+     "(readonly) Size of the read-ahead buffer in bytes."},
+    {NULL}
+};
+
+/** \brief tp_getset for PyCSDL2_WAVStreamType */
+static PyGetSetDef PyCSDL2_WAVStreamGetSetters[] = {
+    {"spec",
+     (getter) PyCSDL2_WAVStreamGetSpec,
+     (setter) NULL,
+     "(readonly) SDL_AudioSpec describing the audio data format."},
+    {"frames",
+     (getter) PyCSDL2_WAVStreamGetFrames,
+     (setter) NULL,
+     "(readonly) Total number of sample frames."},
+    {"position",
+     (getter) PyCSDL2_WAVStreamGetPosition,
+     (setter) NULL,
+     "(readonly) Index of the next sample frame to be read."},
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_WAVStream */
+static PyTypeObject PyCSDL2_WAVStreamType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_WAVStream",
+    /* tp_basicsize      */ sizeof(PyCSDL2_WAVStream),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_WAVStreamDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */
+    "Reads the audio data of a WAVE file incrementally.\n"
+    "\n"
+    "Read sample frames with SDL_WAVStreamRead(). Memory use is bounded by\n"
+    "the read-ahead buffer, whatever the length of the file.\n",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_WAVStreamTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_WAVStreamClear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_WAVStream, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_WAVStreamMembers,
+    /* tp_getset         */ PyCSDL2_WAVStreamGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_WAVStreamNew
+};
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_WAVCacheBuf csdl2.SDL_WAVCacheBuf
+ *
+ * \brief Caches converted WAVE data on disk.
+ *
+ * Loading a WAVE file and converting it to the format of the audio device
+ * takes time, and has to be done again every time the program starts.
+ * SDL_LoadWAVCached() stores the converted audio data in a cache file, and on
+ * later loads maps the cache file into memory instead. Cache hits need no
+ * decoding, no conversion and no copy of the audio data.
+ *
+ * A cache file consists of a PYCSDL2_WAVCACHE_HEADER byte header, followed by
+ * the converted audio data, followed by the identity of the source. All header
+ * fields are little endian:
+ *
+ * | Offset | Size | Field                                        |
+ * | ------ | ---- | -------------------------------------------- |
+ * | 0      | 8    | PYCSDL2_WAVCACHE_MAGIC                       |
+ * | 8      | 4    | PYCSDL2_WAVCACHE_VERSION                     |
+ * | 12     | 2    | Audio format of the data                     |
+ * | 14     | 1    | Number of channels                           |
+ * | 15     | 1    | Reserved, 0                                  |
+ * | 16     | 4    | Sample rate                                  |
+ * | 20     | 4    | Length of the data in bytes                  |
+ * | 24     | 4    | Length of the source identity in bytes       |
+ * | 28     | 36   | Reserved, 0                                  |
+ *
+ * A file source is identified by its path, size and modification time, and
+ * any other source by a key supplied by the caller. Either way the source is
+ * not read at all on a cache hit.
+ *
+ * @{
+ */
+
+/** \brief Magic bytes at the start of a cache file */
+#define PYCSDL2_WAVCACHE_MAGIC "PYCSDL2W"
+
+/** \brief Version of the cache file format */
+#define PYCSDL2_WAVCACHE_VERSION 2
+
+/**
+ * \brief Size of the cache file header.
+ *
+ * The data following it is thus 64-byte aligned in the mapping.
+ */
+#define PYCSDL2_WAVCACHE_HEADER 64
+
+/** \brief Number of temporary file names tried before giving up */
+#define PYCSDL2_WAVCACHE_TRIES 100
+
+/** \brief Identifies the contents of a cache file */
+typedef struct PyCSDL2_WAVCacheKey {
+    /** \brief Target audio format */
+    SDL_AudioFormat format;
+    /** \brief Target number of channels */
+    Uint8 channels;
+    /** \brief Target sample rate */
+    int freq;
+    /** \brief Identity of the source, to be freed with SDL_free() */
+    Uint8 *id;
+    /** \brief Length of id in bytes */
+    Uint32 id_len;
+} PyCSDL2_WAVCacheKey;
+
+/** \brief Instance data for PyCSDL2_WAVCacheBufType */
+typedef struct PyCSDL2_WAVCacheBuf {
+    PyCSDL2_BufferHEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief The mapped cache file. buf points into it. */
+    PyCSDL2_FileMapping map;
+} PyCSDL2_WAVCacheBuf;
+
+/** \brief Counter making temporary cache file names unique */
+static SDL_atomic_t PyCSDL2_WAVCacheTmpCount;
+
+static void
+PyCSDL2_WAVCachePut32(Uint8 *p, Uint32 x)
+{
+    x = SDL_SwapLE32(x);
+    SDL_memcpy(p, &x, 4);
+}
+
+static void
+PyCSDL2_WAVCachePut64(Uint8 *p, Uint64 x)
+{
+    x = SDL_SwapLE64(x);
+    SDL_memcpy(p, &x, 8);
+}
+
+static Uint32
+PyCSDL2_WAVCacheGet32(const Uint8 *p)
+{
+    Uint32 x;
+
+    SDL_memcpy(&x, p, 4);
+    return SDL_SwapLE32(x);
+}
+
+/**
+ * \brief Sets the identity of key to prefix followed by data.
+ *
+ * May be called without holding the GIL.
+ *
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_WAVCacheSetId(PyCSDL2_WAVCacheKey *key, const char *prefix,
+                      const void *data, size_t len)
+{
+    size_t prefix_len = SDL_strlen(prefix);
+
+    if (len > 0x7FFFFFFF - prefix_len)
+        return SDL_SetError("Cache key is too long");
+
+    key->id = SDL_malloc(prefix_len + len);
+    if (!key->id)
+        return SDL_OutOfMemory();
+    SDL_memcpy(key->id, prefix, prefix_len);
+    if (len)
+        SDL_memcpy(key->id + prefix_len, data, len);
+    key->id_len = (Uint32) (prefix_len + len);
+    return 0;
+}
+
+/**
+ * \brief Identifies the file at path by its path, size and modification time.
+ *
+ * The file is not opened. May be called without holding the GIL.
+ *
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_WAVCacheFileId(PyCSDL2_WAVCacheKey *key, const char *path)
+{
+    size_t pathlen = SDL_strlen(path);
+    Uint64 size, mtime;
+    Uint8 *id;
+    int ret;
+#ifdef __WIN32__
+    WIN32_FILE_ATTRIBUTE_DATA attrs;
+
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attrs))
+        return SDL_SetError("Couldn't open %s", path);
+    size = (Uint64) attrs.nFileSizeHigh << 32 | attrs.nFileSizeLow;
+    mtime = (Uint64) attrs.ftLastWriteTime.dwHighDateTime << 32 |
+            attrs.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat st;
+
+    if (stat(path, &st))
+        return SDL_SetError("Couldn't open %s", path);
+    size = (Uint64) st.st_size;
+#ifdef __APPLE__
+    mtime = (Uint64) st.st_mtimespec.tv_sec * 1000000000 +
+            (Uint64) st.st_mtimespec.tv_nsec;
+#else
+    mtime = (Uint64) st.st_mtim.tv_sec * 1000000000 +
+            (Uint64) st.st_mtim.tv_nsec;
+#endif
+#endif
+
+    /* The path, including its NUL, then the size and the time */
+    id = SDL_malloc(pathlen + 17);
+    if (!id)
+        return SDL_OutOfMemory();
+    SDL_memcpy(id, path, pathlen + 1);
+    PyCSDL2_WAVCachePut64(id + pathlen + 1, size);
+    PyCSDL2_WAVCachePut64(id + pathlen + 9, mtime);
+
+    ret = PyCSDL2_WAVCacheSetId(key, "file:", id, pathlen + 17);
+    SDL_free(id);
+    return ret;
+}
+
+/**
+ * \brief Checks that the mapped cache file holds the data for key.
+ *
+ * \param map The mapped cache file.
+ * \param key The expected key.
+ * \param[out] len Length of the audio data.
+ * \returns 1 if the cache file matches the key, 0 otherwise.
+ */
+static int
+PyCSDL2_WAVCacheCheck(const PyCSDL2_FileMapping *map,
+                      const PyCSDL2_WAVCacheKey *key, Uint32 *len)
+{
+    const Uint8 *hdr = map->base;
+
+    if (map->size < PYCSDL2_WAVCACHE_HEADER ||
+        SDL_memcmp(hdr, PYCSDL2_WAVCACHE_MAGIC, 8) ||
+        PyCSDL2_WAVCacheGet32(hdr + 8) != PYCSDL2_WAVCACHE_VERSION ||
+        (hdr[12] | hdr[13] << 8) != key->format ||
+        hdr[14] != key->channels ||
+        (int) PyCSDL2_WAVCacheGet32(hdr + 16) != key->freq ||
+        PyCSDL2_WAVCacheGet32(hdr + 24) != key->id_len)
+        return 0;
+
+    *len = PyCSDL2_WAVCacheGet32(hdr + 20);
+    return map->size - PYCSDL2_WAVCACHE_HEADER - key->id_len == *len &&
+           !SDL_memcmp(hdr + PYCSDL2_WAVCACHE_HEADER + *len, key->id,
+                       key->id_len);
+}
+
+/**
+ * \brief Decodes the WAVE file in src and converts it to the format of key.
+ *
+ * May be called without holding the GIL.
+ *
+ * \param src Source WAVE file. It is not closed.
+ * \param key Target format.
+ * \param[out] buf Converted audio data, to be freed with SDL_free().
+ * \param[out] len Length of the converted audio data.
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_WAVCacheConvert(SDL_RWops *src, const PyCSDL2_WAVCacheKey *key,
+                        Uint8 **buf, Uint32 *len)
+{
+    SDL_AudioSpec spec;
+    SDL_AudioCVT cvt;
+    Uint8 *audio_buf, *tmp;
+    Uint32 audio_len;
+    int ret;
+
+    if (!SDL_LoadWAV_RW(src, 0, &spec, &audio_buf, &audio_len))
+        return -1;
+
+    ret = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                            key->format, key->channels, key->freq);
+    if (ret < 0)
+        goto fail;
+
+    if (ret && audio_len) {
+        if ((Uint64) audio_len * cvt.len_mult > 0x7FFFFFFF) {
+            SDL_SetError("WAVE data is too large to convert");
+            goto fail;
+        }
+
+        tmp = SDL_realloc(audio_buf, audio_len * cvt.len_mult);
+        if (!tmp) {
+            SDL_OutOfMemory();
+            goto fail;
+        }
+        audio_buf = tmp;
+
+        cvt.buf = audio_buf;
+        cvt.len = (int) audio_len;
+        if (!PyCSDL2_AudioCVTConvert(&cvt, spec.channels, spec.freq,
+                                     key->channels, key->freq) &&
+            SDL_ConvertAudio(&cvt))
+            goto fail;
+        audio_len = (Uint32) cvt.len_cvt;
+    }
+
+    *buf = audio_buf;
+    *len = audio_len;
+    return 0;
+
+fail:
+    SDL_free(audio_buf);
+    return -1;
+}
+
+#ifdef __WIN32__
+/** \brief Writes all of data to file. */
+static int
+PyCSDL2_WAVCacheWriteAll(HANDLE file, const Uint8 *data, size_t len)
+{
+    DWORD n;
+
+    while (len) {
+        if (!WriteFile(file, data, len > 0x40000000 ? 0x40000000 : (DWORD) len,
+                       &n, NULL))
+            return 0;
+        data += n;
+        len -= n;
+    }
+    return 1;
+}
+#else
+/** \brief Writes all of data to fd. */
+static int
+PyCSDL2_WAVCacheWriteAll(int fd, const Uint8 *data, size_t len)
+{
+    ssize_t n;
+
+    while (len) {
+        n = write(fd, data, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 0;
+        data += n;
+        len -= (size_t) n;
+    }
+    return 1;
+}
+#endif
+
+/**
+ * \brief Writes a cache file.
+ *
+ * The cache file is written to a newly created temporary file with a unique
+ * name first, and then renamed to path. A partially written cache file is thus
+ * never mapped, and concurrent writers of the same cache file do not write
+ * into each other's temporary files.
+ *
+ * May be called without holding the GIL.
+ *
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_WAVCacheWrite(const char *path, const PyCSDL2_WAVCacheKey *key,
+                      const Uint8 *buf, Uint32 len)
+{
+    Uint8 hdr[PYCSDL2_WAVCACHE_HEADER];
+    Uint16 format = SDL_SwapLE16(key->format);
+    size_t tmplen = SDL_strlen(path) + 64;
+    char *tmppath;
+    int ok, tries;
+#ifdef __WIN32__
+    HANDLE file = INVALID_HANDLE_VALUE;
+    unsigned long pid = GetCurrentProcessId();
+#else
+    int fd = -1;
+    unsigned long pid = (unsigned long) getpid();
+#endif
+
+    SDL_memset(hdr, 0, sizeof(hdr));
+    SDL_memcpy(hdr, PYCSDL2_WAVCACHE_MAGIC, 8);
+    PyCSDL2_WAVCachePut32(hdr + 8, PYCSDL2_WAVCACHE_VERSION);
+    SDL_memcpy(hdr + 12, &format, 2);
+    hdr[14] = key->channels;
+    PyCSDL2_WAVCachePut32(hdr + 16, (Uint32) key->freq);
+    PyCSDL2_WAVCachePut32(hdr + 20, len);
+    PyCSDL2_WAVCachePut32(hdr + 24, key->id_len);
+
+    tmppath = SDL_malloc(tmplen);
+    if (!tmppath)
+        return SDL_OutOfMemory();
+
+    /* Like mkstemp(), but keeping the permissions of a new file */
+    for (tries = 0; tries < PYCSDL2_WAVCACHE_TRIES; tries++) {
+        SDL_snprintf(tmppath, tmplen, "%s.%lu.%d.tmp", path, pid,
+                     SDL_AtomicAdd(&PyCSDL2_WAVCacheTmpCount, 1));
+#ifdef __WIN32__
+        file = CreateFileA(tmppath, GENERIC_WRITE, 0, NULL, CREATE_NEW,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE ||
+            GetLastError() != ERROR_FILE_EXISTS)
+            break;
+#else
+        fd = open(tmppath, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if (fd >= 0 || errno != EEXIST)
+            break;
+#endif
+    }
+
+#ifdef __WIN32__
+    if (file == INVALID_HANDLE_VALUE) {
+#else
+    if (fd < 0) {
+#endif
+        SDL_free(tmppath);
+        return SDL_SetError("Couldn't write %s", path);
+    }
+
+#ifdef __WIN32__
+    ok = PyCSDL2_WAVCacheWriteAll(file, hdr, sizeof(hdr)) &&
+         PyCSDL2_WAVCacheWriteAll(file, buf, len) &&
+         PyCSDL2_WAVCacheWriteAll(file, key->id, key->id_len);
+    if (!CloseHandle(file))
+        ok = 0;
+    if (ok && !MoveFileExA(tmppath, path, MOVEFILE_REPLACE_EXISTING))
+        ok = 0;
+#else
+    ok = PyCSDL2_WAVCacheWriteAll(fd, hdr, sizeof(hdr)) &&
+         PyCSDL2_WAVCacheWriteAll(fd, buf, len) &&
+         PyCSDL2_WAVCacheWriteAll(fd, key->id, key->id_len);
+    if (close(fd))
+        ok = 0;
+    if (ok && rename(tmppath, path))
+        ok = 0;
+#endif
+
+    if (!ok) {
+        remove(tmppath);
+        SDL_free(tmppath);
+        return SDL_SetError("Couldn't write %s", path);
+    }
+
+    SDL_free(tmppath);
+    return 0;
+}
+
+/**
+ * \brief Maps the cache file for a source, creating it first if needed.
+ *
+ * The source is only opened and read on a cache miss. May be called without
+ * holding the GIL.
+ *
+ * \param file Path of the source WAVE file, or NULL to read src.
+ * \param src Source WAVE file if file is NULL. It is not closed.
+ * \param path Path of the cache file.
+ * \param key Target format. If file is given, the identity of the source is
+ *            filled in, otherwise it must have been set already.
+ * \param[out] map The mapped cache file.
+ * \param[out] len Length of the audio data following the header.
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_WAVCacheLoad(const char *file, SDL_RWops *src, const char *path,
+                     PyCSDL2_WAVCacheKey *key, PyCSDL2_FileMapping *map,
+                     Uint32 *len)
+{
+    Uint8 *buf;
+    Uint32 buflen;
+    int ret;
+
+    if (file && !key->id && PyCSDL2_WAVCacheFileId(key, file))
+        return -1;
+
+    if (!PyCSDL2_MapFile(path, map)) {
+        if (PyCSDL2_WAVCacheCheck(map, key, len))
+            return 0;
+        PyCSDL2_UnmapFile(map);
+    }
+
+    if (file) {
+        src = SDL_RWFromFile(file, "rb");
+        if (!src)
+            return -1;
+    }
+
+    ret = PyCSDL2_WAVCacheConvert(src, key, &buf, &buflen);
+    if (file)
+        SDL_RWclose(src);
+    if (ret)
+        return -1;
+
+    ret = PyCSDL2_WAVCacheWrite(path, key, buf, buflen);
+    SDL_free(buf);
+    if (ret)
+        return -1;
+
+    if (PyCSDL2_MapFile(path, map))
+        return -1;
+
+    if (!PyCSDL2_WAVCacheCheck(map, key, len)) {
+        PyCSDL2_UnmapFile(map);
+        return SDL_SetError("Invalid cache file %s", path);
+    }
+
+    return 0;
+}
+
+/** \brief Destructor for PyCSDL2_WAVCacheBufType */
+static void
+PyCSDL2_WAVCacheBufDealloc(PyCSDL2_WAVCacheBuf *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyCSDL2_UnmapFile(&self->map);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Type definition for csdl2.SDL_WAVCacheBuf */
+static PyTypeObject PyCSDL2_WAVCacheBufType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_WAVCacheBuf",
+    /* tp_basicsize      */ sizeof(PyCSDL2_WAVCacheBuf),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_WAVCacheBufDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ &PyCSDL2_BufferAsBuffer,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */ "Read-only buffer containing cached audio data.",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_WAVCacheBuf, in_weakreflist)
+};
+
+/**
+ * \brief Creates an instance of PyCSDL2_WAVCacheBufType
+ *
+ * \param map Mapped cache file to take ownership of. It is unmapped on
+ *            failure.
+ * \param len Length of the audio data following the header.
+ */
+static PyCSDL2_WAVCacheBuf *
+PyCSDL2_WAVCacheBufCreate(PyCSDL2_FileMapping *map, Uint32 len)
+{
+    PyCSDL2_WAVCacheBuf *self;
+    PyTypeObject *type = &PyCSDL2_WAVCacheBufType;
+
+    self = (PyCSDL2_WAVCacheBuf*)type->tp_alloc(type, 0);
+    if (!self) {
+        PyCSDL2_UnmapFile(map);
+        return NULL;
+    }
+
+    self->map = *map;
+    PyCSDL2_BufferInit((PyCSDL2_Buffer*) self, CTYPE_UCHAR,
+                       map->base + PYCSDL2_WAVCACHE_HEADER, len, 1);
+
+    return self;
+}
+
+/** @} */
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_BITSIZE()
+ *
+ * \code{.py}
+ * SDL_AUDIO_BITSIZE(x: int) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_BITSIZE(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyLong_FromUnsignedLong(SDL_AUDIO_BITSIZE(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISFLOAT()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISFLOAT(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISFLOAT(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISFLOAT(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISBIGENDIAN()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISBIGENDIAN(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISBIGENDIAN(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISBIGENDIAN(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISSIGNED()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISSIGNED(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISSIGNED(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISSIGNED(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISINT()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISINT(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISINT(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISINT(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISLITTLEENDIAN()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISLITTLEENDIAN(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISLITTLEENDIAN(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISLITTLEENDIAN(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_AUDIO_ISUNSIGNED()
+ *
+ * \code{.py}
+ * SDL_AUDIO_ISUNSIGNED(x: int) -> bool
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AUDIO_ISUNSIGNED(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint16 x;
+    static char *kwlist[] = {"x", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+        return NULL;
+
+    return PyBool_FromLong(SDL_AUDIO_ISUNSIGNED(x));
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetNumAudioDrivers()
+ *
+ * \code{.py}
+ * SDL_GetNumAudioDrivers() -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetNumAudioDrivers(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    return PyLong_FromLong(SDL_GetNumAudioDrivers());
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetAudioDriver()
+ *
+ * \code{.py}
+ * SDL_GetAudioDriver(index: int) -> str
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetAudioDriver(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    int index;
+    const char *name;
+    static char *kwlist[] = {"index", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", kwlist, &index))
+        return NULL;
+
+    name = SDL_GetAudioDriver(index);
+    if (!name) {
+        PyErr_SetString(PyExc_ValueError, "Index out of range");
+        return NULL;
+    }
+
+    return PyUnicode_FromString(name);
+}
+
+/**
+ * \brief Implements csdl2.SDL_AudioInit()
+ *
+ * \code{.py}
+ * SDL_AudioInit(driver_name: str or None) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AudioInit(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    const char *driver_name;
+    int ret;
+    static char *kwlist[] = {"driver_name", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "z", kwlist, &driver_name))
+        return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SDL_AudioInit(driver_name);
+    Py_END_ALLOW_THREADS
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_AudioQuit()
+ *
+ * \code{.py}
+ * SDL_AudioQuit() -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AudioQuit(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    SDL_AudioQuit();
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetCurrentAudioDriver()
+ *
+ * \code{.py}
+ * SDL_GetCurrentAudioDriver() -> str or None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetCurrentAudioDriver(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    const char *driver_name;
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    driver_name = SDL_GetCurrentAudioDriver();
+    if (driver_name)
+        return PyUnicode_FromString(driver_name);
+    else
+        Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_OpenAudio()
+ *
+ * \code{.py}
+ * SDL_OpenAudio(desired: SDL_AudioSpec, obtained: SDL_AudioSpec or None)
+ *     -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_OpenAudio(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_AudioSpec *desired, *obtained;
+    SDL_AudioSpec spec;
+    int ret;
+    static char *kwlist[] = {"desired", "obtained", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O", kwlist,
+                                     &PyCSDL2_AudioSpecType, &desired,
+                                     &obtained))
+        return NULL;
+
+    if ((PyObject*) obtained != Py_None &&
+        Py_TYPE(obtained) != &PyCSDL2_AudioSpecType) {
+        PyErr_SetString(PyExc_TypeError, "\"obtained\" must be either a "
+                        "SDL_AudioSpec or None");
+        return NULL;
+    }
+
+    if (!desired->callback || desired->callback == Py_None) {
+        PyErr_SetString(PyExc_ValueError, "\"callback\" is None");
+        return NULL;
+    }
+
+    if (PyCSDL2_GlobalAudioDevice) {
+        PyErr_SetString(PyExc_RuntimeError, "Audio device is already opened");
+        return NULL;
+    }
+
+    PyCSDL2_GlobalAudioDevice = (PyCSDL2_AudioDevice *)PyCSDL2_AudioDeviceCreate(0);
+    if (!PyCSDL2_GlobalAudioDevice)
+        return NULL;
+
+    /* desired must not keep pointers to the device once it is closed */
+    spec = desired->spec;
+
+    ret = PyCSDL2_AudioDeviceInstallNative(PyCSDL2_GlobalAudioDevice,
+                                           desired->callback,
+                                           desired->userdata, 0, &spec);
+    if (ret < 0) {
+        Py_CLEAR(PyCSDL2_GlobalAudioDevice);
+        return NULL;
+    } else if (!ret) {
+        spec.callback = PyCSDL2_AudioDeviceCallback;
+        spec.userdata = PyCSDL2_GlobalAudioDevice;
+    }
+
+    PyEval_InitThreads();
+
+    Py_INCREF(desired);
+    Py_INCREF(obtained);
+    Py_BEGIN_ALLOW_THREADS
+    ret = SDL_OpenAudio(&spec,
+                        (PyObject*) obtained == Py_None ? NULL : &obtained->spec);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(obtained);
+    Py_DECREF(desired);
+
+    if (ret) {
+        Py_CLEAR(PyCSDL2_GlobalAudioDevice);
+        return PyCSDL2_RaiseSDLError();
+    }
+
+    PyCSDL2_AudioDeviceAttach(PyCSDL2_GlobalAudioDevice, 1,
+                              desired->callback, desired->userdata,
+                              (PyObject*) obtained == Py_None ?
+                              &spec : &obtained->spec);
+
+    if (!PyCSDL2_AudioDeviceNativeOpened(PyCSDL2_GlobalAudioDevice,
+                                         (PyObject*) obtained == Py_None ?
+                                         &spec : &obtained->spec)) {
+        PyCSDL2_AudioDeviceDetach(PyCSDL2_GlobalAudioDevice);
+        Py_BEGIN_ALLOW_THREADS
+        SDL_CloseAudio();
+        Py_END_ALLOW_THREADS
+        Py_CLEAR(PyCSDL2_GlobalAudioDevice);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetNumAudioDevices()
+ *
+ * \code{.py}
+ * SDL_GetNumAudioDevices(iscapture: bool) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetNumAudioDevices(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    int iscapture, ret;
+    static char *kwlist[] = {"iscapture", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "p", kwlist, &iscapture))
+        return NULL;
+
+    SDL_ClearError();
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SDL_GetNumAudioDevices(iscapture);
+    Py_END_ALLOW_THREADS
+
+    if (ret == -1 && *(SDL_GetError()))
+        return PyCSDL2_RaiseSDLError();
+
+    return PyLong_FromLong(ret);
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetAudioDeviceName()
+ *
+ * \code{.py}
+ * SDL_GetAudioDeviceName(index: int, iscapture: bool) -> str
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetAudioDeviceName(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    int index, iscapture;
+    const char *device_name;
+    static char *kwlist[] = {"index", "iscapture", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ip", kwlist, &index,
+                                     &iscapture))
+        return NULL;
+
+    device_name = SDL_GetAudioDeviceName(index, iscapture);
+
+    if (!device_name)
+        return PyCSDL2_RaiseSDLError();
+
+    return PyUnicode_FromString(device_name);
+}
+
+/**
+ * \brief Implements csdl2.SDL_OpenAudioDevice()
+ *
+ * \code{.py}
+ * SDL_OpenAudioDevice(device: str, iscapture: bool, desired: SDL_AudioSpec,
+ *                     obtained: SDL_AudioSpec, allowed_changes: int)
+ *      -> SDL_AudioDevice
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_OpenAudioDevice(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Py_buffer device;
+    int iscapture;
+    SDL_AudioSpec desired;
+    PyCSDL2_AudioSpec *desired_obj, *obtained;
+    int allowed_changes, native;
+    SDL_AudioDeviceID id;
+    PyObject *out = NULL, *callback = NULL, *userdata = NULL;
+    static char *kwlist[] = {"device", "iscapture", "desired", "obtained",
+                             "allowed_changes", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "z*pO!Oi", kwlist,
+                                     &device, &iscapture,
+                                     &PyCSDL2_AudioSpecType, &desired_obj,
+                                     &obtained, &allowed_changes))
+        return NULL;
+
+    if ((PyObject*) obtained != Py_None &&
+            Py_TYPE(obtained) != &PyCSDL2_AudioSpecType) {
+        PyErr_SetString(PyExc_TypeError, "\"obtained\" must be either a "
+                        "SDL_AudioSpec or None");
+        goto fail;
+    }
+
+    out = PyCSDL2_AudioDeviceCreate(0);
+    if (!out)
+        goto fail;
+
+    desired = desired_obj->spec;
+
+    /*
+     * If callback is NULL, install our native callback, or our Python bridge
+     * callback.
+     */
+    if (!desired.callback) {
+        native = PyCSDL2_AudioDeviceInstallNative((PyCSDL2_AudioDevice*)out,
+                                                  desired_obj->callback,
+                                                  desired_obj->userdata,
+                                                  iscapture, &desired);
+        if (native < 0)
+            goto fail;
+    }
+
+    if (!desired.callback) {
+        desired.callback = PyCSDL2_AudioDeviceCallback;
+        desired.userdata = out;
+        callback = desired_obj->callback;
+        userdata = desired_obj->userdata;
+
+        if (!callback || callback == Py_None) {
+            PyErr_SetString(PyExc_ValueError, "\"callback\" is None");
+            goto fail;
+        }
+    }
+
+    PyEval_InitThreads();
+
+    id = SDL_OpenAudioDevice(device.buf, iscapture, &desired,
+                             (PyObject*) obtained == Py_None ?
+                             NULL : &obtained->spec,
+                             allowed_changes);
+    if (!id) {
+        PyCSDL2_RaiseSDLError();
+        goto fail;
+    }
+
+    PyCSDL2_AudioDeviceAttach((PyCSDL2_AudioDevice*)out, id, callback,
+                              userdata,
+                              (PyObject*) obtained == Py_None ?
+                              &desired : &obtained->spec);
+
+    if (!PyCSDL2_AudioDeviceNativeOpened((PyCSDL2_AudioDevice*)out,
+                                         (PyObject*) obtained == Py_None ?
+                                         NULL : &obtained->spec))
+        goto fail;
+
+    PyBuffer_Release(&device);
+    return out;
 
-/** @} */
+fail:
+    PyBuffer_Release(&device);
+    Py_XDECREF(out);
+    return NULL;
+}
 
 /**
- * \brief Implements csdl2.SDL_AUDIO_BITSIZE()
+ * \brief Implements csdl2.SDL_AudioRingBufferWrite()
  *
  * \code{.py}
- * SDL_AUDIO_BITSIZE(x: int) -> int
+ * SDL_AudioRingBufferWrite(ring: SDL_AudioRingBuffer, data: buffer) -> int
  * \endcode
  */
 static PyObject *
-PyCSDL2_AUDIO_BITSIZE(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioRingBufferWrite(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    PyCSDL2_AudioRingBuffer *ring;
+    Py_buffer data;
+    Uint32 len, ret;
+    static char *kwlist[] = {"ring", "data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!y*", kwlist,
+                                     &PyCSDL2_AudioRingBufferType, &ring,
+                                     &data))
+        return NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+    if (!PyCSDL2_AudioRingBufferCheckRole(ring, 0)) {
+        PyBuffer_Release(&data);
         return NULL;
+    }
 
-    return PyLong_FromUnsignedLong(SDL_AUDIO_BITSIZE(x));
+    len = data.len > PYCSDL2_AUDIORINGBUFFER_MAXSIZE ?
+          PYCSDL2_AUDIORINGBUFFER_MAXSIZE : (Uint32) data.len;
+
+    ret = PyCSDL2_AudioRingBufferPush(ring, data.buf, len);
+
+    PyBuffer_Release(&data);
+    return PyLong_FromUnsignedLong(ret);
 }
 
 /**
- * \brief Implements csdl2.SDL_AUDIO_ISFLOAT()
+ * \brief Records a memoryview returned by SDL_AudioRingBufferPeek()
  *
- * \code{.py}
- * SDL_AUDIO_ISFLOAT(x: int) -> bool
- * \endcode
+ * Entries whose data is no longer exported are dropped on the way.
+ *
+ * \returns 1 on success, 0 with an exception set on failure.
  */
-static PyObject *
-PyCSDL2_AUDIO_ISFLOAT(PyObject *module, PyObject *args, PyObject *kwds)
+static int
+PyCSDL2_AudioRingBufferTrack(PyCSDL2_AudioRingBuffer *self,
+                             PyCSDL2_Buffer *buf, PyObject *view)
 {
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    PyObject *ref, *item;
+    Py_ssize_t i, j = 0;
+    int ret;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
-        return NULL;
+    if (!self->peeked) {
+        self->peeked = PyList_New(0);
+        if (!self->peeked)
+            return 0;
+    }
 
-    return PyBool_FromLong(SDL_AUDIO_ISFLOAT(x));
-}
+    for (i = 0; i < PyList_GET_SIZE(self->peeked); i++) {
+        item = PyList_GET_ITEM(self->peeked, i);
+        if (((PyCSDL2_Buffer*) PyTuple_GET_ITEM(item, 0))->num_exports) {
+            Py_INCREF(item);
+            PyList_SetItem(self->peeked, j++, item);
+        }
+    }
+    if (PyList_SetSlice(self->peeked, j, i, NULL))
+        return 0;
 
-/**
- * \brief Implements csdl2.SDL_AUDIO_ISBIGENDIAN()
- *
- * \code{.py}
- * SDL_AUDIO_ISBIGENDIAN(x: int) -> bool
- * \endcode
- */
-static PyObject *
-PyCSDL2_AUDIO_ISBIGENDIAN(PyObject *module, PyObject *args, PyObject *kwds)
-{
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    ref = PyWeakref_NewRef(view, NULL);
+    if (!ref)
+        return 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
-        return NULL;
+    item = PyTuple_Pack(2, (PyObject*) buf, ref);
+    Py_DECREF(ref);
+    if (!item)
+        return 0;
 
-    return PyBool_FromLong(SDL_AUDIO_ISBIGENDIAN(x));
+    ret = PyList_Append(self->peeked, item);
+    Py_DECREF(item);
+    return !ret;
 }
 
 /**
- * \brief Implements csdl2.SDL_AUDIO_ISSIGNED()
+ * \brief Releases the memoryviews returned by SDL_AudioRingBufferPeek()
  *
- * \code{.py}
- * SDL_AUDIO_ISSIGNED(x: int) -> bool
- * \endcode
+ * Fails with BufferError if the data is still exported by other objects,
+ * such as slices of the memoryviews, in which case it must not be consumed.
+ *
+ * \returns 1 on success, 0 with an exception set on failure.
  */
-static PyObject *
-PyCSDL2_AUDIO_ISSIGNED(PyObject *module, PyObject *args, PyObject *kwds)
+static int
+PyCSDL2_AudioRingBufferRelease(PyCSDL2_AudioRingBuffer *self)
 {
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    Py_ssize_t i, n;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
-        return NULL;
+    if (!self->peeked)
+        return 1;
 
-    return PyBool_FromLong(SDL_AUDIO_ISSIGNED(x));
-}
+    n = PyList_GET_SIZE(self->peeked);
 
-/**
- * \brief Implements csdl2.SDL_AUDIO_ISINT()
- *
- * \code{.py}
- * SDL_AUDIO_ISINT(x: int) -> bool
- * \endcode
- */
-static PyObject *
-PyCSDL2_AUDIO_ISINT(PyObject *module, PyObject *args, PyObject *kwds)
-{
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    for (i = 0; i < n; i++) {
+        PyObject *item = PyList_GET_ITEM(self->peeked, i);
+        PyObject *view = PyWeakref_GetObject(PyTuple_GET_ITEM(item, 1));
+        PyObject *ret;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
-        return NULL;
+        if (view == Py_None)
+            continue;
 
-    return PyBool_FromLong(SDL_AUDIO_ISINT(x));
+        Py_INCREF(view);
+        ret = PyObject_CallMethod(view, "release", NULL);
+        Py_DECREF(view);
+        if (!ret)
+            return 0;
+        Py_DECREF(ret);
+    }
+
+    for (i = 0; i < n; i++) {
+        PyObject *item = PyList_GET_ITEM(self->peeked, i);
+
+        if (((PyCSDL2_Buffer*) PyTuple_GET_ITEM(item, 0))->num_exports) {
+            PyErr_SetString(PyExc_BufferError, "data returned by "
+                            "SDL_AudioRingBufferPeek() is still exported");
+            return 0;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        PyObject *item = PyList_GET_ITEM(self->peeked, i);
+
+        ((PyCSDL2_Buffer*) PyTuple_GET_ITEM(item, 0))->buf = NULL;
+    }
+
+    Py_CLEAR(self->peeked);
+    return 1;
 }
 
 /**
- * \brief Implements csdl2.SDL_AUDIO_ISLITTLEENDIAN()
+ * \brief Implements csdl2.SDL_AudioRingBufferPeek()
  *
  * \code{.py}
- * SDL_AUDIO_ISLITTLEENDIAN(x: int) -> bool
+ * SDL_AudioRingBufferPeek(ring: SDL_AudioRingBuffer)
+ *     -> (memoryview, memoryview)
  * \endcode
  */
 static PyObject *
-PyCSDL2_AUDIO_ISLITTLEENDIAN(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioRingBufferPeek(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    PyCSDL2_AudioRingBuffer *ring;
+    Uint32 head, tail, first, n;
+    PyCSDL2_Buffer *buf[2] = {NULL, NULL};
+    PyObject *view[2] = {NULL, NULL};
+    PyObject *out = NULL;
+    int i;
+    static char *kwlist[] = {"ring", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_AudioRingBufferType, &ring))
         return NULL;
 
-    return PyBool_FromLong(SDL_AUDIO_ISLITTLEENDIAN(x));
+    if (!PyCSDL2_AudioRingBufferCheckRole(ring, 1))
+        return NULL;
+
+    head = (Uint32) SDL_AtomicGet(&ring->head);
+    tail = (Uint32) SDL_AtomicGet(&ring->tail);
+    SDL_MemoryBarrierAcquire();
+
+    /*
+     * The producer never writes to the queued bytes, so the views stay valid
+     * until SDL_AudioRingBufferConsume() releases them.
+     */
+    n = head - tail;
+    first = ring->size - (tail & (ring->size - 1));
+    if (first > n)
+        first = n;
+
+    buf[0] = PyCSDL2_BufferCreate(CTYPE_UCHAR,
+                                  ring->buf + (tail & (ring->size - 1)),
+                                  first, 1, (PyObject*) ring);
+    buf[1] = PyCSDL2_BufferCreate(CTYPE_UCHAR, ring->buf, n - first, 1,
+                                  (PyObject*) ring);
+    if (!buf[0] || !buf[1])
+        goto finish;
+
+    for (i = 0; i < 2; i++) {
+        view[i] = PyMemoryView_FromObject((PyObject*) buf[i]);
+        if (!view[i])
+            goto finish;
+    }
+
+    for (i = 0; i < 2; i++)
+        if (!PyCSDL2_AudioRingBufferTrack(ring, buf[i], view[i]))
+            goto finish;
+
+    out = PyTuple_Pack(2, view[0], view[1]);
+
+finish:
+    for (i = 0; i < 2; i++) {
+        Py_XDECREF(view[i]);
+        Py_XDECREF(buf[i]);
+    }
+    return out;
 }
 
 /**
- * \brief Implements csdl2.SDL_AUDIO_ISUNSIGNED()
+ * \brief Implements csdl2.SDL_AudioRingBufferConsume()
  *
  * \code{.py}
- * SDL_AUDIO_ISUNSIGNED(x: int) -> bool
+ * SDL_AudioRingBufferConsume(ring: SDL_AudioRingBuffer, len: int) -> None
  * \endcode
  */
 static PyObject *
-PyCSDL2_AUDIO_ISUNSIGNED(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioRingBufferConsume(PyObject *module, PyObject *args,
+                               PyObject *kwds)
 {
-    Uint16 x;
-    static char *kwlist[] = {"x", NULL};
+    PyCSDL2_AudioRingBuffer *ring;
+    Uint32 len, tail;
+    static char *kwlist[] = {"ring", "len", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint16_UNIT, kwlist, &x))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!" Uint32_UNIT, kwlist,
+                                     &PyCSDL2_AudioRingBufferType, &ring,
+                                     &len))
         return NULL;
 
-    return PyBool_FromLong(SDL_AUDIO_ISUNSIGNED(x));
-}
+    if (!PyCSDL2_AudioRingBufferCheckRole(ring, 1))
+        return NULL;
 
-/**
- * \brief Implements csdl2.SDL_GetNumAudioDrivers()
- *
- * \code{.py}
- * SDL_GetNumAudioDrivers() -> int
- * \endcode
- */
-static PyObject *
-PyCSDL2_GetNumAudioDrivers(PyObject *module, PyObject *args, PyObject *kwds)
-{
-    static char *kwlist[] = {NULL};
+    if (len > PyCSDL2_AudioRingBufferQueued(ring)) {
+        PyErr_SetString(PyExc_ValueError, "len is larger than the number of "
+                        "queued bytes");
+        return NULL;
+    }
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+    if (!PyCSDL2_AudioRingBufferRelease(ring))
         return NULL;
 
-    return PyLong_FromLong(SDL_GetNumAudioDrivers());
+    tail = (Uint32) SDL_AtomicGet(&ring->tail);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->tail, (int) (tail + len));
+
+    Py_RETURN_NONE;
 }
 
 /**
- * \brief Implements csdl2.SDL_GetAudioDriver()
+ * \brief Implements csdl2.SDL_AudioMixerPlay()
  *
  * \code{.py}
- * SDL_GetAudioDriver(index: int) -> str
+ * SDL_AudioMixerPlay(mixer: SDL_AudioMixer, voice: int, data: buffer,
+ *                    channels: int = 0, gain: float = 1.0, pan: float = 0.0,
+ *                    loop: bool = False, loop_start: int = 0,
+ *                    loop_end: int = 0) -> None
  * \endcode
  */
 static PyObject *
-PyCSDL2_GetAudioDriver(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioMixerPlay(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    int index;
-    const char *name;
-    static char *kwlist[] = {"index", NULL};
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", kwlist, &index))
+    PyCSDL2_AudioMixer *mixer;
+    PyCSDL2_AudioMixerCmd cmd;
+    Py_buffer data;
+    int channels = 0, loop = 0;
+    float gain = 1.0f, pan = 0.0f;
+    Uint32 loop_start = 0, loop_end = 0;
+    Py_ssize_t frames;
+    static char *kwlist[] = {"mixer", "voice", "data", "channels", "gain",
+                             "pan", "loop", "loop_start", "loop_end", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!iy*|iffp" Uint32_UNIT
+                                     Uint32_UNIT, kwlist,
+                                     &PyCSDL2_AudioMixerType, &mixer,
+                                     &cmd.voice, &data, &channels, &gain,
+                                     &pan, &loop, &loop_start, &loop_end))
         return NULL;
 
-    name = SDL_GetAudioDriver(index);
-    if (!name) {
-        PyErr_SetString(PyExc_ValueError, "Index out of range");
-        return NULL;
+    if (!PyCSDL2_AudioMixerVoiceParams(mixer, &cmd, gain, pan))
+        goto fail;
+
+    if (!channels)
+        channels = mixer->channels;
+
+    if (channels != 1 && channels != 2) {
+        PyErr_SetString(PyExc_ValueError, "channels must be 1 or 2");
+        goto fail;
     }
 
-    return PyUnicode_FromString(name);
+    frames = data.len / (PyCSDL2_AudioMixerSampleSize(mixer->format) *
+                         channels);
+    if ((Uint64) frames > 0xFFFFFFFF) {
+        PyErr_SetString(PyExc_ValueError, "data is too large");
+        goto fail;
+    }
+
+    if (!loop_end)
+        loop_end = (Uint32) frames;
+
+    if (loop && (loop_start >= loop_end || loop_end > frames)) {
+        PyErr_SetString(PyExc_ValueError, "invalid loop points");
+        goto fail;
+    }
+
+    cmd.type = PYCSDL2_AUDIOMIXER_PLAY;
+    cmd.data = data.buf;
+    cmd.frames = (Uint32) frames;
+    cmd.channels = channels;
+    cmd.loop = loop;
+    cmd.loop_start = loop_start;
+    cmd.loop_end = loop_end;
+
+    if (!PyCSDL2_AudioMixerPush(mixer, &cmd, &data))
+        goto fail;
+
+    Py_RETURN_NONE;
+
+fail:
+    PyBuffer_Release(&data);
+    return NULL;
 }
 
 /**
- * \brief Implements csdl2.SDL_AudioInit()
+ * \brief Implements csdl2.SDL_AudioMixerStop()
  *
  * \code{.py}
- * SDL_AudioInit(driver_name: str or None) -> None
+ * SDL_AudioMixerStop(mixer: SDL_AudioMixer, voice: int) -> None
  * \endcode
  */
 static PyObject *
-PyCSDL2_AudioInit(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioMixerStop(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    const char *driver_name;
-    int ret;
-    static char *kwlist[] = {"driver_name", NULL};
+    PyCSDL2_AudioMixer *mixer;
+    PyCSDL2_AudioMixerCmd cmd;
+    static char *kwlist[] = {"mixer", "voice", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "z", kwlist, &driver_name))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!i", kwlist,
+                                     &PyCSDL2_AudioMixerType, &mixer,
+                                     &cmd.voice))
         return NULL;
 
-    Py_BEGIN_ALLOW_THREADS
-    ret = SDL_AudioInit(driver_name);
-    Py_END_ALLOW_THREADS
+    if (!PyCSDL2_AudioMixerVoiceParams(mixer, &cmd, 0.0f, 0.0f))
+        return NULL;
 
-    if (ret)
-        return PyCSDL2_RaiseSDLError();
+    cmd.type = PYCSDL2_AUDIOMIXER_STOP;
+    if (!PyCSDL2_AudioMixerPush(mixer, &cmd, NULL))
+        return NULL;
 
     Py_RETURN_NONE;
 }
 
 /**
- * \brief Implements csdl2.SDL_AudioQuit()
+ * \brief Implements csdl2.SDL_AudioMixerSetParams()
  *
  * \code{.py}
- * SDL_AudioQuit() -> None
+ * SDL_AudioMixerSetParams(mixer: SDL_AudioMixer, voice: int,
+ *                         gain: float = 1.0, pan: float = 0.0) -> None
  * \endcode
  */
 static PyObject *
-PyCSDL2_AudioQuit(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioMixerSetParams(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {NULL};
+    PyCSDL2_AudioMixer *mixer;
+    PyCSDL2_AudioMixerCmd cmd;
+    float gain = 1.0f, pan = 0.0f;
+    static char *kwlist[] = {"mixer", "voice", "gain", "pan", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!i|ff", kwlist,
+                                     &PyCSDL2_AudioMixerType, &mixer,
+                                     &cmd.voice, &gain, &pan))
+        return NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+    if (!PyCSDL2_AudioMixerVoiceParams(mixer, &cmd, gain, pan))
         return NULL;
 
-    Py_BEGIN_ALLOW_THREADS
-    SDL_AudioQuit();
-    Py_END_ALLOW_THREADS
+    cmd.type = PYCSDL2_AUDIOMIXER_PARAMS;
+    if (!PyCSDL2_AudioMixerPush(mixer, &cmd, NULL))
+        return NULL;
 
     Py_RETURN_NONE;
 }
 
 /**
- * \brief Implements csdl2.SDL_GetCurrentAudioDriver()
+ * \brief Implements csdl2.SDL_AudioMixerIsPlaying()
  *
  * \code{.py}
- * SDL_GetCurrentAudioDriver() -> str or None
+ * SDL_AudioMixerIsPlaying(mixer: SDL_AudioMixer, voice: int) -> bool
  * \endcode
  */
 static PyObject *
-PyCSDL2_GetCurrentAudioDriver(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioMixerIsPlaying(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    const char *driver_name;
-    static char *kwlist[] = {NULL};
+    PyCSDL2_AudioMixer *mixer;
+    PyCSDL2_AudioMixerCmd cmd;
+    static char *kwlist[] = {"mixer", "voice", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!i", kwlist,
+                                     &PyCSDL2_AudioMixerType, &mixer,
+                                     &cmd.voice))
         return NULL;
 
-    driver_name = SDL_GetCurrentAudioDriver();
-    if (driver_name)
-        return PyUnicode_FromString(driver_name);
-    else
-        Py_RETURN_NONE;
+    if (!PyCSDL2_AudioMixerVoiceParams(mixer, &cmd, 0.0f, 0.0f))
+        return NULL;
+
+    PyCSDL2_AudioMixerCollect(mixer);
+
+    return PyBool_FromLong(SDL_AtomicGet(&mixer->playing[cmd.voice]));
 }
 
 /**
- * \brief Implements csdl2.SDL_OpenAudio()
+ * \brief Implements csdl2.SDL_AudioMixerMix()
  *
  * \code{.py}
- * SDL_OpenAudio(desired: SDL_AudioSpec, obtained: SDL_AudioSpec or None)
- *     -> None
+ * SDL_AudioMixerMix(mixer: SDL_AudioMixer, stream: buffer) -> None
  * \endcode
  */
 static PyObject *
-PyCSDL2_OpenAudio(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioMixerMix(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    PyCSDL2_AudioSpec *desired, *obtained;
-    int ret;
-    static char *kwlist[] = {"desired", "obtained", NULL};
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O", kwlist,
-                                     &PyCSDL2_AudioSpecType, &desired,
-                                     &obtained))
-        return NULL;
-
-    if ((PyObject*) obtained != Py_None &&
-        Py_TYPE(obtained) != &PyCSDL2_AudioSpecType) {
-        PyErr_SetString(PyExc_TypeError, "\"obtained\" must be either a "
-                        "SDL_AudioSpec or None");
-        return NULL;
-    }
-
-    if (!desired->callback || desired->callback == Py_None) {
-        PyErr_SetString(PyExc_ValueError, "\"callback\" is None");
-        return NULL;
-    }
-
-    if (PyCSDL2_GlobalAudioDevice) {
-        PyErr_SetString(PyExc_RuntimeError, "Audio device is already opened");
-        return NULL;
-    }
+    PyCSDL2_AudioMixer *mixer;
+    Py_buffer stream;
+    static char *kwlist[] = {"mixer", "stream", NULL};
 
-    PyCSDL2_GlobalAudioDevice = (PyCSDL2_AudioDevice *)PyCSDL2_AudioDeviceCreate(0);
-    if (!PyCSDL2_GlobalAudioDevice)
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!w*", kwlist,
+                                     &PyCSDL2_AudioMixerType, &mixer,
+                                     &stream))
         return NULL;
 
-    desired->spec.callback = PyCSDL2_AudioDeviceCallback;
-    desired->spec.userdata = PyCSDL2_GlobalAudioDevice;
-
-    PyEval_InitThreads();
-
-    Py_INCREF(desired);
-    Py_INCREF(obtained);
-    Py_BEGIN_ALLOW_THREADS
-    ret = SDL_OpenAudio(&desired->spec,
-                        (PyObject*) obtained == Py_None ? NULL : &obtained->spec);
-    Py_END_ALLOW_THREADS
-    Py_DECREF(obtained);
-    Py_DECREF(desired);
-
-    if (ret) {
-        Py_CLEAR(PyCSDL2_GlobalAudioDevice);
-        return PyCSDL2_RaiseSDLError();
+    if (SDL_AtomicGet(&mixer->attached)) {
+        PyBuffer_Release(&stream);
+        PyErr_SetString(PyExc_ValueError, "SDL_AudioMixer is attached to an "
+                        "audio device");
+        return NULL;
     }
 
-    PyCSDL2_AudioDeviceAttach(PyCSDL2_GlobalAudioDevice, 1,
-                              desired->callback, desired->userdata);
+    if ((Uint64) stream.len > 0xFFFFFFFF) {
+        PyBuffer_Release(&stream);
+        PyErr_SetString(PyExc_ValueError, "stream is too large");
+        return NULL;
+    }
+
+    /* The GIL prevents the mixer from being attached in the meantime. */
+    PyCSDL2_AudioMixerRender(mixer, stream.buf, (Uint32) stream.len);
+    PyCSDL2_AudioMixerCollect(mixer);
 
+    PyBuffer_Release(&stream);
     Py_RETURN_NONE;
 }
 
 /**
- * \brief Implements csdl2.SDL_GetNumAudioDevices()
+ * \brief Resamples audio data with a PyCSDL2_AudioResampler.
  *
- * \code{.py}
- * SDL_GetNumAudioDevices(iscapture: bool) -> int
- * \endcode
+ * \param rs The resampler.
+ * \param data Input frames, or NULL for silence.
+ * \param frames Number of input frames.
+ * \param reset Non-zero to reset the resampler afterwards.
+ * \returns A new bytes object with the output frames, or NULL with an
+ *          exception set.
  */
 static PyObject *
-PyCSDL2_GetNumAudioDevices(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioResamplerProcessBytes(PyCSDL2_AudioResampler *rs,
+                                   const Uint8 *data, Uint64 frames,
+                                   int reset)
 {
-    int iscapture, ret;
-    static char *kwlist[] = {"iscapture", NULL};
+    Uint32 fsize = PyCSDL2_AudioResamplerFrameSize(rs);
+    Uint64 avail, produced;
+    PyObject *out;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "p", kwlist, &iscapture))
+    if (!PyCSDL2_AudioResamplerAttach(rs, 0))
         return NULL;
 
-    SDL_ClearError();
+    avail = PyCSDL2_AudioResamplerAvail(rs, frames);
+    if (avail > PY_SSIZE_T_MAX / fsize) {
+        SDL_AtomicSet(&rs->attached, 0);
+        return PyErr_NoMemory();
+    }
+
+    out = PyBytes_FromStringAndSize(NULL, (Py_ssize_t) (avail * fsize));
+    if (!out) {
+        SDL_AtomicSet(&rs->attached, 0);
+        return NULL;
+    }
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SDL_GetNumAudioDevices(iscapture);
+    produced = PyCSDL2_AudioResamplerProcessData(rs, data, frames,
+                                                 (Uint8 *)
+                                                 PyBytes_AS_STRING(out));
+    if (reset)
+        PyCSDL2_AudioResamplerInitHistory(rs);
     Py_END_ALLOW_THREADS
 
-    if (ret == -1 && *(SDL_GetError()))
-        return PyCSDL2_RaiseSDLError();
+    SDL_AtomicSet(&rs->attached, 0);
+    assert(produced == avail);
+    (void) produced;
 
-    return PyLong_FromLong(ret);
+    return out;
 }
 
 /**
- * \brief Implements csdl2.SDL_GetAudioDeviceName()
+ * \brief Implements csdl2.SDL_AudioResamplerProcess()
  *
  * \code{.py}
- * SDL_GetAudioDeviceName(index: int, iscapture: bool) -> str
+ * SDL_AudioResamplerProcess(resampler: SDL_AudioResampler,
+ *                           data: buffer) -> bytes
  * \endcode
  */
 static PyObject *
-PyCSDL2_GetAudioDeviceName(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioResamplerProcess(PyObject *module, PyObject *args,
+                              PyObject *kwds)
 {
-    int index, iscapture;
-    const char *device_name;
-    static char *kwlist[] = {"index", "iscapture", NULL};
+    PyCSDL2_AudioResampler *rs;
+    Py_buffer data;
+    Py_ssize_t frame_size;
+    PyObject *ret;
+    static char *kwlist[] = {"resampler", "data", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "ip", kwlist, &index,
-                                     &iscapture))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!y*", kwlist,
+                                     &PyCSDL2_AudioResamplerType, &rs, &data))
         return NULL;
 
-    device_name = SDL_GetAudioDeviceName(index, iscapture);
-
-    if (!device_name)
-        return PyCSDL2_RaiseSDLError();
+    frame_size = PyCSDL2_AudioResamplerFrameSize(rs);
+    if (data.len % frame_size) {
+        PyBuffer_Release(&data);
+        PyErr_SetString(PyExc_ValueError, "data must contain whole sample "
+                        "frames");
+        return NULL;
+    }
 
-    return PyUnicode_FromString(device_name);
+    ret = PyCSDL2_AudioResamplerProcessBytes(rs, data.buf,
+                                             data.len / frame_size, 0);
+    PyBuffer_Release(&data);
+    return ret;
 }
 
 /**
- * \brief Implements csdl2.SDL_OpenAudioDevice()
+ * \brief Implements csdl2.SDL_AudioResamplerFlush()
  *
  * \code{.py}
- * SDL_OpenAudioDevice(device: str, iscapture: bool, desired: SDL_AudioSpec,
- *                     obtained: SDL_AudioSpec, allowed_changes: int)
- *      -> SDL_AudioDevice
+ * SDL_AudioResamplerFlush(resampler: SDL_AudioResampler) -> bytes
  * \endcode
  */
 static PyObject *
-PyCSDL2_OpenAudioDevice(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_AudioResamplerFlush(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    Py_buffer device;
-    int iscapture;
-    SDL_AudioSpec desired;
-    PyCSDL2_AudioSpec *desired_obj, *obtained;
-    int allowed_changes;
-    SDL_AudioDeviceID id;
-    PyObject *out = NULL, *callback = NULL, *userdata = NULL;
-    static char *kwlist[] = {"device", "iscapture", "desired", "obtained",
-                             "allowed_changes", NULL};
+    PyCSDL2_AudioResampler *rs;
+    static char *kwlist[] = {"resampler", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "z*pO!Oi", kwlist,
-                                     &device, &iscapture,
-                                     &PyCSDL2_AudioSpecType, &desired_obj,
-                                     &obtained, &allowed_changes))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_AudioResamplerType, &rs))
         return NULL;
 
-    if ((PyObject*) obtained != Py_None &&
-            Py_TYPE(obtained) != &PyCSDL2_AudioSpecType) {
-        PyErr_SetString(PyExc_TypeError, "\"obtained\" must be either a "
-                        "SDL_AudioSpec or None");
-        goto fail;
-    }
-
-    out = PyCSDL2_AudioDeviceCreate(0);
-    if (!out)
-        goto fail;
-
-    desired = desired_obj->spec;
-
-    /* If callback is NULL, install our Python bridge callback. */
-    if (!desired.callback) {
-        desired.callback = PyCSDL2_AudioDeviceCallback;
-        desired.userdata = out;
-        callback = desired_obj->callback;
-        userdata = desired_obj->userdata;
+    /* Half a window of silence pushes out the output up to the last input */
+    return PyCSDL2_AudioResamplerProcessBytes(rs, NULL, rs->taps / 2, 1);
+}
 
-        if (!callback || callback == Py_None) {
-            PyErr_SetString(PyExc_ValueError, "\"callback\" is None");
-            goto fail;
-        }
-    }
+/**
+ * \brief Implements csdl2.SDL_AudioResamplerReset()
+ *
+ * \code{.py}
+ * SDL_AudioResamplerReset(resampler: SDL_AudioResampler) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_AudioResamplerReset(PyObject *module, PyObject *args,
+                                PyObject *kwds)
+{
+    PyCSDL2_AudioResampler *rs;
+    static char *kwlist[] = {"resampler", NULL};
 
-    PyEval_InitThreads();
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_AudioResamplerType, &rs))
+        return NULL;
 
-    id = SDL_OpenAudioDevice(device.buf, iscapture, &desired,
-                             (PyObject*) obtained == Py_None ? NULL : &obtained->spec,
-                             allowed_changes);
-    if (!id) {
-        PyCSDL2_RaiseSDLError();
-        goto fail;
-    }
+    if (!PyCSDL2_AudioResamplerAttach(rs, 0))
+        return NULL;
 
-    PyCSDL2_AudioDeviceAttach((PyCSDL2_AudioDevice*)out, id, callback,
-                              userdata);
-    PyBuffer_Release(&device);
-    return out;
+    PyCSDL2_AudioResamplerInitHistory(rs);
+    SDL_AtomicSet(&rs->attached, 0);
 
-fail:
-    PyBuffer_Release(&device);
-    Py_XDECREF(out);
-    return NULL;
+    Py_RETURN_NONE;
 }
 
 /**
@@ -1347,6 +5060,76 @@ PyCSDL2_GetAudioDeviceStatus(PyObject *module, PyObject *args, PyObject *kwds)
     return PyLong_FromLong(ret);
 }
 
+/**
+ * \brief Implements csdl2.SDL_GetAudioDeviceStats()
+ *
+ * \code{.py}
+ * SDL_GetAudioDeviceStats(dev: SDL_AudioDevice) -> dict
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetAudioDeviceStats(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_AudioDevice *dev;
+    PyCSDL2_AudioDeviceStats st;
+    static char *kwlist[] = {"dev", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_AudioDeviceType, &dev))
+        return NULL;
+
+    if (!PyCSDL2_AudioDeviceValid(dev))
+        return NULL;
+
+    PyCSDL2_AudioDeviceStatsSnapshot(&dev->stats, &st);
+
+    return Py_BuildValue("{s:K,s:K,s:K,s:I,s:I,s:K,s:I,s:I}",
+                         "callbacks", (unsigned long long) st.callbacks,
+                         "overruns", (unsigned long long) st.overruns,
+                         "gil_wait_total", (unsigned long long)
+                         st.gil_wait_total,
+                         "gil_wait_max", (unsigned int) st.gil_wait_max,
+                         "gil_wait_p99", (unsigned int)
+                         PyCSDL2_AudioStatsP99(st.gil_wait_hist, st.callbacks,
+                                               st.gil_wait_max),
+                         "call_total", (unsigned long long) st.call_total,
+                         "call_max", (unsigned int) st.call_max,
+                         "call_p99", (unsigned int)
+                         PyCSDL2_AudioStatsP99(st.call_hist, st.callbacks,
+                                               st.call_max));
+}
+
+/**
+ * \brief Implements csdl2.SDL_ResetAudioDeviceStats()
+ *
+ * \code{.py}
+ * SDL_ResetAudioDeviceStats(dev: SDL_AudioDevice) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_ResetAudioDeviceStats(PyObject *module, PyObject *args,
+                              PyObject *kwds)
+{
+    PyCSDL2_AudioDevice *dev;
+    static char *kwlist[] = {"dev", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_AudioDeviceType, &dev))
+        return NULL;
+
+    if (!PyCSDL2_AudioDeviceValid(dev))
+        return NULL;
+
+    /* The audio thread may be waiting for the GIL with the device locked */
+    Py_BEGIN_ALLOW_THREADS
+    SDL_LockAudioDevice(dev->id);
+    PyCSDL2_AudioDeviceStatsReset(&dev->stats);
+    SDL_UnlockAudioDevice(dev->id);
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
 /**
  * \brief Implements csdl2.SDL_PauseAudio()
  *
@@ -1514,6 +5297,201 @@ PyCSDL2_FreeWAV(PyObject *module, PyObject *args, PyObject *kwds)
     Py_RETURN_NONE;
 }
 
+/**
+ * \brief Implements csdl2.SDL_LoadWAVCached()
+ *
+ * \code{.py}
+ * SDL_LoadWAVCached(src: str or SDL_RWops, spec: SDL_AudioSpec, cache: str,
+ *                   key: str or bytes or None=None)
+ *     -> (SDL_AudioSpec, SDL_WAVCacheBuf, int)
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_LoadWAVCached(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *src_obj, *spec_obj, *key_obj = Py_None;
+    const char *file = NULL, *cache, *id;
+    Py_ssize_t id_len;
+    PyCSDL2_RWops *rwops = NULL;
+    SDL_AudioSpec *target, spec;
+    PyCSDL2_WAVCacheKey key;
+    PyCSDL2_FileMapping map;
+    Uint32 len;
+    int ret;
+    PyObject *outspec = NULL;
+    PyCSDL2_WAVCacheBuf *outbuf = NULL;
+    PyObject *out = NULL;
+    static char *kwlist[] = {"src", "spec", "cache", "key", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOs|O", kwlist, &src_obj,
+                                     &spec_obj, &cache, &key_obj))
+        return NULL;
+
+    if (PyUnicode_Check(src_obj)) {
+        file = PyUnicode_AsUTF8(src_obj);
+        if (!file)
+            return NULL;
+    } else if (Py_TYPE(src_obj) == &PyCSDL2_RWopsType) {
+        rwops = (PyCSDL2_RWops*) src_obj;
+        if (!PyCSDL2_RWopsValid(rwops))
+            return NULL;
+    } else {
+        return PyCSDL2_RaiseTypeError("src", "str or SDL_RWops", src_obj);
+    }
+
+    if (!PyCSDL2_AudioSpecPtr(spec_obj, &target))
+        return NULL;
+
+    SDL_zero(key);
+    key.format = target->format;
+    key.channels = target->channels;
+    key.freq = target->freq;
+
+    if (key_obj != Py_None) {
+        if (PyBytes_Check(key_obj)) {
+            id = PyBytes_AS_STRING(key_obj);
+            id_len = PyBytes_GET_SIZE(key_obj);
+        } else if (PyUnicode_Check(key_obj)) {
+            id = PyUnicode_AsUTF8AndSize(key_obj, &id_len);
+            if (!id)
+                return NULL;
+        } else {
+            return PyCSDL2_RaiseTypeError("key", "str or bytes", key_obj);
+        }
+        if (PyCSDL2_WAVCacheSetId(&key, "key:", id, (size_t) id_len))
+            return PyCSDL2_RaiseSDLError();
+    } else if (rwops) {
+        PyErr_SetString(PyExc_ValueError,
+                        "key is required when src is a SDL_RWops");
+        return NULL;
+    }
+
+    Py_XINCREF(rwops);
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_WAVCacheLoad(file, rwops ? rwops->rwops : NULL, cache,
+                               &key, &map, &len);
+    SDL_free(key.id);
+    Py_END_ALLOW_THREADS
+    Py_XDECREF(rwops);
+
+    /* A SDL_RWops calling back into Python may have raised an exception */
+    if (PyErr_Occurred()) {
+        if (!ret)
+            PyCSDL2_UnmapFile(&map);
+        return NULL;
+    }
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    outbuf = PyCSDL2_WAVCacheBufCreate(&map, len);
+
+    /* Same as the spec SDL_LoadWAV_RW() returns */
+    SDL_zero(spec);
+    spec.format = key.format;
+    spec.channels = key.channels;
+    spec.freq = key.freq;
+    spec.samples = 4096;
+    outspec = PyCSDL2_AudioSpecCreate(&spec);
+
+    if (outbuf && outspec)
+        out = Py_BuildValue("OO" Uint32_UNIT, outspec, outbuf, len);
+
+    Py_XDECREF(outspec);
+    Py_XDECREF(outbuf);
+    return out;
+}
+
+/**
+ * \brief Implements csdl2.SDL_WAVStreamRead()
+ *
+ * \code{.py}
+ * SDL_WAVStreamRead(stream: SDL_WAVStream, buffer: buffer,
+ *                   frames: int) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_WAVStreamRead(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_WAVStream *stream;
+    Py_buffer buffer;
+    Uint32 frames, ret;
+    static char *kwlist[] = {"stream", "buffer", "frames", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!w*" Uint32_UNIT, kwlist,
+                                     &PyCSDL2_WAVStreamType, &stream,
+                                     &buffer, &frames))
+        return NULL;
+
+    if (!PyCSDL2_WAVStreamValid(stream)) {
+        PyBuffer_Release(&buffer);
+        return NULL;
+    }
+
+    if ((Uint64) frames * stream->frame_size > 0xFFFFFFFF ||
+        (Py_ssize_t) (frames * stream->frame_size) > buffer.len) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError, "buffer is too small");
+        return NULL;
+    }
+
+    stream->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_WAVStreamReadFrames(stream, buffer.buf, frames);
+    Py_END_ALLOW_THREADS
+    stream->busy = 0;
+
+    PyBuffer_Release(&buffer);
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    return PyLong_FromUnsignedLong(ret);
+}
+
+/**
+ * \brief Implements csdl2.SDL_WAVStreamSeek()
+ *
+ * \code{.py}
+ * SDL_WAVStreamSeek(stream: SDL_WAVStream, frame: int) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_WAVStreamSeek(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_WAVStream *stream;
+    Uint64 frame;
+    int ret;
+    static char *kwlist[] = {"stream", "frame", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!" Uint64_UNIT, kwlist,
+                                     &PyCSDL2_WAVStreamType, &stream,
+                                     &frame))
+        return NULL;
+
+    if (!PyCSDL2_WAVStreamValid(stream))
+        return NULL;
+
+    if (frame > stream->data_len / stream->frame_size) {
+        PyErr_SetString(PyExc_ValueError, "frame is out of range");
+        return NULL;
+    }
+
+    stream->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_WAVStreamSeekFrame(stream, frame);
+    Py_END_ALLOW_THREADS
+    stream->busy = 0;
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    if (!ret)
+        return PyCSDL2_RaiseSDLError();
+
+    Py_RETURN_NONE;
+}
+
 /**
  * \brief Implements csdl2.SDL_BuildAudioCVT()
  *
@@ -1547,6 +5525,11 @@ PyCSDL2_BuildAudioCVT(PyObject *module, PyObject *args, PyObject *kwds)
     if (ret < 0)
         return PyCSDL2_RaiseSDLError();
 
+    cvt->src_channels = src_channels;
+    cvt->dst_channels = dst_channels;
+    cvt->src_rate = src_rate;
+    cvt->dst_rate = dst_rate;
+
     return PyBool_FromLong(ret);
 }
 
@@ -1556,6 +5539,9 @@ PyCSDL2_BuildAudioCVT(PyObject *module, PyObject *args, PyObject *kwds)
  * \code{.py}
  * SDL_ConvertAudio(cvt: SDL_AudioCVT) -> None
  * \endcode
+ *
+ * Common conversions are done by the vectorized kernels in audiocvt.h, all
+ * others by SDL's own converters.
  */
 static PyObject *
 PyCSDL2_ConvertAudio(PyObject *module, PyObject *args, PyObject *kwds)
@@ -1584,7 +5570,11 @@ PyCSDL2_ConvertAudio(PyObject *module, PyObject *args, PyObject *kwds)
 
     PyCSDL2_Set(buf_obj, cvt->buf.obj);
     Py_BEGIN_ALLOW_THREADS
-    ret = SDL_ConvertAudio(&cvt->cvt);
+    if (PyCSDL2_AudioCVTConvert(&cvt->cvt, cvt->src_channels, cvt->src_rate,
+                                cvt->dst_channels, cvt->dst_rate))
+        ret = 0;
+    else
+        ret = SDL_ConvertAudio(&cvt->cvt);
     Py_END_ALLOW_THREADS
     PyCSDL2_Set(buf_obj, NULL);
 
@@ -1803,6 +5793,7 @@ PyCSDL2_CloseAudio(PyObject *module, PyObject *args, PyObject *kwds)
     SDL_CloseAudio();
     Py_END_ALLOW_THREADS
 
+    PyCSDL2_AudioDeviceRelease(PyCSDL2_GlobalAudioDevice);
     Py_CLEAR(PyCSDL2_GlobalAudioDevice);
     Py_RETURN_NONE;
 }
@@ -1833,6 +5824,8 @@ PyCSDL2_CloseAudioDevice(PyObject *module, PyObject *args, PyObject *kwds)
     SDL_CloseAudioDevice(id);
     Py_END_ALLOW_THREADS
 
+    PyCSDL2_AudioDeviceRelease(dev);
+
     Py_RETURN_NONE;
 }
 
@@ -1907,8 +5900,22 @@ PyCSDL2_initaudio(PyObject *module)
     if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_AudioDeviceType) < 0)
         return 0;
 
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_AudioRingBufferType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_AudioMixerType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_AudioResamplerType) < 0)
+        return 0;
+
     if (PyType_Ready(&PyCSDL2_WAVBufType)) { return 0; }
 
+    if (PyType_Ready(&PyCSDL2_WAVCacheBufType)) { return 0; }
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_WAVStreamType) < 0)
+        return 0;
+
     return 1;
 }
 
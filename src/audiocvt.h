@@ -0,0 +1,1110 @@
+/*
+ * pycsdl2
+ * Copyright (c) 2015 Paul Tan <pyokagan@pyokagan.name>
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must
+ *        not claim that you wrote the original software. If you use this
+ *        software in a product, an acknowledgment in the product
+ *        documentation would be appreciated but is not required.
+ *     2. Altered source versions must be plainly marked as such, and must
+ *        not be misrepresented as being the original software.
+ *     3. This notice may not be removed or altered from any source
+ *        distribution.
+ */
+/**
+ * \file audiocvt.h
+ * \brief Vectorized fast paths for SDL_ConvertAudio()
+ *
+ * SDL 2.0.0 converts audio one sample at a time, running one pass over the
+ * buffer for every filter in the SDL_AudioCVT. This file implements SSE2 and
+ * AVX2 kernels for the most common conversions (S16 <-> F32, U8 <-> S16,
+ * S16LSB <-> S16MSB byte swapping and mono <-> stereo), fused into a single
+ * pass over the buffer. The kernels produce byte-for-byte the same output as
+ * SDL's own filters, and are selected at runtime based on the CPU.
+ *
+ * Conversions which are not covered (e.g. those which involve rate
+ * conversion) are left to SDL_ConvertAudio().
+ *
+ * It also implements the filter design and inner loops of the polyphase
+ * resampler used by SDL_AudioResampler.
+ */
+#ifndef _PYCSDL2_AUDIOCVT_H_
+#define _PYCSDL2_AUDIOCVT_H_
+#include <math.h>
+#include <SDL_audio.h>
+#include <SDL_cpuinfo.h>
+#include <SDL_hints.h>
+#include <SDL_stdinc.h>
+#include <SDL_thread.h>
+
+#if (defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)) && \
+     (defined(__x86_64__) || defined(__i386__))) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1700 && \
+     (defined(_M_X64) || defined(_M_IX86)))
+#define PYCSDL2_AUDIOCVT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PYCSDL2_TARGET_SSE2
+#define PYCSDL2_TARGET_AVX2
+#define PYCSDL2_TARGET_AVX2FMA
+#else
+#define PYCSDL2_TARGET_SSE2 __attribute__((target("sse2")))
+#define PYCSDL2_TARGET_AVX2 __attribute__((target("avx2")))
+#define PYCSDL2_TARGET_AVX2FMA __attribute__((target("avx2,fma")))
+#endif
+#endif /* x86 */
+
+/**
+ * \brief Hint which limits the instruction set used by SDL_ConvertAudio()
+ *
+ * One of "none" (always use SDL's own converters), "sse2" or "avx2". By
+ * default the best instruction set supported by the CPU is used. Like all SDL
+ * hints, it can also be set with an environment variable of the same name.
+ */
+#define PYCSDL2_HINT_AUDIOCVT_SIMD "PYCSDL2_AUDIOCVT_SIMD"
+
+/**
+ * \brief Hint which sets the number of threads used by SDL_ConvertAudio()
+ *
+ * Large buffers are split into bands which are converted in parallel. "0"
+ * means one thread per CPU. The default is "1" (no extra threads).
+ */
+#define PYCSDL2_HINT_AUDIOCVT_THREADS "PYCSDL2_AUDIOCVT_THREADS"
+
+/** \brief Instruction set levels of the conversion kernels. */
+enum PyCSDL2_AudioCVTLevel {
+    PYCSDL2_AUDIOCVT_NONE = 0,
+    PYCSDL2_AUDIOCVT_SSE2,
+    PYCSDL2_AUDIOCVT_AVX2,
+    PYCSDL2_AUDIOCVT_NUMLEVELS
+};
+
+/** \brief Conversion kernels, used as indices into the kernel tables. */
+enum PyCSDL2_AudioCVTKernelId {
+    PYCSDL2_AUDIOCVT_U8_S16 = 0,
+    PYCSDL2_AUDIOCVT_S16_U8,
+    PYCSDL2_AUDIOCVT_S16_F32,
+    PYCSDL2_AUDIOCVT_F32_S16,
+    PYCSDL2_AUDIOCVT_SWAP16,
+    PYCSDL2_AUDIOCVT_DUP8,
+    PYCSDL2_AUDIOCVT_DUP16,
+    PYCSDL2_AUDIOCVT_DUP32,
+    PYCSDL2_AUDIOCVT_MONO_U8,
+    PYCSDL2_AUDIOCVT_MONO_S16,
+    PYCSDL2_AUDIOCVT_NUMKERNELS
+};
+
+/**
+ * \brief A conversion kernel.
+ *
+ * Type conversion kernels convert n samples, channel conversion kernels
+ * convert n sample frames. src and dst must not overlap.
+ */
+typedef void (*PyCSDL2_AudioCVTKernel)(const void *src, void *dst, size_t n);
+
+/** \brief Must match DIVBY32767 in SDL_audiotypecvt.c */
+#define PYCSDL2_DIVBY32767 3.05185094759972e-05f
+
+/** \brief Size of the scratch buffers used when converting in place. */
+#define PYCSDL2_AUDIOCVT_CHUNK 8192
+
+/** \brief Minimum number of sample frames converted by a thread. */
+#define PYCSDL2_AUDIOCVT_MINBAND 65536
+
+/** \brief Maximum number of threads used for a conversion. */
+#define PYCSDL2_AUDIOCVT_MAXTHREADS 16
+
+/**
+ * \brief A single-pass conversion, as derived from an SDL_AudioCVT.
+ */
+typedef struct PyCSDL2_AudioCVTPlan {
+    /** \brief Type conversion kernel, or NULL */
+    PyCSDL2_AudioCVTKernel type;
+    /** \brief Channel conversion kernel, or NULL */
+    PyCSDL2_AudioCVTKernel chan;
+    /** \brief Number of source channels */
+    size_t src_channels;
+    /** \brief Bytes per source sample frame */
+    size_t src_frame;
+    /** \brief Bytes per destination sample frame */
+    size_t dst_frame;
+    /** \brief Number of sample frames converted at a time when in place */
+    size_t chunk;
+} PyCSDL2_AudioCVTPlan;
+
+#ifdef PYCSDL2_AUDIOCVT_X86
+
+/* Scalar kernels. These mirror the filters in SDL_audiotypecvt.c and
+ * SDL_audiocvt.c, and are used for the tails of the vectorized kernels. */
+
+static void
+PyCSDL2_AudioU8ToS16Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (Sint16) (((Sint16) (s[i] ^ 0x80)) << 8);
+}
+
+static void
+PyCSDL2_AudioS16ToU8Scalar(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (Uint8) ((s[i] ^ 0x8000) >> 8);
+}
+
+static void
+PyCSDL2_AudioS16ToF32Scalar(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    float *d = (float *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = ((float) s[i]) * PYCSDL2_DIVBY32767;
+}
+
+static void
+PyCSDL2_AudioF32ToS16Scalar(const void *src, void *dst, size_t n)
+{
+    const float *s = (const float *) src;
+    Sint16 *d = (Sint16 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (Sint16) (s[i] * 32767.0f);
+}
+
+static void
+PyCSDL2_AudioSwap16Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint16 *s = (const Uint16 *) src;
+    Uint16 *d = (Uint16 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = SDL_Swap16(s[i]);
+}
+
+static void
+PyCSDL2_AudioDup8Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[2 * i] = d[2 * i + 1] = s[i];
+}
+
+static void
+PyCSDL2_AudioDup16Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint16 *s = (const Uint16 *) src;
+    Uint16 *d = (Uint16 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[2 * i] = d[2 * i + 1] = s[i];
+}
+
+static void
+PyCSDL2_AudioDup32Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint32 *s = (const Uint32 *) src;
+    Uint32 *d = (Uint32 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[2 * i] = d[2 * i + 1] = s[i];
+}
+
+static void
+PyCSDL2_AudioMonoU8Scalar(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (Uint8) ((s[2 * i] + s[2 * i + 1]) / 2);
+}
+
+static void
+PyCSDL2_AudioMonoS16Scalar(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        d[i] = (Sint16) (((Sint32) s[2 * i] + (Sint32) s[2 * i + 1]) / 2);
+}
+
+/* SSE2 kernels */
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioU8ToS16SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+
+        v = _mm_xor_si128(v, bias);
+        _mm_storeu_si128((__m128i *) (d + i), _mm_unpacklo_epi8(zero, v));
+        _mm_storeu_si128((__m128i *) (d + i + 8), _mm_unpackhi_epi8(zero, v));
+    }
+
+    PyCSDL2_AudioU8ToS16Scalar(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioS16ToU8SSE2(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    const __m128i bias = _mm_set1_epi16((short) 0x8000);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (s + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (s + i + 8));
+
+        a = _mm_srli_epi16(_mm_xor_si128(a, bias), 8);
+        b = _mm_srli_epi16(_mm_xor_si128(b, bias), 8);
+        _mm_storeu_si128((__m128i *) (d + i), _mm_packus_epi16(a, b));
+    }
+
+    PyCSDL2_AudioS16ToU8Scalar(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioS16ToF32SSE2(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    float *d = (float *) dst;
+    const __m128 k = _mm_set1_ps(PYCSDL2_DIVBY32767);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+        _mm_storeu_ps(d + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(d + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+
+    PyCSDL2_AudioS16ToF32Scalar(s + i, d + i, n - i);
+}
+
+/*
+ * Like the scalar conversion, truncates towards zero and keeps the low 16
+ * bits of the 32-bit result, rather than saturating.
+ */
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioF32ToS16SSE2(const void *src, void *dst, size_t n)
+{
+    const float *s = (const float *) src;
+    Sint16 *d = (Sint16 *) dst;
+    const __m128 k = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(s + i), k));
+        __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(s + i + 4), k));
+
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i *) (d + i), _mm_packs_epi32(a, b));
+    }
+
+    PyCSDL2_AudioF32ToS16Scalar(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioSwap16SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint16 *s = (const Uint16 *) src;
+    Uint16 *d = (Uint16 *) dst;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *) (d + i), v);
+    }
+
+    PyCSDL2_AudioSwap16Scalar(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioDup8SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+
+        _mm_storeu_si128((__m128i *) (d + 2 * i), _mm_unpacklo_epi8(v, v));
+        _mm_storeu_si128((__m128i *) (d + 2 * i + 16),
+                         _mm_unpackhi_epi8(v, v));
+    }
+
+    PyCSDL2_AudioDup8Scalar(s + i, d + 2 * i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioDup16SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint16 *s = (const Uint16 *) src;
+    Uint16 *d = (Uint16 *) dst;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+
+        _mm_storeu_si128((__m128i *) (d + 2 * i), _mm_unpacklo_epi16(v, v));
+        _mm_storeu_si128((__m128i *) (d + 2 * i + 8),
+                         _mm_unpackhi_epi16(v, v));
+    }
+
+    PyCSDL2_AudioDup16Scalar(s + i, d + 2 * i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioDup32SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint32 *s = (const Uint32 *) src;
+    Uint32 *d = (Uint32 *) dst;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+
+        _mm_storeu_si128((__m128i *) (d + 2 * i), _mm_unpacklo_epi32(v, v));
+        _mm_storeu_si128((__m128i *) (d + 2 * i + 4),
+                         _mm_unpackhi_epi32(v, v));
+    }
+
+    PyCSDL2_AudioDup32Scalar(s + i, d + 2 * i, n - i);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioMonoU8SSE2(const void *src, void *dst, size_t n)
+{
+    const Uint8 *s = (const Uint8 *) src;
+    Uint8 *d = (Uint8 *) dst;
+    const __m128i lomask = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (s + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (s + 2 * i + 16));
+
+        a = _mm_add_epi16(_mm_and_si128(a, lomask), _mm_srli_epi16(a, 8));
+        b = _mm_add_epi16(_mm_and_si128(b, lomask), _mm_srli_epi16(b, 8));
+        a = _mm_srli_epi16(a, 1);
+        b = _mm_srli_epi16(b, 1);
+        _mm_storeu_si128((__m128i *) (d + i), _mm_packus_epi16(a, b));
+    }
+
+    PyCSDL2_AudioMonoU8Scalar(s + 2 * i, d + i, n - i);
+}
+
+/*
+ * Computes (l + r) / 2 in 32 bits, rounding towards zero like C division.
+ */
+PYCSDL2_TARGET_SSE2 static __m128i
+PyCSDL2_AudioMonoS16SSE2Half(__m128i v)
+{
+    __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    __m128i r = _mm_srai_epi32(v, 16);
+    __m128i sum = _mm_add_epi32(l, r);
+
+    return _mm_srai_epi32(_mm_add_epi32(sum, _mm_srli_epi32(sum, 31)), 1);
+}
+
+PYCSDL2_TARGET_SSE2 static void
+PyCSDL2_AudioMonoS16SSE2(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (s + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (s + 2 * i + 8));
+
+        a = PyCSDL2_AudioMonoS16SSE2Half(a);
+        b = PyCSDL2_AudioMonoS16SSE2Half(b);
+        _mm_storeu_si128((__m128i *) (d + i), _mm_packs_epi32(a, b));
+    }
+
+    PyCSDL2_AudioMonoS16Scalar(s + 2 * i, d + i, n - i);
+}
+
+/* AVX2 kernels */
+
+PYCSDL2_TARGET_AVX2 static void
+PyCSDL2_AudioS16ToF32AVX2(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    float *d = (float *) dst;
+    const __m256 k = _mm256_set1_ps(PYCSDL2_DIVBY32767);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i a, b;
+
+        a = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (s + i)));
+        b = _mm256_cvtepi16_epi32(
+                _mm_loadu_si128((const __m128i *) (s + i + 8)));
+        _mm256_storeu_ps(d + i, _mm256_mul_ps(_mm256_cvtepi32_ps(a), k));
+        _mm256_storeu_ps(d + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), k));
+    }
+
+    PyCSDL2_AudioS16ToF32SSE2(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_AVX2 static void
+PyCSDL2_AudioF32ToS16AVX2(const void *src, void *dst, size_t n)
+{
+    const float *s = (const float *) src;
+    Sint16 *d = (Sint16 *) dst;
+    const __m256 k = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i a, b, v;
+
+        a = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(s + i), k));
+        b = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(s + i + 8), k));
+        a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+        b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+        /* packs works within 128-bit lanes, so restore the sample order */
+        v = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *) (d + i), v);
+    }
+
+    PyCSDL2_AudioF32ToS16SSE2(s + i, d + i, n - i);
+}
+
+PYCSDL2_TARGET_AVX2 static __m256i
+PyCSDL2_AudioMonoS16AVX2Half(__m256i v)
+{
+    __m256i l = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+    __m256i r = _mm256_srai_epi32(v, 16);
+    __m256i sum = _mm256_add_epi32(l, r);
+
+    return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_srli_epi32(sum, 31)),
+                             1);
+}
+
+PYCSDL2_TARGET_AVX2 static void
+PyCSDL2_AudioMonoS16AVX2(const void *src, void *dst, size_t n)
+{
+    const Sint16 *s = (const Sint16 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (s + 2 * i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (s + 2 * i + 16));
+        __m256i v;
+
+        a = PyCSDL2_AudioMonoS16AVX2Half(a);
+        b = PyCSDL2_AudioMonoS16AVX2Half(b);
+        v = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *) (d + i), v);
+    }
+
+    PyCSDL2_AudioMonoS16SSE2(s + 2 * i, d + i, n - i);
+}
+
+/** \brief Kernel tables, indexed by PyCSDL2_AudioCVTLevel */
+static const PyCSDL2_AudioCVTKernel
+PyCSDL2_AudioCVTKernels[PYCSDL2_AUDIOCVT_NUMLEVELS]
+                       [PYCSDL2_AUDIOCVT_NUMKERNELS] = {
+    /* PYCSDL2_AUDIOCVT_NONE */
+    {NULL},
+    /* PYCSDL2_AUDIOCVT_SSE2 */
+    {
+        PyCSDL2_AudioU8ToS16SSE2,
+        PyCSDL2_AudioS16ToU8SSE2,
+        PyCSDL2_AudioS16ToF32SSE2,
+        PyCSDL2_AudioF32ToS16SSE2,
+        PyCSDL2_AudioSwap16SSE2,
+        PyCSDL2_AudioDup8SSE2,
+        PyCSDL2_AudioDup16SSE2,
+        PyCSDL2_AudioDup32SSE2,
+        PyCSDL2_AudioMonoU8SSE2,
+        PyCSDL2_AudioMonoS16SSE2
+    },
+    /* PYCSDL2_AUDIOCVT_AVX2 */
+    {
+        PyCSDL2_AudioU8ToS16SSE2,
+        PyCSDL2_AudioS16ToU8SSE2,
+        PyCSDL2_AudioS16ToF32AVX2,
+        PyCSDL2_AudioF32ToS16AVX2,
+        PyCSDL2_AudioSwap16SSE2,
+        PyCSDL2_AudioDup8SSE2,
+        PyCSDL2_AudioDup16SSE2,
+        PyCSDL2_AudioDup32SSE2,
+        PyCSDL2_AudioMonoU8SSE2,
+        PyCSDL2_AudioMonoS16AVX2
+    }
+};
+
+/**
+ * \brief Returns the best PyCSDL2_AudioCVTLevel supported by the CPU.
+ */
+static int
+PyCSDL2_AudioCVTDetectLevel(void)
+{
+    int level = PYCSDL2_AUDIOCVT_NONE;
+
+    if (!SDL_HasSSE2())
+        return level;
+    level = PYCSDL2_AUDIOCVT_SSE2;
+
+#ifdef _MSC_VER
+    {
+        int info[4];
+
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            /* OSXSAVE and AVX, with the OS saving the YMM registers */
+            if ((info[2] & 0x18000000) == 0x18000000 &&
+                (_xgetbv(0) & 6) == 6) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & 0x20)
+                    level = PYCSDL2_AUDIOCVT_AVX2;
+            }
+        }
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        level = PYCSDL2_AUDIOCVT_AVX2;
+#endif
+
+    return level;
+}
+
+/**
+ * \brief Returns the PyCSDL2_AudioCVTLevel to use for conversions.
+ *
+ * This is the level supported by the CPU, limited by
+ * PYCSDL2_HINT_AUDIOCVT_SIMD.
+ */
+static int
+PyCSDL2_AudioCVTGetLevel(void)
+{
+    static int detected = -1;
+    const char *hint;
+    int level;
+
+    if (detected < 0)
+        detected = PyCSDL2_AudioCVTDetectLevel();
+    level = detected;
+
+    hint = SDL_GetHint(PYCSDL2_HINT_AUDIOCVT_SIMD);
+    if (!hint || !*hint)
+        return level;
+    else if (!SDL_strcasecmp(hint, "none") || !SDL_strcmp(hint, "0"))
+        return PYCSDL2_AUDIOCVT_NONE;
+    else if (!SDL_strcasecmp(hint, "sse2"))
+        return SDL_min(level, PYCSDL2_AUDIOCVT_SSE2);
+    else
+        return level;
+}
+
+/**
+ * \brief Returns the number of threads to use for conversions.
+ */
+static int
+PyCSDL2_AudioCVTGetThreads(void)
+{
+    const char *hint = SDL_GetHint(PYCSDL2_HINT_AUDIOCVT_THREADS);
+    int n;
+
+    if (!hint || !*hint)
+        return 1;
+
+    n = SDL_atoi(hint);
+    if (n <= 0)
+        n = SDL_GetCPUCount();
+
+    return SDL_max(1, SDL_min(n, PYCSDL2_AUDIOCVT_MAXTHREADS));
+}
+
+/**
+ * \brief Derives a single-pass conversion from a SDL_AudioCVT.
+ *
+ * \param plan The plan to fill in.
+ * \param cvt The SDL_AudioCVT, as initialized by SDL_BuildAudioCVT().
+ * \param src_channels Source channels passed to SDL_BuildAudioCVT().
+ * \param src_rate Source rate passed to SDL_BuildAudioCVT().
+ * \param dst_channels Destination channels passed to SDL_BuildAudioCVT().
+ * \param dst_rate Destination rate passed to SDL_BuildAudioCVT().
+ * \param level The PyCSDL2_AudioCVTLevel of the kernels to use.
+ * \returns 1 if the conversion is supported, 0 otherwise.
+ */
+static int
+PyCSDL2_AudioCVTPlanInit(PyCSDL2_AudioCVTPlan *plan, const SDL_AudioCVT *cvt,
+                         Uint8 src_channels, int src_rate,
+                         Uint8 dst_channels, int dst_rate, int level)
+{
+    const PyCSDL2_AudioCVTKernel *kernels;
+    SDL_AudioFormat src_format = cvt->src_format;
+    SDL_AudioFormat dst_format = cvt->dst_format;
+    size_t src_size, dst_size, max_frame;
+    int type = -1, chan = -1;
+
+    if (level <= PYCSDL2_AUDIOCVT_NONE || !cvt->needed)
+        return 0;
+    if (src_rate != dst_rate || !src_channels || !dst_channels)
+        return 0;
+
+    src_size = SDL_AUDIO_BITSIZE(src_format) / 8;
+    dst_size = SDL_AUDIO_BITSIZE(dst_format) / 8;
+
+    /* Type conversion, which SDL does first */
+    if (src_format == dst_format) {
+        /* No type conversion */
+    } else if (src_format == AUDIO_U8 && dst_format == AUDIO_S16SYS) {
+        type = PYCSDL2_AUDIOCVT_U8_S16;
+    } else if (src_format == AUDIO_S16SYS && dst_format == AUDIO_U8) {
+        type = PYCSDL2_AUDIOCVT_S16_U8;
+    } else if (src_format == AUDIO_S16SYS && dst_format == AUDIO_F32SYS) {
+        type = PYCSDL2_AUDIOCVT_S16_F32;
+    } else if (src_format == AUDIO_F32SYS && dst_format == AUDIO_S16SYS) {
+        type = PYCSDL2_AUDIOCVT_F32_S16;
+    } else if ((src_format == AUDIO_S16LSB && dst_format == AUDIO_S16MSB) ||
+               (src_format == AUDIO_S16MSB && dst_format == AUDIO_S16LSB)) {
+        type = PYCSDL2_AUDIOCVT_SWAP16;
+    } else {
+        return 0;
+    }
+
+    /* Channel conversion, done in the destination format */
+    if (src_channels == dst_channels) {
+        /* No channel conversion */
+    } else if (src_channels == 1 && dst_channels == 2) {
+        if (dst_size == 1)
+            chan = PYCSDL2_AUDIOCVT_DUP8;
+        else if (dst_size == 2)
+            chan = PYCSDL2_AUDIOCVT_DUP16;
+        else if (dst_size == 4)
+            chan = PYCSDL2_AUDIOCVT_DUP32;
+        else
+            return 0;
+    } else if (src_channels == 2 && dst_channels == 1) {
+        /* SDL 2.0.0 mixes F32 down as if it were S32, so leave it to SDL */
+        if (dst_format == AUDIO_U8)
+            chan = PYCSDL2_AUDIOCVT_MONO_U8;
+        else if (dst_format == AUDIO_S16SYS)
+            chan = PYCSDL2_AUDIOCVT_MONO_S16;
+        else
+            return 0;
+    } else {
+        return 0;
+    }
+
+    if (type < 0 && chan < 0)
+        return 0;
+
+    kernels = PyCSDL2_AudioCVTKernels[level];
+    plan->type = type < 0 ? NULL : kernels[type];
+    plan->chan = chan < 0 ? NULL : kernels[chan];
+    plan->src_channels = src_channels;
+    plan->src_frame = src_size * src_channels;
+    plan->dst_frame = dst_size * dst_channels;
+
+    max_frame = SDL_max(plan->src_frame, plan->dst_frame);
+    max_frame = SDL_max(max_frame, dst_size * src_channels);
+    plan->chunk = PYCSDL2_AUDIOCVT_CHUNK / max_frame;
+    if (!plan->chunk)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * \brief Converts a block of at most plan->chunk sample frames.
+ *
+ * src and dst must not overlap.
+ */
+static void
+PyCSDL2_AudioCVTRunChunk(const PyCSDL2_AudioCVTPlan *plan, const Uint8 *src,
+                         Uint8 *dst, size_t frames)
+{
+    float tmp[PYCSDL2_AUDIOCVT_CHUNK / sizeof(float)];
+
+    if (plan->type && plan->chan) {
+        plan->type(src, tmp, frames * plan->src_channels);
+        plan->chan(tmp, dst, frames);
+    } else if (plan->type) {
+        plan->type(src, dst, frames * plan->src_channels);
+    } else {
+        plan->chan(src, dst, frames);
+    }
+}
+
+/**
+ * \brief Converts sample frames from src to dst.
+ *
+ * src and dst may either be the same buffer, or not overlap at all.
+ */
+static void
+PyCSDL2_AudioCVTRun(const PyCSDL2_AudioCVTPlan *plan, const Uint8 *src,
+                    Uint8 *dst, size_t frames)
+{
+    float out[PYCSDL2_AUDIOCVT_CHUNK / sizeof(float)];
+    size_t ss = plan->src_frame, ds = plan->dst_frame, chunk = plan->chunk;
+    size_t i, n;
+
+    if (src != dst) {
+        for (i = 0; i < frames; i += n) {
+            n = SDL_min(chunk, frames - i);
+            PyCSDL2_AudioCVTRunChunk(plan, src + i * ss, dst + i * ds, n);
+        }
+    } else if (ds <= ss) {
+        /* Shrinking, so the output never overtakes the input going forward */
+        for (i = 0; i < frames; i += n) {
+            n = SDL_min(chunk, frames - i);
+            PyCSDL2_AudioCVTRunChunk(plan, src + i * ss, (Uint8 *) out, n);
+            SDL_memcpy(dst + i * ds, out, n * ds);
+        }
+    } else {
+        /* Growing, so convert from the end like SDL does */
+        for (i = frames; i > 0; i -= n) {
+            n = SDL_min(chunk, i);
+            PyCSDL2_AudioCVTRunChunk(plan, src + (i - n) * ss, (Uint8 *) out,
+                                     n);
+            SDL_memcpy(dst + (i - n) * ds, out, n * ds);
+        }
+    }
+}
+
+/** \brief A band of sample frames converted by a thread. */
+typedef struct PyCSDL2_AudioCVTBand {
+    const PyCSDL2_AudioCVTPlan *plan;
+    const Uint8 *src;
+    Uint8 *dst;
+    size_t frames;
+} PyCSDL2_AudioCVTBand;
+
+/** \brief Thread function which converts a PyCSDL2_AudioCVTBand. */
+static int SDLCALL
+PyCSDL2_AudioCVTBandThread(void *data)
+{
+    PyCSDL2_AudioCVTBand *band = (PyCSDL2_AudioCVTBand *) data;
+
+    PyCSDL2_AudioCVTRun(band->plan, band->src, band->dst, band->frames);
+    return 0;
+}
+
+/**
+ * \brief Converts frames in place, splitting the work across threads.
+ *
+ * Bands of a conversion which changes the frame size would overwrite each
+ * other's input, so the source is first copied to a scratch buffer. If that
+ * fails, the conversion is done on the calling thread.
+ */
+static void
+PyCSDL2_AudioCVTRunThreaded(const PyCSDL2_AudioCVTPlan *plan, Uint8 *buf,
+                            size_t frames, int nthreads)
+{
+    PyCSDL2_AudioCVTBand bands[PYCSDL2_AUDIOCVT_MAXTHREADS];
+    SDL_Thread *threads[PYCSDL2_AUDIOCVT_MAXTHREADS];
+    Uint8 *scratch = NULL;
+    const Uint8 *src = buf;
+    size_t start = 0;
+    int i;
+
+    nthreads = (int) SDL_min((size_t) nthreads,
+                             frames / PYCSDL2_AUDIOCVT_MINBAND);
+    if (nthreads <= 1) {
+        PyCSDL2_AudioCVTRun(plan, buf, buf, frames);
+        return;
+    }
+
+    if (plan->src_frame != plan->dst_frame) {
+        scratch = (Uint8 *) SDL_malloc(frames * plan->src_frame);
+        if (!scratch) {
+            PyCSDL2_AudioCVTRun(plan, buf, buf, frames);
+            return;
+        }
+        SDL_memcpy(scratch, buf, frames * plan->src_frame);
+        src = scratch;
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        /* Keep band boundaries aligned so the vector loops stay busy */
+        size_t end = i == nthreads - 1 ? frames :
+                     (frames * (i + 1) / nthreads) & ~(size_t) 63;
+
+        bands[i].plan = plan;
+        bands[i].src = src + start * plan->src_frame;
+        bands[i].dst = buf + start * plan->dst_frame;
+        bands[i].frames = end - start;
+        start = end;
+    }
+
+    for (i = 1; i < nthreads; i++)
+        threads[i] = SDL_CreateThread(PyCSDL2_AudioCVTBandThread,
+                                      "PyCSDL2_AudioCVT", &bands[i]);
+
+    PyCSDL2_AudioCVTBandThread(&bands[0]);
+
+    for (i = 1; i < nthreads; i++) {
+        if (threads[i])
+            SDL_WaitThread(threads[i], NULL);
+        else
+            PyCSDL2_AudioCVTBandThread(&bands[i]);
+    }
+
+    SDL_free(scratch);
+}
+
+#endif /* PYCSDL2_AUDIOCVT_X86 */
+
+/**
+ * \brief Converts the audio data in cvt->buf using the fast path.
+ *
+ * May be called without holding the GIL.
+ *
+ * \param cvt The SDL_AudioCVT, with buf and len set.
+ * \param src_channels Source channels passed to SDL_BuildAudioCVT().
+ * \param src_rate Source rate passed to SDL_BuildAudioCVT().
+ * \param dst_channels Destination channels passed to SDL_BuildAudioCVT().
+ * \param dst_rate Destination rate passed to SDL_BuildAudioCVT().
+ * \returns 1 if the data was converted, 0 if the conversion is not supported
+ *          and SDL_ConvertAudio() should be used instead.
+ */
+static int
+PyCSDL2_AudioCVTConvert(SDL_AudioCVT *cvt, Uint8 src_channels, int src_rate,
+                        Uint8 dst_channels, int dst_rate)
+{
+#ifdef PYCSDL2_AUDIOCVT_X86
+    PyCSDL2_AudioCVTPlan plan;
+    size_t frames;
+
+    if (!cvt->buf || cvt->len <= 0)
+        return 0;
+
+    if (!PyCSDL2_AudioCVTPlanInit(&plan, cvt, src_channels, src_rate,
+                                  dst_channels, dst_rate,
+                                  PyCSDL2_AudioCVTGetLevel()))
+        return 0;
+
+    /* SDL's filters handle partial frames in their own ways */
+    if ((size_t) cvt->len % plan.src_frame)
+        return 0;
+
+    frames = (size_t) cvt->len / plan.src_frame;
+    PyCSDL2_AudioCVTRunThreaded(&plan, cvt->buf, frames,
+                                PyCSDL2_AudioCVTGetThreads());
+    cvt->len_cvt = (int) (frames * plan.dst_frame);
+
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief A dot product kernel used by the resampler.
+ *
+ * n must be a multiple of PYCSDL2_AUDIORESAMPLE_TAPALIGN.
+ */
+typedef float (*PyCSDL2_AudioDotKernel)(const float *a, const float *b,
+                                        size_t n);
+
+/** \brief Resampler filter lengths are rounded up to a multiple of this. */
+#define PYCSDL2_AUDIORESAMPLE_TAPALIGN 8
+
+/** \brief Kaiser window beta of the resampler filters. */
+#define PYCSDL2_AUDIORESAMPLE_BETA 8.0
+
+/** \brief Cutoff of the resampler filters, relative to the Nyquist rate. */
+#define PYCSDL2_AUDIORESAMPLE_ROLLOFF 0.9
+
+static float
+PyCSDL2_AudioDotScalar(const float *a, const float *b, size_t n)
+{
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i;
+
+    for (i = 0; i < n; i += 4) {
+        acc[0] += a[i] * b[i];
+        acc[1] += a[i + 1] * b[i + 1];
+        acc[2] += a[i + 2] * b[i + 2];
+        acc[3] += a[i + 3] * b[i + 3];
+    }
+
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+#ifdef PYCSDL2_AUDIOCVT_X86
+
+PYCSDL2_TARGET_SSE2 static float
+PyCSDL2_AudioDotSSE2(const float *a, const float *b, size_t n)
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    float out[4];
+    size_t i;
+
+    for (i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                           _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                           _mm_loadu_ps(b + i + 4)));
+    }
+
+    _mm_storeu_ps(out, _mm_add_ps(acc0, acc1));
+    return (out[0] + out[1]) + (out[2] + out[3]);
+}
+
+PYCSDL2_TARGET_AVX2FMA static float
+PyCSDL2_AudioDotAVX2(const float *a, const float *b, size_t n)
+{
+    __m256 acc = _mm256_setzero_ps();
+    __m128 sum;
+    float out[4];
+    size_t i;
+
+    for (i = 0; i < n; i += 8)
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                              acc);
+
+    sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                     _mm256_extractf128_ps(acc, 1));
+    _mm_storeu_ps(out, sum);
+    return (out[0] + out[1]) + (out[2] + out[3]);
+}
+
+#endif /* PYCSDL2_AUDIOCVT_X86 */
+
+/**
+ * \brief Returns the dot product kernel to use for resampling.
+ *
+ * Like the conversion kernels, the instruction set is limited by
+ * PYCSDL2_HINT_AUDIOCVT_SIMD.
+ */
+static PyCSDL2_AudioDotKernel
+PyCSDL2_AudioGetDotKernel(void)
+{
+#ifdef PYCSDL2_AUDIOCVT_X86
+    switch (PyCSDL2_AudioCVTGetLevel()) {
+    case PYCSDL2_AUDIOCVT_AVX2:
+#ifdef _MSC_VER
+        /* MSVC does not tell us whether FMA may be used */
+        return PyCSDL2_AudioDotSSE2;
+#else
+        if (__builtin_cpu_supports("fma"))
+            return PyCSDL2_AudioDotAVX2;
+        return PyCSDL2_AudioDotSSE2;
+#endif
+    case PYCSDL2_AUDIOCVT_SSE2:
+        return PyCSDL2_AudioDotSSE2;
+    default:
+        break;
+    }
+#endif
+    return PyCSDL2_AudioDotScalar;
+}
+
+/** \brief Zeroth order modified Bessel function of the first kind. */
+static double
+PyCSDL2_AudioBesselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 64; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
+
+/**
+ * \brief Computes the coefficients of a Kaiser-windowed sinc filter bank.
+ *
+ * Phase p of the filter bank interpolates the input at a fractional offset
+ * of p / nphases sample frames after tap (taps / 2 - 1). Every phase is
+ * normalized to unity gain at DC.
+ *
+ * \param coeffs Output array of nphases * taps coefficients.
+ * \param nphases Number of filter phases.
+ * \param taps Number of taps per phase, which must be even.
+ * \param cutoff Cutoff frequency relative to the input Nyquist rate.
+ */
+static void
+PyCSDL2_AudioResampleDesign(float *coeffs, Uint32 nphases, Uint32 taps,
+                            double cutoff)
+{
+    const double pi = 3.14159265358979323846;
+    double half = taps / 2.0, norm = PyCSDL2_AudioBesselI0(
+        PYCSDL2_AUDIORESAMPLE_BETA);
+    Uint32 p, k;
+
+    for (p = 0; p < nphases; p++) {
+        float *h = coeffs + (size_t) p * taps;
+        double sum = 0.0;
+
+        for (k = 0; k < taps; k++) {
+            double t = (double) k - (half - 1.0) - (double) p / nphases;
+            double x = t / half, w, v;
+
+            if (x <= -1.0 || x >= 1.0)
+                w = 0.0;
+            else
+                w = PyCSDL2_AudioBesselI0(PYCSDL2_AUDIORESAMPLE_BETA *
+                                          sqrt(1.0 - x * x)) / norm;
+
+            if (t == 0.0)
+                v = cutoff;
+            else
+                v = sin(pi * cutoff * t) / (pi * t);
+
+            h[k] = (float) (v * w);
+            sum += v * w;
+        }
+
+        for (k = 0; k < taps; k++)
+            h[k] = (float) (h[k] / sum);
+    }
+}
+
+#endif /* _PYCSDL2_AUDIOCVT_H_ */
@@ -682,7 +682,12 @@ PyCSDL2_initcapi(PyObject *m)
         PyCSDL2_SurfacePtr,
 /* src/video.h */
         PyCSDL2_WindowCreate,
-        PyCSDL2_WindowPtr
+        PyCSDL2_WindowPtr,
+/* Entries added later, see include/pycsdl2.h */
+/* src/audio.h */
+        PyCSDL2_AudioRingBufferCapture,
+/* src/events.h */
+        PyCSDL2_PushUserEvents
     };
     PyObject *capsule = PyCapsule_New((void*) &api, "csdl2._C_API", NULL);
     if (!capsule) { return 0; }
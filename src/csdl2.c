@@ -32,7 +32,9 @@
 #include "capi.h"
 #include "events.h"
 #include "init.h"
+#include "keyboard.h"
 #include "keycode.h"
+#include "mouse.h"
 #include "pixels.h"
 #include "rect.h"
 #include "render.h"
@@ -74,6 +76,7 @@ PyInit_csdl2(void)
     if (!PyCSDL2_initcapi(m)) { goto fail; }
     if (!PyCSDL2_initinit(m)) { goto fail; }
     if (!PyCSDL2_initkeycode(m)) { goto fail; }
+    if (!PyCSDL2_initmouse(m)) { goto fail; }
     if (!PyCSDL2_initpixels(m)) { goto fail; }
     if (!PyCSDL2_initrect(m)) { goto fail; }
     if (!PyCSDL2_initrender(m)) { goto fail; }
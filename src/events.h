@@ -29,6 +29,13 @@
 #define _PYCSDL2_EVENTS_H_
 #include <Python.h>
 #include <SDL_events.h>
+#include <SDL_atomic.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#ifndef __WIN32__
+#include <errno.h>
+#endif
 #include "../include/pycsdl2.h"
 #include "util.h"
 #include "error.h"
@@ -40,15 +47,33 @@ typedef struct PyCSDL2_EventMem {
     PyObject_HEAD
     /** \brief SDL_Event struct */
     SDL_Event ev;
+    /**
+     * \brief Copy of SDL_DropEvent.file, taken when SDL handed over the
+     *        event, or NULL.
+     *
+     * The pointer in ev can be overwritten from Python, so it is never
+     * followed after the event has been handed over.
+     */
+    PyObject *file;
 } PyCSDL2_EventMem;
 
+/** \brief Destructor for PyCSDL2_EventMemType */
+static void
+PyCSDL2_EventMemDealloc(PyCSDL2_EventMem *self)
+{
+    Py_XDECREF(self->file);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
 /**
  * \brief Type definition for the private class csdl2.SDL_EventMem
  */
 static PyTypeObject PyCSDL2_EventMemType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     /* tp_name           */ "csdl2.SDL_EventMem",
-    /* tp_basicsize      */ sizeof(PyCSDL2_EventMem)
+    /* tp_basicsize      */ sizeof(PyCSDL2_EventMem),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_EventMemDealloc
 };
 
 /**
@@ -63,6 +88,31 @@ PyCSDL2_EventMemCreate(void)
     return (PyCSDL2_EventMem*) PyType_GenericAlloc(&PyCSDL2_EventMemType, 0);
 }
 
+/**
+ * \brief Copies the file of the SDL_DROPFILE event SDL has just stored in
+ *        self->ev.
+ *
+ * Must only be called right after SDL wrote the event, while the pointer
+ * still comes from SDL.
+ *
+ * \returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+PyCSDL2_EventMemTakeFile(PyCSDL2_EventMem *self)
+{
+    const char *s = self->ev.drop.file;
+    PyObject *file = NULL;
+
+    if (self->ev.type == SDL_DROPFILE && s) {
+        file = PyUnicode_DecodeUTF8(s, SDL_strlen(s), "replace");
+        if (!file)
+            return -1;
+    }
+
+    Py_XSETREF(self->file, file);
+    return 0;
+}
+
 /** \brief Instance data for PyCSDL2_MouseMotionEventType */
 typedef struct PyCSDL2_MouseMotionEvent {
     PyObject_HEAD
@@ -459,6 +509,755 @@ PyCSDL2_MouseMotionEventPtr(PyObject *obj, SDL_MouseMotionEvent **out)
     return 1;
 }
 
+/**
+ * \defgroup csdl2_EventViews Typed views of SDL_Event members
+ *
+ * \brief Python objects viewing one member of the SDL_Event union.
+ *
+ * Except for SDL_MouseMotionEvent, the views of the SDL_Event members are
+ * all instances of PyCSDL2_EventView, and differ only in their type object.
+ * Their attributes use the generic PyCSDL2_EventViewGetField() and
+ * PyCSDL2_EventViewSetField(), with the closure encoding the type and offset
+ * of the field as built by PYCSDL2_EVENTFIELD(). Reading an attribute is thus
+ * a single load from the underlying PyCSDL2_EventMem.
+ *
+ * @{
+ */
+
+/** \brief Types of fields in the SDL_Event structures */
+enum PyCSDL2_EventFieldKind {
+    PYCSDL2_EVENTFIELD_UINT8,
+    PYCSDL2_EVENTFIELD_UINT16,
+    PYCSDL2_EVENTFIELD_SINT16,
+    PYCSDL2_EVENTFIELD_UINT32,
+    PYCSDL2_EVENTFIELD_SINT32,
+    PYCSDL2_EVENTFIELD_SINT64,
+    PYCSDL2_EVENTFIELD_FLOAT,
+    /** \brief NUL-terminated UTF-8 char array */
+    PYCSDL2_EVENTFIELD_TEXT,
+    /**
+     * \brief SDL_DropEvent.file. Reads the copy in PyCSDL2_EventMem.file
+     *        if the event is a SDL_DROPFILE, never the pointer itself.
+     */
+    PYCSDL2_EVENTFIELD_STRING,
+    /** \brief Pointer exposed as an int */
+    PYCSDL2_EVENTFIELD_POINTER
+};
+
+/** \brief Size of the text fields of SDL_TextEditingEvent and friends */
+#define PYCSDL2_EVENTFIELD_TEXTSIZE 32
+
+SDL_COMPILE_TIME_ASSERT(edit_text, sizeof(((SDL_TextEditingEvent*)0)->text)
+                        == PYCSDL2_EVENTFIELD_TEXTSIZE);
+SDL_COMPILE_TIME_ASSERT(text_text, sizeof(((SDL_TextInputEvent*)0)->text)
+                        == PYCSDL2_EVENTFIELD_TEXTSIZE);
+
+/**
+ * \brief Builds the getset closure of a field.
+ *
+ * \param kind PyCSDL2_EventFieldKind of the field.
+ * \param type The SDL structure containing the field.
+ * \param member Name of the field.
+ */
+#define PYCSDL2_EVENTFIELD(kind, type, member) \
+    ((void*) (size_t) (offsetof(type, member) << 4 | (kind)))
+
+/** \brief Instance data of the SDL_Event member views */
+typedef struct PyCSDL2_EventView {
+    PyObject_HEAD
+    /** \brief Head of weak reference list */
+    PyObject *in_weakreflist;
+    /** \brief Underlying PyCSDL2_EventMem */
+    PyCSDL2_EventMem *ev_mem;
+    /** \brief Offset of the viewed structure in the SDL_Event */
+    size_t offset;
+    /** \brief Cached view of SDL_KeyboardEvent.keysym, or NULL */
+    PyObject *keysym;
+} PyCSDL2_EventView;
+
+/**
+ * \brief Creates a view of type sharing ev_mem.
+ *
+ * \param type Type object of the view.
+ * \param ev_mem The PyCSDL2_EventMem to view. If NULL, a new one is created.
+ * \param offset Offset of the viewed structure in the SDL_Event.
+ * \returns A new reference to the view, or NULL with an exception set.
+ */
+static PyCSDL2_EventView *
+PyCSDL2_EventViewCreate(PyTypeObject *type, PyCSDL2_EventMem *ev_mem,
+                        size_t offset)
+{
+    PyCSDL2_EventView *self;
+
+    if (!(self = (PyCSDL2_EventView*) type->tp_alloc(type, 0)))
+        return NULL;
+
+    if (ev_mem) {
+        Py_INCREF(ev_mem);
+        self->ev_mem = ev_mem;
+    } else if (!(self->ev_mem = PyCSDL2_EventMemCreate())) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    self->offset = offset;
+
+    return self;
+}
+
+/** \brief newfunc for the SDL_Event member views */
+static PyCSDL2_EventView *
+PyCSDL2_EventViewNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    return PyCSDL2_EventViewCreate(type, NULL, 0);
+}
+
+/** \brief Destructor for the SDL_Event member views */
+static void
+PyCSDL2_EventViewDealloc(PyCSDL2_EventView *self)
+{
+    if (self->in_weakreflist)
+        PyObject_ClearWeakRefs((PyObject*) self);
+    Py_XDECREF(self->keysym);
+    Py_XDECREF(self->ev_mem);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Returns a pointer to the viewed structure */
+static Uint8 *
+PyCSDL2_EventViewData(PyCSDL2_EventView *self)
+{
+    return (Uint8*) &self->ev_mem->ev + self->offset;
+}
+
+/** \brief Generic getter for the fields of the SDL_Event member views */
+static PyObject *
+PyCSDL2_EventViewGetField(PyCSDL2_EventView *self, void *closure)
+{
+    size_t field = (size_t) closure;
+    Uint8 *p = PyCSDL2_EventViewData(self) + (field >> 4);
+    const char *s;
+    size_t len;
+
+    switch (field & 0xF) {
+    case PYCSDL2_EVENTFIELD_UINT8:
+        return PyLong_FromUnsignedLong(*p);
+    case PYCSDL2_EVENTFIELD_UINT16:
+        return PyLong_FromUnsignedLong(*(Uint16*) p);
+    case PYCSDL2_EVENTFIELD_SINT16:
+        return PyLong_FromLong(*(Sint16*) p);
+    case PYCSDL2_EVENTFIELD_UINT32:
+        return PyLong_FromUnsignedLong(*(Uint32*) p);
+    case PYCSDL2_EVENTFIELD_SINT32:
+        return PyLong_FromLong(*(Sint32*) p);
+    case PYCSDL2_EVENTFIELD_SINT64:
+        return PyLong_FromLongLong(*(Sint64*) p);
+    case PYCSDL2_EVENTFIELD_FLOAT:
+        return PyFloat_FromDouble(*(float*) p);
+    case PYCSDL2_EVENTFIELD_TEXT:
+        s = (const char*) p;
+        for (len = 0; len < PYCSDL2_EVENTFIELD_TEXTSIZE && s[len]; len++)
+            ;
+        return PyUnicode_DecodeUTF8(s, len, "replace");
+    case PYCSDL2_EVENTFIELD_STRING:
+        if (self->ev_mem->ev.type != SDL_DROPFILE || !self->ev_mem->file)
+            Py_RETURN_NONE;
+        Py_INCREF(self->ev_mem->file);
+        return self->ev_mem->file;
+    case PYCSDL2_EVENTFIELD_POINTER:
+        return PyLong_FromVoidPtr(*(void**) p);
+    default:
+        PyErr_SetString(PyExc_AssertionError, "invalid event field");
+        return NULL;
+    }
+}
+
+/**
+ * \brief Converts value to an int within [min, max].
+ *
+ * \returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+PyCSDL2_EventViewLongAsRange(PyObject *value, long min, long max,
+                             const char *ctype, long *out)
+{
+    long x = PyLong_AsLong(value);
+
+    if (x == -1 && PyErr_Occurred())
+        return -1;
+
+    if (x < min || x > max) {
+        PyErr_Format(PyExc_OverflowError,
+                     "Python int too large to convert to %s", ctype);
+        return -1;
+    }
+
+    *out = x;
+    return 0;
+}
+
+/** \brief Generic setter for the fields of the SDL_Event member views */
+static int
+PyCSDL2_EventViewSetField(PyCSDL2_EventView *self, PyObject *value,
+                          void *closure)
+{
+    size_t field = (size_t) closure;
+    Uint8 *p = PyCSDL2_EventViewData(self) + (field >> 4);
+    const char *s;
+    Py_ssize_t len;
+    double d;
+    void *ptr;
+    long x;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+
+    switch (field & 0xF) {
+    case PYCSDL2_EVENTFIELD_UINT8:
+        if (PyCSDL2_EventViewLongAsRange(value, 0, 0xFF, "Uint8", &x))
+            return -1;
+        *p = (Uint8) x;
+        return 0;
+    case PYCSDL2_EVENTFIELD_UINT16:
+        if (PyCSDL2_EventViewLongAsRange(value, 0, 0xFFFF, "Uint16", &x))
+            return -1;
+        *(Uint16*) p = (Uint16) x;
+        return 0;
+    case PYCSDL2_EVENTFIELD_SINT16:
+        if (PyCSDL2_EventViewLongAsRange(value, -0x8000, 0x7FFF, "Sint16",
+                                         &x))
+            return -1;
+        *(Sint16*) p = (Sint16) x;
+        return 0;
+    case PYCSDL2_EVENTFIELD_UINT32:
+        return PyCSDL2_LongAsUint32(value, (Uint32*) p);
+    case PYCSDL2_EVENTFIELD_SINT32:
+        return PyCSDL2_LongAsSint32(value, (Sint32*) p);
+    case PYCSDL2_EVENTFIELD_SINT64:
+        return PyCSDL2_LongAsSint64(value, (Sint64*) p);
+    case PYCSDL2_EVENTFIELD_FLOAT:
+        d = PyFloat_AsDouble(value);
+        if (d == -1.0 && PyErr_Occurred())
+            return -1;
+        *(float*) p = (float) d;
+        return 0;
+    case PYCSDL2_EVENTFIELD_TEXT:
+        if (!(s = PyUnicode_AsUTF8AndSize(value, &len)))
+            return -1;
+        if (len >= PYCSDL2_EVENTFIELD_TEXTSIZE) {
+            PyErr_Format(PyExc_ValueError, "text must be less than %d bytes "
+                         "when encoded as UTF-8",
+                         PYCSDL2_EVENTFIELD_TEXTSIZE);
+            return -1;
+        }
+        SDL_memset(p, 0, PYCSDL2_EVENTFIELD_TEXTSIZE);
+        SDL_memcpy(p, s, len);
+        return 0;
+    case PYCSDL2_EVENTFIELD_POINTER:
+        ptr = PyLong_AsVoidPtr(value);
+        if (!ptr && PyErr_Occurred())
+            return -1;
+        *(void**) p = ptr;
+        return 0;
+    default:
+        PyErr_SetString(PyExc_AttributeError, "readonly attribute");
+        return -1;
+    }
+}
+
+/**
+ * \brief getbufferproc helper for the SDL_Event member views
+ *
+ * \param size Size of the viewed structure.
+ */
+static int
+PyCSDL2_EventViewGetBuffer(PyCSDL2_EventView *self, Py_buffer *view,
+                           int flags, size_t size)
+{
+    return PyBuffer_FillInfo(view, (PyObject*) self,
+                             PyCSDL2_EventViewData(self), size, 0, flags);
+}
+
+/**
+ * \brief Defines the type object of a SDL_Event member view.
+ *
+ * Expects PyCSDL2_<name>GetSetters to be defined, and defines
+ * PyCSDL2_<name>Type for the class csdl2.SDL_<name>, whose buffer is the
+ * SDL_<name> structure.
+ */
+#define PYCSDL2_EVENTVIEW_TYPE(name, doc) \
+static int \
+PyCSDL2_##name##GetBuffer(PyCSDL2_EventView *self, Py_buffer *view, \
+                          int flags) \
+{ \
+    return PyCSDL2_EventViewGetBuffer(self, view, flags, \
+                                      sizeof(SDL_##name)); \
+} \
+\
+static PyBufferProcs PyCSDL2_##name##BufferProcs = { \
+    (getbufferproc) PyCSDL2_##name##GetBuffer, \
+    (releasebufferproc) NULL \
+}; \
+\
+static PyTypeObject PyCSDL2_##name##Type = { \
+    PyVarObject_HEAD_INIT(NULL, 0) \
+    /* tp_name           */ "csdl2.SDL_" #name, \
+    /* tp_basicsize      */ sizeof(PyCSDL2_EventView), \
+    /* tp_itemsize       */ 0, \
+    /* tp_dealloc        */ (destructor) PyCSDL2_EventViewDealloc, \
+    /* tp_print          */ 0, \
+    /* tp_getattr        */ 0, \
+    /* tp_setattr        */ 0, \
+    /* tp_reserved       */ 0, \
+    /* tp_repr           */ 0, \
+    /* tp_as_number      */ 0, \
+    /* tp_as_sequence    */ 0, \
+    /* tp_as_mapping     */ 0, \
+    /* tp_hash           */ 0, \
+    /* tp_call           */ 0, \
+    /* tp_str            */ 0, \
+    /* tp_getattro       */ 0, \
+    /* tp_setattro       */ 0, \
+    /* tp_as_buffer      */ &PyCSDL2_##name##BufferProcs, \
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT, \
+    /* tp_doc            */ doc, \
+    /* tp_traverse       */ 0, \
+    /* tp_clear          */ 0, \
+    /* tp_richcompare    */ 0, \
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_EventView, in_weakreflist), \
+    /* tp_iter           */ 0, \
+    /* tp_iternext       */ 0, \
+    /* tp_methods        */ 0, \
+    /* tp_members        */ 0, \
+    /* tp_getset         */ PyCSDL2_##name##GetSetters, \
+    /* tp_base           */ 0, \
+    /* tp_dict           */ 0, \
+    /* tp_descr_get      */ 0, \
+    /* tp_descr_set      */ 0, \
+    /* tp_dictoffset     */ 0, \
+    /* tp_init           */ 0, \
+    /* tp_alloc          */ 0, \
+    /* tp_new            */ (newfunc) PyCSDL2_EventViewNew, \
+}
+
+/**
+ * \brief getset entry of a field of a SDL_Event member view.
+ *
+ * \param name Name of the field, as in the SDL structure.
+ * \param kind PYCSDL2_EVENTFIELD_* suffix of the field type.
+ * \param type The SDL structure containing the field.
+ * \param doc Docstring of the attribute.
+ */
+#define PYCSDL2_EVENTVIEW_FIELD(name, kind, type, doc) \
+    {#name, \
+     (getter) PyCSDL2_EventViewGetField, \
+     (setter) PyCSDL2_EventViewSetField, \
+     doc, \
+     PYCSDL2_EVENTFIELD(PYCSDL2_EVENTFIELD_##kind, type, name)}
+
+/** \brief getset entries of the type and timestamp fields */
+#define PYCSDL2_EVENTVIEW_HEADER(sdltype) \
+    PYCSDL2_EVENTVIEW_FIELD(type, UINT32, sdltype, "Event type."), \
+    PYCSDL2_EVENTVIEW_FIELD(timestamp, UINT32, sdltype, \
+                            "Timestamp of the event in milliseconds.")
+
+static PyGetSetDef PyCSDL2_CommonEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_CommonEvent),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(CommonEvent,
+                       "Fields shared by every event type.\n");
+
+static PyGetSetDef PyCSDL2_WindowEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_WindowEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_WindowEvent,
+                            "The associated window."),
+    PYCSDL2_EVENTVIEW_FIELD(event, UINT8, SDL_WindowEvent,
+                            "The SDL_WindowEventID."),
+    PYCSDL2_EVENTVIEW_FIELD(data1, SINT32, SDL_WindowEvent,
+                            "Event dependent data."),
+    PYCSDL2_EVENTVIEW_FIELD(data2, SINT32, SDL_WindowEvent,
+                            "Event dependent data."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(WindowEvent,
+                       "Window state change event data.\n");
+
+static PyGetSetDef PyCSDL2_KeysymGetSetters[] = {
+    PYCSDL2_EVENTVIEW_FIELD(scancode, SINT32, SDL_Keysym,
+                            "SDL physical key code."),
+    PYCSDL2_EVENTVIEW_FIELD(sym, SINT32, SDL_Keysym,
+                            "SDL virtual key code."),
+    PYCSDL2_EVENTVIEW_FIELD(mod, UINT16, SDL_Keysym,
+                            "Current key modifiers."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(Keysym,
+                       "The key that was pressed or released.\n");
+
+/** \brief Getter for SDL_KeyboardEvent.keysym */
+static PyObject *
+PyCSDL2_KeyboardEventGetKeysym(PyCSDL2_EventView *self, void *closure)
+{
+    if (!self->keysym) {
+        self->keysym = (PyObject*) PyCSDL2_EventViewCreate(
+            &PyCSDL2_KeysymType, self->ev_mem,
+            self->offset + offsetof(SDL_KeyboardEvent, keysym));
+        if (!self->keysym)
+            return NULL;
+    }
+    Py_INCREF(self->keysym);
+    return self->keysym;
+}
+
+static PyGetSetDef PyCSDL2_KeyboardEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_KeyboardEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_KeyboardEvent,
+                            "The window with keyboard focus, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(state, UINT8, SDL_KeyboardEvent,
+                            "SDL_PRESSED or SDL_RELEASED."),
+    PYCSDL2_EVENTVIEW_FIELD(repeat, UINT8, SDL_KeyboardEvent,
+                            "Non-zero if this is a key repeat."),
+    {"keysym",
+     (getter) PyCSDL2_KeyboardEventGetKeysym,
+     (setter) NULL,
+     "(readonly) The SDL_Keysym of the key that was pressed or released.",
+     NULL},
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(KeyboardEvent,
+                       "Keyboard button event data.\n");
+
+static PyGetSetDef PyCSDL2_TextEditingEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_TextEditingEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_TextEditingEvent,
+                            "The window with keyboard focus, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(text, TEXT, SDL_TextEditingEvent,
+                            "The editing text."),
+    PYCSDL2_EVENTVIEW_FIELD(start, SINT32, SDL_TextEditingEvent,
+                            "The start cursor of selected editing text."),
+    PYCSDL2_EVENTVIEW_FIELD(length, SINT32, SDL_TextEditingEvent,
+                            "The length of selected editing text."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(TextEditingEvent,
+                       "Keyboard text editing event data.\n");
+
+static PyGetSetDef PyCSDL2_TextInputEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_TextInputEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_TextInputEvent,
+                            "The window with keyboard focus, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(text, TEXT, SDL_TextInputEvent,
+                            "The input text."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(TextInputEvent,
+                       "Keyboard text input event data.\n");
+
+static PyGetSetDef PyCSDL2_MouseButtonEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_MouseButtonEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_MouseButtonEvent,
+                            "The window with mouse focus, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(which, UINT32, SDL_MouseButtonEvent,
+                            "The mouse instance id, or SDL_TOUCH_MOUSEID."),
+    PYCSDL2_EVENTVIEW_FIELD(button, UINT8, SDL_MouseButtonEvent,
+                            "The mouse button index."),
+    PYCSDL2_EVENTVIEW_FIELD(state, UINT8, SDL_MouseButtonEvent,
+                            "SDL_PRESSED or SDL_RELEASED."),
+    PYCSDL2_EVENTVIEW_FIELD(x, SINT32, SDL_MouseButtonEvent,
+                            "X coordinate, relative to window."),
+    PYCSDL2_EVENTVIEW_FIELD(y, SINT32, SDL_MouseButtonEvent,
+                            "Y coordinate, relative to window."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(MouseButtonEvent,
+                       "Mouse button event data.\n");
+
+static PyGetSetDef PyCSDL2_MouseWheelEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_MouseWheelEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_MouseWheelEvent,
+                            "The window with mouse focus, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(which, UINT32, SDL_MouseWheelEvent,
+                            "The mouse instance id, or SDL_TOUCH_MOUSEID."),
+    PYCSDL2_EVENTVIEW_FIELD(x, SINT32, SDL_MouseWheelEvent,
+                            "The amount scrolled horizontally."),
+    PYCSDL2_EVENTVIEW_FIELD(y, SINT32, SDL_MouseWheelEvent,
+                            "The amount scrolled vertically."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(MouseWheelEvent,
+                       "Mouse wheel event data.\n");
+
+static PyGetSetDef PyCSDL2_JoyAxisEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_JoyAxisEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_JoyAxisEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(axis, UINT8, SDL_JoyAxisEvent,
+                            "The joystick axis index."),
+    PYCSDL2_EVENTVIEW_FIELD(value, SINT16, SDL_JoyAxisEvent,
+                            "The axis value, from -32768 to 32767."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(JoyAxisEvent,
+                       "Joystick axis motion event data.\n");
+
+static PyGetSetDef PyCSDL2_JoyBallEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_JoyBallEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_JoyBallEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(ball, UINT8, SDL_JoyBallEvent,
+                            "The joystick trackball index."),
+    PYCSDL2_EVENTVIEW_FIELD(xrel, SINT16, SDL_JoyBallEvent,
+                            "The relative motion in the X direction."),
+    PYCSDL2_EVENTVIEW_FIELD(yrel, SINT16, SDL_JoyBallEvent,
+                            "The relative motion in the Y direction."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(JoyBallEvent,
+                       "Joystick trackball motion event data.\n");
+
+static PyGetSetDef PyCSDL2_JoyHatEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_JoyHatEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_JoyHatEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(hat, UINT8, SDL_JoyHatEvent,
+                            "The joystick hat index."),
+    PYCSDL2_EVENTVIEW_FIELD(value, UINT8, SDL_JoyHatEvent,
+                            "The hat position value."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(JoyHatEvent,
+                       "Joystick hat position change event data.\n");
+
+static PyGetSetDef PyCSDL2_JoyButtonEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_JoyButtonEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_JoyButtonEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(button, UINT8, SDL_JoyButtonEvent,
+                            "The joystick button index."),
+    PYCSDL2_EVENTVIEW_FIELD(state, UINT8, SDL_JoyButtonEvent,
+                            "SDL_PRESSED or SDL_RELEASED."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(JoyButtonEvent,
+                       "Joystick button event data.\n");
+
+static PyGetSetDef PyCSDL2_JoyDeviceEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_JoyDeviceEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_JoyDeviceEvent,
+                            "The joystick device index for the ADDED event,"
+                            " instance id for the REMOVED event."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(JoyDeviceEvent,
+                       "Joystick device event data.\n");
+
+static PyGetSetDef PyCSDL2_ControllerAxisEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_ControllerAxisEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_ControllerAxisEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(axis, UINT8, SDL_ControllerAxisEvent,
+                            "The controller axis."),
+    PYCSDL2_EVENTVIEW_FIELD(value, SINT16, SDL_ControllerAxisEvent,
+                            "The axis value, from -32768 to 32767."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(ControllerAxisEvent,
+                       "Game controller axis motion event data.\n");
+
+static PyGetSetDef PyCSDL2_ControllerButtonEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_ControllerButtonEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_ControllerButtonEvent,
+                            "The joystick instance id."),
+    PYCSDL2_EVENTVIEW_FIELD(button, UINT8, SDL_ControllerButtonEvent,
+                            "The controller button."),
+    PYCSDL2_EVENTVIEW_FIELD(state, UINT8, SDL_ControllerButtonEvent,
+                            "SDL_PRESSED or SDL_RELEASED."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(ControllerButtonEvent,
+                       "Game controller button event data.\n");
+
+static PyGetSetDef PyCSDL2_ControllerDeviceEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_ControllerDeviceEvent),
+    PYCSDL2_EVENTVIEW_FIELD(which, SINT32, SDL_ControllerDeviceEvent,
+                            "The joystick device index for the ADDED event,"
+                            " instance id for the REMOVED or REMAPPED"
+                            " event."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(ControllerDeviceEvent,
+                       "Game controller device event data.\n");
+
+static PyGetSetDef PyCSDL2_QuitEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_QuitEvent),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(QuitEvent,
+                       "Quit requested event data.\n");
+
+static PyGetSetDef PyCSDL2_UserEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_UserEvent),
+    PYCSDL2_EVENTVIEW_FIELD(windowID, UINT32, SDL_UserEvent,
+                            "The associated window, if any."),
+    PYCSDL2_EVENTVIEW_FIELD(code, SINT32, SDL_UserEvent,
+                            "User defined event code."),
+    PYCSDL2_EVENTVIEW_FIELD(data1, POINTER, SDL_UserEvent,
+                            "User defined data pointer, as an int."),
+    PYCSDL2_EVENTVIEW_FIELD(data2, POINTER, SDL_UserEvent,
+                            "User defined data pointer, as an int."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(UserEvent,
+                       "A user-defined event type.\n");
+
+static PyGetSetDef PyCSDL2_SysWMEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_SysWMEvent),
+    {"msg",
+     (getter) PyCSDL2_EventViewGetField,
+     (setter) NULL,
+     "(readonly) Address of the driver dependent SDL_SysWMmsg, as an int.",
+     PYCSDL2_EVENTFIELD(PYCSDL2_EVENTFIELD_POINTER, SDL_SysWMEvent, msg)},
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(SysWMEvent,
+                       "Video driver dependent system event data.\n");
+
+static PyGetSetDef PyCSDL2_TouchFingerEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_TouchFingerEvent),
+    PYCSDL2_EVENTVIEW_FIELD(touchId, SINT64, SDL_TouchFingerEvent,
+                            "The touch device id."),
+    PYCSDL2_EVENTVIEW_FIELD(fingerId, SINT64, SDL_TouchFingerEvent,
+                            "The finger id."),
+    PYCSDL2_EVENTVIEW_FIELD(x, FLOAT, SDL_TouchFingerEvent,
+                            "Normalized in the range 0...1."),
+    PYCSDL2_EVENTVIEW_FIELD(y, FLOAT, SDL_TouchFingerEvent,
+                            "Normalized in the range 0...1."),
+    PYCSDL2_EVENTVIEW_FIELD(dx, FLOAT, SDL_TouchFingerEvent,
+                            "Normalized in the range 0...1."),
+    PYCSDL2_EVENTVIEW_FIELD(dy, FLOAT, SDL_TouchFingerEvent,
+                            "Normalized in the range 0...1."),
+    PYCSDL2_EVENTVIEW_FIELD(pressure, FLOAT, SDL_TouchFingerEvent,
+                            "Normalized in the range 0...1."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(TouchFingerEvent,
+                       "Touch finger event data.\n");
+
+static PyGetSetDef PyCSDL2_MultiGestureEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_MultiGestureEvent),
+    PYCSDL2_EVENTVIEW_FIELD(touchId, SINT64, SDL_MultiGestureEvent,
+                            "The touch device id."),
+    PYCSDL2_EVENTVIEW_FIELD(dTheta, FLOAT, SDL_MultiGestureEvent,
+                            "The amount that the fingers rotated."),
+    PYCSDL2_EVENTVIEW_FIELD(dDist, FLOAT, SDL_MultiGestureEvent,
+                            "The amount that the fingers pinched."),
+    PYCSDL2_EVENTVIEW_FIELD(x, FLOAT, SDL_MultiGestureEvent,
+                            "Normalized center of the gesture."),
+    PYCSDL2_EVENTVIEW_FIELD(y, FLOAT, SDL_MultiGestureEvent,
+                            "Normalized center of the gesture."),
+    PYCSDL2_EVENTVIEW_FIELD(numFingers, UINT16, SDL_MultiGestureEvent,
+                            "The number of fingers used in the gesture."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(MultiGestureEvent,
+                       "Multiple finger gesture event data.\n");
+
+static PyGetSetDef PyCSDL2_DollarGestureEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_DollarGestureEvent),
+    PYCSDL2_EVENTVIEW_FIELD(touchId, SINT64, SDL_DollarGestureEvent,
+                            "The touch device id."),
+    PYCSDL2_EVENTVIEW_FIELD(gestureId, SINT64, SDL_DollarGestureEvent,
+                            "The unique id of the closest gesture."),
+    PYCSDL2_EVENTVIEW_FIELD(numFingers, UINT32, SDL_DollarGestureEvent,
+                            "The number of fingers used to draw the"
+                            " stroke."),
+    PYCSDL2_EVENTVIEW_FIELD(error, FLOAT, SDL_DollarGestureEvent,
+                            "Difference between the gesture template and"
+                            " the actual performed gesture."),
+    PYCSDL2_EVENTVIEW_FIELD(x, FLOAT, SDL_DollarGestureEvent,
+                            "Normalized center of the gesture."),
+    PYCSDL2_EVENTVIEW_FIELD(y, FLOAT, SDL_DollarGestureEvent,
+                            "Normalized center of the gesture."),
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(DollarGestureEvent,
+                       "Dollar gesture event data.\n");
+
+static PyGetSetDef PyCSDL2_DropEventGetSetters[] = {
+    PYCSDL2_EVENTVIEW_HEADER(SDL_DropEvent),
+    {"file",
+     (getter) PyCSDL2_EventViewGetField,
+     (setter) NULL,
+     "(readonly) The file name, or None if the event is not a\n"
+     "SDL_DROPFILE event.",
+     PYCSDL2_EVENTFIELD(PYCSDL2_EVENTFIELD_STRING, SDL_DropEvent, file)},
+    {NULL}
+};
+
+PYCSDL2_EVENTVIEW_TYPE(DropEvent,
+                       "File open request event data.\n");
+
+/**
+ * \brief Type objects of the views of the SDL_Event union members.
+ *
+ * The index of a member in this table is the index of its cached view in
+ * PyCSDL2_Event.views, and the closure of its PyCSDL2_Event getter.
+ */
+static PyTypeObject *PyCSDL2_EventMemberTypes[] = {
+    &PyCSDL2_CommonEventType,
+    &PyCSDL2_WindowEventType,
+    &PyCSDL2_KeyboardEventType,
+    &PyCSDL2_TextEditingEventType,
+    &PyCSDL2_TextInputEventType,
+    &PyCSDL2_MouseMotionEventType,
+    &PyCSDL2_MouseButtonEventType,
+    &PyCSDL2_MouseWheelEventType,
+    &PyCSDL2_JoyAxisEventType,
+    &PyCSDL2_JoyBallEventType,
+    &PyCSDL2_JoyHatEventType,
+    &PyCSDL2_JoyButtonEventType,
+    &PyCSDL2_JoyDeviceEventType,
+    &PyCSDL2_ControllerAxisEventType,
+    &PyCSDL2_ControllerButtonEventType,
+    &PyCSDL2_ControllerDeviceEventType,
+    &PyCSDL2_QuitEventType,
+    &PyCSDL2_UserEventType,
+    &PyCSDL2_SysWMEventType,
+    &PyCSDL2_TouchFingerEventType,
+    &PyCSDL2_MultiGestureEventType,
+    &PyCSDL2_DollarGestureEventType,
+    &PyCSDL2_DropEventType
+};
+
+/** \brief Number of SDL_Event union members with a view */
+#define PYCSDL2_EVENT_NUMVIEWS SDL_arraysize(PyCSDL2_EventMemberTypes)
+
+/** @} */
+
 /**
  * \brief Instance data of PyCSDL2_EventType
  */
@@ -468,54 +1267,123 @@ typedef struct PyCSDL2_Event {
     PyObject *in_weakreflist;
     /** \brief Pointer to the PyCSDL2_EventMem for the event */
     PyCSDL2_EventMem *ev_mem;
-    /** \brief Object providing view to "motion" attribute of SDL_Event */
-    PyCSDL2_MouseMotionEvent *motion;
+    /**
+     * \brief Cached views of the SDL_Event members, indexed as
+     *        PyCSDL2_EventMemberTypes. Created on first access.
+     */
+    PyObject *views[PYCSDL2_EVENT_NUMVIEWS];
 } PyCSDL2_Event;
 
+static PyTypeObject PyCSDL2_EventType;
+
+/** \brief Maximum number of PyCSDL2_Event objects kept for reuse */
+#define PYCSDL2_EVENT_MAXFREELIST 64
+
+/**
+ * \brief Free list of PyCSDL2_Event objects.
+ *
+ * Deallocated events are kept here instead of being freed, together with
+ * their zeroed PyCSDL2_EventMem if nothing else references it, so that
+ * creating an event per poll does not hit the allocator. Only accessed with
+ * the GIL held.
+ */
+static struct PyCSDL2_EventFreeList {
+    /** \brief The free events */
+    PyCSDL2_Event *items[PYCSDL2_EVENT_MAXFREELIST];
+    /** \brief Number of free events */
+    int len;
+    /** \brief Number of events created from the free list */
+    Uint64 hits;
+    /** \brief Number of events allocated because the free list was empty */
+    Uint64 misses;
+} PyCSDL2_EventFreeList;
+
 /**
  * \brief Instance creation function for PyCSDL2_EventType
  *
- * Sets PyCSDL2_Event.ev_mem to a new instance of PyCSDL2_EventMemType.
+ * Sets PyCSDL2_Event.ev_mem to a new instance of PyCSDL2_EventMemType. Reuses
+ * an event from the free list if there is one.
  */
 static PyCSDL2_Event *
 PyCSDL2_EventNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
+    struct PyCSDL2_EventFreeList *fl = &PyCSDL2_EventFreeList;
     PyCSDL2_Event *self;
-    PyTypeObject *t;
 
-    if (!(self = (PyCSDL2_Event*)type->tp_alloc(type, 0)))
-        return NULL;
-    if (!(self->ev_mem = PyCSDL2_EventMemCreate())) {
+    if (type == &PyCSDL2_EventType && fl->len) {
+        self = fl->items[--fl->len];
+        fl->hits++;
+        (void) PyObject_INIT(self, type);
+    } else {
+        if (type == &PyCSDL2_EventType)
+            fl->misses++;
+        if (!(self = (PyCSDL2_Event*)type->tp_alloc(type, 0)))
+            return NULL;
+    }
+
+    if (!self->ev_mem && !(self->ev_mem = PyCSDL2_EventMemCreate())) {
         Py_DECREF(self);
         return NULL;
     }
 
-    t = &PyCSDL2_MouseMotionEventType;
-    self->motion = PyCSDL2_MouseMotionEventNew(t, NULL, NULL);
-    if (!self->motion)
-        goto fail;
-    PyCSDL2_Set(self->motion->ev_mem, self->ev_mem);
-
     return self;
-
-fail:
-    Py_DECREF(self);
-    return NULL;
 }
 
 /**
  * \brief Destructor for PyCSDL2_EventType
  *
- * Releases reference to PyCSDL2_EventMem.
+ * Releases reference to PyCSDL2_EventMem and the cached views, then puts the
+ * event on the free list if it is not full.
  */
 static void
 PyCSDL2_EventDealloc(PyCSDL2_Event *self)
 {
+    struct PyCSDL2_EventFreeList *fl = &PyCSDL2_EventFreeList;
+    size_t i;
+
     if (self->in_weakreflist)
         PyObject_ClearWeakRefs((PyObject*) self);
-    Py_XDECREF(self->ev_mem);
-    Py_XDECREF(self->motion);
-    Py_TYPE(self)->tp_free((PyObject*) self);
+    for (i = 0; i < PYCSDL2_EVENT_NUMVIEWS; i++)
+        Py_CLEAR(self->views[i]);
+
+    if (Py_TYPE(self) != &PyCSDL2_EventType ||
+        fl->len == PYCSDL2_EVENT_MAXFREELIST) {
+        Py_XDECREF(self->ev_mem);
+        Py_TYPE(self)->tp_free((PyObject*) self);
+        return;
+    }
+
+    /* Views which outlive the event still use its memory */
+    if (self->ev_mem && Py_REFCNT(self->ev_mem) == 1) {
+        SDL_zero(self->ev_mem->ev);
+        Py_CLEAR(self->ev_mem->file);
+    } else
+        Py_CLEAR(self->ev_mem);
+    self->in_weakreflist = NULL;
+    fl->items[fl->len++] = self;
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetEventPoolStats()
+ *
+ * \code
+ * SDL_GetEventPoolStats() -> dict
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetEventPoolStats(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    struct PyCSDL2_EventFreeList *fl = &PyCSDL2_EventFreeList;
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    return Py_BuildValue("{s:K,s:K,s:i,s:i}",
+                         "hits", (unsigned long long) fl->hits,
+                         "misses", (unsigned long long) fl->misses,
+                         "free", fl->len,
+                         "capacity", PYCSDL2_EVENT_MAXFREELIST);
 }
 
 /**
@@ -537,9 +1405,6 @@ PyCSDL2_EventValid(PyCSDL2_Event *self)
         return 0;
     }
 
-    if (!PyCSDL2_Assert(self->motion))
-        return 0;
-
     return 1;
 }
 
@@ -563,31 +1428,91 @@ PyCSDL2_EventSetType(PyCSDL2_Event *self, PyObject *value, void *closure)
     return PyCSDL2_LongAsUint32(value, &self->ev_mem->ev.type);
 }
 
-/** \brief Getter for SDL_Event.motion */
+/**
+ * \brief Getter for the SDL_Event union members.
+ *
+ * The view is created on first access and shares the PyCSDL2_EventMem of the
+ * event, so all views of an event see the same SDL_Event.
+ *
+ * \param closure Index of the member in PyCSDL2_EventMemberTypes.
+ */
 static PyObject *
-PyCSDL2_EventGetMotion(PyCSDL2_Event *self, void *closure)
+PyCSDL2_EventGetMember(PyCSDL2_Event *self, void *closure)
 {
-    return PyCSDL2_Get((PyObject*) self->motion);
-}
+    size_t i = (size_t) closure;
+    PyTypeObject *type = PyCSDL2_EventMemberTypes[i];
+    PyCSDL2_MouseMotionEvent *motion;
 
-/**
- * \brief get setters for PyCSDL2_EventType
- */
-static PyGetSetDef PyCSDL2_EventGetSetters[] = {
+    if (!PyCSDL2_EventValid(self))
+        return NULL;
+
+    if (self->views[i])
+        return PyCSDL2_Get(self->views[i]);
+
+    if (type == &PyCSDL2_MouseMotionEventType) {
+        motion = (PyCSDL2_MouseMotionEvent*) type->tp_alloc(type, 0);
+        if (!motion)
+            return NULL;
+        Py_INCREF(self->ev_mem);
+        motion->ev_mem = self->ev_mem;
+        self->views[i] = (PyObject*) motion;
+    } else {
+        self->views[i] = (PyObject*) PyCSDL2_EventViewCreate(type,
+                                                             self->ev_mem, 0);
+        if (!self->views[i])
+            return NULL;
+    }
+
+    return PyCSDL2_Get(self->views[i]);
+}
+
+/** \brief getset entry of a SDL_Event union member */
+#define PYCSDL2_EVENT_MEMBER(name, index, doc) \
+    {name, \
+     (getter) PyCSDL2_EventGetMember, \
+     (setter) NULL, \
+     "(readonly) " doc, \
+     (void*) (index)}
+
+/**
+ * \brief get setters for PyCSDL2_EventType
+ */
+static PyGetSetDef PyCSDL2_EventGetSetters[] = {
     {"type",
      (getter) PyCSDL2_EventGetType,
      (setter) PyCSDL2_EventSetType,
      "Event type",
      NULL},
-    {"motion",
-     (getter) PyCSDL2_EventGetMotion,
-     (setter) NULL,
-     "(readonly) Mouse motion event data.\n"
-     "\n"
-     "Use this attribute to access the mouse motion event data when a mouse\n"
-     "motion event occurs (event type if SDL_MOUSEMOTION).",
-     NULL
-    },
+    PYCSDL2_EVENT_MEMBER("common", 0, "Common event data."),
+    PYCSDL2_EVENT_MEMBER("window", 1, "Window event data."),
+    PYCSDL2_EVENT_MEMBER("key", 2, "Keyboard event data."),
+    PYCSDL2_EVENT_MEMBER("edit", 3, "Text editing event data."),
+    PYCSDL2_EVENT_MEMBER("text", 4, "Text input event data."),
+    PYCSDL2_EVENT_MEMBER("motion", 5,
+        "Mouse motion event data.\n"
+        "\n"
+        "Use this attribute to access the mouse motion event data when a\n"
+        "mouse motion event occurs (event type if SDL_MOUSEMOTION)."),
+    PYCSDL2_EVENT_MEMBER("button", 6, "Mouse button event data."),
+    PYCSDL2_EVENT_MEMBER("wheel", 7, "Mouse wheel event data."),
+    PYCSDL2_EVENT_MEMBER("jaxis", 8, "Joystick axis event data."),
+    PYCSDL2_EVENT_MEMBER("jball", 9, "Joystick ball event data."),
+    PYCSDL2_EVENT_MEMBER("jhat", 10, "Joystick hat event data."),
+    PYCSDL2_EVENT_MEMBER("jbutton", 11, "Joystick button event data."),
+    PYCSDL2_EVENT_MEMBER("jdevice", 12, "Joystick device event data."),
+    PYCSDL2_EVENT_MEMBER("caxis", 13, "Game controller axis event data."),
+    PYCSDL2_EVENT_MEMBER("cbutton", 14,
+                         "Game controller button event data."),
+    PYCSDL2_EVENT_MEMBER("cdevice", 15,
+                         "Game controller device event data."),
+    PYCSDL2_EVENT_MEMBER("quit", 16, "Quit request event data."),
+    PYCSDL2_EVENT_MEMBER("user", 17, "Custom event data."),
+    PYCSDL2_EVENT_MEMBER("syswm", 18,
+                         "System dependent window event data."),
+    PYCSDL2_EVENT_MEMBER("tfinger", 19, "Touch finger event data."),
+    PYCSDL2_EVENT_MEMBER("mgesture", 20, "Multi finger gesture data."),
+    PYCSDL2_EVENT_MEMBER("dgesture", 21, "Dollar gesture data."),
+    PYCSDL2_EVENT_MEMBER("drop", 22, "Drag and drop event data."),
     {NULL}
 };
 
@@ -672,10 +1597,30 @@ PyCSDL2_EventCreate(const SDL_Event *ev)
         return NULL;
 
     self->ev_mem->ev = *ev;
+    if (PyCSDL2_EventMemTakeFile(self->ev_mem)) {
+        Py_DECREF(self);
+        return NULL;
+    }
 
     return (PyObject*)self;
 }
 
+/**
+ * \brief Takes the file of an event SDL has just stored in obj.
+ *
+ * Does nothing unless obj is a PyCSDL2_Event, the only event buffer with a
+ * drop.file attribute.
+ *
+ * \returns 0 on success, -1 with an exception set on failure.
+ */
+static int
+PyCSDL2_EventTakeFile(PyObject *obj)
+{
+    if (Py_TYPE(obj) != &PyCSDL2_EventType)
+        return 0;
+    return PyCSDL2_EventMemTakeFile(((PyCSDL2_Event*) obj)->ev_mem);
+}
+
 /**
  * \brief Borrows the SDL_Event from a PyCSDL2_Event object.
  *
@@ -732,157 +1677,2229 @@ PyCSDL2_GetEventBuffer(Py_buffer *buf, PyObject *obj, size_t len, int flags)
 }
 
 /**
- * \brief Implements csdl2.SDL_PumpEvents()
+ * \defgroup csdl2_EventNotifier csdl2.SDL_EventNotifier
  *
- * \code
- * SDL_PumpEvents() -> None
- * \endcode
+ * \brief Wakes event loops such as asyncio when events are queued.
  *
- * \returns Py_None on success, NULL if an exception occurred.
+ * Each notifier owns an eventfd, or a pipe where eventfd is not available,
+ * which becomes readable when events are added to the event queue. Events
+ * pushed with SDL_PushEvent() are seen by a single SDL event watch shared by
+ * all notifiers. Events added with SDL_PeepEvents() bypass event watches, so
+ * the csdl2 functions adding events that way signal the notifiers themselves.
+ *
+ * SDL calls event watches before the event is queued, so a consumer woken by
+ * the watch may clear the notifier and find the queue still empty. The
+ * csdl2 functions adding events thus signal again once the events are
+ * queued. Events pushed by C code on other threads are only signalled by the
+ * watch, and may wait until the consumer next wakes up.
+ *
+ * The event watch is registered with the first notifier and stays registered
+ * until the events subsystem is shut down, since SDL may be calling it on
+ * another thread when a notifier is closed. It does nothing while no notifier
+ * is open.
+ *
+ * Signalling does not need the GIL, and writes to the fd only once until the
+ * notifier is cleared.
+ *
+ * @{
  */
-static PyObject *
-PyCSDL2_PumpEvents(PyObject *module, PyObject *args, PyObject *kwds)
+
+/** \brief Instance data for PyCSDL2_EventNotifierType */
+typedef struct PyCSDL2_EventNotifier {
+    PyObject_HEAD
+    /** \brief Head of weak reference list */
+    PyObject *in_weakreflist;
+    /** \brief Read end, or -1 if closed */
+    int rfd;
+    /** \brief Write end, which is rfd for an eventfd */
+    int wfd;
+    /** \brief 1 if the fd has been written to since the last clear */
+    SDL_atomic_t pending;
+    /** \brief Next notifier in PyCSDL2_EventNotifiers */
+    struct PyCSDL2_EventNotifier *next;
+} PyCSDL2_EventNotifier;
+
+/** \brief Open notifiers, signalled by PyCSDL2_EventNotifierSignalAll() */
+static PyCSDL2_EventNotifier *PyCSDL2_EventNotifiers;
+
+/** \brief Protects PyCSDL2_EventNotifiers */
+static SDL_SpinLock PyCSDL2_EventNotifiersLock;
+
+/**
+ * \brief 1 if PyCSDL2_EventNotifierWatch() is registered.
+ *
+ * Only accessed with the GIL held.
+ */
+static int PyCSDL2_EventNotifierWatchAdded;
+
+static PyTypeObject PyCSDL2_EventNotifierType;
+
+/** \brief Makes the fd readable, unless it already is. */
+static void
+PyCSDL2_EventNotifierSignal(PyCSDL2_EventNotifier *self)
 {
-    static char *kwlist[] = {NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
-        return NULL;
-    SDL_PumpEvents();
-    Py_RETURN_NONE;
+#ifndef __WIN32__
+#ifdef __linux__
+    Uint64 one = 1;
+#else
+    char one = 1;
+#endif
+    ssize_t ret;
+
+    if (!SDL_AtomicCAS(&self->pending, 0, 1))
+        return;
+
+    do {
+        ret = write(self->wfd, &one, sizeof(one));
+    } while (ret < 0 && errno == EINTR);
+#endif
+}
+
+/** \brief Signals every open notifier. Does not need the GIL. */
+static void
+PyCSDL2_EventNotifierSignalAll(void)
+{
+    PyCSDL2_EventNotifier *n;
+
+    if (!PyCSDL2_EventNotifiers)
+        return;
+
+    SDL_AtomicLock(&PyCSDL2_EventNotifiersLock);
+    for (n = PyCSDL2_EventNotifiers; n; n = n->next)
+        PyCSDL2_EventNotifierSignal(n);
+    SDL_AtomicUnlock(&PyCSDL2_EventNotifiersLock);
 }
 
 /**
- * \brief Implements csdl2.SDL_PeepEvents()
+ * \brief SDL event watch shared by all notifiers.
  *
- * \code
- * SDL_PeepEvents(events, numevents: int, action: int, minType: int,
- *                maxType: int) -> int
- * \endcode
- * where events is a buffer object with len == sizeof(SDL_Event) * numevents
+ * Called by SDL_PushEvent() on whichever thread pushed the event, before the
+ * event is queued.
+ */
+static int SDLCALL
+PyCSDL2_EventNotifierWatch(void *userdata, SDL_Event *event)
+{
+    PyCSDL2_EventNotifierSignalAll();
+    return 0;
+}
+
+/**
+ * \brief Forgets the event watch after the events subsystem was shut down.
  *
- * \returns PyLong of the number of events actually stored, NULL if an
- *          exception occurred.
+ * SDL drops all event watches then, so the next notifier registers it again.
  */
-static PyObject *
-PyCSDL2_PeepEvents(PyObject *module, PyObject *args, PyObject *kwds)
+static void
+PyCSDL2_EventNotifierQuit(void)
 {
-    PyObject *ev_obj;
-    Py_buffer ev_buf;
-    int numevents, action, ret, flags = 0;
-    Uint32 minType, maxType;
-    static char *kwlist[] = {"events", "numevents", "action", "minType",
-                             "maxType", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oii" Uint32_UNIT Uint32_UNIT,
-                                     kwlist, &ev_obj, &numevents, &action,
-                                     &minType, &maxType))
+    PyCSDL2_EventNotifierWatchAdded = 0;
+}
+
+/**
+ * \brief Unlinks the notifier, so that it is no longer signalled, and closes
+ *        the fds.
+ */
+static void
+PyCSDL2_EventNotifierClose(PyCSDL2_EventNotifier *self)
+{
+    PyCSDL2_EventNotifier **p;
+
+    if (self->rfd < 0)
+        return;
+
+    SDL_AtomicLock(&PyCSDL2_EventNotifiersLock);
+    for (p = &PyCSDL2_EventNotifiers; *p; p = &(*p)->next) {
+        if (*p == self) {
+            *p = self->next;
+            break;
+        }
+    }
+    SDL_AtomicUnlock(&PyCSDL2_EventNotifiersLock);
+
+#ifndef __WIN32__
+    if (self->wfd != self->rfd)
+        close(self->wfd);
+    close(self->rfd);
+#endif
+    self->rfd = self->wfd = -1;
+}
+
+/** \brief tp_new for PyCSDL2_EventNotifierType */
+static PyCSDL2_EventNotifier *
+PyCSDL2_EventNotifierNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_EventNotifier *self;
+    static char *kwlist[] = {NULL};
+#if !defined(__WIN32__) && !defined(__linux__)
+    int fds[2], i;
+#endif
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
         return NULL;
-    if (numevents < 0) {
-        PyErr_SetString(PyExc_ValueError, "numevents must be positive");
+
+#ifdef __WIN32__
+    PyErr_SetString(PyExc_NotImplementedError,
+                    "SDL_EventNotifier is not supported on Windows");
+    return NULL;
+#else
+    self = (PyCSDL2_EventNotifier*) type->tp_alloc(type, 0);
+    if (!self)
         return NULL;
+    self->rfd = self->wfd = -1;
+
+#ifdef __linux__
+    self->rfd = self->wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (self->rfd < 0) {
+        Py_DECREF(self);
+        return (PyCSDL2_EventNotifier*) PyErr_SetFromErrno(PyExc_OSError);
     }
-    if (action != SDL_ADDEVENT)
-        flags |= PyBUF_WRITABLE;
-    if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, numevents, flags))
-        return NULL;
-    ret = SDL_PeepEvents(ev_buf.buf, numevents, action, minType, maxType);
-    PyBuffer_Release(&ev_buf);
-    if (ret < 0)
-        return PyCSDL2_RaiseSDLError();
-    return PyLong_FromLong(ret);
+#else
+    if (pipe(fds)) {
+        Py_DECREF(self);
+        return (PyCSDL2_EventNotifier*) PyErr_SetFromErrno(PyExc_OSError);
+    }
+    self->rfd = fds[0];
+    self->wfd = fds[1];
+    for (i = 0; i < 2; i++) {
+        if (fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK) ||
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC)) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            close(fds[0]);
+            close(fds[1]);
+            self->rfd = self->wfd = -1;
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+#endif
+
+    SDL_AtomicLock(&PyCSDL2_EventNotifiersLock);
+    self->next = PyCSDL2_EventNotifiers;
+    PyCSDL2_EventNotifiers = self;
+    SDL_AtomicUnlock(&PyCSDL2_EventNotifiersLock);
+
+    if (!PyCSDL2_EventNotifierWatchAdded) {
+        SDL_AddEventWatch(PyCSDL2_EventNotifierWatch, NULL);
+        PyCSDL2_EventNotifierWatchAdded = 1;
+    }
+
+    /* Wake the first wait if events are already queued */
+    if (SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT,
+                       SDL_LASTEVENT) > 0)
+        PyCSDL2_EventNotifierSignal(self);
+
+    return self;
+#endif
 }
 
-/**
- * \brief Implements csdl2.SDL_FlushEvents()
- *
- * \code
- * SDL_FlushEvents(minType: int, maxType: int) -> None
- * \endcode
- *
- * \returns Py_None on success, NULL if an exception occurred.
- */
+/** \brief tp_dealloc for PyCSDL2_EventNotifierType */
+static void
+PyCSDL2_EventNotifierDealloc(PyCSDL2_EventNotifier *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyCSDL2_EventNotifierClose(self);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Validates the PyCSDL2_EventNotifier object */
+static int
+PyCSDL2_EventNotifierValid(PyCSDL2_EventNotifier *self)
+{
+    if (!PyCSDL2_Assert(self))
+        return 0;
+
+    if (self->rfd < 0) {
+        PyErr_SetString(PyExc_ValueError, "SDL_EventNotifier is closed");
+        return 0;
+    }
+
+    return 1;
+}
+
+/** \brief Getter for PyCSDL2_EventNotifier.fd */
 static PyObject *
-PyCSDL2_FlushEvents(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_EventNotifierGetFd(PyCSDL2_EventNotifier *self, void *closure)
 {
-    Uint32 minType, maxType;
-    static char *kwlist[] = {"minType", "maxType", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT Uint32_UNIT,
-                                     kwlist, &minType, &maxType))
+    if (!PyCSDL2_EventNotifierValid(self))
         return NULL;
-    SDL_FlushEvents(minType, maxType);
-    Py_RETURN_NONE;
+
+    return PyLong_FromLong(self->rfd);
 }
 
+/** \brief List of getters and setters for PyCSDL2_EventNotifierType */
+static PyGetSetDef PyCSDL2_EventNotifierGetSetters[] = {
+    {"fd",
+     (getter) PyCSDL2_EventNotifierGetFd,
+     (setter) NULL,
+     "(readonly) File descriptor which is readable when events are queued.",
+     NULL},
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_EventNotifier */
+static PyTypeObject PyCSDL2_EventNotifierType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_EventNotifier",
+    /* tp_basicsize      */ sizeof(PyCSDL2_EventNotifier),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_EventNotifierDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */
+    "SDL_EventNotifier()\n"
+    "\n"
+    "A file descriptor which becomes readable when events are added to the\n"
+    "event queue, for waiting on events in a selector or asyncio loop.\n",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_EventNotifier, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ 0,
+    /* tp_getset         */ PyCSDL2_EventNotifierGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_EventNotifierNew
+};
+
 /**
- * \brief Implements csdl2.SDL_PollEvent()
+ * \brief Implements csdl2.SDL_EventNotifierClear()
  *
  * \code
- * SDL_PollEvent(event) -> bool
+ * SDL_EventNotifierClear(notifier: SDL_EventNotifier) -> None
  * \endcode
- * where event is any object that provides a buffer with the same size as
- * SDL_Event.
  *
- * \returns Py_True if SDL_PollEvent() returned 1 and Py_False if
- *          SDL_PollEvent() returned 0. NULL if an exception occurred.
+ * Makes the fd of the notifier unreadable until more events are queued. To
+ * not miss events, the notifier must be cleared before draining the queue.
  */
 static PyObject *
-PyCSDL2_PollEvent(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_EventNotifierClearPy(PyObject *module, PyObject *args,
+                             PyObject *kwds)
 {
-    PyObject *ev_obj;
-    Py_buffer ev_buf;
-    int ret;
-    static char *kwlist[] = {"event", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist,
-                                     &ev_obj))
+    PyCSDL2_EventNotifier *self;
+#ifndef __WIN32__
+    char buf[64];
+    ssize_t ret;
+#endif
+    static char *kwlist[] = {"notifier", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_EventNotifierType, &self))
         return NULL;
-    if (ev_obj == Py_None) {
-        ev_buf.obj = NULL;
-        ev_buf.buf = NULL;
-    } else if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, PyBUF_WRITABLE))
+
+    if (!PyCSDL2_EventNotifierValid(self))
         return NULL;
-    ret = SDL_PollEvent((SDL_Event*) ev_buf.buf);
-    PyBuffer_Release(&ev_buf);
-    return PyBool_FromLong(ret);
+
+#ifndef __WIN32__
+    do {
+        ret = read(self->rfd, buf, sizeof(buf));
+    } while (ret > 0 || (ret < 0 && errno == EINTR));
+#endif
+
+    /*
+     * Reset pending only after draining. An event queued in between is not
+     * signalled, but is seen by the drain of the queue which follows. A
+     * write still on its way at this point only causes a spurious wakeup.
+     * An event whose watch already ran but which is not queued yet is
+     * signalled again after queueing if csdl2 pushed it.
+     */
+    SDL_AtomicSet(&self->pending, 0);
+
+    Py_RETURN_NONE;
 }
 
 /**
- * \brief Implements csdl2.SDL_PushEvent()
+ * \brief Implements csdl2.SDL_EventNotifierClose()
  *
  * \code
- * SDL_PushEvent(event) -> bool
+ * SDL_EventNotifierClose(notifier: SDL_EventNotifier) -> None
  * \endcode
- * where event is any object that provides a buffer with the same size as
- * SDL_Event.
- *
- * \returns Py_True if SDL_PushEvent() returned 1 and Py_False if
- *          SDL_PushEvent() returned 0.
  */
 static PyObject *
-PyCSDL2_PushEvent(PyObject *module, PyObject *args, PyObject *kwds)
+PyCSDL2_EventNotifierClosePy(PyObject *module, PyObject *args,
+                             PyObject *kwds)
 {
-    PyObject *ev_obj;
-    Py_buffer ev_buf;
-    int ret;
-    static char *kwlist[] = {"event", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist,
-                                     &ev_obj))
-        return NULL;
-    if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, 0))
+    PyCSDL2_EventNotifier *self;
+    static char *kwlist[] = {"notifier", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_EventNotifierType, &self))
         return NULL;
-    ret = SDL_PushEvent((SDL_Event*) ev_buf.buf);
-    PyBuffer_Release(&ev_buf);
-    if (ret < 0)
-        return PyCSDL2_RaiseSDLError();
-    return PyBool_FromLong(ret);
+
+    PyCSDL2_EventNotifierClose(self);
+
+    Py_RETURN_NONE;
 }
 
+/** @} */
+
 /**
- * \brief Initializes bindings to SDL_events.h
+ * \defgroup csdl2_EventLog Event recording and replay
  *
- * \param module csdl2 module PyObject
- * \returns 1 on success, 0 if an exception occurred.
+ * \brief Binary log of dequeued events, and replay of such logs.
+ *
+ * An event log starts with a PYCSDL2_EVENTLOG_HEADER byte header:
+ *
+ * - 8 bytes: magic "PYCSDL2E"
+ * - Uint32: version, PYCSDL2_EVENTLOG_VERSION
+ * - Uint32: size of a record, PYCSDL2_EVENTLOG_RECORD
+ *
+ * followed by the records, each being a Uint64 time in nanoseconds since the
+ * recording was started and the SDL_Event. Everything is in native byte
+ * order, so a log is only replayed on the platform it was recorded on, which
+ * the version and record size check for.
+ *
+ * @{
  */
-static int
-PyCSDL2_initevents(PyObject *module)
+
+/** \brief Magic bytes at the start of an event log */
+#define PYCSDL2_EVENTLOG_MAGIC "PYCSDL2E"
+
+/** \brief Version of the event log format */
+#define PYCSDL2_EVENTLOG_VERSION 1
+
+/** \brief Size of the event log header */
+#define PYCSDL2_EVENTLOG_HEADER 16
+
+/** \brief Size of an event log record */
+#define PYCSDL2_EVENTLOG_RECORD (8 + sizeof(SDL_Event))
+
+/** \brief Number of records buffered by the recorder before writing */
+#define PYCSDL2_EVENTLOG_BUFFERED 256
+
+/**
+ * \brief State of the event recorder.
+ *
+ * Only accessed with the GIL held.
+ */
+static struct PyCSDL2_EventRecorder {
+    /** \brief Destination of the log, or NULL if not recording */
+    SDL_RWops *dst;
+    /** \brief SDL_GetPerformanceCounter() when the recording started */
+    Uint64 start;
+    /** \brief Records not written to dst yet */
+    Uint8 *buf;
+    /** \brief Number of records in buf */
+    size_t len;
+    /** \brief Number of events recorded */
+    Uint64 count;
+    /** \brief SDL error message of the first failed write, or "" */
+    char error[256];
+} PyCSDL2_EventRecorder;
+
+/** \brief Converts a duration in performance counter ticks to nanoseconds */
+static Uint64
+PyCSDL2_EventLogTicksToNs(Uint64 ticks)
+{
+    Uint64 freq = SDL_GetPerformanceFrequency();
+
+    return ticks / freq * 1000000000 + ticks % freq * 1000000000 / freq;
+}
+
+/** \brief Writes the buffered records of the recorder */
+static void
+PyCSDL2_EventRecorderFlush(void)
+{
+    struct PyCSDL2_EventRecorder *rec = &PyCSDL2_EventRecorder;
+
+    if (rec->len && !rec->error[0] &&
+        SDL_RWwrite(rec->dst, rec->buf, PYCSDL2_EVENTLOG_RECORD, rec->len) !=
+        rec->len) {
+        SDL_strlcpy(rec->error, SDL_GetError(), sizeof(rec->error));
+        if (!rec->error[0])
+            SDL_strlcpy(rec->error, "Error writing event log",
+                        sizeof(rec->error));
+    }
+    rec->len = 0;
+}
+
+/**
+ * \brief Records events which were dequeued by a csdl2 function.
+ *
+ * Does nothing if no recording is in progress. Write errors are reported
+ * by SDL_StopEventRecording() instead of the function which dequeued the
+ * events, so that the events are not lost.
+ *
+ * \param events The dequeued events.
+ * \param n Number of events.
+ */
+static void
+PyCSDL2_EventRecord(const SDL_Event *events, int n)
+{
+    struct PyCSDL2_EventRecorder *rec = &PyCSDL2_EventRecorder;
+    Uint64 t;
+    Uint8 *p;
+    int i;
+
+    if (!rec->dst || n <= 0)
+        return;
+
+    t = PyCSDL2_EventLogTicksToNs(SDL_GetPerformanceCounter() - rec->start);
+
+    for (i = 0; i < n; i++) {
+        if (rec->len == PYCSDL2_EVENTLOG_BUFFERED)
+            PyCSDL2_EventRecorderFlush();
+
+        p = rec->buf + rec->len * PYCSDL2_EVENTLOG_RECORD;
+        SDL_memcpy(p, &t, 8);
+        SDL_memcpy(p + 8, &events[i], sizeof(SDL_Event));
+
+        /* Pointers owned by SDL are meaningless in a replay */
+        if (events[i].type == SDL_DROPFILE)
+            SDL_memset(p + 8 + offsetof(SDL_DropEvent, file), 0,
+                       sizeof(char*));
+        else if (events[i].type == SDL_SYSWMEVENT)
+            SDL_memset(p + 8 + offsetof(SDL_SysWMEvent, msg), 0,
+                       sizeof(SDL_SysWMmsg*));
+
+        rec->len++;
+        rec->count++;
+    }
+}
+
+/**
+ * \brief Implements csdl2.SDL_StartEventRecording()
+ *
+ * \code
+ * SDL_StartEventRecording(file: str) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_StartEventRecording(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    struct PyCSDL2_EventRecorder *rec = &PyCSDL2_EventRecorder;
+    PyObject *file_obj;
+    SDL_RWops *dst;
+    Uint8 hdr[PYCSDL2_EVENTLOG_HEADER];
+    Uint32 version = PYCSDL2_EVENTLOG_VERSION;
+    Uint32 record = PYCSDL2_EVENTLOG_RECORD;
+    size_t ret;
+    static char *kwlist[] = {"file", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
+                                     PyUnicode_FSConverter, &file_obj))
+        return NULL;
+
+    if (rec->dst) {
+        Py_DECREF(file_obj);
+        PyErr_SetString(PyExc_ValueError, "already recording events");
+        return NULL;
+    }
+
+    if (!rec->buf) {
+        rec->buf = PyMem_Malloc(PYCSDL2_EVENTLOG_BUFFERED *
+                                PYCSDL2_EVENTLOG_RECORD);
+        if (!rec->buf) {
+            Py_DECREF(file_obj);
+            return PyErr_NoMemory();
+        }
+    }
+
+    SDL_memcpy(hdr, PYCSDL2_EVENTLOG_MAGIC, 8);
+    SDL_memcpy(hdr + 8, &version, 4);
+    SDL_memcpy(hdr + 12, &record, 4);
+
+    Py_BEGIN_ALLOW_THREADS
+    dst = SDL_RWFromFile(PyBytes_AS_STRING(file_obj), "wb");
+    ret = dst ? SDL_RWwrite(dst, hdr, sizeof(hdr), 1) : 0;
+    if (dst && ret != 1) {
+        SDL_RWclose(dst);
+        dst = NULL;
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(file_obj);
+
+    if (!dst)
+        return PyCSDL2_RaiseSDLError();
+
+    rec->dst = dst;
+    rec->start = SDL_GetPerformanceCounter();
+    rec->len = 0;
+    rec->count = 0;
+    rec->error[0] = '\0';
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_StopEventRecording()
+ *
+ * \code
+ * SDL_StopEventRecording() -> int
+ * \endcode
+ *
+ * \returns PyLong of the number of events recorded, NULL if an exception
+ *          occurred.
+ */
+static PyObject *
+PyCSDL2_StopEventRecording(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    struct PyCSDL2_EventRecorder *rec = &PyCSDL2_EventRecorder;
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    if (!rec->dst) {
+        PyErr_SetString(PyExc_ValueError, "not recording events");
+        return NULL;
+    }
+
+    PyCSDL2_EventRecorderFlush();
+    if (SDL_RWclose(rec->dst) && !rec->error[0])
+        SDL_strlcpy(rec->error, SDL_GetError(), sizeof(rec->error));
+    rec->dst = NULL;
+
+    if (rec->error[0]) {
+        PyErr_SetString(PyExc_OSError, rec->error);
+        return NULL;
+    }
+
+    return PyLong_FromUnsignedLongLong(rec->count);
+}
+
+/** \brief Instance data for PyCSDL2_EventReplayType */
+typedef struct PyCSDL2_EventReplay {
+    PyObject_HEAD
+    /** \brief Head of weak reference list */
+    PyObject *in_weakreflist;
+    /** \brief The mapped event log */
+    PyCSDL2_FileMapping map;
+    /** \brief Number of records in the log */
+    size_t count;
+    /** \brief Index of the next record to inject */
+    size_t pos;
+    /** \brief SDL_GetPerformanceCounter() of the first real time pump */
+    Uint64 start;
+} PyCSDL2_EventReplay;
+
+static PyTypeObject PyCSDL2_EventReplayType;
+
+/** \brief Returns the time of a record in nanoseconds */
+static Uint64
+PyCSDL2_EventReplayTime(PyCSDL2_EventReplay *self, size_t i)
+{
+    Uint64 t;
+
+    SDL_memcpy(&t, self->map.base + PYCSDL2_EVENTLOG_HEADER +
+               i * PYCSDL2_EVENTLOG_RECORD, 8);
+    return t;
+}
+
+/** \brief tp_new for PyCSDL2_EventReplayType */
+static PyCSDL2_EventReplay *
+PyCSDL2_EventReplayNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_EventReplay *self;
+    PyObject *file_obj;
+    PyCSDL2_FileMapping map;
+    Uint32 version = 0, record = 0;
+    int ret;
+    static char *kwlist[] = {"file", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
+                                     PyUnicode_FSConverter, &file_obj))
+        return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_MapFile(PyBytes_AS_STRING(file_obj), &map);
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(file_obj);
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    if (map.size >= PYCSDL2_EVENTLOG_HEADER) {
+        SDL_memcpy(&version, map.base + 8, 4);
+        SDL_memcpy(&record, map.base + 12, 4);
+    }
+
+    if (map.size < PYCSDL2_EVENTLOG_HEADER ||
+        SDL_memcmp(map.base, PYCSDL2_EVENTLOG_MAGIC, 8) ||
+        version != PYCSDL2_EVENTLOG_VERSION ||
+        record != PYCSDL2_EVENTLOG_RECORD ||
+        (map.size - PYCSDL2_EVENTLOG_HEADER) % PYCSDL2_EVENTLOG_RECORD) {
+        PyCSDL2_UnmapFile(&map);
+        PyErr_SetString(PyExc_ValueError, "invalid event log");
+        return NULL;
+    }
+
+    self = (PyCSDL2_EventReplay*) type->tp_alloc(type, 0);
+    if (!self) {
+        PyCSDL2_UnmapFile(&map);
+        return NULL;
+    }
+
+    self->map = map;
+    self->count = (map.size - PYCSDL2_EVENTLOG_HEADER) /
+                  PYCSDL2_EVENTLOG_RECORD;
+
+    return self;
+}
+
+/** \brief tp_dealloc for PyCSDL2_EventReplayType */
+static void
+PyCSDL2_EventReplayDealloc(PyCSDL2_EventReplay *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyCSDL2_UnmapFile(&self->map);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Getter for SDL_EventReplay.count */
+static PyObject *
+PyCSDL2_EventReplayGetCount(PyCSDL2_EventReplay *self, void *closure)
+{
+    return PyLong_FromSize_t(self->count);
+}
+
+/** \brief Getter for SDL_EventReplay.pos */
+static PyObject *
+PyCSDL2_EventReplayGetPos(PyCSDL2_EventReplay *self, void *closure)
+{
+    return PyLong_FromSize_t(self->pos);
+}
+
+/** \brief Getter for SDL_EventReplay.duration */
+static PyObject *
+PyCSDL2_EventReplayGetDuration(PyCSDL2_EventReplay *self, void *closure)
+{
+    if (!self->count)
+        return PyFloat_FromDouble(0.0);
+    return PyFloat_FromDouble(
+        PyCSDL2_EventReplayTime(self, self->count - 1) / 1e9);
+}
+
+/** \brief List of getters and setters for PyCSDL2_EventReplayType */
+static PyGetSetDef PyCSDL2_EventReplayGetSetters[] = {
+    {"count",
+     (getter) PyCSDL2_EventReplayGetCount,
+     (setter) NULL,
+     "(readonly) Number of events in the log.",
+     NULL},
+    {"pos",
+     (getter) PyCSDL2_EventReplayGetPos,
+     (setter) NULL,
+     "(readonly) Index of the next event to be injected.",
+     NULL},
+    {"duration",
+     (getter) PyCSDL2_EventReplayGetDuration,
+     (setter) NULL,
+     "(readonly) Time of the last event in seconds.",
+     NULL},
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_EventReplay */
+static PyTypeObject PyCSDL2_EventReplayType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_EventReplay",
+    /* tp_basicsize      */ sizeof(PyCSDL2_EventReplay),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_EventReplayDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */
+    "SDL_EventReplay(file: str)\n"
+    "\n"
+    "Memory-maps an event log written by SDL_StartEventRecording() for\n"
+    "injection into the event queue with SDL_EventReplayPump().\n",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_EventReplay, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ 0,
+    /* tp_getset         */ PyCSDL2_EventReplayGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_EventReplayNew
+};
+
+/**
+ * \brief Implements csdl2.SDL_EventReplayPump()
+ *
+ * \code
+ * SDL_EventReplayPump(replay: SDL_EventReplay,
+ *                     time: float or None = None) -> int
+ * \endcode
+ *
+ * Adds the events of the log up to time, in seconds since the start of the
+ * recording, to the event queue with SDL_PeepEvents(). If time is None, it is
+ * the time elapsed since the first such call.
+ *
+ * \returns PyLong of the number of events added, NULL if an exception
+ *          occurred.
+ */
+static PyObject *
+PyCSDL2_EventReplayPump(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_EventReplay *self;
+    PyObject *time_obj = Py_None;
+    SDL_Event events[64];
+    const Uint8 *p;
+    Uint64 now;
+    double t;
+    size_t start, n;
+    int ret;
+    static char *kwlist[] = {"replay", "time", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|O", kwlist,
+                                     &PyCSDL2_EventReplayType, &self,
+                                     &time_obj))
+        return NULL;
+
+    if (time_obj == Py_None) {
+        if (!self->start)
+            self->start = SDL_GetPerformanceCounter();
+        now = PyCSDL2_EventLogTicksToNs(SDL_GetPerformanceCounter() -
+                                        self->start);
+    } else {
+        t = PyFloat_AsDouble(time_obj);
+        if (t == -1.0 && PyErr_Occurred())
+            return NULL;
+        if (!Py_IS_FINITE(t) || t < 0.0) {
+            PyErr_SetString(PyExc_ValueError, "time must be finite and not "
+                            "negative");
+            return NULL;
+        }
+        /* The nanoseconds must fit in a Uint64, which 2^64 does not */
+        if (t * 1e9 >= 18446744073709551616.0) {
+            PyErr_SetString(PyExc_ValueError, "time is too large");
+            return NULL;
+        }
+        /* Round, so that times read from duration match exactly */
+        now = (Uint64) (t * 1e9 + 0.5);
+    }
+
+    start = self->pos;
+    while (self->pos < self->count &&
+           PyCSDL2_EventReplayTime(self, self->pos) <= now) {
+        for (n = 0; n < SDL_arraysize(events) &&
+             self->pos + n < self->count &&
+             PyCSDL2_EventReplayTime(self, self->pos + n) <= now; n++) {
+            p = self->map.base + PYCSDL2_EVENTLOG_HEADER +
+                (self->pos + n) * PYCSDL2_EVENTLOG_RECORD;
+            SDL_memcpy(&events[n], p + 8, sizeof(SDL_Event));
+        }
+
+        ret = SDL_PeepEvents(events, (int) n, SDL_ADDEVENT, 0, 0);
+        if (ret > 0)
+            self->pos += ret;
+        if (ret < 0) {
+            PyCSDL2_RaiseSDLError();
+            break;
+        }
+        if (ret < (int) n) {
+            PyErr_SetString(PyExc_RuntimeError, "event queue is full");
+            break;
+        }
+    }
+
+    if (self->pos != start)
+        PyCSDL2_EventNotifierSignalAll();
+
+    if (PyErr_Occurred())
+        return NULL;
+
+    return PyLong_FromSize_t(self->pos - start);
+}
+
+/** @} */
+
+/**
+ * \brief Implements csdl2.SDL_PumpEvents()
+ *
+ * \code
+ * SDL_PumpEvents() -> None
+ * \endcode
+ *
+ * \returns Py_None on success, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_PumpEvents(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+    SDL_PumpEvents();
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_PeepEvents()
+ *
+ * \code
+ * SDL_PeepEvents(events, numevents: int, action: int, minType: int,
+ *                maxType: int) -> int
+ * \endcode
+ * where events is a buffer object with len == sizeof(SDL_Event) * numevents
+ *
+ * \returns PyLong of the number of events actually stored, NULL if an
+ *          exception occurred.
+ */
+static PyObject *
+PyCSDL2_PeepEvents(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj;
+    Py_buffer ev_buf;
+    int numevents, action, ret, flags = 0;
+    Uint32 minType, maxType;
+    static char *kwlist[] = {"events", "numevents", "action", "minType",
+                             "maxType", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oii" Uint32_UNIT Uint32_UNIT,
+                                     kwlist, &ev_obj, &numevents, &action,
+                                     &minType, &maxType))
+        return NULL;
+    if (numevents < 0) {
+        PyErr_SetString(PyExc_ValueError, "numevents must be positive");
+        return NULL;
+    }
+    if (action != SDL_ADDEVENT)
+        flags |= PyBUF_WRITABLE;
+    if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, numevents, flags))
+        return NULL;
+    ret = SDL_PeepEvents(ev_buf.buf, numevents, action, minType, maxType);
+    if (action == SDL_GETEVENT)
+        PyCSDL2_EventRecord(ev_buf.buf, ret);
+    PyBuffer_Release(&ev_buf);
+    if (ret < 0)
+        return PyCSDL2_RaiseSDLError();
+    /* Added events bypass the event watch */
+    if (ret > 0 && action == SDL_ADDEVENT)
+        PyCSDL2_EventNotifierSignalAll();
+    if (ret > 0 && action != SDL_ADDEVENT && PyCSDL2_EventTakeFile(ev_obj))
+        return NULL;
+    return PyLong_FromLong(ret);
+}
+
+/**
+ * \brief Implements csdl2.SDL_FlushEvents()
+ *
+ * \code
+ * SDL_FlushEvents(minType: int, maxType: int) -> None
+ * \endcode
+ *
+ * \returns Py_None on success, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_FlushEvents(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint32 minType, maxType;
+    static char *kwlist[] = {"minType", "maxType", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT Uint32_UNIT,
+                                     kwlist, &minType, &maxType))
+        return NULL;
+    SDL_FlushEvents(minType, maxType);
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_PollEvent()
+ *
+ * \code
+ * SDL_PollEvent(event) -> bool
+ * \endcode
+ * where event is any object that provides a buffer with the same size as
+ * SDL_Event.
+ *
+ * \returns Py_True if SDL_PollEvent() returned 1 and Py_False if
+ *          SDL_PollEvent() returned 0. NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_PollEvent(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj;
+    Py_buffer ev_buf;
+    int ret;
+    static char *kwlist[] = {"event", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist,
+                                     &ev_obj))
+        return NULL;
+    if (ev_obj == Py_None) {
+        ev_buf.obj = NULL;
+        ev_buf.buf = NULL;
+    } else if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, PyBUF_WRITABLE))
+        return NULL;
+    ret = SDL_PollEvent((SDL_Event*) ev_buf.buf);
+    if (ret && ev_buf.buf)
+        PyCSDL2_EventRecord(ev_buf.buf, 1);
+    PyBuffer_Release(&ev_buf);
+    if (ret && PyCSDL2_EventTakeFile(ev_obj))
+        return NULL;
+    return PyBool_FromLong(ret);
+}
+
+/**
+ * \brief Implements csdl2.SDL_WaitEvent()
+ *
+ * \code
+ * SDL_WaitEvent(event) -> None
+ * \endcode
+ * where event is None or any object that provides a writable buffer with the
+ * same size as SDL_Event.
+ *
+ * The GIL is released while waiting, so other Python threads can run while
+ * the calling thread blocks on input.
+ *
+ * \returns Py_None on success, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_WaitEvent(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj;
+    Py_buffer ev_buf;
+    int ret;
+    static char *kwlist[] = {"event", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &ev_obj))
+        return NULL;
+    if (ev_obj == Py_None) {
+        ev_buf.obj = NULL;
+        ev_buf.buf = NULL;
+    } else if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, PyBUF_WRITABLE))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SDL_WaitEvent((SDL_Event*) ev_buf.buf);
+    Py_END_ALLOW_THREADS
+    if (ret && ev_buf.buf)
+        PyCSDL2_EventRecord(ev_buf.buf, 1);
+    PyBuffer_Release(&ev_buf);
+    if (!ret)
+        return PyCSDL2_RaiseSDLError();
+    if (PyCSDL2_EventTakeFile(ev_obj))
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Implements csdl2.SDL_WaitEventTimeout()
+ *
+ * \code
+ * SDL_WaitEventTimeout(event, timeout: int) -> bool
+ * \endcode
+ * where event is None or any object that provides a writable buffer with the
+ * same size as SDL_Event, and timeout is in milliseconds.
+ *
+ * The GIL is released while waiting.
+ *
+ * \returns Py_True if an event is available, Py_False if the timeout elapsed
+ *          first, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_WaitEventTimeout(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj;
+    Py_buffer ev_buf;
+    int timeout, ret;
+    static char *kwlist[] = {"event", "timeout", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Oi", kwlist, &ev_obj,
+                                     &timeout))
+        return NULL;
+    if (ev_obj == Py_None) {
+        ev_buf.obj = NULL;
+        ev_buf.buf = NULL;
+    } else if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, PyBUF_WRITABLE))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SDL_WaitEventTimeout((SDL_Event*) ev_buf.buf, timeout);
+    Py_END_ALLOW_THREADS
+    if (ret && ev_buf.buf)
+        PyCSDL2_EventRecord(ev_buf.buf, 1);
+    PyBuffer_Release(&ev_buf);
+    if (ret && PyCSDL2_EventTakeFile(ev_obj))
+        return NULL;
+    return PyBool_FromLong(ret);
+}
+
+/**
+ * \brief Implements csdl2.SDL_PollEvents()
+ *
+ * \code
+ * SDL_PollEvents(events, max: int or None = None) -> int
+ * \endcode
+ * where events is a writable buffer of SDL_Event structs, such as a NumPy
+ * array with the dtype SDL_EVENT_DTYPE.
+ *
+ * Pumps the event loop once and moves up to max events from the front of the
+ * event queue into events, so that a whole frame's worth of input crosses the
+ * Python/C boundary in a single call.
+ *
+ * \returns PyLong of the number of events stored, NULL if an exception
+ *          occurred.
+ */
+static PyObject *
+PyCSDL2_PollEvents(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj, *max_obj = Py_None;
+    Py_buffer ev_buf;
+    Py_ssize_t capacity, max;
+    int ret;
+    static char *kwlist[] = {"events", "max", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &ev_obj,
+                                     &max_obj))
+        return NULL;
+    if (PyObject_GetBuffer(ev_obj, &ev_buf,
+                           PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE))
+        return NULL;
+    if (ev_buf.len % sizeof(SDL_Event)) {
+        PyErr_Format(PyExc_BufferError, "Invalid SDL_Event buffer size. "
+                     "Expected a multiple of %zu. Got: %zd.",
+                     sizeof(SDL_Event), ev_buf.len);
+        goto fail;
+    }
+    capacity = ev_buf.len / sizeof(SDL_Event);
+    if (max_obj == Py_None) {
+        max = capacity;
+    } else {
+        max = PyLong_AsSsize_t(max_obj);
+        if (max == -1 && PyErr_Occurred())
+            goto fail;
+        if (max < 0) {
+            PyErr_SetString(PyExc_ValueError, "max must be positive");
+            goto fail;
+        }
+        if (max > capacity) {
+            PyErr_Format(PyExc_BufferError, "SDL_Event buffer too small. "
+                         "Expected at least %zd events. Got: %zd.", max,
+                         capacity);
+            goto fail;
+        }
+    }
+    if (max > INT_MAX)
+        max = INT_MAX;
+    SDL_PumpEvents();
+    ret = SDL_PeepEvents(ev_buf.buf, (int) max, SDL_GETEVENT, SDL_FIRSTEVENT,
+                         SDL_LASTEVENT);
+    PyCSDL2_EventRecord(ev_buf.buf, ret);
+    PyBuffer_Release(&ev_buf);
+    if (ret < 0)
+        return PyCSDL2_RaiseSDLError();
+    return PyLong_FromLong(ret);
+
+fail:
+    PyBuffer_Release(&ev_buf);
+    return NULL;
+}
+
+/**
+ * \brief Implements csdl2.SDL_PushEvent()
+ *
+ * \code
+ * SDL_PushEvent(event) -> bool
+ * \endcode
+ * where event is any object that provides a buffer with the same size as
+ * SDL_Event.
+ *
+ * \returns Py_True if SDL_PushEvent() returned 1 and Py_False if
+ *          SDL_PushEvent() returned 0.
+ */
+static PyObject *
+PyCSDL2_PushEvent(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *ev_obj;
+    Py_buffer ev_buf;
+    int ret;
+    static char *kwlist[] = {"event", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist,
+                                     &ev_obj))
+        return NULL;
+    if (PyCSDL2_GetEventBuffer(&ev_buf, ev_obj, 1, 0))
+        return NULL;
+    ret = SDL_PushEvent((SDL_Event*) ev_buf.buf);
+    PyBuffer_Release(&ev_buf);
+    if (ret < 0)
+        return PyCSDL2_RaiseSDLError();
+    /* The event watch ran before the event was queued */
+    if (ret > 0)
+        PyCSDL2_EventNotifierSignalAll();
+    return PyBool_FromLong(ret);
+}
+
+/**
+ * \defgroup csdl2_EventColumns csdl2.SDL_EventColumns
+ *
+ * \brief Struct-of-arrays export of the event queue.
+ *
+ * SDL_PollEventColumns() drains the event queue into a column per field, so
+ * that NumPy code can process a frame's input without touching each event.
+ * Each column is exposed as a read-only PyCSDL2_Buffer of the events stored
+ * by the last drain.
+ *
+ * @{
+ */
+
+/** \brief Instance data for PyCSDL2_EventColumnsType */
+typedef struct PyCSDL2_EventColumns {
+    PyObject_HEAD
+    /** \brief Head of weak reference list */
+    PyObject *in_weakreflist;
+    /** \brief Maximum number of events stored by a drain */
+    Py_ssize_t capacity;
+    /** \brief Number of events stored by the last drain */
+    Py_ssize_t count;
+    /** \brief Memory block holding all columns */
+    void *mem;
+    /** \brief Event types */
+    Uint32 *types;
+    /** \brief Event timestamps */
+    Uint32 *timestamps;
+    /** \brief Window IDs of window, keyboard, mouse and user events */
+    Uint32 *window_ids;
+    /** \brief Pointer position, or data1 and data2 of window events */
+    Sint32 *x, *y;
+    /** \brief Relative motion, or scroll amounts of wheel events */
+    Sint32 *xrel, *yrel;
+    /** \brief Key codes of keyboard events */
+    Sint32 *keys;
+    /** \brief Scan codes of keyboard events */
+    Sint32 *scancodes;
+    /** \brief Key modifiers of keyboard events */
+    Uint16 *mods;
+    /** \brief Mouse buttons of mouse button events */
+    Uint8 *buttons;
+    /** \brief Key and button states, or button masks of motion events */
+    Uint32 *states;
+    /** \brief Window event IDs, or codes of user events */
+    Sint32 *codes;
+} PyCSDL2_EventColumns;
+
+/** \brief A column of PyCSDL2_EventColumns */
+typedef struct PyCSDL2_EventColumn {
+    /** \brief Attribute name */
+    const char *name;
+    /** \brief Item type */
+    enum PyCSDL2_CType itemtype;
+    /** \brief Offset of the column pointer in PyCSDL2_EventColumns */
+    size_t offset;
+} PyCSDL2_EventColumn;
+
+/** \brief Columns of PyCSDL2_EventColumns, in memory order */
+static const PyCSDL2_EventColumn PyCSDL2_EventColumnList[] = {
+    {"types", CTYPE_UINT32, offsetof(PyCSDL2_EventColumns, types)},
+    {"timestamps", CTYPE_UINT32, offsetof(PyCSDL2_EventColumns, timestamps)},
+    {"window_ids", CTYPE_UINT32, offsetof(PyCSDL2_EventColumns, window_ids)},
+    {"x", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, x)},
+    {"y", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, y)},
+    {"xrel", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, xrel)},
+    {"yrel", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, yrel)},
+    {"keys", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, keys)},
+    {"scancodes", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, scancodes)},
+    {"mods", CTYPE_UINT16, offsetof(PyCSDL2_EventColumns, mods)},
+    {"buttons", CTYPE_UCHAR, offsetof(PyCSDL2_EventColumns, buttons)},
+    {"states", CTYPE_UINT32, offsetof(PyCSDL2_EventColumns, states)},
+    {"codes", CTYPE_SINT32, offsetof(PyCSDL2_EventColumns, codes)},
+    {NULL}
+};
+
+/** \brief Returns the address of a column pointer of self */
+#define PYCSDL2_EVENTCOLUMN_PTR(self, col) \
+    ((void**) ((char*) (self) + (col)->offset))
+
+static PyTypeObject PyCSDL2_EventColumnsType;
+
+/** \brief tp_new for PyCSDL2_EventColumnsType */
+static PyCSDL2_EventColumns *
+PyCSDL2_EventColumnsNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_EventColumns *self;
+    const PyCSDL2_EventColumn *col;
+    Py_ssize_t capacity, size = 0;
+    char *p;
+    static char *kwlist[] = {"capacity", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &capacity))
+        return NULL;
+
+    if (capacity <= 0 || capacity > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "invalid capacity");
+        return NULL;
+    }
+
+    /* Keep every column 8-byte aligned for vectorized access */
+    for (col = PyCSDL2_EventColumnList; col->name; col++) {
+        if (capacity > (PY_SSIZE_T_MAX - size - 8) /
+                       PyCSDL2_CTypeSize(col->itemtype))
+            return (PyCSDL2_EventColumns*) PyErr_NoMemory();
+        size += (capacity * PyCSDL2_CTypeSize(col->itemtype) + 7) & ~7;
+    }
+
+    self = (PyCSDL2_EventColumns*) type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    self->mem = PyMem_Malloc(size);
+    if (!self->mem) {
+        Py_DECREF(self);
+        return (PyCSDL2_EventColumns*) PyErr_NoMemory();
+    }
+
+    p = self->mem;
+    for (col = PyCSDL2_EventColumnList; col->name; col++) {
+        *PYCSDL2_EVENTCOLUMN_PTR(self, col) = p;
+        p += (capacity * PyCSDL2_CTypeSize(col->itemtype) + 7) & ~7;
+    }
+    self->capacity = capacity;
+
+    return self;
+}
+
+/** \brief tp_dealloc for PyCSDL2_EventColumnsType */
+static void
+PyCSDL2_EventColumnsDealloc(PyCSDL2_EventColumns *self)
+{
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyMem_Free(self->mem);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/**
+ * \brief Getter for the columns of PyCSDL2_EventColumnsType.
+ *
+ * \param closure The PyCSDL2_EventColumn.
+ * \returns A read-only PyCSDL2_Buffer of the column entries of the events
+ *          stored by the last drain, which keeps self alive.
+ */
+static PyObject *
+PyCSDL2_EventColumnsGetColumn(PyCSDL2_EventColumns *self, void *closure)
+{
+    const PyCSDL2_EventColumn *col = closure;
+
+    return (PyObject*) PyCSDL2_BufferCreate(col->itemtype,
+                                            *PYCSDL2_EVENTCOLUMN_PTR(self,
+                                                                     col),
+                                            self->count, 1,
+                                            (PyObject*) self);
+}
+
+/** \brief Getter for PyCSDL2_EventColumns.capacity */
+static PyObject *
+PyCSDL2_EventColumnsGetCapacity(PyCSDL2_EventColumns *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->capacity);
+}
+
+/** \brief Getter for PyCSDL2_EventColumns.count */
+static PyObject *
+PyCSDL2_EventColumnsGetCount(PyCSDL2_EventColumns *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->count);
+}
+
+/** \brief Defines the getter of the column at index i */
+#define PYCSDL2_EVENTCOLUMN_GETSET(i, doc) \
+    {(char*) PyCSDL2_EventColumnList[i].name, \
+     (getter) PyCSDL2_EventColumnsGetColumn, (setter) NULL, doc, \
+     (void*) &PyCSDL2_EventColumnList[i]}
+
+/** \brief List of attributes of PyCSDL2_EventColumnsType */
+static PyGetSetDef PyCSDL2_EventColumnsGetSetters[] = {
+    {"capacity",
+     (getter) PyCSDL2_EventColumnsGetCapacity,
+     (setter) NULL,
+     "(readonly) Maximum number of events stored by a drain.",
+     NULL},
+    {"count",
+     (getter) PyCSDL2_EventColumnsGetCount,
+     (setter) NULL,
+     "(readonly) Number of events stored by the last drain.",
+     NULL},
+    PYCSDL2_EVENTCOLUMN_GETSET(0, "(readonly) Event types."),
+    PYCSDL2_EVENTCOLUMN_GETSET(1, "(readonly) Event timestamps."),
+    PYCSDL2_EVENTCOLUMN_GETSET(2, "(readonly) Window IDs."),
+    PYCSDL2_EVENTCOLUMN_GETSET(3, "(readonly) X positions."),
+    PYCSDL2_EVENTCOLUMN_GETSET(4, "(readonly) Y positions."),
+    PYCSDL2_EVENTCOLUMN_GETSET(5, "(readonly) Relative X motion."),
+    PYCSDL2_EVENTCOLUMN_GETSET(6, "(readonly) Relative Y motion."),
+    PYCSDL2_EVENTCOLUMN_GETSET(7, "(readonly) Key codes."),
+    PYCSDL2_EVENTCOLUMN_GETSET(8, "(readonly) Scan codes."),
+    PYCSDL2_EVENTCOLUMN_GETSET(9, "(readonly) Key modifiers."),
+    PYCSDL2_EVENTCOLUMN_GETSET(10, "(readonly) Mouse buttons."),
+    PYCSDL2_EVENTCOLUMN_GETSET(11, "(readonly) Key and button states."),
+    PYCSDL2_EVENTCOLUMN_GETSET(12, "(readonly) Event codes."),
+    {NULL}
+};
+
+/** \brief Type definition of csdl2.SDL_EventColumns */
+static PyTypeObject PyCSDL2_EventColumnsType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_EventColumns",
+    /* tp_basicsize      */ sizeof(PyCSDL2_EventColumns),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_EventColumnsDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */
+    "SDL_EventColumns(capacity: int)\n"
+    "\n"
+    "Columns of up to `capacity` events, filled by SDL_PollEventColumns().\n",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_EventColumns, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ 0,
+    /* tp_getset         */ PyCSDL2_EventColumnsGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_EventColumnsNew
+};
+
+/**
+ * \brief Stores an event in row i of the columns.
+ *
+ * Columns which do not apply to the event type are set to 0.
+ */
+static void
+PyCSDL2_EventColumnsStore(PyCSDL2_EventColumns *self, Py_ssize_t i,
+                          const SDL_Event *ev)
+{
+    Uint32 window_id = 0, state = 0;
+    Sint32 x = 0, y = 0, xrel = 0, yrel = 0, key = 0, scancode = 0, code = 0;
+    Uint16 mod = 0;
+    Uint8 button = 0;
+
+    switch (ev->type) {
+    case SDL_WINDOWEVENT:
+        window_id = ev->window.windowID;
+        code = ev->window.event;
+        x = ev->window.data1;
+        y = ev->window.data2;
+        break;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        window_id = ev->key.windowID;
+        state = ev->key.state;
+        key = ev->key.keysym.sym;
+        scancode = ev->key.keysym.scancode;
+        mod = ev->key.keysym.mod;
+        break;
+    case SDL_TEXTEDITING:
+        window_id = ev->edit.windowID;
+        break;
+    case SDL_TEXTINPUT:
+        window_id = ev->text.windowID;
+        break;
+    case SDL_MOUSEMOTION:
+        window_id = ev->motion.windowID;
+        state = ev->motion.state;
+        x = ev->motion.x;
+        y = ev->motion.y;
+        xrel = ev->motion.xrel;
+        yrel = ev->motion.yrel;
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        window_id = ev->button.windowID;
+        state = ev->button.state;
+        button = ev->button.button;
+        x = ev->button.x;
+        y = ev->button.y;
+        break;
+    case SDL_MOUSEWHEEL:
+        window_id = ev->wheel.windowID;
+        xrel = ev->wheel.x;
+        yrel = ev->wheel.y;
+        break;
+    default:
+        if (ev->type >= SDL_USEREVENT && ev->type < SDL_LASTEVENT) {
+            window_id = ev->user.windowID;
+            code = ev->user.code;
+        }
+        break;
+    }
+
+    self->types[i] = ev->type;
+    self->timestamps[i] = ev->common.timestamp;
+    self->window_ids[i] = window_id;
+    self->x[i] = x;
+    self->y[i] = y;
+    self->xrel[i] = xrel;
+    self->yrel[i] = yrel;
+    self->keys[i] = key;
+    self->scancodes[i] = scancode;
+    self->mods[i] = mod;
+    self->buttons[i] = button;
+    self->states[i] = state;
+    self->codes[i] = code;
+}
+
+/** \brief Number of events moved out of the event queue at once */
+#define PYCSDL2_EVENTCOLUMNS_CHUNK 64
+
+/**
+ * \brief Implements csdl2.SDL_PollEventColumns()
+ *
+ * \code
+ * SDL_PollEventColumns(columns: SDL_EventColumns) -> int
+ * \endcode
+ *
+ * Pumps the event loop once and moves up to columns.capacity events from the
+ * front of the event queue into columns, replacing the events stored by the
+ * previous drain.
+ *
+ * \returns PyLong of the number of events stored, NULL if an exception
+ *          occurred.
+ */
+static PyObject *
+PyCSDL2_PollEventColumns(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_EventColumns *self;
+    SDL_Event events[PYCSDL2_EVENTCOLUMNS_CHUNK];
+    Py_ssize_t count = 0;
+    int i, len, ret;
+    static char *kwlist[] = {"columns", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_EventColumnsType, &self))
+        return NULL;
+
+    SDL_PumpEvents();
+
+    while (count < self->capacity) {
+        len = PYCSDL2_EVENTCOLUMNS_CHUNK;
+        if (len > self->capacity - count)
+            len = (int) (self->capacity - count);
+
+        ret = SDL_PeepEvents(events, len, SDL_GETEVENT, SDL_FIRSTEVENT,
+                             SDL_LASTEVENT);
+        if (ret < 0) {
+            self->count = count;
+            return PyCSDL2_RaiseSDLError();
+        }
+        PyCSDL2_EventRecord(events, ret);
+
+        for (i = 0; i < ret; i++)
+            PyCSDL2_EventColumnsStore(self, count + i, &events[i]);
+        count += ret;
+
+        if (ret < len)
+            break;
+    }
+
+    self->count = count;
+    return PyLong_FromSsize_t(count);
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_UserEventInjection User event injection
+ *
+ * \brief Batched pushing of user events from any thread.
+ *
+ * Python payloads are kept alive in PyCSDL2_UserEventPayloads, keyed by an
+ * integer handle which is stored in user.data1. user.data2 is set to
+ * PyCSDL2_UserEventTag to mark the events carrying such a handle.
+ *
+ * @{
+ */
+
+/** \brief Maximum number of events added to the queue at once */
+#define PYCSDL2_USEREVENT_CHUNK 64
+
+/** \brief dict mapping payload handles to the payload objects */
+static PyObject *PyCSDL2_UserEventPayloads;
+
+/** \brief Last payload handle given out */
+static size_t PyCSDL2_UserEventHandle;
+
+/** \brief Its address marks events whose user.data1 is a payload handle */
+static const char PyCSDL2_UserEventTag;
+
+/**
+ * \brief Adds user events to the back of the event queue.
+ *
+ * The events are added with SDL_PeepEvents() in chunks, which takes the
+ * event queue lock once per chunk and bypasses the event filter. Does not
+ * need the GIL, and may be called from any thread.
+ *
+ * \param type Event type, between SDL_USEREVENT and SDL_LASTEVENT.
+ * \param codes user.code of each event.
+ * \param data1 user.data1 of each event, or NULL for all NULL.
+ * \param data2 user.data2 of every event.
+ * \param n Number of events.
+ * \returns The number of events added, which is less than n if the queue is
+ *          full, or -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_PushUserEventsData(Uint32 type, const Sint32 *codes,
+                           void *const *data1, void *data2, int n)
+{
+    SDL_Event events[PYCSDL2_USEREVENT_CHUNK];
+    Uint32 now;
+    int i, len, ret = 0, pushed = 0;
+
+    if (type < SDL_USEREVENT || type >= SDL_LASTEVENT)
+        return SDL_SetError("Invalid user event type");
+
+    now = SDL_GetTicks();
+    SDL_zero(events);
+
+    while (pushed < n) {
+        len = n - pushed;
+        if (len > PYCSDL2_USEREVENT_CHUNK)
+            len = PYCSDL2_USEREVENT_CHUNK;
+
+        for (i = 0; i < len; i++) {
+            events[i].user.type = type;
+            events[i].user.timestamp = now;
+            events[i].user.code = codes[pushed + i];
+            events[i].user.data1 = data1 ? data1[pushed + i] : NULL;
+            events[i].user.data2 = data2;
+        }
+
+        ret = SDL_PeepEvents(events, len, SDL_ADDEVENT, 0, 0);
+        if (ret < 0)
+            break;
+        pushed += ret;
+        if (ret < len)
+            break;
+    }
+
+    if (pushed)
+        PyCSDL2_EventNotifierSignalAll();
+
+    return pushed ? pushed : ret;
+}
+
+/**
+ * \brief Adds user events with the given codes and data1 pointers.
+ *
+ * Exported through the C API for extensions which need to wake the main
+ * loop from their own threads. Does not need the GIL.
+ *
+ * \returns The number of events added, or -1 with the SDL error set.
+ */
+static int
+PyCSDL2_PushUserEvents(Uint32 type, const Sint32 *codes, void *const *data1,
+                       int n)
+{
+    return PyCSDL2_PushUserEventsData(type, codes, data1, NULL, n);
+}
+
+/**
+ * \brief Implements csdl2.SDL_PushUserEvents()
+ *
+ * \code
+ * SDL_PushUserEvents(type: int, codes, payloads=None) -> int
+ * \endcode
+ *
+ * The GIL is released while the events are added to the queue.
+ *
+ * \returns PyLong of the number of events added, NULL if an exception
+ *          occurred.
+ */
+static PyObject *
+PyCSDL2_PushUserEventsPy(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyObject *codes_obj, *payloads_obj = Py_None;
+    PyObject *codes_seq = NULL, *payloads_seq = NULL, *key;
+    PyObject *err_type, *err_value, *err_tb;
+    Sint32 *codes = NULL;
+    void **data1 = NULL;
+    Py_ssize_t n, i;
+    Uint32 type;
+    int ret = -1;
+    static char *kwlist[] = {"type", "codes", "payloads", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT "O|O", kwlist,
+                                     &type, &codes_obj, &payloads_obj))
+        return NULL;
+
+    if (!(codes_seq = PySequence_Fast(codes_obj, "codes must be a sequence")))
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(codes_seq);
+
+    if (n > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "too many events");
+        goto exit;
+    }
+
+    if (payloads_obj != Py_None) {
+        payloads_seq = PySequence_Fast(payloads_obj,
+                                       "payloads must be a sequence");
+        if (!payloads_seq)
+            goto exit;
+        if (PySequence_Fast_GET_SIZE(payloads_seq) != n) {
+            PyErr_SetString(PyExc_ValueError,
+                            "codes and payloads must have the same length");
+            goto exit;
+        }
+    }
+
+    codes = PyMem_New(Sint32, n ? n : 1);
+    if (!codes) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (PyCSDL2_LongAsSint32(PySequence_Fast_GET_ITEM(codes_seq, i),
+                                 &codes[i]))
+            goto exit;
+    }
+
+    if (payloads_seq) {
+        data1 = PyMem_New(void*, n ? n : 1);
+        if (!data1) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+
+        for (i = 0; i < n; i++) {
+            data1[i] = (void*) ++PyCSDL2_UserEventHandle;
+            key = PyLong_FromSize_t(PyCSDL2_UserEventHandle);
+            if (!key || PyDict_SetItem(PyCSDL2_UserEventPayloads, key,
+                                       PySequence_Fast_GET_ITEM(payloads_seq,
+                                                                i))) {
+                Py_XDECREF(key);
+                n = i;
+                goto unregister;
+            }
+            Py_DECREF(key);
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = PyCSDL2_PushUserEventsData(type, codes, data1,
+                                     data1 ? (void*) &PyCSDL2_UserEventTag :
+                                     NULL, (int) n);
+    Py_END_ALLOW_THREADS
+
+    if (ret < 0)
+        PyCSDL2_RaiseSDLError();
+
+unregister:
+    /* Payloads of the events which were not added are not needed */
+    PyErr_Fetch(&err_type, &err_value, &err_tb);
+    for (i = ret < 0 ? 0 : ret; data1 && i < n; i++) {
+        key = PyLong_FromSize_t((size_t) data1[i]);
+        if (!key || PyDict_DelItem(PyCSDL2_UserEventPayloads, key))
+            PyErr_Clear();
+        Py_XDECREF(key);
+    }
+    PyErr_Restore(err_type, err_value, err_tb);
+
+exit:
+    PyMem_Free(codes);
+    PyMem_Free(data1);
+    Py_XDECREF(payloads_seq);
+    Py_DECREF(codes_seq);
+    if (ret < 0 || PyErr_Occurred())
+        return NULL;
+    return PyLong_FromLong(ret);
+}
+
+/**
+ * \brief Takes the payload of a user event pushed by SDL_PushUserEvents().
+ *
+ * Clears user.data1 and user.data2 of the event so that the payload cannot
+ * be taken twice.
+ *
+ * \returns A new reference to the payload, or to Py_None if the event has no
+ *          payload. NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_TakeUserEventPayload(SDL_Event *ev)
+{
+    PyObject *key, *payload;
+
+    if (ev->type < SDL_USEREVENT || ev->type >= SDL_LASTEVENT ||
+        ev->user.data2 != (void*) &PyCSDL2_UserEventTag)
+        Py_RETURN_NONE;
+
+    if (!(key = PyLong_FromSize_t((size_t) ev->user.data1)))
+        return NULL;
+
+    payload = PyDict_GetItem(PyCSDL2_UserEventPayloads, key);
+    if (payload) {
+        Py_INCREF(payload);
+        if (PyDict_DelItem(PyCSDL2_UserEventPayloads, key)) {
+            Py_DECREF(payload);
+            Py_DECREF(key);
+            return NULL;
+        }
+    } else {
+        payload = Py_None;
+        Py_INCREF(payload);
+    }
+    Py_DECREF(key);
+
+    ev->user.data1 = NULL;
+    ev->user.data2 = NULL;
+    return payload;
+}
+
+/**
+ * \brief Implements csdl2.SDL_TakeUserEventPayloads()
+ *
+ * \code
+ * SDL_TakeUserEventPayloads(events, count=None) -> list
+ * \endcode
+ * where events is a writable buffer of SDL_Event structs.
+ */
+static PyObject *
+PyCSDL2_TakeUserEventPayloads(PyObject *module, PyObject *args,
+                              PyObject *kwds)
+{
+    PyObject *ev_obj, *count_obj = Py_None, *out = NULL, *payload;
+    Py_buffer ev_buf;
+    Py_ssize_t capacity, count, i;
+    static char *kwlist[] = {"events", "count", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &ev_obj,
+                                     &count_obj))
+        return NULL;
+
+    if (PyObject_GetBuffer(ev_obj, &ev_buf,
+                           PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE))
+        return NULL;
+
+    if (ev_buf.len % sizeof(SDL_Event)) {
+        PyErr_Format(PyExc_BufferError, "Invalid SDL_Event buffer size. "
+                     "Expected a multiple of %zu. Got: %zd.",
+                     sizeof(SDL_Event), ev_buf.len);
+        goto exit;
+    }
+    capacity = ev_buf.len / sizeof(SDL_Event);
+
+    if (count_obj == Py_None) {
+        count = capacity;
+    } else {
+        count = PyLong_AsSsize_t(count_obj);
+        if (count == -1 && PyErr_Occurred())
+            goto exit;
+        if (count < 0 || count > capacity) {
+            PyErr_SetString(PyExc_ValueError,
+                            "count must be between 0 and the number of "
+                            "events in the buffer");
+            goto exit;
+        }
+    }
+
+    if (!(out = PyList_New(count)))
+        goto exit;
+
+    for (i = 0; i < count; i++) {
+        payload = PyCSDL2_TakeUserEventPayload((SDL_Event*) ev_buf.buf + i);
+        if (!payload) {
+            Py_CLEAR(out);
+            goto exit;
+        }
+        PyList_SET_ITEM(out, i, payload);
+    }
+
+exit:
+    PyBuffer_Release(&ev_buf);
+    return out;
+}
+
+/** @} */
+
+/**
+ * \brief Implements csdl2.SDL_EventState()
+ *
+ * \code
+ * SDL_EventState(type: int, state: int) -> int
+ * \endcode
+ *
+ * Events of a disabled type are dropped by SDL before they are queued, so
+ * they never reach Python.
+ *
+ * \returns PyLong of the previous state, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_EventState(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint32 type;
+    int state;
+    static char *kwlist[] = {"type", "state", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT "i", kwlist,
+                                     &type, &state))
+        return NULL;
+    return PyLong_FromLong(SDL_EventState(type, state));
+}
+
+/**
+ * \defgroup csdl2_EventCoalescing Event coalescing
+ *
+ * \brief Native event filter merging consecutive motion and wheel events.
+ *
+ * When an event which can be coalesced is pushed, the filter walks the event
+ * queue with SDL_FilterEvents(), which holds the queue lock. If the last
+ * queued event is of the same type and from the same window and device, the
+ * incoming event is merged into it and dropped. Since a filter callback
+ * cannot see whether an entry is the last one, the pass merges into every
+ * matching entry tentatively and undoes the merge when it moves on to the
+ * next entry.
+ *
+ * @{
+ */
+
+/** \brief Configuration of the coalescing event filter */
+static struct PyCSDL2_EventCoalesceConfig {
+    /** \brief Coalesce SDL_MOUSEMOTION events */
+    SDL_bool motion;
+    /** \brief Coalesce SDL_MOUSEWHEEL events */
+    SDL_bool wheel;
+    /** \brief Event filter which was installed before ours, or NULL */
+    SDL_EventFilter next;
+    /** \brief userdata of next */
+    void *next_userdata;
+} PyCSDL2_EventCoalesceConfig;
+
+/** \brief State of a pass over the event queue */
+typedef struct PyCSDL2_EventCoalescePass {
+    /** \brief The event being pushed */
+    const SDL_Event *incoming;
+    /** \brief The queued event it was merged into, or NULL */
+    SDL_Event *merged;
+    /** \brief Copy of merged from before the merge */
+    SDL_Event saved;
+} PyCSDL2_EventCoalescePass;
+
+/** \brief Returns true if b can be merged into the queued event a */
+static int
+PyCSDL2_EventCanCoalesce(const SDL_Event *a, const SDL_Event *b)
+{
+    if (a->type != b->type)
+        return 0;
+
+    switch (b->type) {
+    case SDL_MOUSEMOTION:
+        return PyCSDL2_EventCoalesceConfig.motion &&
+               a->motion.windowID == b->motion.windowID &&
+               a->motion.which == b->motion.which;
+    case SDL_MOUSEWHEEL:
+        return PyCSDL2_EventCoalesceConfig.wheel &&
+               a->wheel.windowID == b->wheel.windowID &&
+               a->wheel.which == b->wheel.which;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * \brief Merges b into a.
+ *
+ * The merged event has the position, button state and timestamp of b, and
+ * the sum of the relative motion or scroll amounts.
+ */
+static void
+PyCSDL2_EventCoalesce(SDL_Event *a, const SDL_Event *b)
+{
+    a->common.timestamp = b->common.timestamp;
+
+    if (b->type == SDL_MOUSEMOTION) {
+        a->motion.state = b->motion.state;
+        a->motion.x = b->motion.x;
+        a->motion.y = b->motion.y;
+        a->motion.xrel += b->motion.xrel;
+        a->motion.yrel += b->motion.yrel;
+    } else {
+        a->wheel.x += b->wheel.x;
+        a->wheel.y += b->wheel.y;
+    }
+}
+
+/** \brief SDL_FilterEvents() callback for a pass over the event queue */
+static int SDLCALL
+PyCSDL2_EventCoalescePassFilter(void *userdata, SDL_Event *entry)
+{
+    PyCSDL2_EventCoalescePass *pass = userdata;
+
+    /* The entry we merged into was not the last one */
+    if (pass->merged) {
+        *pass->merged = pass->saved;
+        pass->merged = NULL;
+    }
+
+    if (PyCSDL2_EventCanCoalesce(entry, pass->incoming)) {
+        pass->saved = *entry;
+        PyCSDL2_EventCoalesce(entry, pass->incoming);
+        pass->merged = entry;
+    }
+
+    return 1;
+}
+
+/**
+ * \brief The coalescing event filter.
+ *
+ * \returns 0 if the event was merged into the last queued event or dropped
+ *          by the previous filter, 1 if it should be queued.
+ */
+static int SDLCALL
+PyCSDL2_EventCoalesceFilter(void *userdata, SDL_Event *event)
+{
+    PyCSDL2_EventCoalescePass pass;
+    SDL_EventFilter next = PyCSDL2_EventCoalesceConfig.next;
+
+    if (next && !next(PyCSDL2_EventCoalesceConfig.next_userdata, event))
+        return 0;
+
+    if (!(event->type == SDL_MOUSEMOTION &&
+          PyCSDL2_EventCoalesceConfig.motion) &&
+        !(event->type == SDL_MOUSEWHEEL && PyCSDL2_EventCoalesceConfig.wheel))
+        return 1;
+
+    pass.incoming = event;
+    pass.merged = NULL;
+    SDL_FilterEvents(PyCSDL2_EventCoalescePassFilter, &pass);
+
+    return pass.merged == NULL;
+}
+
+/**
+ * \brief Implements csdl2.SDL_EventCoalescing()
+ *
+ * \code
+ * SDL_EventCoalescing(type: int, state: int) -> int
+ * \endcode
+ * where type is SDL_MOUSEMOTION or SDL_MOUSEWHEEL and state is SDL_ENABLE,
+ * SDL_DISABLE or SDL_QUERY.
+ *
+ * Enabling coalescing installs the filter with SDL_SetEventFilter() if it is
+ * not installed yet. The filter is removed by SDL_Quit(), which also resets
+ * the configuration.
+ *
+ * \returns PyLong of the previous state, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_EventCoalescing(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    Uint32 type;
+    int state, installed;
+    SDL_bool *flag;
+    SDL_EventFilter filter = NULL;
+    void *filter_userdata = NULL;
+    Uint8 prev;
+    static char *kwlist[] = {"type", "state", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, Uint32_UNIT "i", kwlist,
+                                     &type, &state))
+        return NULL;
+
+    if (type == SDL_MOUSEMOTION) {
+        flag = &PyCSDL2_EventCoalesceConfig.motion;
+    } else if (type == SDL_MOUSEWHEEL) {
+        flag = &PyCSDL2_EventCoalesceConfig.wheel;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "only SDL_MOUSEMOTION and "
+                        "SDL_MOUSEWHEEL events can be coalesced");
+        return NULL;
+    }
+
+    if (state != SDL_QUERY && state != SDL_ENABLE && state != SDL_DISABLE) {
+        PyErr_SetString(PyExc_ValueError, "invalid state");
+        return NULL;
+    }
+
+    SDL_GetEventFilter(&filter, &filter_userdata);
+    installed = filter == PyCSDL2_EventCoalesceFilter;
+    if (!installed) {
+        PyCSDL2_EventCoalesceConfig.motion = SDL_FALSE;
+        PyCSDL2_EventCoalesceConfig.wheel = SDL_FALSE;
+    }
+
+    prev = *flag ? SDL_ENABLE : SDL_DISABLE;
+
+    if (state == SDL_ENABLE) {
+        if (!installed) {
+            PyCSDL2_EventCoalesceConfig.next = filter;
+            PyCSDL2_EventCoalesceConfig.next_userdata = filter_userdata;
+            SDL_SetEventFilter(PyCSDL2_EventCoalesceFilter, NULL);
+        }
+        *flag = SDL_TRUE;
+    } else if (state == SDL_DISABLE) {
+        *flag = SDL_FALSE;
+    }
+
+    return PyLong_FromLong(prev);
+}
+
+/** @} */
+
+/** \brief A field of SDL_EVENT_DTYPE */
+typedef struct PyCSDL2_EventField {
+    /** \brief Field name */
+    const char *name;
+    /** \brief NumPy type string of the field, in native byte order */
+    const char *format;
+    /** \brief Offset of the field in SDL_Event */
+    size_t offset;
+} PyCSDL2_EventField;
+
+SDL_COMPILE_TIME_ASSERT(SDL_Scancode, sizeof(SDL_Scancode) == 4);
+SDL_COMPILE_TIME_ASSERT(SDL_Keycode, sizeof(SDL_Keycode) == 4);
+
+/**
+ * \brief Fields of SDL_EVENT_DTYPE.
+ *
+ * Fields of the different event structures overlap, as they do in the
+ * SDL_Event union. They are prefixed with the name of the SDL_Event member
+ * which holds them, except for the header fields shared by most events.
+ */
+static const PyCSDL2_EventField PyCSDL2_EventFields[] = {
+    {"type", "u4", offsetof(SDL_Event, type)},
+    {"timestamp", "u4", offsetof(SDL_CommonEvent, timestamp)},
+    {"windowID", "u4", offsetof(SDL_WindowEvent, windowID)},
+    {"window_event", "u1", offsetof(SDL_WindowEvent, event)},
+    {"window_data1", "i4", offsetof(SDL_WindowEvent, data1)},
+    {"window_data2", "i4", offsetof(SDL_WindowEvent, data2)},
+    {"key_state", "u1", offsetof(SDL_KeyboardEvent, state)},
+    {"key_repeat", "u1", offsetof(SDL_KeyboardEvent, repeat)},
+    {"key_scancode", "i4",
+     offsetof(SDL_KeyboardEvent, keysym) + offsetof(SDL_Keysym, scancode)},
+    {"key_sym", "i4",
+     offsetof(SDL_KeyboardEvent, keysym) + offsetof(SDL_Keysym, sym)},
+    {"key_mod", "u2",
+     offsetof(SDL_KeyboardEvent, keysym) + offsetof(SDL_Keysym, mod)},
+    {"motion_which", "u4", offsetof(SDL_MouseMotionEvent, which)},
+    {"motion_state", "u4", offsetof(SDL_MouseMotionEvent, state)},
+    {"motion_x", "i4", offsetof(SDL_MouseMotionEvent, x)},
+    {"motion_y", "i4", offsetof(SDL_MouseMotionEvent, y)},
+    {"motion_xrel", "i4", offsetof(SDL_MouseMotionEvent, xrel)},
+    {"motion_yrel", "i4", offsetof(SDL_MouseMotionEvent, yrel)},
+    {"button_which", "u4", offsetof(SDL_MouseButtonEvent, which)},
+    {"button_button", "u1", offsetof(SDL_MouseButtonEvent, button)},
+    {"button_state", "u1", offsetof(SDL_MouseButtonEvent, state)},
+    {"button_x", "i4", offsetof(SDL_MouseButtonEvent, x)},
+    {"button_y", "i4", offsetof(SDL_MouseButtonEvent, y)},
+    {"wheel_which", "u4", offsetof(SDL_MouseWheelEvent, which)},
+    {"wheel_x", "i4", offsetof(SDL_MouseWheelEvent, x)},
+    {"wheel_y", "i4", offsetof(SDL_MouseWheelEvent, y)},
+    {"tfinger_touchId", "i8", offsetof(SDL_TouchFingerEvent, touchId)},
+    {"tfinger_fingerId", "i8", offsetof(SDL_TouchFingerEvent, fingerId)},
+    {"tfinger_x", "f4", offsetof(SDL_TouchFingerEvent, x)},
+    {"tfinger_y", "f4", offsetof(SDL_TouchFingerEvent, y)},
+    {"tfinger_dx", "f4", offsetof(SDL_TouchFingerEvent, dx)},
+    {"tfinger_dy", "f4", offsetof(SDL_TouchFingerEvent, dy)},
+    {"tfinger_pressure", "f4", offsetof(SDL_TouchFingerEvent, pressure)},
+    {"user_code", "i4", offsetof(SDL_UserEvent, code)},
+    {NULL}
+};
+
+/**
+ * \brief Creates the SDL_EVENT_DTYPE dict.
+ *
+ * The dict is in the form accepted by numpy.dtype(), with the keys "names",
+ * "formats", "offsets" and "itemsize", so that csdl2 does not need to depend
+ * on NumPy.
+ *
+ * \returns A new dict, or NULL with an exception set on failure.
+ */
+static PyObject *
+PyCSDL2_EventDTypeCreate(void)
+{
+    const PyCSDL2_EventField *f;
+    PyObject *names = NULL, *formats = NULL, *offsets = NULL, *out = NULL;
+    Py_ssize_t i, n = 0;
+
+    for (f = PyCSDL2_EventFields; f->name; f++)
+        n++;
+
+    if (!(names = PyList_New(n)) || !(formats = PyList_New(n)) ||
+        !(offsets = PyList_New(n)))
+        goto fail;
+
+    for (i = 0; i < n; i++) {
+        PyObject *x;
+
+        f = &PyCSDL2_EventFields[i];
+        if (!(x = PyUnicode_FromString(f->name)))
+            goto fail;
+        PyList_SET_ITEM(names, i, x);
+        if (!(x = PyUnicode_FromString(f->format)))
+            goto fail;
+        PyList_SET_ITEM(formats, i, x);
+        if (!(x = PyLong_FromSize_t(f->offset)))
+            goto fail;
+        PyList_SET_ITEM(offsets, i, x);
+    }
+
+    out = Py_BuildValue("{sOsOsOsn}", "names", names, "formats", formats,
+                        "offsets", offsets, "itemsize",
+                        (Py_ssize_t) sizeof(SDL_Event));
+
+fail:
+    Py_XDECREF(names);
+    Py_XDECREF(formats);
+    Py_XDECREF(offsets);
+    return out;
+}
+
+/**
+ * \brief Initializes bindings to SDL_events.h
+ *
+ * \param module csdl2 module PyObject
+ * \returns 1 on success, 0 if an exception occurred.
+ */
+static int
+PyCSDL2_initevents(PyObject *module)
 {
+    PyObject *dtype;
+    size_t i;
     static const PyCSDL2_Constant constants[] = {
         {"SDL_RELEASED", SDL_RELEASED},
         {"SDL_PRESSED", SDL_PRESSED},
@@ -955,12 +3972,38 @@ PyCSDL2_initevents(PyObject *module)
 
     if (PyType_Ready(&PyCSDL2_EventMemType)) { return 0; }
 
-    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_MouseMotionEventType) < 0)
+    for (i = 0; i < PYCSDL2_EVENT_NUMVIEWS; i++) {
+        if (PyCSDL2_PyModuleAddType(module, PyCSDL2_EventMemberTypes[i]) < 0)
+            return 0;
+    }
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_KeysymType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_EventColumnsType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_EventNotifierType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_EventReplayType) < 0)
+        return 0;
+
+    if (!PyCSDL2_UserEventPayloads &&
+        !(PyCSDL2_UserEventPayloads = PyDict_New()))
         return 0;
 
     if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_EventType) < 0)
         return 0;
 
+    if (!(dtype = PyCSDL2_EventDTypeCreate()))
+        return 0;
+
+    if (PyModule_AddObject(module, "SDL_EVENT_DTYPE", dtype)) {
+        Py_DECREF(dtype);
+        return 0;
+    }
+
     return 1;
 }
 
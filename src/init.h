@@ -32,6 +32,7 @@
 #include "../include/pycsdl2.h"
 #include "util.h"
 #include "error.h"
+#include "events.h"
 
 /**
  * \brief Implements csdl2.SDL_Init()
@@ -94,6 +95,8 @@ PyCSDL2_QuitSubSystem(PyObject *module, PyObject *args, PyObject *kwds)
         return NULL;
 
     SDL_QuitSubSystem(flags);
+    if (!SDL_WasInit(SDL_INIT_EVENTS))
+        PyCSDL2_EventNotifierQuit();
 
     Py_RETURN_NONE;
 }
@@ -133,6 +136,7 @@ PyCSDL2_Quit(PyObject *module, PyObject *args, PyObject *kwds)
         return NULL;
 
     SDL_Quit();
+    PyCSDL2_EventNotifierQuit();
 
     Py_RETURN_NONE;
 }
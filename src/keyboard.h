@@ -0,0 +1,92 @@
+/*
+ * pycsdl2
+ * Copyright (c) 2015 Paul Tan <pyokagan@pyokagan.name>
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must
+ *        not claim that you wrote the original software. If you use this
+ *        software in a product, an acknowledgment in the product
+ *        documentation would be appreciated but is not required.
+ *     2. Altered source versions must be plainly marked as such, and must
+ *        not be misrepresented as being the original software.
+ *     3. This notice may not be removed or altered from any source
+ *        distribution.
+ */
+/**
+ * \file keyboard.h
+ * \brief Bindings for SDL_keyboard.h
+ */
+#ifndef _PYCSDL2_KEYBOARD_H_
+#define _PYCSDL2_KEYBOARD_H_
+#include <Python.h>
+#include <SDL_keyboard.h>
+#include "../include/pycsdl2.h"
+#include "util.h"
+
+/**
+ * \brief Read-only buffer over SDL's keyboard state array.
+ *
+ * The array is owned by SDL and lives for the lifetime of the application,
+ * so the buffer is created once and shared by all callers.
+ */
+static PyCSDL2_Buffer *PyCSDL2_KeyboardState;
+
+/**
+ * \brief Implements csdl2.SDL_GetKeyboardState()
+ *
+ * \code{.py}
+ * SDL_GetKeyboardState() -> buffer
+ * \endcode
+ *
+ * \returns A new reference to a read-only buffer of Uint8 key states indexed
+ *          by scancode, which is updated in place by SDL_PumpEvents().
+ */
+static PyObject *
+PyCSDL2_GetKeyboardState(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    const Uint8 *state;
+    int numkeys;
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    if (!PyCSDL2_KeyboardState) {
+        state = SDL_GetKeyboardState(&numkeys);
+        PyCSDL2_KeyboardState = PyCSDL2_BufferCreate(CTYPE_UCHAR,
+                                                     (void*) state,
+                                                     numkeys, 1, NULL);
+        if (!PyCSDL2_KeyboardState)
+            return NULL;
+    }
+
+    Py_INCREF(PyCSDL2_KeyboardState);
+    return (PyObject*) PyCSDL2_KeyboardState;
+}
+
+/**
+ * \brief Implements csdl2.SDL_GetModState()
+ *
+ * \code{.py}
+ * SDL_GetModState() -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_GetModState(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    return PyLong_FromUnsignedLong(SDL_GetModState());
+}
+
+#endif /* _PYCSDL2_KEYBOARD_H_ */
@@ -31,7 +31,9 @@
 #include "error.h"
 #include "events.h"
 #include "init.h"
+#include "keyboard.h"
 #include "keycode.h"
+#include "mouse.h"
 #include "pixels.h"
 #include "rect.h"
 #include "render.h"
@@ -281,6 +283,119 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "sound.\n"
     },
 
+    {"SDL_AudioRingBufferWrite",
+     (PyCFunction) PyCSDL2_AudioRingBufferWrite,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioRingBufferWrite(ring: SDL_AudioRingBuffer, data: buffer)\n"
+     "    -> int\n"
+     "\n"
+     "Queues audio data into the ring buffer, to be played by the audio\n"
+     "device it is attached to. Returns the number of bytes written, which\n"
+     "is less than the length of `data` if the ring buffer is full.\n"
+    },
+
+    {"SDL_AudioRingBufferPeek",
+     (PyCFunction) PyCSDL2_AudioRingBufferPeek,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioRingBufferPeek(ring: SDL_AudioRingBuffer)\n"
+     "    -> (memoryview, memoryview)\n"
+     "\n"
+     "Returns the queued audio data as two read-only memoryviews into the\n"
+     "ring buffer, without copying. The second one is non-empty if the\n"
+     "data wraps around the end of the ring buffer. The views are\n"
+     "released by the next call to SDL_AudioRingBufferConsume().\n"
+    },
+
+    {"SDL_AudioRingBufferConsume",
+     (PyCFunction) PyCSDL2_AudioRingBufferConsume,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioRingBufferConsume(ring: SDL_AudioRingBuffer, len: int)\n"
+     "    -> None\n"
+     "\n"
+     "Removes `len` bytes from the front of the ring buffer, making room\n"
+     "for more captured audio data. Releases the memoryviews returned by\n"
+     "SDL_AudioRingBufferPeek() first, and raises BufferError if their data\n"
+     "is still exported by other objects.\n"
+    },
+
+    {"SDL_AudioMixerPlay",
+     (PyCFunction) PyCSDL2_AudioMixerPlay,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioMixerPlay(mixer: SDL_AudioMixer, voice: int, data: buffer,\n"
+     "                   channels: int = 0, gain: float = 1.0,\n"
+     "                   pan: float = 0.0, loop: bool = False,\n"
+     "                   loop_start: int = 0, loop_end: int = 0) -> None\n"
+     "\n"
+     "Starts playing `data` on the voice, replacing whatever it was\n"
+     "playing. `data` must be in the format of the mixer, with `channels`\n"
+     "channels (0 means the number of channels of the mixer). If `loop` is\n"
+     "True, playback jumps back to the frame `loop_start` when reaching the\n"
+     "frame `loop_end` (0 means the end of `data`).\n"
+    },
+
+    {"SDL_AudioMixerStop",
+     (PyCFunction) PyCSDL2_AudioMixerStop,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioMixerStop(mixer: SDL_AudioMixer, voice: int) -> None\n"
+     "\n"
+     "Stops playback of the voice.\n"
+    },
+
+    {"SDL_AudioMixerSetParams",
+     (PyCFunction) PyCSDL2_AudioMixerSetParams,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioMixerSetParams(mixer: SDL_AudioMixer, voice: int,\n"
+     "                        gain: float = 1.0, pan: float = 0.0) -> None\n"
+     "\n"
+     "Sets the gain and pan (-1.0 is left, 1.0 is right) of the voice.\n"
+    },
+
+    {"SDL_AudioMixerIsPlaying",
+     (PyCFunction) PyCSDL2_AudioMixerIsPlaying,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioMixerIsPlaying(mixer: SDL_AudioMixer, voice: int) -> bool\n"
+     "\n"
+     "Returns True if the voice is playing. Commands which have not been\n"
+     "processed by the audio thread yet are not taken into account.\n"
+    },
+
+    {"SDL_AudioMixerMix",
+     (PyCFunction) PyCSDL2_AudioMixerMix,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioMixerMix(mixer: SDL_AudioMixer, stream: buffer) -> None\n"
+     "\n"
+     "Renders the output of a mixer that is not attached to an audio\n"
+     "device into `stream`.\n"
+    },
+
+    {"SDL_AudioResamplerProcess",
+     (PyCFunction) PyCSDL2_AudioResamplerProcess,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioResamplerProcess(resampler: SDL_AudioResampler,\n"
+     "                          data: buffer) -> bytes\n"
+     "\n"
+     "Resamples `data`, which must contain whole sample frames in the\n"
+     "format of the resampler. Returns as many output frames as the input\n"
+     "so far allows; the rest is produced by later calls.\n"
+    },
+
+    {"SDL_AudioResamplerFlush",
+     (PyCFunction) PyCSDL2_AudioResamplerFlush,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioResamplerFlush(resampler: SDL_AudioResampler) -> bytes\n"
+     "\n"
+     "Returns the remaining output frames of the stream, and resets the\n"
+     "resampler for a new stream.\n"
+    },
+
+    {"SDL_AudioResamplerReset",
+     (PyCFunction) PyCSDL2_AudioResamplerReset,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_AudioResamplerReset(resampler: SDL_AudioResampler) -> None\n"
+     "\n"
+     "Discards the state of the resampler, to start a new stream.\n"
+    },
+
     {"SDL_GetAudioStatus",
      (PyCFunction) PyCSDL2_GetAudioStatus,
      METH_VARARGS | METH_KEYWORDS,
@@ -299,6 +414,23 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "one of SDL_AUDIO_STOPPED, SDL_AUDIO_PLAYING or SDL_AUDIO_PAUSED.\n"
     },
 
+    {"SDL_GetAudioDeviceStats",
+     (PyCFunction) PyCSDL2_GetAudioDeviceStats,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetAudioDeviceStats(dev: SDL_AudioDevice) -> dict\n"
+     "\n"
+     "Returns timing statistics of the audio callback of `dev`.\n"
+     "Durations are in microseconds.\n"
+    },
+
+    {"SDL_ResetAudioDeviceStats",
+     (PyCFunction) PyCSDL2_ResetAudioDeviceStats,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_ResetAudioDeviceStats(dev: SDL_AudioDevice) -> None\n"
+     "\n"
+     "Clears the timing statistics of `dev`.\n"
+    },
+
     {"SDL_PauseAudio",
      (PyCFunction) PyCSDL2_PauseAudio,
      METH_VARARGS | METH_KEYWORDS,
@@ -361,6 +493,38 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "by SDL_LoadWAV() or SDL_LoadWAV_RW() will automatically call this\n"
      "function as part of its destructor.\n"
     },
+    {"SDL_LoadWAVCached",
+     (PyCFunction) PyCSDL2_LoadWAVCached,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_LoadWAVCached(src, spec, cache, key=None)\n"
+     "    -> (SDL_AudioSpec, SDL_WAVCacheBuf, int)\n"
+     "\n"
+     "Loads a WAVE file and converts it to the format, channels and freq of\n"
+     "spec, caching the converted audio data in the file cache. If the cache\n"
+     "file already holds the converted data of the same source, it is mapped\n"
+     "into memory instead, without reading the source. src is either a file\n"
+     "path, identified by its path, size and modification time, or a\n"
+     "SDL_RWops, identified by key. key may also be given for a file path.\n"
+    },
+
+    {"SDL_WAVStreamRead",
+     (PyCFunction) PyCSDL2_WAVStreamRead,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_WAVStreamRead(stream: SDL_WAVStream, buffer: buffer,\n"
+     "                  frames: int) -> int\n"
+     "\n"
+     "Reads up to `frames` sample frames from the stream into `buffer`.\n"
+     "Returns the number of frames read, which is 0 at the end of the data.\n"
+    },
+
+    {"SDL_WAVStreamSeek",
+     (PyCFunction) PyCSDL2_WAVStreamSeek,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_WAVStreamSeek(stream: SDL_WAVStream, frame: int) -> None\n"
+     "\n"
+     "Moves the stream so that the next read starts at sample frame\n"
+     "`frame`.\n"
+    },
 
     {"SDL_BuildAudioCVT",
      (PyCFunction) PyCSDL2_BuildAudioCVT,
@@ -615,6 +779,81 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "Returns True if there are events in the queue, False otherwise.\n"
     },
 
+    {"SDL_PollEvents",
+     (PyCFunction) PyCSDL2_PollEvents,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_PollEvents(events, max=None) -> int\n"
+     "\n"
+     "Pumps the event loop, then removes up to `max` events from the front\n"
+     "of the event queue and stores them in `events`, a writable buffer\n"
+     "holding an array of SDL_Event structs. If `max` is None, it is the\n"
+     "number of SDL_Event structs which fit in `events`.\n"
+     "\n"
+     "Returns the number of events stored.\n"
+     "\n"
+     "A NumPy array for `events` can be created with\n"
+     "numpy.zeros(n, dtype=SDL_EVENT_DTYPE).\n"
+    },
+
+    {"SDL_PollEventColumns",
+     (PyCFunction) PyCSDL2_PollEventColumns,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_PollEventColumns(columns) -> int\n"
+     "\n"
+     "Pumps the event loop, then removes up to `columns.capacity` events\n"
+     "from the front of the event queue and stores their fields in the\n"
+     "columns of `columns`, an SDL_EventColumns.\n"
+     "\n"
+     "Returns the number of events stored.\n"
+    },
+
+    {"SDL_EventNotifierClear",
+     (PyCFunction) PyCSDL2_EventNotifierClearPy,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_EventNotifierClear(notifier) -> None\n"
+     "\n"
+     "Makes the fd of the SDL_EventNotifier `notifier` unreadable until\n"
+     "more events are queued. Clear the notifier before draining the\n"
+     "event queue, so that no events added by csdl2 are missed.\n"
+    },
+
+    {"SDL_EventNotifierClose",
+     (PyCFunction) PyCSDL2_EventNotifierClosePy,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_EventNotifierClose(notifier) -> None\n"
+     "\n"
+     "Stops watching for events and closes the fd of the SDL_EventNotifier\n"
+     "`notifier`. Does nothing if it is already closed.\n"
+    },
+
+    {"SDL_WaitEvent",
+     (PyCFunction) PyCSDL2_WaitEvent,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_WaitEvent(event) -> None\n"
+     "\n"
+     "Waits indefinitely for the next available event.\n"
+     "\n"
+     "If `event` is not None, the next event is removed from the queue and\n"
+     "stored in `event`.\n"
+     "\n"
+     "Other Python threads can run while this function waits.\n"
+    },
+
+    {"SDL_WaitEventTimeout",
+     (PyCFunction) PyCSDL2_WaitEventTimeout,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_WaitEventTimeout(event, timeout: int) -> bool\n"
+     "\n"
+     "Waits until the specified timeout (in milliseconds) for the next\n"
+     "available event.\n"
+     "\n"
+     "If `event` is not None, the next event is removed from the queue and\n"
+     "stored in `event`.\n"
+     "\n"
+     "Returns True if an event is available, False if the timeout elapsed\n"
+     "first. Other Python threads can run while this function waits.\n"
+    },
+
     {"SDL_PushEvent",
      (PyCFunction) PyCSDL2_PushEvent,
      METH_VARARGS | METH_KEYWORDS,
@@ -628,6 +867,97 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "other code that also wants its own custom event types.\n"
     },
 
+    {"SDL_PushUserEvents",
+     (PyCFunction) PyCSDL2_PushUserEventsPy,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_PushUserEvents(type: int, codes, payloads=None) -> int\n"
+     "\n"
+     "Adds a user event of `type` for each int in `codes` to the back of\n"
+     "the event queue. If `payloads` is not None, it must have the same\n"
+     "length as `codes`, and each event carries the corresponding object,\n"
+     "which can be retrieved with SDL_TakeUserEventPayloads().\n"
+     "\n"
+     "The GIL is released while the events are added. Returns the number\n"
+     "of events added, which is less than len(codes) if the queue is full.\n"
+    },
+
+    {"SDL_TakeUserEventPayloads",
+     (PyCFunction) PyCSDL2_TakeUserEventPayloads,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_TakeUserEventPayloads(events, count=None) -> list\n"
+     "\n"
+     "Returns the payloads of the first `count` events in `events`, a\n"
+     "writable buffer of SDL_Event structs, removing them from the events.\n"
+     "Events without a payload give None.\n"
+    },
+
+    {"SDL_GetEventPoolStats",
+     (PyCFunction) PyCSDL2_GetEventPoolStats,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetEventPoolStats() -> dict\n"
+     "\n"
+     "Returns statistics of the free list of SDL_Event objects: the number\n"
+     "of events created from it (hits) and allocated because it was empty\n"
+     "(misses), and the number of free events and its capacity.\n"
+    },
+
+    {"SDL_StartEventRecording",
+     (PyCFunction) PyCSDL2_StartEventRecording,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_StartEventRecording(file: str) -> None\n"
+     "\n"
+     "Starts recording every event dequeued by SDL_PollEvent(),\n"
+     "SDL_PollEvents(), SDL_WaitEvent(), SDL_WaitEventTimeout() and\n"
+     "SDL_PeepEvents() into a binary event log at `file`.\n"
+    },
+
+    {"SDL_StopEventRecording",
+     (PyCFunction) PyCSDL2_StopEventRecording,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_StopEventRecording() -> int\n"
+     "\n"
+     "Stops recording events and closes the event log. Returns the number\n"
+     "of events recorded.\n"
+    },
+
+    {"SDL_EventReplayPump",
+     (PyCFunction) PyCSDL2_EventReplayPump,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_EventReplayPump(replay: SDL_EventReplay, time=None) -> int\n"
+     "\n"
+     "Adds the events of `replay` recorded up to `time`, in seconds since\n"
+     "the start of the recording, to the event queue. If `time` is None,\n"
+     "the time elapsed since the first such call is used.\n"
+     "\n"
+     "Returns the number of events added.\n"
+    },
+
+    {"SDL_EventState",
+     (PyCFunction) PyCSDL2_EventState,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_EventState(type: int, state: int) -> int\n"
+     "\n"
+     "Sets the state of processing events of `type`. If `state` is\n"
+     "SDL_DISABLE or SDL_IGNORE, events of that type are dropped before\n"
+     "they are added to the event queue. If `state` is SDL_ENABLE, they are\n"
+     "processed normally. If `state` is SDL_QUERY, the state is unchanged.\n"
+     "\n"
+     "Returns the previous state, SDL_DISABLE or SDL_ENABLE.\n"
+    },
+
+    {"SDL_EventCoalescing",
+     (PyCFunction) PyCSDL2_EventCoalescing,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_EventCoalescing(type: int, state: int) -> int\n"
+     "\n"
+     "Sets whether consecutive events of `type`, which must be\n"
+     "SDL_MOUSEMOTION or SDL_MOUSEWHEEL, are merged as they are pushed\n"
+     "into the event queue. `state` is SDL_ENABLE, SDL_DISABLE or\n"
+     "SDL_QUERY.\n"
+     "\n"
+     "Returns the previous state, SDL_DISABLE or SDL_ENABLE.\n"
+    },
+
     /* init.h */
 
     {"SDL_Init",
@@ -731,6 +1061,29 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "exit conditions.\n"
     },
 
+    /* keyboard.h */
+
+    {"SDL_GetKeyboardState",
+     (PyCFunction) PyCSDL2_GetKeyboardState,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetKeyboardState() -> buffer\n"
+     "\n"
+     "Returns a read-only buffer of the state of each key, indexed by\n"
+     "scancode. 1 means the key is pressed and 0 means it is not.\n"
+     "\n"
+     "The buffer views SDL's internal array, so it does not need to be\n"
+     "fetched again: it is updated in place when events are pumped.\n"
+    },
+
+    {"SDL_GetModState",
+     (PyCFunction) PyCSDL2_GetModState,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetModState() -> int\n"
+     "\n"
+     "Returns the current key modifier state as a bitmask of KMOD_*\n"
+     "constants.\n"
+    },
+
     /* keycode.h */
 
     {"SDL_SCANCODE_TO_KEYCODE",
@@ -739,6 +1092,27 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "SDL_SCANCODE_TO_KEYCODE(scancode: int) -> int\n"
     },
 
+    /* mouse.h */
+
+    {"SDL_GetMouseState",
+     (PyCFunction) PyCSDL2_GetMouseState,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetMouseState() -> (int, int, int)\n"
+     "\n"
+     "Returns a (buttons, x, y) tuple of the mouse button bitmask and the\n"
+     "mouse position relative to the focus window.\n"
+    },
+
+    {"SDL_GetInputSnapshot",
+     (PyCFunction) PyCSDL2_GetInputSnapshot,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_GetInputSnapshot(snapshot=None) -> SDL_InputSnapshot\n"
+     "\n"
+     "Stores the mouse position, mouse buttons and key modifiers in\n"
+     "`snapshot`, creating a new SDL_InputSnapshot if it is None, and\n"
+     "returns it.\n"
+    },
+
     /* pixels.h */
 
     {"SDL_AllocFormat",
@@ -1332,6 +1706,35 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "    The texture will be stretched to fill the given rectangle.\n"
     },
 
+    {"SDL_RenderCopyBatch",
+     (PyCFunction) PyCSDL2_RenderCopyBatch,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderCopyBatch(renderer: SDL_Renderer, texture: SDL_Texture,\n"
+     "                    srcrects: buffer, dstrects: buffer, count: int)\n"
+     "    -> None\n"
+     "\n"
+     "Copies `count` portions of the texture to the current rendering\n"
+     "target, as if by calling SDL_RenderCopy() for each of them in order.\n"
+     "\n"
+     "renderer\n"
+     "    The rendering context.\n"
+     "\n"
+     "texture\n"
+     "    The source texture.\n"
+     "\n"
+     "srcrects\n"
+     "    An array of SDL_Rects with the source rectangles, or None to copy\n"
+     "    the entire texture each time. A rectangle with zero width and\n"
+     "    height also stands for the entire texture. If `dstrects` is None,\n"
+     "    an array of interleaved source and destination rectangles.\n"
+     "\n"
+     "dstrects\n"
+     "    An array of SDL_Rects with the destination rectangles, or None.\n"
+     "\n"
+     "count\n"
+     "    The number of copies.\n"
+    },
+
     {"SDL_RenderCopyEx",
      (PyCFunction) PyCSDL2_RenderCopyEx,
      METH_VARARGS | METH_KEYWORDS,
@@ -1370,6 +1773,38 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "    SDL_FLIP_VERTICAL OR'd together.\n"
     },
 
+    {"SDL_RenderCopyExBatch",
+     (PyCFunction) PyCSDL2_RenderCopyExBatch,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderCopyExBatch(renderer: SDL_Renderer, texture: SDL_Texture,\n"
+     "                      srcrects: buffer, dstrects: buffer,\n"
+     "                      angles: buffer, centers: buffer, flips: buffer,\n"
+     "                      count: int) -> None\n"
+     "\n"
+     "Copies `count` portions of the texture to the current rendering\n"
+     "target, as if by calling SDL_RenderCopyEx() for each of them in\n"
+     "order.\n"
+     "\n"
+     "srcrects, dstrects\n"
+     "    The source and destination rectangles, as for\n"
+     "    SDL_RenderCopyBatch().\n"
+     "\n"
+     "angles\n"
+     "    An array of floats or doubles with the angles in degrees, or None\n"
+     "    for no rotation.\n"
+     "\n"
+     "centers\n"
+     "    An array of SDL_Points to rotate around, or None to rotate around\n"
+     "    the centers of the destination rectangles.\n"
+     "\n"
+     "flips\n"
+     "    An array of bytes with the SDL_FLIP_* flags, or None for no\n"
+     "    flipping.\n"
+     "\n"
+     "count\n"
+     "    The number of copies.\n"
+    },
+
     {"SDL_RenderReadPixels",
      (PyCFunction) PyCSDL2_RenderReadPixels,
      METH_VARARGS | METH_KEYWORDS,
@@ -1448,6 +1883,163 @@ static PyMethodDef PyCSDL2_Methods[] = {
      "Unbind a texture from the current OpenGL/ES/ES2 context.\n"
     },
 
+    {"SDL_RenderListSetRenderDrawColor",
+     (PyCFunction) PyCSDL2_RenderListSetRenderDrawColor,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListSetRenderDrawColor(list: SDL_RenderList, r: int, g: int,\n"
+     "                                 b: int, a: int, index=None) -> int\n"
+     "\n"
+     "Records a SDL_SetRenderDrawColor() call into `list`, or overwrites\n"
+     "entry `index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListSetRenderDrawBlendMode",
+     (PyCFunction) PyCSDL2_RenderListSetRenderDrawBlendMode,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListSetRenderDrawBlendMode(list: SDL_RenderList,\n"
+     "                                     blendMode: int, index=None)\n"
+     "    -> int\n"
+     "\n"
+     "Records a SDL_SetRenderDrawBlendMode() call into `list`, or overwrites\n"
+     "entry `index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListRenderClear",
+     (PyCFunction) PyCSDL2_RenderListRenderClear,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderClear(list: SDL_RenderList, index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderClear() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListRenderDrawPoints",
+     (PyCFunction) PyCSDL2_RenderListRenderDrawPoints,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderDrawPoints(list: SDL_RenderList, points: buffer,\n"
+     "                               count: int, index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderDrawPoints() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry. The array of\n"
+     "`count` SDL_Points is copied into the list.\n"
+    },
+
+    {"SDL_RenderListRenderDrawLines",
+     (PyCFunction) PyCSDL2_RenderListRenderDrawLines,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderDrawLines(list: SDL_RenderList, points: buffer,\n"
+     "                              count: int, index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderDrawLines() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry. The array of\n"
+     "`count` SDL_Points is copied into the list.\n"
+    },
+
+    {"SDL_RenderListRenderDrawRects",
+     (PyCFunction) PyCSDL2_RenderListRenderDrawRects,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderDrawRects(list: SDL_RenderList, rects: buffer,\n"
+     "                              count: int, index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderDrawRects() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry. The array of\n"
+     "`count` SDL_Rects is copied into the list. If `rects` is None, the\n"
+     "entire rendering target is used.\n"
+    },
+
+    {"SDL_RenderListRenderFillRects",
+     (PyCFunction) PyCSDL2_RenderListRenderFillRects,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderFillRects(list: SDL_RenderList, rects: buffer,\n"
+     "                              count: int, index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderFillRects() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry. The array of\n"
+     "`count` SDL_Rects is copied into the list. If `rects` is None, the\n"
+     "entire rendering target is used.\n"
+    },
+
+    {"SDL_RenderListRenderCopy",
+     (PyCFunction) PyCSDL2_RenderListRenderCopy,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderCopy(list: SDL_RenderList, texture: SDL_Texture,\n"
+     "                         srcrect: SDL_Rect, dstrect: SDL_Rect,\n"
+     "                         index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderCopy() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListRenderCopyEx",
+     (PyCFunction) PyCSDL2_RenderListRenderCopyEx,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderCopyEx(list: SDL_RenderList, texture: SDL_Texture,\n"
+     "                           srcrect: SDL_Rect, dstrect: SDL_Rect,\n"
+     "                           angle: float, center: SDL_Point, flip: int,\n"
+     "                           index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderCopyEx() call into `list`, or overwrites entry\n"
+     "`index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListRenderSetViewport",
+     (PyCFunction) PyCSDL2_RenderListRenderSetViewport,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderSetViewport(list: SDL_RenderList, rect: SDL_Rect,\n"
+     "                                index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderSetViewport() call into `list`, or overwrites\n"
+     "entry `index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListRenderSetClipRect",
+     (PyCFunction) PyCSDL2_RenderListRenderSetClipRect,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListRenderSetClipRect(list: SDL_RenderList, rect: SDL_Rect,\n"
+     "                                index=None) -> int\n"
+     "\n"
+     "Records a SDL_RenderSetClipRect() call into `list`, or overwrites\n"
+     "entry `index` with it, and returns the index of the entry.\n"
+    },
+
+    {"SDL_RenderListReset",
+     (PyCFunction) PyCSDL2_RenderListReset,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListReset(list: SDL_RenderList) -> None\n"
+     "\n"
+     "Removes all commands from `list`.\n"
+    },
+
+    {"SDL_RenderListExecute",
+     (PyCFunction) PyCSDL2_RenderListExecute,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_RenderListExecute(renderer: SDL_Renderer, list: SDL_RenderList)\n"
+     "    -> None\n"
+     "\n"
+     "Runs the commands recorded in `list` on `renderer`, in order, without\n"
+     "the GIL. Stops at the first command which fails.\n"
+    },
+
+    {"SDL_TextureAtlasInsert",
+     (PyCFunction) PyCSDL2_TextureAtlasInsert,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_TextureAtlasInsert(atlas: SDL_TextureAtlas, surfaces) -> int\n"
+     "\n"
+     "Packs the SDL_Surfaces in the sequence `surfaces` into the pages of\n"
+     "`atlas`, adding pages as needed, and uploads each changed page once.\n"
+     "Returns the index of the first new item. The items of the surfaces\n"
+     "are numbered in order from there.\n"
+    },
+
+    {"SDL_TextureAtlasGetStats",
+     (PyCFunction) PyCSDL2_TextureAtlasGetStats,
+     METH_VARARGS | METH_KEYWORDS,
+     "SDL_TextureAtlasGetStats(atlas: SDL_TextureAtlas) -> dict\n"
+     "\n"
+     "Returns the number of pages and items of `atlas`, the pixels used by\n"
+     "items, the pixels of all pages, and the fraction of them used.\n"
+    },
+
     /* rwops.h */
 
     {"SDL_RWFromFile",
@@ -0,0 +1,232 @@
+/*
+ * pycsdl2
+ * Copyright (c) 2015 Paul Tan <pyokagan@pyokagan.name>
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ *     1. The origin of this software must not be misrepresented; you must
+ *        not claim that you wrote the original software. If you use this
+ *        software in a product, an acknowledgment in the product
+ *        documentation would be appreciated but is not required.
+ *     2. Altered source versions must be plainly marked as such, and must
+ *        not be misrepresented as being the original software.
+ *     3. This notice may not be removed or altered from any source
+ *        distribution.
+ */
+/**
+ * \file mouse.h
+ * \brief Bindings for SDL_mouse.h
+ */
+#ifndef _PYCSDL2_MOUSE_H_
+#define _PYCSDL2_MOUSE_H_
+#include <Python.h>
+#include <structmember.h>
+#include <SDL_keyboard.h>
+#include <SDL_mouse.h>
+#include "../include/pycsdl2.h"
+#include "util.h"
+
+/**
+ * \brief Implements csdl2.SDL_GetMouseState()
+ *
+ * \code{.py}
+ * SDL_GetMouseState() -> (int, int, int)
+ * \endcode
+ *
+ * \returns A (buttons, x, y) tuple, where buttons is the button bitmask.
+ */
+static PyObject *
+PyCSDL2_GetMouseState(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    int x, y;
+    Uint32 buttons;
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    buttons = SDL_GetMouseState(&x, &y);
+
+    return Py_BuildValue("kii", (unsigned long) buttons, x, y);
+}
+
+/**
+ * \defgroup csdl2_SDL_InputSnapshot csdl2.SDL_InputSnapshot
+ *
+ * @{
+ */
+
+/** \brief Instance data for PyCSDL2_InputSnapshotType */
+typedef struct PyCSDL2_InputSnapshot {
+    PyObject_HEAD
+    /** \brief Head of weak ref list */
+    PyObject *in_weakreflist;
+    /** \brief Mouse x position relative to the focus window */
+    int x;
+    /** \brief Mouse y position relative to the focus window */
+    int y;
+    /** \brief Mouse button bitmask */
+    unsigned int buttons;
+    /** \brief Key modifiers */
+    unsigned int mod;
+} PyCSDL2_InputSnapshot;
+
+/** \brief tp_new for PyCSDL2_InputSnapshotType */
+static PyObject *
+PyCSDL2_InputSnapshotNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    return type->tp_alloc(type, 0);
+}
+
+/** \brief tp_dealloc for PyCSDL2_InputSnapshotType */
+static void
+PyCSDL2_InputSnapshotDealloc(PyCSDL2_InputSnapshot *self)
+{
+    PyObject_ClearWeakRefs((PyObject*)self);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/** \brief List of members in PyCSDL2_InputSnapshotType */
+static PyMemberDef PyCSDL2_InputSnapshotMembers[] = {
+    {"x", T_INT, offsetof(PyCSDL2_InputSnapshot, x), READONLY,
+     "(readonly) Mouse x position relative to the focus window."},
+    {"y", T_INT, offsetof(PyCSDL2_InputSnapshot, y), READONLY,
+     "(readonly) Mouse y position relative to the focus window."},
+    {"buttons", T_UINT, offsetof(PyCSDL2_InputSnapshot, buttons), READONLY,
+     "(readonly) Bitmask of the pressed mouse buttons."},
+    {"mod", T_UINT, offsetof(PyCSDL2_InputSnapshot, mod), READONLY,
+     "(readonly) Bitmask of the pressed key modifiers."},
+    {NULL}
+};
+
+/** \brief Type definition for csdl2.SDL_InputSnapshot */
+static PyTypeObject PyCSDL2_InputSnapshotType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_InputSnapshot",
+    /* tp_basicsize      */ sizeof(PyCSDL2_InputSnapshot),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_InputSnapshotDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc            */
+    "SDL_InputSnapshot()\n"
+    "\n"
+    "Mouse and key modifier state, filled by SDL_GetInputSnapshot().\n",
+    /* tp_traverse       */ 0,
+    /* tp_clear          */ 0,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_InputSnapshot, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_InputSnapshotMembers,
+    /* tp_getset         */ 0,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ PyCSDL2_InputSnapshotNew
+};
+
+/**
+ * \brief Implements csdl2.SDL_GetInputSnapshot()
+ *
+ * \code{.py}
+ * SDL_GetInputSnapshot(snapshot: SDL_InputSnapshot or None = None)
+ *     -> SDL_InputSnapshot
+ * \endcode
+ *
+ * Fills snapshot with the mouse position, mouse buttons and key modifiers.
+ * If snapshot is None, a new SDL_InputSnapshot is created.
+ *
+ * \returns A new reference to the snapshot, NULL if an exception occurred.
+ */
+static PyObject *
+PyCSDL2_GetInputSnapshot(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_InputSnapshot *self = NULL;
+    PyTypeObject *type = &PyCSDL2_InputSnapshotType;
+    int x, y;
+    static char *kwlist[] = {"snapshot", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O!", kwlist, type, &self))
+        return NULL;
+
+    if (self) {
+        Py_INCREF(self);
+    } else {
+        self = (PyCSDL2_InputSnapshot*) type->tp_alloc(type, 0);
+        if (!self)
+            return NULL;
+    }
+
+    self->buttons = SDL_GetMouseState(&x, &y);
+    self->x = x;
+    self->y = y;
+    self->mod = SDL_GetModState();
+
+    return (PyObject*) self;
+}
+
+/** @} */
+
+/**
+ * \brief Initializes bindings to SDL_mouse.h
+ *
+ * \param module csdl2 module object
+ * \returns 1 on success, 0 if an exception occurred.
+ */
+static int
+PyCSDL2_initmouse(PyObject *module)
+{
+    static const PyCSDL2_Constant constants[] = {
+        {"SDL_BUTTON_LEFT", SDL_BUTTON_LEFT},
+        {"SDL_BUTTON_MIDDLE", SDL_BUTTON_MIDDLE},
+        {"SDL_BUTTON_RIGHT", SDL_BUTTON_RIGHT},
+        {"SDL_BUTTON_X1", SDL_BUTTON_X1},
+        {"SDL_BUTTON_X2", SDL_BUTTON_X2},
+        {"SDL_BUTTON_LMASK", SDL_BUTTON_LMASK},
+        {"SDL_BUTTON_MMASK", SDL_BUTTON_MMASK},
+        {"SDL_BUTTON_RMASK", SDL_BUTTON_RMASK},
+        {"SDL_BUTTON_X1MASK", SDL_BUTTON_X1MASK},
+        {"SDL_BUTTON_X2MASK", SDL_BUTTON_X2MASK},
+        {NULL, 0}
+    };
+
+    if (PyCSDL2_PyModuleAddConstants(module, constants) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_InputSnapshotType) < 0)
+        return 0;
+
+    return 1;
+}
+
+#endif /* _PYCSDL2_MOUSE_H_ */
@@ -461,6 +461,36 @@ PyCSDL2_ConvertRectRead(PyObject *object, Py_buffer *view)
     return Py_CLEANUP_SUPPORTED;
 }
 
+/**
+ * \brief Converter for a readonly array of SDL_Rects, or None.
+ *
+ * If object is None, view->buf is set to NULL. The caller checks the size
+ * of the array.
+ */
+static int
+PyCSDL2_ConvertRectsRead(PyObject *object, Py_buffer *view)
+{
+    if (!object) {
+        PyBuffer_Release(view);
+        return 1;
+    }
+    if (object == Py_None) {
+        view->obj = NULL;
+        view->buf = NULL;
+        view->len = 0;
+        return 1;
+    }
+    if (PyObject_GetBuffer(object, view, PyBUF_SIMPLE))
+        return 0;
+    if (!PyBuffer_IsContiguous(view, 'C')) {
+        PyErr_SetString(PyExc_BufferError,
+                        "SDL_Rect buffer must be C-contiguous");
+        PyBuffer_Release(view);
+        return 0;
+    }
+    return Py_CLEANUP_SUPPORTED;
+}
+
 /**
  * \brief Implements csdl2.SDL_HasIntersection()
  *
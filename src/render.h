@@ -29,6 +29,7 @@
 #define _PYCSDL2_RENDER_H_
 #include <Python.h>
 #include <SDL_render.h>
+#include <SDL_atomic.h>
 #include "../include/pycsdl2.h"
 #include "util.h"
 #include "error.h"
@@ -533,6 +534,22 @@ typedef struct PyCSDL2_Renderer {
     SDL_Renderer *renderer;
     /** \brief PyObject representing the default render target */
     PyObject *deftarget;
+    /**
+     * \brief Protects the waits on cond. Never taken with the GIL held, so
+     *        that a thread waiting for it cannot block the GIL.
+     */
+    SDL_mutex *lock;
+    /** \brief Signalled when busy or now_serving changes */
+    SDL_cond *cond;
+    /**
+     * \brief Non-zero while a call runs on the renderer without the GIL.
+     *        Only set with the GIL held.
+     */
+    SDL_atomic_t busy;
+    /** \brief Next ticket handed out by PyCSDL2_RendererWait() */
+    unsigned int next_ticket;
+    /** \brief Ticket of the thread whose turn it is to use the renderer */
+    unsigned int now_serving;
 } PyCSDL2_Renderer;
 
 /**
@@ -566,6 +583,10 @@ PyCSDL2_RendererDealloc(PyCSDL2_Renderer *self)
         PyCSDL2_PtrMapDelItem(PyCSDL2_RendererDict, self->renderer);
         SDL_DestroyRenderer(self->renderer);
     }
+    if (self->cond)
+        SDL_DestroyCond(self->cond);
+    if (self->lock)
+        SDL_DestroyMutex(self->lock);
     Py_TYPE(self)->tp_free((PyObject*) self);
 }
 
@@ -599,6 +620,84 @@ static PyTypeObject PyCSDL2_RendererType = {
     /* tp_weaklistoffset */ offsetof(PyCSDL2_Renderer, in_weakreflist)
 };
 
+/**
+ * \brief Waits until no call runs on the renderer without the GIL.
+ *
+ * SDL renderers are not thread-safe, so every use of a renderer with the GIL
+ * held must wait for the calls which released the GIL to finish. Once this
+ * returns, no such call can start until the GIL is released again.
+ *
+ * Waiting threads take their turns in order of arrival, so that a thread
+ * issuing calls in a loop cannot starve the others.
+ *
+ * The caller must own a reference to renderer.
+ */
+static void
+PyCSDL2_RendererWait(PyCSDL2_Renderer *renderer)
+{
+    unsigned int ticket;
+
+    if (!SDL_AtomicGet(&renderer->busy) &&
+        renderer->next_ticket == renderer->now_serving)
+        return;
+
+    ticket = renderer->next_ticket++;
+    for (;;) {
+        Py_BEGIN_ALLOW_THREADS
+        SDL_LockMutex(renderer->lock);
+        while (SDL_AtomicGet(&renderer->busy) ||
+               renderer->now_serving != ticket)
+            SDL_CondWait(renderer->cond, renderer->lock);
+        SDL_UnlockMutex(renderer->lock);
+        Py_END_ALLOW_THREADS
+        /*
+         * The turn stays reserved while taking the GIL back, so only a
+         * thread which was served before this one can have started a call
+         * meanwhile. Wait for it with the same ticket.
+         */
+        if (!SDL_AtomicGet(&renderer->busy))
+            break;
+    }
+
+    /* busy is only set with the GIL held, so no call can start now */
+    SDL_LockMutex(renderer->lock);
+    renderer->now_serving++;
+    SDL_CondBroadcast(renderer->cond);
+    SDL_UnlockMutex(renderer->lock);
+}
+
+/**
+ * \brief Starts a section which calls into the renderer without the GIL.
+ *
+ * The renderer must have been validated with PyCSDL2_RendererValid(). It is
+ * pinned for the duration of the section, and other threads using it wait
+ * in PyCSDL2_RendererValid() until the section ends, so it cannot be
+ * destroyed mid-call. Objects and buffers used in the section must be kept
+ * alive by the caller.
+ *
+ * Must be paired with PYCSDL2_RENDERER_END_ALLOW_THREADS in the same scope.
+ */
+#define PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(rdr) \
+    { \
+        PyCSDL2_Renderer *_pycsdl2_rdr = (rdr); \
+        Py_INCREF(_pycsdl2_rdr); \
+        SDL_AtomicSet(&_pycsdl2_rdr->busy, 1); \
+        Py_BEGIN_ALLOW_THREADS
+
+/**
+ * \brief Ends a PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS section
+ *
+ * Wakes the waiting threads before taking the GIL back.
+ */
+#define PYCSDL2_RENDERER_END_ALLOW_THREADS \
+        SDL_LockMutex(_pycsdl2_rdr->lock); \
+        SDL_AtomicSet(&_pycsdl2_rdr->busy, 0); \
+        SDL_CondBroadcast(_pycsdl2_rdr->cond); \
+        SDL_UnlockMutex(_pycsdl2_rdr->lock); \
+        Py_END_ALLOW_THREADS \
+        Py_DECREF(_pycsdl2_rdr); \
+    }
+
 /**
  * \brief Validates the PyCSDL2_Renderer object
  *
@@ -608,6 +707,8 @@ static PyTypeObject PyCSDL2_RendererType = {
  * * The contained SDL_Window or SDL_Surface of its default render target is
  *   not NULL.
  *
+ * Waits for calls running on the renderer in other threads to finish first.
+ *
  * \param renderer PyCSDL2_Renderer to check
  * \returns 1 if the renderer is valid, 0 with an exception set if it is not.
  */
@@ -623,6 +724,8 @@ PyCSDL2_RendererValid(PyCSDL2_Renderer *renderer)
         return 0;
     }
 
+    PyCSDL2_RendererWait(renderer);
+
     if (!renderer->renderer) {
         PyErr_SetString(PyExc_ValueError, "Invalid SDL_Renderer");
         return 0;
@@ -676,6 +779,13 @@ PyCSDL2_RendererCreate(SDL_Renderer *renderer, PyObject *deftarget)
     if (!self)
         return NULL;
 
+    self->lock = SDL_CreateMutex();
+    self->cond = SDL_CreateCond();
+    if (!self->lock || !self->cond) {
+        Py_DECREF(self);
+        return PyCSDL2_RaiseSDLError();
+    }
+
     self->renderer = renderer;
     PyCSDL2_Set(self->deftarget, deftarget);
 
@@ -708,6 +818,25 @@ PyCSDL2_RendererPtr(PyObject *obj, SDL_Renderer **out)
     return 1;
 }
 
+/**
+ * \brief Converter for a valid PyCSDL2_Renderer object.
+ *
+ * \param obj The PyCSDL2_Renderer object
+ * \param[out] out Output pointer, borrowing obj.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_RendererConvert(PyObject *obj, PyCSDL2_Renderer **out)
+{
+    PyCSDL2_Renderer *self = (PyCSDL2_Renderer*)obj;
+
+    if (!PyCSDL2_RendererValid(self))
+        return 0;
+
+    *out = self;
+    return 1;
+}
+
 /**
  * \defgroup csdl2_SDL_Texture csdl2.SDL_Texture
  *
@@ -744,6 +873,9 @@ PyCSDL2_TextureDealloc(PyCSDL2_Texture *self)
     PyObject_ClearWeakRefs((PyObject*) self);
     if (self->texture) {
         PyCSDL2_PtrMapDelItem(PyCSDL2_TextureDict, self->texture);
+        /* Another thread may be using the renderer without the GIL */
+        if (self->renderer)
+            PyCSDL2_RendererWait(self->renderer);
         if (self->renderer && self->renderer->renderer &&
             SDL_GetRenderTarget(self->renderer->renderer) == self->texture) {
             SDL_SetRenderTarget(self->renderer->renderer, NULL);
@@ -777,6 +909,17 @@ PyCSDL2_TextureValid(PyCSDL2_Texture *self, int allow_locked)
         return 0;
     }
 
+    /* The texture may be destroyed by another thread while waiting */
+    if (self->renderer && (SDL_AtomicGet(&self->renderer->busy) ||
+                           self->renderer->next_ticket !=
+                           self->renderer->now_serving)) {
+        PyCSDL2_Renderer *renderer = self->renderer;
+
+        Py_INCREF(renderer);
+        PyCSDL2_RendererWait(renderer);
+        Py_DECREF(renderer);
+    }
+
     if (!self->texture) {
         PyErr_SetString(PyExc_ValueError, "invalid SDL_Texture");
         return 0;
@@ -888,6 +1031,47 @@ PyCSDL2_TexturePtr(PyObject *obj, SDL_Texture **out)
     return 1;
 }
 
+/**
+ * \brief Converter for a valid, unlocked PyCSDL2_Texture object.
+ *
+ * \param obj The PyCSDL2_Texture object
+ * \param[out] out Output pointer, borrowing obj.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_TextureConvert(PyObject *obj, PyCSDL2_Texture **out)
+{
+    PyCSDL2_Texture *self = (PyCSDL2_Texture*)obj;
+
+    if (!PyCSDL2_TextureValid(self, 0))
+        return 0;
+
+    *out = self;
+    return 1;
+}
+
+/**
+ * \brief Checks that the texture was created with the renderer.
+ *
+ * SDL checks this as well, raising the same error, but it has to be
+ * checked before the GIL is released, as only the renderer is guarded while
+ * the GIL is released.
+ *
+ * \returns 1 if it was, 0 with an exception set otherwise.
+ */
+static int
+PyCSDL2_TextureOfRenderer(PyCSDL2_Texture *texture,
+                          PyCSDL2_Renderer *renderer)
+{
+    if (texture->renderer != renderer) {
+        SDL_SetError("Texture was not created with this renderer");
+        PyCSDL2_RaiseSDLError();
+        return 0;
+    }
+
+    return 1;
+}
+
 /**
  * \brief Detaches the SDL_Texture and PyCSDL2_Renderer from the
  *        PyCSDL2_Texture
@@ -1539,6 +1723,7 @@ PyCSDL2_GetTextureBlendMode(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_UpdateTexture(PyObject *module, PyObject *args, PyObject *kwds)
 {
+    PyCSDL2_Texture *texture_obj;
     SDL_Texture *texture;
     Py_buffer rect, pixels;
     SDL_Rect r;
@@ -1548,11 +1733,13 @@ PyCSDL2_UpdateTexture(PyObject *module, PyObject *args, PyObject *kwds)
     static char *kwlist[] = {"texture", "rect", "pixels", "pitch", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&y*i", kwlist,
-                                     PyCSDL2_TexturePtr, &texture,
+                                     PyCSDL2_TextureConvert, &texture_obj,
                                      PyCSDL2_ConvertRectRead, &rect,
                                      &pixels, &pitch))
         return NULL;
 
+    texture = texture_obj->texture;
+
     /* SDL assumes that pitch is positive */
     if (pitch < 0) {
         PyBuffer_Release(&rect);
@@ -1602,7 +1789,9 @@ PyCSDL2_UpdateTexture(PyObject *module, PyObject *args, PyObject *kwds)
         return PyCSDL2_RaiseBufferSizeError("pixels", min_size, pixels.len);
     }
 
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(texture_obj->renderer)
     ret = SDL_UpdateTexture(texture, rect.buf, pixels.buf, pitch);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
 
     PyBuffer_Release(&rect);
     PyBuffer_Release(&pixels);
@@ -2140,12 +2329,16 @@ PyCSDL2_GetRenderDrawBlendMode(PyObject *module, PyObject *args,
 static PyObject *
 PyCSDL2_RenderClear(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
+    int ret;
     static char *kwlist[] = {"renderer", NULL};
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer))
+                                     PyCSDL2_RendererConvert, &renderer))
         return NULL;
-    if (SDL_RenderClear(renderer))
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderClear(renderer->renderer);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+    if (ret)
         return PyCSDL2_RaiseSDLError();
     Py_RETURN_NONE;
 }
@@ -2160,15 +2353,20 @@ PyCSDL2_RenderClear(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawPoint(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
-    int x, y;
+    PyCSDL2_Renderer *renderer;
+    int x, y, ret;
     static char *kwlist[] = {"renderer", "x", "y", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&ii", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer, &x, &y))
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     &x, &y))
         return NULL;
 
-    if (SDL_RenderDrawPoint(renderer, x, y))
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawPoint(renderer->renderer, x, y);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    if (ret)
         return PyCSDL2_RaiseSDLError();
 
     Py_RETURN_NONE;
@@ -2185,14 +2383,14 @@ PyCSDL2_RenderDrawPoint(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawPoints(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer points;
     int count, ret;
     Py_ssize_t expected;
     static char *kwlist[] = {"renderer", "points", "count", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&y*i", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      &points, &count))
         return NULL;
 
@@ -2202,7 +2400,9 @@ PyCSDL2_RenderDrawPoints(PyObject *module, PyObject *args, PyObject *kwds)
         return PyCSDL2_RaiseBufferSizeError("points", expected, points.len);
     }
 
-    ret = SDL_RenderDrawPoints(renderer, points.buf, count);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawPoints(renderer->renderer, points.buf, count);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&points);
 
     if (ret)
@@ -2222,16 +2422,20 @@ PyCSDL2_RenderDrawPoints(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawLine(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
-    int x1, y1, x2, y2;
+    PyCSDL2_Renderer *renderer;
+    int x1, y1, x2, y2, ret;
     static char *kwlist[] = {"renderer", "x1", "y1", "x2", "y2", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&iiii", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      &x1, &y1, &x2, &y2))
         return NULL;
 
-    if (SDL_RenderDrawLine(renderer, x1, y1, x2, y2))
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawLine(renderer->renderer, x1, y1, x2, y2);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    if (ret)
         return PyCSDL2_RaiseSDLError();
 
     Py_RETURN_NONE;
@@ -2247,15 +2451,15 @@ PyCSDL2_RenderDrawLine(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawLines(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer points;
     int count, ret;
     Py_ssize_t expected;
     static char *kwlist[] = {"renderer", "points", "count", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&y*i", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer, &points,
-                                     &count))
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     &points, &count))
         return NULL;
 
     expected = sizeof(SDL_Point) * count;
@@ -2264,7 +2468,9 @@ PyCSDL2_RenderDrawLines(PyObject *module, PyObject *args, PyObject *kwds)
         return PyCSDL2_RaiseBufferSizeError("points", expected, points.len);
     }
 
-    ret = SDL_RenderDrawLines(renderer, points.buf, count);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawLines(renderer->renderer, points.buf, count);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&points);
 
     if (ret)
@@ -2283,17 +2489,19 @@ PyCSDL2_RenderDrawLines(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawRect(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer rect;
     int ret;
     static char *kwlist[] = {"renderer", "rect", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      PyCSDL2_ConvertRectRead, &rect))
         return NULL;
 
-    ret = SDL_RenderDrawRect(renderer, rect.buf);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawRect(renderer->renderer, rect.buf);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&rect);
 
     if (ret)
@@ -2313,14 +2521,14 @@ PyCSDL2_RenderDrawRect(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderDrawRects(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer rects;
     int count, ret;
     Py_ssize_t expected;
     static char *kwlist[] = {"renderer", "rects", "count", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&y*i", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      &rects, &count))
         return NULL;
 
@@ -2330,7 +2538,9 @@ PyCSDL2_RenderDrawRects(PyObject *module, PyObject *args, PyObject *kwds)
         return PyCSDL2_RaiseBufferSizeError("rects", expected, rects.len);
     }
 
-    ret = SDL_RenderDrawRects(renderer, rects.buf, count);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderDrawRects(renderer->renderer, rects.buf, count);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&rects);
 
     if (ret)
@@ -2349,15 +2559,17 @@ PyCSDL2_RenderDrawRects(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderFillRect(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer rect;
     int ret;
     static char *kwlist[] = {"renderer", "rect", NULL};
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      PyCSDL2_ConvertRectRead, &rect))
         return NULL;
-    ret = SDL_RenderFillRect(renderer, rect.buf);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderFillRect(renderer->renderer, rect.buf);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&rect);
     if (ret) return PyCSDL2_RaiseSDLError();
     Py_RETURN_NONE;
@@ -2374,14 +2586,14 @@ PyCSDL2_RenderFillRect(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderFillRects(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     Py_buffer rects;
     int count, ret;
     Py_ssize_t expected;
     static char *kwlist[] = {"renderer", "rects", "count", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&y*i", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
+                                     PyCSDL2_RendererConvert, &renderer,
                                      &rects, &count))
         return NULL;
 
@@ -2391,7 +2603,9 @@ PyCSDL2_RenderFillRects(PyObject *module, PyObject *args, PyObject *kwds)
         return PyCSDL2_RaiseBufferSizeError("rects", expected, rects.len);
     }
 
-    ret = SDL_RenderFillRects(renderer, rects.buf, count);
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderFillRects(renderer->renderer, rects.buf, count);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     PyBuffer_Release(&rects);
 
     if (ret)
@@ -2411,21 +2625,30 @@ PyCSDL2_RenderFillRects(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderCopy(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
-    SDL_Texture *texture;
+    PyCSDL2_Renderer *renderer;
+    PyCSDL2_Texture *texture;
     Py_buffer srcrect, dstrect;
     int ret;
     static char *kwlist[] = {"renderer", "texture", "srcrect", "dstrect",
                              NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
-                                     PyCSDL2_TexturePtr, &texture,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     PyCSDL2_TextureConvert, &texture,
                                      PyCSDL2_ConvertRectRead, &srcrect,
                                      PyCSDL2_ConvertRectRead, &dstrect))
         return NULL;
 
-    ret = SDL_RenderCopy(renderer, texture, srcrect.buf, dstrect.buf);
+    if (!PyCSDL2_TextureOfRenderer(texture, renderer)) {
+        PyBuffer_Release(&srcrect);
+        PyBuffer_Release(&dstrect);
+        return NULL;
+    }
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderCopy(renderer->renderer, texture->texture, srcrect.buf,
+                         dstrect.buf);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
 
     PyBuffer_Release(&srcrect);
     PyBuffer_Release(&dstrect);
@@ -2448,8 +2671,8 @@ PyCSDL2_RenderCopy(PyObject *module, PyObject *args, PyObject *kwds)
 static PyObject *
 PyCSDL2_RenderCopyEx(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
-    SDL_Texture *texture;
+    PyCSDL2_Renderer *renderer;
+    PyCSDL2_Texture *texture;
     Py_buffer srcrect, dstrect, center;
     double angle;
     int flip, ret;
@@ -2457,8 +2680,8 @@ PyCSDL2_RenderCopyEx(PyObject *module, PyObject *args, PyObject *kwds)
                              "angle", "center", "flip", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&dO&i", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer,
-                                     PyCSDL2_TexturePtr, &texture,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     PyCSDL2_TextureConvert, &texture,
                                      PyCSDL2_ConvertRectRead, &srcrect,
                                      PyCSDL2_ConvertRectRead, &dstrect,
                                      &angle,
@@ -2466,8 +2689,17 @@ PyCSDL2_RenderCopyEx(PyObject *module, PyObject *args, PyObject *kwds)
                                      &flip))
         return NULL;
 
-    ret = SDL_RenderCopyEx(renderer, texture, srcrect.buf, dstrect.buf, angle,
-                           center.buf, flip);
+    if (!PyCSDL2_TextureOfRenderer(texture, renderer)) {
+        PyBuffer_Release(&srcrect);
+        PyBuffer_Release(&dstrect);
+        PyBuffer_Release(&center);
+        return NULL;
+    }
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    ret = SDL_RenderCopyEx(renderer->renderer, texture->texture, srcrect.buf,
+                           dstrect.buf, angle, center.buf, flip);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
 
     PyBuffer_Release(&srcrect);
     PyBuffer_Release(&dstrect);
@@ -2479,6 +2711,305 @@ PyCSDL2_RenderCopyEx(PyObject *module, PyObject *args, PyObject *kwds)
     Py_RETURN_NONE;
 }
 
+/**
+ * \brief Checks the rectangle arrays of a batched texture copy.
+ *
+ * If dstrects is None, srcrects holds interleaved pairs of source and
+ * destination rectangles. srcrects may be None on its own, in which case
+ * *src is set to NULL.
+ *
+ * \param srcrects Source rectangle buffer.
+ * \param dstrects Destination rectangle buffer.
+ * \param count Number of copies.
+ * \param[out] src First source rectangle, or NULL.
+ * \param[out] dst First destination rectangle.
+ * \param[out] stride Distance between consecutive rectangles, in bytes.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_RectPairs(const Py_buffer *srcrects, const Py_buffer *dstrects,
+                  int count, const char **src, const char **dst,
+                  Py_ssize_t *stride)
+{
+    Py_ssize_t expected;
+
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must not be negative");
+        return 0;
+    }
+
+    if (dstrects->buf) {
+        *stride = sizeof(SDL_Rect);
+        expected = *stride * count;
+        if (srcrects->buf && srcrects->len < expected) {
+            PyCSDL2_RaiseBufferSizeError("srcrects", expected, srcrects->len);
+            return 0;
+        }
+        if (dstrects->len < expected) {
+            PyCSDL2_RaiseBufferSizeError("dstrects", expected, dstrects->len);
+            return 0;
+        }
+        *src = srcrects->buf;
+        *dst = dstrects->buf;
+    } else {
+        if (!srcrects->buf) {
+            PyErr_SetString(PyExc_ValueError,
+                            "srcrects and dstrects cannot both be None");
+            return 0;
+        }
+        *stride = 2 * sizeof(SDL_Rect);
+        expected = *stride * count;
+        if (srcrects->len < expected) {
+            PyCSDL2_RaiseBufferSizeError("srcrects", expected, srcrects->len);
+            return 0;
+        }
+        *src = srcrects->buf;
+        *dst = *src + sizeof(SDL_Rect);
+    }
+
+    return 1;
+}
+
+/**
+ * \brief Reads the i-th pair of rectangles checked by PyCSDL2_RectPairs().
+ *
+ * The buffers need not be aligned, so the rectangles are copied out.
+ *
+ * \returns s, or NULL if the source rectangle stands for the entire
+ *          texture.
+ */
+static const SDL_Rect *
+PyCSDL2_RectPairGet(const char *src, const char *dst, Py_ssize_t stride,
+                    int i, SDL_Rect *s, SDL_Rect *d)
+{
+    memcpy(d, dst + i * stride, sizeof(SDL_Rect));
+    if (!src)
+        return NULL;
+    memcpy(s, src + i * stride, sizeof(SDL_Rect));
+    return s->w || s->h ? s : NULL;
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderCopyBatch()
+ *
+ * \code{.py}
+ * SDL_RenderCopyBatch(renderer: SDL_Renderer, texture: SDL_Texture,
+ *                     srcrects: buffer, dstrects: buffer, count: int)
+ *     -> None
+ * \endcode
+ *
+ * If dstrects is None, srcrects holds count interleaved pairs of source and
+ * destination rectangles. A source rectangle with zero width and height
+ * stands for the entire texture.
+ */
+static PyObject *
+PyCSDL2_RenderCopyBatch(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_Renderer *renderer;
+    PyCSDL2_Texture *texture;
+    Py_buffer srcrects, dstrects;
+    const char *src, *dst;
+    Py_ssize_t stride;
+    int count, i, ret = 0;
+    static char *kwlist[] = {"renderer", "texture", "srcrects", "dstrects",
+                             "count", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&i", kwlist,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     PyCSDL2_TextureConvert, &texture,
+                                     PyCSDL2_ConvertRectsRead, &srcrects,
+                                     PyCSDL2_ConvertRectsRead, &dstrects,
+                                     &count))
+        return NULL;
+
+    if (!PyCSDL2_TextureOfRenderer(texture, renderer))
+        goto fail;
+
+    if (!PyCSDL2_RectPairs(&srcrects, &dstrects, count, &src, &dst, &stride))
+        goto fail;
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    for (i = 0; i < count && !ret; i++) {
+        SDL_Rect s, d;
+
+        ret = SDL_RenderCopy(renderer->renderer, texture->texture,
+                             PyCSDL2_RectPairGet(src, dst, stride, i, &s, &d),
+                             &d);
+    }
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    PyBuffer_Release(&srcrects);
+    PyBuffer_Release(&dstrects);
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    Py_RETURN_NONE;
+
+fail:
+    PyBuffer_Release(&srcrects);
+    PyBuffer_Release(&dstrects);
+    return NULL;
+}
+
+/**
+ * \brief Returns the size of the items of an array of angles.
+ *
+ * \returns sizeof(float) or sizeof(double), or 0 with an exception set if
+ *          the array holds neither.
+ */
+static Py_ssize_t
+PyCSDL2_AngleSize(const Py_buffer *view)
+{
+    const char *format = view->format ? view->format : "B";
+    char native = SDL_BYTEORDER == SDL_LIL_ENDIAN ? '<' : '>';
+
+    if (*format == '@' || *format == '=' || *format == native)
+        format++;
+
+    if (!strcmp(format, "f"))
+        return sizeof(float);
+    if (!strcmp(format, "d"))
+        return sizeof(double);
+
+    PyErr_Format(PyExc_TypeError, "angles must be an array of float or "
+                 "double, not of format '%.20s'", view->format);
+    return 0;
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderCopyExBatch()
+ *
+ * \code{.py}
+ * SDL_RenderCopyExBatch(renderer: SDL_Renderer, texture: SDL_Texture,
+ *                       srcrects: buffer, dstrects: buffer, angles: buffer,
+ *                       centers: buffer, flips: buffer, count: int) -> None
+ * \endcode
+ *
+ * The rectangles are read as in SDL_RenderCopyBatch(). angles, centers and
+ * flips may each be None for no rotation, rotation around the centers of the
+ * destination rectangles and no flipping respectively.
+ */
+static PyObject *
+PyCSDL2_RenderCopyExBatch(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_Renderer *renderer;
+    PyCSDL2_Texture *texture;
+    Py_buffer srcrects, dstrects, angles, centers, flips;
+    const char *src, *dst;
+    Py_ssize_t stride, angle_size = 0;
+    int count, i, ret = 0;
+    static char *kwlist[] = {"renderer", "texture", "srcrects", "dstrects",
+                             "angles", "centers", "flips", "count", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&O&O&O&i", kwlist,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     PyCSDL2_TextureConvert, &texture,
+                                     PyCSDL2_ConvertRectsRead, &srcrects,
+                                     PyCSDL2_ConvertRectsRead, &dstrects,
+                                     PyCSDL2_ConvertBufferRead, &angles,
+                                     PyCSDL2_ConvertBufferRead, &centers,
+                                     PyCSDL2_ConvertBufferRead, &flips,
+                                     &count))
+        return NULL;
+
+    if (!PyCSDL2_TextureOfRenderer(texture, renderer))
+        goto fail;
+
+    if (!PyCSDL2_RectPairs(&srcrects, &dstrects, count, &src, &dst, &stride))
+        goto fail;
+
+    if (angles.buf) {
+        angle_size = PyCSDL2_AngleSize(&angles);
+        if (!angle_size)
+            goto fail;
+        if (angles.len < angle_size * count) {
+            PyCSDL2_RaiseBufferSizeError("angles", angle_size * count,
+                                         angles.len);
+            goto fail;
+        }
+    }
+
+    if (centers.buf && centers.len < (Py_ssize_t)sizeof(SDL_Point) * count) {
+        PyCSDL2_RaiseBufferSizeError("centers", sizeof(SDL_Point) * count,
+                                     centers.len);
+        goto fail;
+    }
+
+    if (flips.buf) {
+        if (flips.itemsize != 1) {
+            PyErr_SetString(PyExc_TypeError, "flips must be an array of "
+                            "bytes");
+            goto fail;
+        }
+        if (flips.len < count) {
+            PyCSDL2_RaiseBufferSizeError("flips", count, flips.len);
+            goto fail;
+        }
+        for (i = 0; i < count; i++) {
+            Uint8 flip = ((const Uint8*)flips.buf)[i];
+
+            if (flip & ~(SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL)) {
+                PyErr_Format(PyExc_ValueError, "invalid flip at index %d: "
+                             "%d", i, (int)flip);
+                goto fail;
+            }
+        }
+    }
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    for (i = 0; i < count && !ret; i++) {
+        SDL_Rect s, d;
+        SDL_Point c;
+        const SDL_Rect *sp;
+        double angle = 0.0;
+        int flip = SDL_FLIP_NONE;
+
+        sp = PyCSDL2_RectPairGet(src, dst, stride, i, &s, &d);
+
+        if (angle_size == sizeof(float)) {
+            float a;
+
+            memcpy(&a, (const char*)angles.buf + i * sizeof(float),
+                   sizeof(float));
+            angle = a;
+        } else if (angle_size) {
+            memcpy(&angle, (const char*)angles.buf + i * sizeof(double),
+                   sizeof(double));
+        }
+
+        if (centers.buf)
+            memcpy(&c, (const char*)centers.buf + i * sizeof(SDL_Point),
+                   sizeof(SDL_Point));
+
+        if (flips.buf)
+            flip = ((const Uint8*)flips.buf)[i];
+
+        ret = SDL_RenderCopyEx(renderer->renderer, texture->texture, sp, &d,
+                               angle, centers.buf ? &c : NULL, flip);
+    }
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    PyBuffer_Release(&srcrects);
+    PyBuffer_Release(&dstrects);
+    PyBuffer_Release(&angles);
+    PyBuffer_Release(&centers);
+    PyBuffer_Release(&flips);
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    Py_RETURN_NONE;
+
+fail:
+    PyBuffer_Release(&srcrects);
+    PyBuffer_Release(&dstrects);
+    PyBuffer_Release(&angles);
+    PyBuffer_Release(&centers);
+    PyBuffer_Release(&flips);
+    return NULL;
+}
+
 /**
  * \brief Implements csdl2.SDL_RenderReadPixels()
  *
@@ -2550,7 +3081,9 @@ PyCSDL2_RenderReadPixels(PyObject *module, PyObject *args, PyObject *kwds)
         goto fail;
     }
 
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer_obj)
     ret = SDL_RenderReadPixels(renderer, rect.buf, format, pixels.buf, pitch);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
 
     PyBuffer_Release(&rect);
     PyBuffer_Release(&pixels);
@@ -2576,12 +3109,15 @@ fail:
 static PyObject *
 PyCSDL2_RenderPresent(PyObject *module, PyObject *args, PyObject *kwds)
 {
-    SDL_Renderer *renderer;
+    PyCSDL2_Renderer *renderer;
     static char *kwlist[] = {"renderer", NULL};
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
-                                     PyCSDL2_RendererPtr, &renderer))
+                                     PyCSDL2_RendererConvert, &renderer))
         return NULL;
-    SDL_RenderPresent(renderer);
+    /* May block until the next vertical retrace */
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    SDL_RenderPresent(renderer->renderer);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
     Py_RETURN_NONE;
 }
 
@@ -2685,14 +3221,1702 @@ PyCSDL2_GL_UnbindTexture(PyObject *module, PyObject *args, PyObject *kwds)
 }
 
 /**
- * \brief Initializes bindings to SDL_render.h
+ * \defgroup csdl2_SDL_RenderList csdl2.SDL_RenderList
  *
- * Adds constants defined in SDL_render.h to module.
+ * \brief Display list of render commands replayed without the GIL.
  *
- * \param module csdl2 module object
- * \returns 1 on success, 0 if an exception occurred.
+ * Commands are recorded into a flat array of PyCSDL2_RenderListCmd. Point and
+ * rectangle arrays are copied into a separate data pool which the commands
+ * refer to by offset, so the pool can grow without invalidating them.
+ * Textures used by copy commands are owned by the list.
+ *
+ * While a list is executed the GIL is released, so the list must not change
+ * meanwhile. Recording into a list which is being executed is an error.
+ *
+ * @{
  */
-static int
+
+/** \brief PyCSDL2_RenderListCmd types */
+enum PyCSDL2_RenderListCmdType {
+    PYCSDL2_RENDERLIST_SETDRAWCOLOR,
+    PYCSDL2_RENDERLIST_SETDRAWBLENDMODE,
+    PYCSDL2_RENDERLIST_CLEAR,
+    PYCSDL2_RENDERLIST_DRAWPOINTS,
+    PYCSDL2_RENDERLIST_DRAWLINES,
+    PYCSDL2_RENDERLIST_DRAWRECTS,
+    PYCSDL2_RENDERLIST_FILLRECTS,
+    PYCSDL2_RENDERLIST_COPY,
+    PYCSDL2_RENDERLIST_COPYEX,
+    PYCSDL2_RENDERLIST_SETVIEWPORT,
+    PYCSDL2_RENDERLIST_SETCLIPRECT
+};
+
+/** \brief A command recorded in a PyCSDL2_RenderList */
+typedef struct PyCSDL2_RenderListCmd {
+    /** \brief One of PyCSDL2_RenderListCmdType */
+    int type;
+    /** \brief (SETDRAWCOLOR) Red, green, blue and alpha */
+    Uint8 color[4];
+    /** \brief (SETDRAWBLENDMODE) Blend mode. (COPYEX) Flip flags */
+    int mode;
+    /** \brief (DRAW*, FILLRECTS) Offset of the items in the data pool */
+    size_t offset;
+    /** \brief (DRAW*, FILLRECTS) Number of items */
+    int count;
+    /** \brief Bytes of the data pool reserved for this entry at offset */
+    size_t reserved;
+    /** \brief (COPY, COPYEX) Source texture, owned by the list */
+    PyCSDL2_Texture *texture;
+    /** \brief (COPY, COPYEX) Source rect. (SETVIEWPORT, SETCLIPRECT) Rect */
+    SDL_Rect rect;
+    /**
+     * \brief Non-zero if rect is used, zero for NULL. (DRAWRECTS, FILLRECTS)
+     *        Zero for the entire rendering target instead of the array.
+     */
+    int has_rect;
+    /** \brief (COPY, COPYEX) Destination rect */
+    SDL_Rect dstrect;
+    /** \brief Non-zero if dstrect is used, zero for NULL */
+    int has_dstrect;
+    /** \brief (COPYEX) Rotation angle in degrees */
+    double angle;
+    /** \brief (COPYEX) Rotation center */
+    SDL_Point center;
+    /** \brief Non-zero if center is used, zero for NULL */
+    int has_center;
+} PyCSDL2_RenderListCmd;
+
+/** \brief Instance data for PyCSDL2_RenderListType */
+typedef struct PyCSDL2_RenderList {
+    PyObject_HEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief Recorded commands */
+    PyCSDL2_RenderListCmd *cmds;
+    /** \brief Number of recorded commands */
+    Py_ssize_t num_cmds;
+    /** \brief Allocated capacity of cmds */
+    Py_ssize_t max_cmds;
+    /** \brief Pool of point and rectangle arrays used by the commands */
+    char *data;
+    /** \brief Number of bytes used in data */
+    size_t data_len;
+    /** \brief Allocated capacity of data */
+    size_t data_cap;
+    /** \brief Number of SDL_RenderListExecute() calls running the list */
+    int executing;
+} PyCSDL2_RenderList;
+
+static PyTypeObject PyCSDL2_RenderListType;
+
+/** \brief tp_new for PyCSDL2_RenderListType */
+static PyCSDL2_RenderList *
+PyCSDL2_RenderListNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+        return NULL;
+
+    return (PyCSDL2_RenderList*) type->tp_alloc(type, 0);
+}
+
+/** \brief Traversal function for PyCSDL2_RenderListType */
+static int
+PyCSDL2_RenderListTraverse(PyCSDL2_RenderList *self, visitproc visit,
+                           void *arg)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->num_cmds; i++)
+        Py_VISIT(self->cmds[i].texture);
+    return 0;
+}
+
+/** \brief Clear function for PyCSDL2_RenderListType */
+static int
+PyCSDL2_RenderListClear(PyCSDL2_RenderList *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->num_cmds; i++)
+        Py_CLEAR(self->cmds[i].texture);
+    return 0;
+}
+
+/** \brief Destructor for PyCSDL2_RenderListType */
+static void
+PyCSDL2_RenderListDealloc(PyCSDL2_RenderList *self)
+{
+    PyObject_GC_UnTrack(self);
+    PyCSDL2_RenderListClear(self);
+    PyObject_ClearWeakRefs((PyObject*) self);
+    PyMem_Free(self->cmds);
+    PyMem_Free(self->data);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief sq_length for PyCSDL2_RenderListType */
+static Py_ssize_t
+PyCSDL2_RenderListLength(PyCSDL2_RenderList *self)
+{
+    return self->num_cmds;
+}
+
+/** \brief tp_as_sequence for PyCSDL2_RenderListType */
+static PySequenceMethods PyCSDL2_RenderListAsSequence = {
+    /* sq_length */ (lenfunc) PyCSDL2_RenderListLength
+};
+
+/** \brief Type definition for csdl2.SDL_RenderList */
+static PyTypeObject PyCSDL2_RenderListType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_RenderList",
+    /* tp_basicsize      */ sizeof(PyCSDL2_RenderList),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_RenderListDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ &PyCSDL2_RenderListAsSequence,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */
+    "Display list of render commands.\n"
+    "\n"
+    "Record commands with the SDL_RenderList* functions, and replay them\n"
+    "with SDL_RenderListExecute().\n",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_RenderListTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_RenderListClear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_RenderList, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ 0,
+    /* tp_getset         */ 0,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_RenderListNew
+};
+
+/**
+ * \brief Converter for a PyCSDL2_RenderList which can be recorded into.
+ *
+ * \param obj The PyCSDL2_RenderList object
+ * \param[out] out Output pointer, borrowing obj.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_RenderListConvert(PyObject *obj, PyCSDL2_RenderList **out)
+{
+    if (!PyCSDL2_Assert(obj))
+        return 0;
+
+    if (Py_TYPE(obj) != &PyCSDL2_RenderListType) {
+        PyCSDL2_RaiseTypeError(NULL, "SDL_RenderList", obj);
+        return 0;
+    }
+
+    if (((PyCSDL2_RenderList*)obj)->executing) {
+        PyErr_SetString(PyExc_ValueError, "SDL_RenderList is being "
+                        "executed");
+        return 0;
+    }
+
+    *out = (PyCSDL2_RenderList*)obj;
+    return 1;
+}
+
+/**
+ * \brief Records a command into the list.
+ *
+ * \param self The list.
+ * \param index None to append the command, or the index of the entry to
+ *              overwrite with it.
+ * \param cmd The command. Its offset and reserved fields are ignored.
+ * \param data Point or rect array of the command, copied into the pool.
+ * \param len Size of data in bytes.
+ * \returns The index of the entry, or NULL with an exception set.
+ */
+static PyObject *
+PyCSDL2_RenderListPut(PyCSDL2_RenderList *self, PyObject *index,
+                      const PyCSDL2_RenderListCmd *cmd, const void *data,
+                      size_t len)
+{
+    PyCSDL2_RenderListCmd *entry;
+    PyCSDL2_Texture *old_texture = NULL;
+    Py_ssize_t i;
+    size_t offset = 0, reserved = 0;
+
+    if (index == Py_None) {
+        i = self->num_cmds;
+        if (i == self->max_cmds) {
+            Py_ssize_t max_cmds = self->max_cmds ? self->max_cmds * 2 : 16;
+            PyCSDL2_RenderListCmd *cmds;
+
+            cmds = PyMem_Realloc(self->cmds, max_cmds * sizeof(*cmds));
+            if (!cmds)
+                return PyErr_NoMemory();
+            self->cmds = cmds;
+            self->max_cmds = max_cmds;
+        }
+    } else {
+        i = PyNumber_AsSsize_t(index, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+        if (i < 0)
+            i += self->num_cmds;
+        if (i < 0 || i >= self->num_cmds) {
+            PyErr_SetString(PyExc_IndexError, "SDL_RenderList index out of "
+                            "range");
+            return NULL;
+        }
+        offset = self->cmds[i].offset;
+        reserved = self->cmds[i].reserved;
+        old_texture = self->cmds[i].texture;
+    }
+
+    /* Patched entries reuse their space in the pool if the data fits */
+    if (len > reserved) {
+        if (self->data_len + len > self->data_cap) {
+            size_t data_cap = self->data_cap ? self->data_cap : 256;
+            char *pool;
+
+            while (data_cap < self->data_len + len)
+                data_cap *= 2;
+            pool = PyMem_Realloc(self->data, data_cap);
+            if (!pool)
+                return PyErr_NoMemory();
+            self->data = pool;
+            self->data_cap = data_cap;
+        }
+        offset = self->data_len;
+        reserved = len;
+        self->data_len += len;
+    }
+    if (len)
+        memcpy(self->data + offset, data, len);
+
+    entry = &self->cmds[i];
+    *entry = *cmd;
+    entry->offset = offset;
+    entry->reserved = reserved;
+    Py_XINCREF(entry->texture);
+    if (i == self->num_cmds)
+        self->num_cmds++;
+
+    Py_XDECREF(old_texture);
+    return PyLong_FromSsize_t(i);
+}
+
+/**
+ * \brief Records a command with an array of points or rects.
+ *
+ * \param items Array, or a view with a NULL buf for the entire rendering
+ *              target.
+ * \param count Number of items in the array.
+ * \param size Size of an item.
+ */
+static PyObject *
+PyCSDL2_RenderListPutArray(PyCSDL2_RenderList *self, PyObject *index,
+                           int type, const Py_buffer *items, int count,
+                           size_t size)
+{
+    PyCSDL2_RenderListCmd cmd;
+    Py_ssize_t expected;
+
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must not be negative");
+        return NULL;
+    }
+
+    SDL_zero(cmd);
+    cmd.type = type;
+
+    if (!items->buf)
+        return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+
+    expected = (Py_ssize_t)size * count;
+    if (items->len < expected)
+        return PyCSDL2_RaiseBufferSizeError(NULL, expected, items->len);
+
+    cmd.count = count;
+    cmd.has_rect = 1;
+    return PyCSDL2_RenderListPut(self, index, &cmd, items->buf, expected);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListSetRenderDrawColor()
+ *
+ * \code{.py}
+ * SDL_RenderListSetRenderDrawColor(list: SDL_RenderList, r: int, g: int,
+ *                                  b: int, a: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListSetRenderDrawColor(PyObject *module, PyObject *args,
+                                     PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    static char *kwlist[] = {"list", "r", "g", "b", "a", "index", NULL};
+
+    SDL_zero(cmd);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&bbbb|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     &cmd.color[0], &cmd.color[1],
+                                     &cmd.color[2], &cmd.color[3], &index))
+        return NULL;
+
+    cmd.type = PYCSDL2_RENDERLIST_SETDRAWCOLOR;
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListSetRenderDrawBlendMode()
+ *
+ * \code{.py}
+ * SDL_RenderListSetRenderDrawBlendMode(list: SDL_RenderList,
+ *                                      blendMode: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListSetRenderDrawBlendMode(PyObject *module, PyObject *args,
+                                         PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    static char *kwlist[] = {"list", "blendMode", "index", NULL};
+
+    SDL_zero(cmd);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&i|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     &cmd.mode, &index))
+        return NULL;
+
+    cmd.type = PYCSDL2_RENDERLIST_SETDRAWBLENDMODE;
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderClear()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderClear(list: SDL_RenderList, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderClear(PyObject *module, PyObject *args,
+                              PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    static char *kwlist[] = {"list", "index", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     &index))
+        return NULL;
+
+    SDL_zero(cmd);
+    cmd.type = PYCSDL2_RENDERLIST_CLEAR;
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Records a command taking an array of points.
+ *
+ * Shared by SDL_RenderListRenderDrawPoints() and
+ * SDL_RenderListRenderDrawLines().
+ */
+static PyObject *
+PyCSDL2_RenderListPoints(int type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyObject *index = Py_None, *ret;
+    Py_buffer points;
+    int count;
+    static char *kwlist[] = {"list", "points", "count", "index", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&y*i|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     &points, &count, &index))
+        return NULL;
+
+    ret = PyCSDL2_RenderListPutArray(self, index, type, &points, count,
+                                     sizeof(SDL_Point));
+    PyBuffer_Release(&points);
+    return ret;
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderDrawPoints()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderDrawPoints(list: SDL_RenderList, points: buffer,
+ *                                count: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderDrawPoints(PyObject *module, PyObject *args,
+                                   PyObject *kwds)
+{
+    return PyCSDL2_RenderListPoints(PYCSDL2_RENDERLIST_DRAWPOINTS, args,
+                                    kwds);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderDrawLines()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderDrawLines(list: SDL_RenderList, points: buffer,
+ *                               count: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderDrawLines(PyObject *module, PyObject *args,
+                                  PyObject *kwds)
+{
+    return PyCSDL2_RenderListPoints(PYCSDL2_RENDERLIST_DRAWLINES, args,
+                                    kwds);
+}
+
+/**
+ * \brief Records a command taking an array of rects, or None.
+ *
+ * Shared by SDL_RenderListRenderDrawRects() and
+ * SDL_RenderListRenderFillRects().
+ */
+static PyObject *
+PyCSDL2_RenderListRects(int type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyObject *index = Py_None, *ret;
+    Py_buffer rects;
+    int count;
+    static char *kwlist[] = {"list", "rects", "count", "index", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&i|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     PyCSDL2_ConvertRectsRead, &rects,
+                                     &count, &index))
+        return NULL;
+
+    ret = PyCSDL2_RenderListPutArray(self, index, type, &rects, count,
+                                     sizeof(SDL_Rect));
+    PyBuffer_Release(&rects);
+    return ret;
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderDrawRects()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderDrawRects(list: SDL_RenderList, rects: buffer,
+ *                               count: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderDrawRects(PyObject *module, PyObject *args,
+                                  PyObject *kwds)
+{
+    return PyCSDL2_RenderListRects(PYCSDL2_RENDERLIST_DRAWRECTS, args, kwds);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderFillRects()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderFillRects(list: SDL_RenderList, rects: buffer,
+ *                               count: int, index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderFillRects(PyObject *module, PyObject *args,
+                                  PyObject *kwds)
+{
+    return PyCSDL2_RenderListRects(PYCSDL2_RENDERLIST_FILLRECTS, args, kwds);
+}
+
+/**
+ * \brief Copies an optional SDL_Rect or SDL_Point buffer into a command.
+ *
+ * \returns 1 if the buffer was given, 0 if it was None.
+ */
+static int
+PyCSDL2_RenderListOptional(const Py_buffer *view, void *out, size_t size)
+{
+    if (!view->buf)
+        return 0;
+    memcpy(out, view->buf, size);
+    return 1;
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderCopy()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderCopy(list: SDL_RenderList, texture: SDL_Texture,
+ *                          srcrect: SDL_Rect, dstrect: SDL_Rect,
+ *                          index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderCopy(PyObject *module, PyObject *args,
+                             PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    Py_buffer srcrect, dstrect;
+    static char *kwlist[] = {"list", "texture", "srcrect", "dstrect",
+                             "index", NULL};
+
+    SDL_zero(cmd);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     PyCSDL2_TextureConvert, &cmd.texture,
+                                     PyCSDL2_ConvertRectRead, &srcrect,
+                                     PyCSDL2_ConvertRectRead, &dstrect,
+                                     &index))
+        return NULL;
+
+    cmd.type = PYCSDL2_RENDERLIST_COPY;
+    cmd.has_rect = PyCSDL2_RenderListOptional(&srcrect, &cmd.rect,
+                                              sizeof(SDL_Rect));
+    cmd.has_dstrect = PyCSDL2_RenderListOptional(&dstrect, &cmd.dstrect,
+                                                 sizeof(SDL_Rect));
+    PyBuffer_Release(&srcrect);
+    PyBuffer_Release(&dstrect);
+
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderCopyEx()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderCopyEx(list: SDL_RenderList, texture: SDL_Texture,
+ *                            srcrect: SDL_Rect, dstrect: SDL_Rect,
+ *                            angle: float, center: SDL_Point, flip: int,
+ *                            index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderCopyEx(PyObject *module, PyObject *args,
+                               PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    Py_buffer srcrect, dstrect, center;
+    static char *kwlist[] = {"list", "texture", "srcrect", "dstrect",
+                             "angle", "center", "flip", "index", NULL};
+
+    SDL_zero(cmd);
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&O&dO&i|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     PyCSDL2_TextureConvert, &cmd.texture,
+                                     PyCSDL2_ConvertRectRead, &srcrect,
+                                     PyCSDL2_ConvertRectRead, &dstrect,
+                                     &cmd.angle,
+                                     PyCSDL2_ConvertPointRead, &center,
+                                     &cmd.mode, &index))
+        return NULL;
+
+    cmd.type = PYCSDL2_RENDERLIST_COPYEX;
+    cmd.has_rect = PyCSDL2_RenderListOptional(&srcrect, &cmd.rect,
+                                              sizeof(SDL_Rect));
+    cmd.has_dstrect = PyCSDL2_RenderListOptional(&dstrect, &cmd.dstrect,
+                                                 sizeof(SDL_Rect));
+    cmd.has_center = PyCSDL2_RenderListOptional(&center, &cmd.center,
+                                                sizeof(SDL_Point));
+    PyBuffer_Release(&srcrect);
+    PyBuffer_Release(&dstrect);
+    PyBuffer_Release(&center);
+
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Records a command taking an optional rect.
+ *
+ * Shared by SDL_RenderListRenderSetViewport() and
+ * SDL_RenderListRenderSetClipRect().
+ */
+static PyObject *
+PyCSDL2_RenderListRect(int type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    PyCSDL2_RenderListCmd cmd;
+    PyObject *index = Py_None;
+    Py_buffer rect;
+    static char *kwlist[] = {"list", "rect", "index", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&|O", kwlist,
+                                     PyCSDL2_RenderListConvert, &self,
+                                     PyCSDL2_ConvertRectRead, &rect, &index))
+        return NULL;
+
+    SDL_zero(cmd);
+    cmd.type = type;
+    cmd.has_rect = PyCSDL2_RenderListOptional(&rect, &cmd.rect,
+                                              sizeof(SDL_Rect));
+    PyBuffer_Release(&rect);
+
+    return PyCSDL2_RenderListPut(self, index, &cmd, NULL, 0);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderSetViewport()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderSetViewport(list: SDL_RenderList, rect: SDL_Rect,
+ *                                 index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderSetViewport(PyObject *module, PyObject *args,
+                                    PyObject *kwds)
+{
+    return PyCSDL2_RenderListRect(PYCSDL2_RENDERLIST_SETVIEWPORT, args,
+                                  kwds);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListRenderSetClipRect()
+ *
+ * \code{.py}
+ * SDL_RenderListRenderSetClipRect(list: SDL_RenderList, rect: SDL_Rect,
+ *                                 index=None) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListRenderSetClipRect(PyObject *module, PyObject *args,
+                                    PyObject *kwds)
+{
+    return PyCSDL2_RenderListRect(PYCSDL2_RENDERLIST_SETCLIPRECT, args,
+                                  kwds);
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListReset()
+ *
+ * \code{.py}
+ * SDL_RenderListReset(list: SDL_RenderList) -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListReset(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_RenderList *self;
+    static char *kwlist[] = {"list", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
+                                     PyCSDL2_RenderListConvert, &self))
+        return NULL;
+
+    PyCSDL2_RenderListClear(self);
+    self->num_cmds = 0;
+    self->data_len = 0;
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * \brief Runs a command of a PyCSDL2_RenderList.
+ *
+ * Called without the GIL. Commands drawing an empty array of points, lines
+ * or rects do nothing, since SDL rejects them and data may be NULL.
+ *
+ * \returns 0 on success, -1 with the SDL error set on failure.
+ */
+static int
+PyCSDL2_RenderListRun(SDL_Renderer *renderer, const char *data,
+                      const PyCSDL2_RenderListCmd *cmd)
+{
+    const SDL_Rect *rect = cmd->has_rect ? &cmd->rect : NULL;
+    const SDL_Rect *dstrect = cmd->has_dstrect ? &cmd->dstrect : NULL;
+    const void *items = cmd->count ? data + cmd->offset : NULL;
+
+    switch (cmd->type) {
+    case PYCSDL2_RENDERLIST_SETDRAWCOLOR:
+        return SDL_SetRenderDrawColor(renderer, cmd->color[0], cmd->color[1],
+                                      cmd->color[2], cmd->color[3]);
+    case PYCSDL2_RENDERLIST_SETDRAWBLENDMODE:
+        return SDL_SetRenderDrawBlendMode(renderer, cmd->mode);
+    case PYCSDL2_RENDERLIST_CLEAR:
+        return SDL_RenderClear(renderer);
+    case PYCSDL2_RENDERLIST_DRAWPOINTS:
+        if (!cmd->count)
+            return 0;
+        return SDL_RenderDrawPoints(renderer, items, cmd->count);
+    case PYCSDL2_RENDERLIST_DRAWLINES:
+        if (!cmd->count)
+            return 0;
+        return SDL_RenderDrawLines(renderer, items, cmd->count);
+    case PYCSDL2_RENDERLIST_DRAWRECTS:
+        if (!cmd->has_rect)
+            return SDL_RenderDrawRect(renderer, NULL);
+        if (!cmd->count)
+            return 0;
+        return SDL_RenderDrawRects(renderer, items, cmd->count);
+    case PYCSDL2_RENDERLIST_FILLRECTS:
+        if (!cmd->has_rect)
+            return SDL_RenderFillRect(renderer, NULL);
+        if (!cmd->count)
+            return 0;
+        return SDL_RenderFillRects(renderer, items, cmd->count);
+    case PYCSDL2_RENDERLIST_COPY:
+        return SDL_RenderCopy(renderer, cmd->texture->texture, rect,
+                              dstrect);
+    case PYCSDL2_RENDERLIST_COPYEX:
+        return SDL_RenderCopyEx(renderer, cmd->texture->texture, rect,
+                                dstrect, cmd->angle,
+                                cmd->has_center ? &cmd->center : NULL,
+                                cmd->mode);
+    case PYCSDL2_RENDERLIST_SETVIEWPORT:
+        return SDL_RenderSetViewport(renderer, rect);
+    case PYCSDL2_RENDERLIST_SETCLIPRECT:
+        return SDL_RenderSetClipRect(renderer, rect);
+    default:
+        return SDL_SetError("Invalid SDL_RenderList command");
+    }
+}
+
+/**
+ * \brief Implements csdl2.SDL_RenderListExecute()
+ *
+ * \code{.py}
+ * SDL_RenderListExecute(renderer: SDL_Renderer, list: SDL_RenderList)
+ *     -> None
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_RenderListExecute(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_Renderer *renderer;
+    PyCSDL2_RenderList *self;
+    Py_ssize_t i;
+    int ret = 0;
+    static char *kwlist[] = {"renderer", "list", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O!", kwlist,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     &PyCSDL2_RenderListType, &self))
+        return NULL;
+
+    /* Validating the textures may release the GIL */
+    self->executing++;
+
+    for (i = 0; i < self->num_cmds; i++) {
+        PyCSDL2_Texture *texture = self->cmds[i].texture;
+
+        if (!texture)
+            continue;
+
+        if (!PyCSDL2_TextureValid(texture, 0) ||
+            !PyCSDL2_TextureOfRenderer(texture, renderer)) {
+            self->executing--;
+            return NULL;
+        }
+    }
+
+    if (!PyCSDL2_RendererValid(renderer)) {
+        self->executing--;
+        return NULL;
+    }
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(renderer)
+    for (i = 0; i < self->num_cmds && !ret; i++)
+        ret = PyCSDL2_RenderListRun(renderer->renderer, self->data,
+                                    &self->cmds[i]);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    self->executing--;
+
+    if (ret)
+        return PyCSDL2_RaiseSDLError();
+
+    Py_RETURN_NONE;
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_SDL_TextureAtlas csdl2.SDL_TextureAtlas
+ *
+ * \brief Packs many surfaces into the pages of a texture atlas.
+ *
+ * Items are packed with the skyline bottom-left algorithm. Each page keeps
+ * its skyline, the list of horizontal segments forming the top edge of the
+ * space used so far, so that items can be inserted at any time.
+ *
+ * Each page keeps a staging SDL_Surface which the items are blitted into.
+ * After every insertion, the part of each page that changed is uploaded to
+ * its SDL_Texture with a single SDL_UpdateTexture() call.
+ *
+ * @{
+ */
+
+/** \brief Segment of the skyline of a PyCSDL2_TextureAtlasPage */
+typedef struct PyCSDL2_SkylineNode {
+    /** \brief Left edge of the segment */
+    int x;
+    /** \brief Height used by the items below the segment */
+    int y;
+    /** \brief Width of the segment */
+    int w;
+} PyCSDL2_SkylineNode;
+
+/** \brief A page of a PyCSDL2_TextureAtlas */
+typedef struct PyCSDL2_TextureAtlasPage {
+    /** \brief Staging surface holding the pixels of the page */
+    SDL_Surface *surface;
+    /** \brief Texture of the page. NULL until the page is first uploaded */
+    PyCSDL2_Texture *texture;
+    /** \brief Skyline segments, from left to right */
+    PyCSDL2_SkylineNode *nodes;
+    /** \brief Number of segments in nodes */
+    int num_nodes;
+    /** \brief Area used by the items of the page, without padding */
+    long used;
+    /** \brief Area of the page changed since it was last uploaded */
+    SDL_Rect dirty;
+} PyCSDL2_TextureAtlasPage;
+
+/** \brief Instance data for PyCSDL2_TextureAtlasType */
+typedef struct PyCSDL2_TextureAtlas {
+    PyObject_HEAD
+    /** \brief Head of weakref list */
+    PyObject *in_weakreflist;
+    /** \brief Renderer which the page textures are created with */
+    PyCSDL2_Renderer *renderer;
+    /** \brief Width of the pages */
+    int width;
+    /** \brief Height of the pages */
+    int height;
+    /** \brief Pixel format of the pages */
+    Uint32 format;
+    /** \brief Empty space left to the right of and below each item */
+    int padding;
+    /** \brief Pages */
+    PyCSDL2_TextureAtlasPage *pages;
+    /** \brief Number of pages */
+    int num_pages;
+    /** \brief Rect of each item within its page */
+    SDL_Rect *rects;
+    /** \brief Page of each item */
+    int *item_pages;
+    /** \brief Number of items */
+    Py_ssize_t num_items;
+    /** \brief Allocated capacity of rects and item_pages */
+    Py_ssize_t max_items;
+    /** \brief Non-zero while a SDL_TextureAtlasInsert() call runs */
+    int inserting;
+} PyCSDL2_TextureAtlas;
+
+static PyTypeObject PyCSDL2_TextureAtlasType;
+
+/** \brief tp_new for PyCSDL2_TextureAtlasType */
+static PyCSDL2_TextureAtlas *
+PyCSDL2_TextureAtlasNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_TextureAtlas *self;
+    PyCSDL2_Renderer *renderer;
+    int width, height, padding = 0, bpp;
+    Uint32 format = SDL_PIXELFORMAT_ARGB8888, rmask, gmask, bmask, amask;
+    static char *kwlist[] = {"renderer", "width", "height", "format",
+                             "padding", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&ii|" Uint32_UNIT "i",
+                                     kwlist,
+                                     PyCSDL2_RendererConvert, &renderer,
+                                     &width, &height, &format, &padding))
+        return NULL;
+
+    if (width <= 0 || height <= 0) {
+        PyErr_SetString(PyExc_ValueError, "width and height must be "
+                        "positive");
+        return NULL;
+    }
+
+    if (padding < 0) {
+        PyErr_SetString(PyExc_ValueError, "padding must not be negative");
+        return NULL;
+    }
+
+    if (SDL_ISPIXELFORMAT_FOURCC(format) ||
+        SDL_ISPIXELFORMAT_INDEXED(format) ||
+        !SDL_PixelFormatEnumToMasks(format, &bpp, &rmask, &gmask, &bmask,
+                                    &amask)) {
+        PyErr_SetString(PyExc_ValueError, "format must be a packed or "
+                        "array pixel format, not an indexed or FourCC one");
+        return NULL;
+    }
+
+    /* SDL surfaces cannot be larger than this */
+    if ((Sint64) width * height * SDL_BYTESPERPIXEL(format) > INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "width and height are too large");
+        return NULL;
+    }
+
+    self = (PyCSDL2_TextureAtlas*) type->tp_alloc(type, 0);
+    if (!self)
+        return NULL;
+
+    PyCSDL2_Set(self->renderer, renderer);
+    self->width = width;
+    self->height = height;
+    self->format = format;
+    self->padding = padding;
+
+    return self;
+}
+
+/** \brief Traversal function for PyCSDL2_TextureAtlasType */
+static int
+PyCSDL2_TextureAtlasTraverse(PyCSDL2_TextureAtlas *self, visitproc visit,
+                             void *arg)
+{
+    int i;
+
+    Py_VISIT(self->renderer);
+    for (i = 0; i < self->num_pages; i++)
+        Py_VISIT(self->pages[i].texture);
+    return 0;
+}
+
+/** \brief Clear function for PyCSDL2_TextureAtlasType */
+static int
+PyCSDL2_TextureAtlasClear(PyCSDL2_TextureAtlas *self)
+{
+    int i;
+
+    Py_CLEAR(self->renderer);
+    for (i = 0; i < self->num_pages; i++)
+        Py_CLEAR(self->pages[i].texture);
+    return 0;
+}
+
+/** \brief Destructor for PyCSDL2_TextureAtlasType */
+static void
+PyCSDL2_TextureAtlasDealloc(PyCSDL2_TextureAtlas *self)
+{
+    int i;
+
+    PyObject_GC_UnTrack(self);
+    PyCSDL2_TextureAtlasClear(self);
+    PyObject_ClearWeakRefs((PyObject*) self);
+    for (i = 0; i < self->num_pages; i++) {
+        SDL_FreeSurface(self->pages[i].surface);
+        PyMem_Free(self->pages[i].nodes);
+    }
+    PyMem_Free(self->pages);
+    PyMem_Free(self->rects);
+    PyMem_Free(self->item_pages);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Getter for SDL_TextureAtlas.pages */
+static PyObject *
+PyCSDL2_TextureAtlasGetPages(PyCSDL2_TextureAtlas *self, void *closure)
+{
+    PyObject *out;
+    int i;
+
+    out = PyTuple_New(self->num_pages);
+    if (!out)
+        return NULL;
+
+    for (i = 0; i < self->num_pages; i++) {
+        PyObject *texture = (PyObject*) self->pages[i].texture;
+
+        if (!texture)
+            texture = Py_None;
+        Py_INCREF(texture);
+        PyTuple_SET_ITEM(out, i, texture);
+    }
+
+    return out;
+}
+
+/** \brief Getter for SDL_TextureAtlas.rects */
+static PyObject *
+PyCSDL2_TextureAtlasGetRects(PyCSDL2_TextureAtlas *self, void *closure)
+{
+    return PyBytes_FromStringAndSize((const char*) self->rects,
+                                     self->num_items * sizeof(SDL_Rect));
+}
+
+/** \brief Getter for SDL_TextureAtlas.item_pages */
+static PyObject *
+PyCSDL2_TextureAtlasGetItemPages(PyCSDL2_TextureAtlas *self, void *closure)
+{
+    return PyBytes_FromStringAndSize((const char*) self->item_pages,
+                                     self->num_items * sizeof(int));
+}
+
+/** \brief tp_members for PyCSDL2_TextureAtlasType */
+static PyMemberDef PyCSDL2_TextureAtlasMembers[] = {
+    {"width", T_INT, offsetof(PyCSDL2_TextureAtlas, width), READONLY,
+     "(readonly) Width of the pages."},
+    {"height", T_INT, offsetof(PyCSDL2_TextureAtlas, height), READONLY,
+     "(readonly) Height of the pages."},
+    {"format", Uint32_TYPE, offsetof(PyCSDL2_TextureAtlas, format), READONLY,
+     "(readonly) Pixel format of the pages."},
+    {"padding", T_INT, offsetof(PyCSDL2_TextureAtlas, padding), READONLY,
+     "(readonly) Empty space to the right of and below each item."},
+    {"count", T_PYSSIZET, offsetof(PyCSDL2_TextureAtlas, num_items),
+     READONLY, "(readonly) Number of items."},
+    {NULL}
+};
+
+/** \brief tp_getset for PyCSDL2_TextureAtlasType */
+static PyGetSetDef PyCSDL2_TextureAtlasGetSetters[] = {
+    {"pages",
+     (getter) PyCSDL2_TextureAtlasGetPages,
+     (setter) NULL,
+     "(readonly) Tuple of the SDL_Texture of each page.",
+     NULL},
+    {"rects",
+     (getter) PyCSDL2_TextureAtlasGetRects,
+     (setter) NULL,
+     "(readonly) Array of the SDL_Rect of each item within its page.",
+     NULL},
+    {"item_pages",
+     (getter) PyCSDL2_TextureAtlasGetItemPages,
+     (setter) NULL,
+     "(readonly) Array of the page index of each item, as C ints.",
+     NULL},
+    {NULL}
+};
+
+/** \brief Type definition for csdl2.SDL_TextureAtlas */
+static PyTypeObject PyCSDL2_TextureAtlasType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "csdl2.SDL_TextureAtlas",
+    /* tp_basicsize      */ sizeof(PyCSDL2_TextureAtlas),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_TextureAtlasDealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */
+    "Texture atlas packing many surfaces into a few textures.\n"
+    "\n"
+    "Add surfaces with SDL_TextureAtlasInsert().\n",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_TextureAtlasTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_TextureAtlasClear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(PyCSDL2_TextureAtlas, in_weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ 0,
+    /* tp_members        */ PyCSDL2_TextureAtlasMembers,
+    /* tp_getset         */ PyCSDL2_TextureAtlasGetSetters,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ 0,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ (newfunc) PyCSDL2_TextureAtlasNew
+};
+
+/**
+ * \brief Finds the lowest position of an item on skyline segment i.
+ *
+ * \returns The top edge of the item placed with its left edge at the
+ *          segment, or -1 if it does not fit there.
+ */
+static int
+PyCSDL2_SkylineFit(const PyCSDL2_TextureAtlasPage *page, int i, int w, int h,
+                   int width, int height)
+{
+    int x = page->nodes[i].x, y = 0, remaining = w;
+
+    if (x + w > width)
+        return -1;
+
+    /* The segments cover the whole width, so this stays in bounds */
+    while (remaining > 0) {
+        if (page->nodes[i].y > y)
+            y = page->nodes[i].y;
+        if (y + h > height)
+            return -1;
+        remaining -= page->nodes[i].w;
+        i++;
+    }
+
+    return y;
+}
+
+/**
+ * \brief Finds the best position of an item on a page.
+ *
+ * Picks the position where the bottom edge of the item is lowest, and then
+ * the leftmost one.
+ *
+ * \returns The index of the skyline segment to place the item at, or -1 if
+ *          it does not fit on the page.
+ */
+static int
+PyCSDL2_SkylineFind(const PyCSDL2_TextureAtlasPage *page, int w, int h,
+                    int width, int height, int *out_y)
+{
+    int i, best = -1, best_bottom = 0;
+
+    for (i = 0; i < page->num_nodes; i++) {
+        int y = PyCSDL2_SkylineFit(page, i, w, h, width, height);
+
+        if (y >= 0 && (best < 0 || y + h < best_bottom)) {
+            best = i;
+            best_bottom = y + h;
+            *out_y = y;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * \brief Raises the skyline over an item placed at segment i.
+ *
+ * The caller must make sure that nodes has room for one more segment.
+ */
+static void
+PyCSDL2_SkylineAdd(PyCSDL2_TextureAtlasPage *page, int i, int y, int w,
+                   int h)
+{
+    PyCSDL2_SkylineNode *nodes = page->nodes;
+    int j;
+
+    memmove(&nodes[i + 1], &nodes[i],
+            (page->num_nodes - i) * sizeof(PyCSDL2_SkylineNode));
+    page->num_nodes++;
+    nodes[i].y = y + h;
+    nodes[i].w = w;
+
+    /* Shrink or remove the segments now under the item */
+    j = i + 1;
+    while (j < page->num_nodes) {
+        int overlap = nodes[i].x + nodes[i].w - nodes[j].x;
+
+        if (overlap <= 0)
+            break;
+        if (overlap < nodes[j].w) {
+            nodes[j].x += overlap;
+            nodes[j].w -= overlap;
+            break;
+        }
+        memmove(&nodes[j], &nodes[j + 1],
+                (page->num_nodes - j - 1) * sizeof(PyCSDL2_SkylineNode));
+        page->num_nodes--;
+    }
+
+    /* Merge neighbouring segments of the same height */
+    for (j = 0; j + 1 < page->num_nodes;) {
+        if (nodes[j].y == nodes[j + 1].y) {
+            nodes[j].w += nodes[j + 1].w;
+            memmove(&nodes[j + 1], &nodes[j + 2],
+                    (page->num_nodes - j - 2) * sizeof(PyCSDL2_SkylineNode));
+            page->num_nodes--;
+        } else {
+            j++;
+        }
+    }
+}
+
+/**
+ * \brief Appends an empty page to the atlas.
+ *
+ * \returns The new page, or NULL with an exception set.
+ */
+static PyCSDL2_TextureAtlasPage *
+PyCSDL2_TextureAtlasAddPage(PyCSDL2_TextureAtlas *self)
+{
+    PyCSDL2_TextureAtlasPage *pages, *page;
+    Uint32 rmask, gmask, bmask, amask;
+    int bpp;
+
+    pages = PyMem_Realloc(self->pages, (self->num_pages + 1) * sizeof(*pages));
+    if (!pages) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    self->pages = pages;
+
+    page = &pages[self->num_pages];
+    SDL_zerop(page);
+
+    /* A skyline has at most one segment per column, plus one spare */
+    page->nodes = PyMem_New(PyCSDL2_SkylineNode, self->width + 1);
+    if (!page->nodes) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    page->nodes[0].x = 0;
+    page->nodes[0].y = 0;
+    page->nodes[0].w = self->width;
+    page->num_nodes = 1;
+
+    SDL_PixelFormatEnumToMasks(self->format, &bpp, &rmask, &gmask, &bmask,
+                               &amask);
+    page->surface = SDL_CreateRGBSurface(0, self->width, self->height, bpp,
+                                         rmask, gmask, bmask, amask);
+    if (!page->surface) {
+        PyMem_Free(page->nodes);
+        PyCSDL2_RaiseSDLError();
+        return NULL;
+    }
+
+    self->num_pages++;
+    return page;
+}
+
+/**
+ * \brief Uploads the changed part of a page to its texture.
+ *
+ * Creates the texture of the page on its first upload. Waits on the renderer
+ * before each call into it, since an earlier upload released the GIL.
+ *
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_TextureAtlasUpload(PyCSDL2_TextureAtlas *self,
+                           PyCSDL2_TextureAtlasPage *page)
+{
+    SDL_Surface *sf = page->surface;
+    const SDL_Rect *r = &page->dirty;
+    const char *pixels;
+    int ret;
+
+    if (SDL_RectEmpty(r))
+        return 1;
+
+    if (!page->texture) {
+        SDL_Texture *texture;
+
+        if (!PyCSDL2_RendererValid(self->renderer))
+            return 0;
+
+        texture = SDL_CreateTexture(self->renderer->renderer, self->format,
+                                    SDL_TEXTUREACCESS_STATIC, self->width,
+                                    self->height);
+        if (!texture) {
+            PyCSDL2_RaiseSDLError();
+            return 0;
+        }
+
+        if (SDL_ISPIXELFORMAT_ALPHA(self->format))
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+        page->texture = (PyCSDL2_Texture*)
+            PyCSDL2_TextureCreate(texture, (PyObject*) self->renderer);
+        if (!page->texture) {
+            SDL_DestroyTexture(texture);
+            return 0;
+        }
+    }
+
+    pixels = (const char*) sf->pixels + r->y * sf->pitch +
+             r->x * sf->format->BytesPerPixel;
+
+    if (!PyCSDL2_RendererValid(self->renderer))
+        return 0;
+
+    PYCSDL2_RENDERER_BEGIN_ALLOW_THREADS(self->renderer)
+    ret = SDL_UpdateTexture(page->texture->texture, r, pixels, sf->pitch);
+    PYCSDL2_RENDERER_END_ALLOW_THREADS
+
+    if (ret) {
+        PyCSDL2_RaiseSDLError();
+        return 0;
+    }
+
+    SDL_zero(page->dirty);
+    return 1;
+}
+
+/** \brief Item of a SDL_TextureAtlasInsert() call, sorted for packing */
+typedef struct PyCSDL2_TextureAtlasEntry {
+    /** \brief Index of the item in the call */
+    Py_ssize_t index;
+    /** \brief The surface of the item */
+    SDL_Surface *surface;
+} PyCSDL2_TextureAtlasEntry;
+
+/** \brief Orders the items of an insertion by decreasing height and width */
+static int
+PyCSDL2_TextureAtlasEntryCmp(const void *a, const void *b)
+{
+    const PyCSDL2_TextureAtlasEntry *x = a, *y = b;
+
+    if (x->surface->h != y->surface->h)
+        return y->surface->h - x->surface->h;
+    if (x->surface->w != y->surface->w)
+        return y->surface->w - x->surface->w;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/**
+ * \brief State of a page before a SDL_TextureAtlasInsert() call, restored if
+ *        the call fails.
+ */
+typedef struct PyCSDL2_TextureAtlasUndo {
+    /** \brief Copy of the skyline segments, or NULL if not changed yet */
+    PyCSDL2_SkylineNode *nodes;
+    /** \brief Number of segments in nodes */
+    int num_nodes;
+    /** \brief Area used by the items of the page */
+    long used;
+} PyCSDL2_TextureAtlasUndo;
+
+/**
+ * \brief Undoes a failed SDL_TextureAtlasInsert() call.
+ *
+ * Removes the pages added by the call, restores the skylines of the other
+ * pages, and clears the pixels of the items packed into them. The cleared
+ * areas are marked as changed, since they may have been uploaded already.
+ *
+ * \param undo State of the pages which existed before the call.
+ * \param num_undo Number of pages which existed before the call.
+ * \param first Index of the first item of the call.
+ * \param entries Items of the call, in packing order.
+ * \param num_packed Number of entries packed and blitted.
+ */
+static void
+PyCSDL2_TextureAtlasRollback(PyCSDL2_TextureAtlas *self,
+                             PyCSDL2_TextureAtlasUndo *undo, int num_undo,
+                             Py_ssize_t first,
+                             const PyCSDL2_TextureAtlasEntry *entries,
+                             Py_ssize_t num_packed)
+{
+    Py_ssize_t i;
+    int p;
+
+    for (i = 0; i < num_packed; i++) {
+        Py_ssize_t k = first + entries[i].index;
+        PyCSDL2_TextureAtlasPage *page;
+
+        if (self->item_pages[k] >= num_undo)
+            continue;
+        page = &self->pages[self->item_pages[k]];
+        SDL_FillRect(page->surface, &self->rects[k], 0);
+        SDL_UnionRect(&page->dirty, &self->rects[k], &page->dirty);
+    }
+
+    while (self->num_pages > num_undo) {
+        PyCSDL2_TextureAtlasPage *page = &self->pages[--self->num_pages];
+
+        Py_CLEAR(page->texture);
+        SDL_FreeSurface(page->surface);
+        PyMem_Free(page->nodes);
+    }
+
+    for (p = 0; p < num_undo; p++) {
+        PyCSDL2_TextureAtlasPage *page = &self->pages[p];
+
+        if (!undo[p].nodes)
+            continue;
+        SDL_memcpy(page->nodes, undo[p].nodes,
+                   undo[p].num_nodes * sizeof(PyCSDL2_SkylineNode));
+        page->num_nodes = undo[p].num_nodes;
+        page->used = undo[p].used;
+    }
+}
+
+/**
+ * \brief Packs and blits an item into the atlas.
+ *
+ * Saves the state of an existing page into undo before changing it for the
+ * first time. On a failed blit, the area of the item is cleared again.
+ *
+ * \param undo State of the pages which existed before the insertion.
+ * \param num_undo Number of pages which existed before the insertion.
+ * \returns 1 on success, 0 with an exception set on failure.
+ */
+static int
+PyCSDL2_TextureAtlasPack(PyCSDL2_TextureAtlas *self, SDL_Surface *surface,
+                         PyCSDL2_TextureAtlasUndo *undo, int num_undo,
+                         SDL_Rect *out_rect, int *out_page)
+{
+    PyCSDL2_TextureAtlasPage *page = NULL;
+    SDL_BlendMode blend_mode;
+    SDL_Rect dst;
+    int w = surface->w + self->padding, h = surface->h + self->padding;
+    int i, p, node = -1, y = 0, ret;
+
+    /* Padding is not needed past the edges of the page */
+    if (w > self->width)
+        w = self->width;
+    if (h > self->height)
+        h = self->height;
+
+    for (i = 0; i < self->num_pages && node < 0; i++) {
+        page = &self->pages[i];
+        node = PyCSDL2_SkylineFind(page, w, h, self->width, self->height,
+                                   &y);
+    }
+
+    if (node < 0) {
+        page = PyCSDL2_TextureAtlasAddPage(self);
+        if (!page)
+            return 0;
+        node = 0;
+        y = 0;
+    }
+
+    p = (int) (page - self->pages);
+    if (p < num_undo && !undo[p].nodes) {
+        undo[p].nodes = PyMem_New(PyCSDL2_SkylineNode, page->num_nodes);
+        if (!undo[p].nodes) {
+            PyErr_NoMemory();
+            return 0;
+        }
+        SDL_memcpy(undo[p].nodes, page->nodes,
+                   page->num_nodes * sizeof(PyCSDL2_SkylineNode));
+        undo[p].num_nodes = page->num_nodes;
+        undo[p].used = page->used;
+    }
+
+    dst.x = page->nodes[node].x;
+    dst.y = y;
+    dst.w = surface->w;
+    dst.h = surface->h;
+
+    /* Copy the pixels as they are, including alpha */
+    SDL_GetSurfaceBlendMode(surface, &blend_mode);
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    ret = SDL_BlitSurface(surface, NULL, page->surface, &dst);
+    SDL_SetSurfaceBlendMode(surface, blend_mode);
+    if (ret) {
+        PyCSDL2_RaiseSDLError();
+        SDL_FillRect(page->surface, &dst, 0);
+        return 0;
+    }
+
+    PyCSDL2_SkylineAdd(page, node, y, w, h);
+    page->used += (long) dst.w * dst.h;
+    SDL_UnionRect(&page->dirty, &dst, &page->dirty);
+    *out_rect = dst;
+    *out_page = p;
+    return 1;
+}
+
+/**
+ * \brief Implements csdl2.SDL_TextureAtlasInsert()
+ *
+ * \code{.py}
+ * SDL_TextureAtlasInsert(atlas: SDL_TextureAtlas, surfaces) -> int
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_TextureAtlasInsert(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    PyCSDL2_TextureAtlas *self;
+    PyCSDL2_TextureAtlasEntry *entries = NULL;
+    PyCSDL2_TextureAtlasUndo *undo = NULL;
+    PyObject *surfaces, *seq = NULL, *ret = NULL;
+    Py_ssize_t n, i, first;
+    int p, num_undo = 0;
+    static char *kwlist[] = {"atlas", "surfaces", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O", kwlist,
+                                     &PyCSDL2_TextureAtlasType, &self,
+                                     &surfaces))
+        return NULL;
+
+    /* The GIL is released while waiting on the renderer and uploading */
+    if (self->inserting) {
+        PyErr_SetString(PyExc_ValueError, "SDL_TextureAtlas is being "
+                        "inserted into");
+        return NULL;
+    }
+    self->inserting = 1;
+
+    if (!self->renderer || !PyCSDL2_RendererValid(self->renderer))
+        goto finish;
+
+    seq = PySequence_Fast(surfaces, "surfaces must be a sequence");
+    if (!seq)
+        goto finish;
+    n = PySequence_Fast_GET_SIZE(seq);
+
+    entries = PyMem_New(PyCSDL2_TextureAtlasEntry, n ? n : 1);
+    if (!entries) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+
+    /* Check every item first so that nothing is packed on bad input */
+    for (i = 0; i < n; i++) {
+        SDL_Surface *sf;
+
+        if (!PyCSDL2_SurfacePtr(PySequence_Fast_GET_ITEM(seq, i), &sf))
+            goto finish;
+
+        if (sf->w <= 0 || sf->h <= 0 || sf->w > self->width ||
+            sf->h > self->height) {
+            PyErr_Format(PyExc_ValueError, "surface %zd of size %dx%d does "
+                         "not fit in a page of size %dx%d", i, sf->w, sf->h,
+                         self->width, self->height);
+            goto finish;
+        }
+
+        if (sf->locked) {
+            PyErr_Format(PyExc_ValueError, "surface %zd is locked", i);
+            goto finish;
+        }
+
+        entries[i].index = i;
+        entries[i].surface = sf;
+    }
+
+    if (self->num_items + n > self->max_items) {
+        Py_ssize_t max_items = self->max_items ? self->max_items : 64;
+        SDL_Rect *rects;
+        int *item_pages;
+
+        while (max_items < self->num_items + n)
+            max_items *= 2;
+
+        rects = PyMem_Realloc(self->rects, max_items * sizeof(SDL_Rect));
+        if (!rects) {
+            PyErr_NoMemory();
+            goto finish;
+        }
+        self->rects = rects;
+
+        item_pages = PyMem_Realloc(self->item_pages, max_items * sizeof(int));
+        if (!item_pages) {
+            PyErr_NoMemory();
+            goto finish;
+        }
+        self->item_pages = item_pages;
+        self->max_items = max_items;
+    }
+
+    /* Packing the largest items first wastes less space */
+    qsort(entries, n, sizeof(PyCSDL2_TextureAtlasEntry),
+          PyCSDL2_TextureAtlasEntryCmp);
+
+    num_undo = self->num_pages;
+    undo = PyMem_New(PyCSDL2_TextureAtlasUndo, num_undo ? num_undo : 1);
+    if (!undo) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+    for (p = 0; p < num_undo; p++)
+        undo[p].nodes = NULL;
+
+    /* Nothing is committed unless every item is packed and uploaded */
+    first = self->num_items;
+    for (i = 0; i < n; i++) {
+        Py_ssize_t k = first + entries[i].index;
+
+        if (!PyCSDL2_TextureAtlasPack(self, entries[i].surface, undo,
+                                      num_undo, &self->rects[k],
+                                      &self->item_pages[k]))
+            goto rollback;
+    }
+
+    for (p = 0; p < self->num_pages; p++)
+        if (!PyCSDL2_TextureAtlasUpload(self, &self->pages[p]))
+            goto rollback;
+
+    self->num_items += n;
+    ret = PyLong_FromSsize_t(first);
+    goto finish;
+
+rollback:
+    PyCSDL2_TextureAtlasRollback(self, undo, num_undo, first, entries, i);
+finish:
+    if (undo)
+        for (p = 0; p < num_undo; p++)
+            PyMem_Free(undo[p].nodes);
+    PyMem_Free(undo);
+    PyMem_Free(entries);
+    Py_XDECREF(seq);
+    self->inserting = 0;
+    return ret;
+}
+
+/**
+ * \brief Implements csdl2.SDL_TextureAtlasGetStats()
+ *
+ * \code{.py}
+ * SDL_TextureAtlasGetStats(atlas: SDL_TextureAtlas) -> dict
+ * \endcode
+ */
+static PyObject *
+PyCSDL2_TextureAtlasGetStats(PyObject *module, PyObject *args,
+                             PyObject *kwds)
+{
+    PyCSDL2_TextureAtlas *self;
+    long long used = 0, total;
+    int i;
+    static char *kwlist[] = {"atlas", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist,
+                                     &PyCSDL2_TextureAtlasType, &self))
+        return NULL;
+
+    for (i = 0; i < self->num_pages; i++)
+        used += self->pages[i].used;
+    total = (long long) self->num_pages * self->width * self->height;
+
+    return Py_BuildValue("{s:i,s:n,s:L,s:L,s:d}",
+                         "pages", self->num_pages,
+                         "items", self->num_items,
+                         "used_pixels", used,
+                         "total_pixels", total,
+                         "occupancy", total ? (double) used / total : 0.0);
+}
+
+/** @} */
+
+/**
+ * \brief Initializes bindings to SDL_render.h
+ *
+ * Adds constants defined in SDL_render.h to module.
+ *
+ * \param module csdl2 module object
+ * \returns 1 on success, 0 if an exception occurred.
+ */
+static int
 PyCSDL2_initrender(PyObject *module)
 {
     static const PyCSDL2_Constant constants[] = {
@@ -2732,6 +4956,12 @@ PyCSDL2_initrender(PyObject *module)
 
     if (PyType_Ready(&PyCSDL2_TexturePixelsType)) { return 0; }
 
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_RenderListType) < 0)
+        return 0;
+
+    if (PyCSDL2_PyModuleAddType(module, &PyCSDL2_TextureAtlasType) < 0)
+        return 0;
+
     PyCSDL2_RendererDict = PyCSDL2_PtrMapCreate();
     if (!PyCSDL2_RendererDict)
         return 0;
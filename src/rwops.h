@@ -209,7 +209,11 @@ PyCSDL2_RWSizePyCall(SDL_RWops *ctx)
 
     Py_XINCREF(rwops_obj);
 
-    if (!PyCSDL2_RWopsValid(rwops_obj))
+    /*
+     * SDL may carry on calling back after an earlier callback raised while
+     * the GIL was released. Keep the first exception.
+     */
+    if (PyErr_Occurred() || !PyCSDL2_RWopsValid(rwops_obj))
         goto finish;
 
     callback = PyCSDL2_Get(rwops_obj->size);
@@ -245,7 +249,8 @@ PyCSDL2_RWSeekPyCall(SDL_RWops *ctx, Sint64 offset, int whence)
 
     Py_XINCREF(rwops_obj);
 
-    if (!PyCSDL2_RWopsValid(rwops_obj))
+    /* Keep the exception of an earlier callback, as above */
+    if (PyErr_Occurred() || !PyCSDL2_RWopsValid(rwops_obj))
         goto finish;
 
     callback = PyCSDL2_Get(rwops_obj->seek);
@@ -282,7 +287,8 @@ PyCSDL2_RWReadPyCall(SDL_RWops *ctx, void *ptr, size_t size, size_t maxnum)
 
     Py_XINCREF(rwops_obj);
 
-    if (!PyCSDL2_RWopsValid(rwops_obj))
+    /* Keep the exception of an earlier callback, as above */
+    if (PyErr_Occurred() || !PyCSDL2_RWopsValid(rwops_obj))
         goto finish;
 
     callback = PyCSDL2_Get(rwops_obj->read);
@@ -328,7 +334,8 @@ PyCSDL2_RWWritePyCall(SDL_RWops *ctx, const void *ptr, size_t size, size_t num)
 
     Py_XINCREF(rwops_obj);
 
-    if (!PyCSDL2_RWopsValid(rwops_obj))
+    /* Keep the exception of an earlier callback, as above */
+    if (PyErr_Occurred() || !PyCSDL2_RWopsValid(rwops_obj))
         goto finish;
 
     callback = PyCSDL2_Get(rwops_obj->write);
@@ -27,6 +27,14 @@
 #define _PYCSDL2_UTIL_H_
 #include <Python.h>
 #include <structmember.h>
+#ifdef __WIN32__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "../include/pycsdl2.h"
 
 #if SIZEOF_SHORT == 2 || defined(DOXYGEN)
@@ -813,6 +821,31 @@ PyCSDL2_RaiseBufferSizeError(const char *arg, Py_ssize_t expected,
                         arg ? ": " : "", expected, actual);
 }
 
+/**
+ * \brief Converter for an optional readonly C-contiguous buffer.
+ *
+ * If object is None, view->buf is set to NULL. Otherwise the buffer is
+ * requested with its format, so that view->format and view->itemsize are
+ * filled in. The caller checks the size of the buffer.
+ */
+static int
+PyCSDL2_ConvertBufferRead(PyObject *object, Py_buffer *view)
+{
+    if (!object) {
+        PyBuffer_Release(view);
+        return 1;
+    }
+    if (object == Py_None) {
+        view->obj = NULL;
+        view->buf = NULL;
+        view->len = 0;
+        return 1;
+    }
+    if (PyObject_GetBuffer(object, view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS))
+        return 0;
+    return Py_CLEANUP_SUPPORTED;
+}
+
 /**
  * \brief Set "invalid type" exception.
  *
@@ -1104,13 +1137,42 @@ static PyMappingMethods PyCSDL2_BufferAsMapping = {
     /* mp_ass_subscript */ (objobjargproc) PyCSDL2_BufferSetItem
 };
 
-/** \brief Type definition for csdl2.SDL_SurfacePixels */
+/** \brief Traversal function for PyCSDL2_BufferType */
+static int
+PyCSDL2_BufferTraverse(PyCSDL2_Buffer *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->obj);
+    return 0;
+}
+
+/** \brief Clear function for PyCSDL2_BufferType */
+static int
+PyCSDL2_BufferClear(PyCSDL2_Buffer *self)
+{
+    Py_CLEAR(self->obj);
+    return 0;
+}
+
+/**
+ * \brief Destructor for PyCSDL2_BufferType
+ *
+ * Releases the reference to the object managing the buffer.
+ */
+static void
+PyCSDL2_BufferDealloc(PyCSDL2_Buffer *self)
+{
+    PyObject_GC_UnTrack(self);
+    PyCSDL2_BufferClear(self);
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+/** \brief Type definition for csdl2.SDL_Buffer */
 static PyTypeObject PyCSDL2_BufferType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     /* tp_name           */ "csdl2.SDL_Buffer",
     /* tp_basicsize      */ sizeof(PyCSDL2_Buffer),
     /* tp_itemsize       */ 0,
-    /* tp_dealloc        */ 0,
+    /* tp_dealloc        */ (destructor) PyCSDL2_BufferDealloc,
     /* tp_print          */ 0,
     /* tp_getattr        */ 0,
     /* tp_setattr        */ 0,
@@ -1125,8 +1187,10 @@ static PyTypeObject PyCSDL2_BufferType = {
     /* tp_getattro       */ 0,
     /* tp_setattro       */ 0,
     /* tp_as_buffer      */ &PyCSDL2_BufferAsBuffer,
-    /* tp_flags          */ Py_TPFLAGS_DEFAULT,
-    /* tp_doc            */ "Temporary buffer"
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */ "Temporary buffer",
+    /* tp_traverse       */ (traverseproc) PyCSDL2_BufferTraverse,
+    /* tp_clear          */ (inquiry) PyCSDL2_BufferClear
 };
 
 /**
@@ -1267,6 +1331,218 @@ PyCSDL2_VoidPtrCheckPtr(PyObject *obj, void *ptr)
     return 1;
 }
 
+/**
+ * \brief Checks if obj is an instance of a ctypes pointer type.
+ *
+ * Instances of ctypes function pointers, pointers and c_void_p are supported.
+ * ctypes is not imported if it has not been imported already, since obj can
+ * then not be a ctypes object.
+ *
+ * \returns 1 if obj is a ctypes pointer, 0 if not, -1 if an exception
+ *          occurred.
+ */
+static int
+PyCSDL2_CTypesPtrCheck(PyObject *obj)
+{
+    PyObject *ctypes, *type;
+    int ret;
+
+    ctypes = PyDict_GetItemString(PyImport_GetModuleDict(), "_ctypes");
+    if (!ctypes)
+        return 0;
+
+    type = PyObject_GetAttrString(ctypes, "CFuncPtr");
+    if (!type)
+        return -1;
+    ret = PyObject_IsInstance(obj, type);
+    Py_DECREF(type);
+    if (ret)
+        return ret;
+
+    type = PyObject_GetAttrString(ctypes, "_Pointer");
+    if (!type)
+        return -1;
+    ret = PyObject_IsInstance(obj, type);
+    Py_DECREF(type);
+    if (ret)
+        return ret;
+
+    type = PyObject_GetAttrString(ctypes, "_SimpleCData");
+    if (!type)
+        return -1;
+    ret = PyObject_IsInstance(obj, type);
+    Py_DECREF(type);
+    if (ret <= 0)
+        return ret;
+
+    type = PyObject_GetAttrString((PyObject*) Py_TYPE(obj), "_type_");
+    if (!type)
+        return -1;
+    ret = PyUnicode_Check(type) &&
+          !PyUnicode_CompareWithASCIIString(type, "P");
+    Py_DECREF(type);
+    return ret;
+}
+
+/**
+ * \brief Extracts the address held by a foreign pointer object.
+ *
+ * The supported foreign pointer objects are PyCapsule, PyCSDL2_VoidPtr, and
+ * ctypes function pointers, pointers and c_void_p.
+ *
+ * \param obj The object to extract the address from.
+ * \param name The name a PyCapsule must have, or NULL to accept any name.
+ * \param[out] out Output pointer.
+ * \returns 1 if obj is a foreign pointer object, 0 if it is not, -1 if an
+ *          exception occurred.
+ */
+static int
+PyCSDL2_ForeignPtr(PyObject *obj, const char *name, void **out)
+{
+    Py_buffer view;
+    int ret;
+
+    if (!PyCSDL2_Assert(obj) || !PyCSDL2_Assert(out))
+        return -1;
+
+    if (PyCapsule_CheckExact(obj)) {
+        if (!name)
+            name = PyCapsule_GetName(obj);
+        else if (!PyCapsule_IsValid(obj, name)) {
+            PyErr_Format(PyExc_TypeError, "capsule must be named \"%s\"",
+                         name);
+            return -1;
+        }
+        *out = PyCapsule_GetPointer(obj, name);
+        return *out ? 1 : -1;
+    }
+
+    if (Py_TYPE(obj) == &PyCSDL2_VoidPtrType) {
+        *out = ((PyCSDL2_VoidPtr*)obj)->ptr;
+        return 1;
+    }
+
+    ret = PyCSDL2_CTypesPtrCheck(obj);
+    if (ret <= 0)
+        return ret;
+
+    /* ctypes objects export the memory which holds the pointer value. */
+    if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE))
+        return -1;
+
+    if (view.len != sizeof(void*)) {
+        PyBuffer_Release(&view);
+        PyCSDL2_RaiseBufferSizeError(NULL, sizeof(void*), view.len);
+        return -1;
+    }
+
+    memcpy(out, view.buf, sizeof(void*));
+    PyBuffer_Release(&view);
+    return 1;
+}
+
+/** @} */
+
+/**
+ * \defgroup csdl2_FileMapping Read-only file mappings
+ *
+ * @{
+ */
+
+/** \brief A read-only mapping of a whole file */
+typedef struct PyCSDL2_FileMapping {
+    /** \brief Start of the mapping, or NULL if nothing is mapped */
+    Uint8 *base;
+    /** \brief Size of the mapping in bytes */
+    size_t size;
+#ifdef __WIN32__
+    /** \brief File mapping object */
+    HANDLE handle;
+#endif
+} PyCSDL2_FileMapping;
+
+/**
+ * \brief Releases a mapping created with PyCSDL2_MapFile().
+ */
+static void
+PyCSDL2_UnmapFile(PyCSDL2_FileMapping *map)
+{
+    if (!map->base)
+        return;
+#ifdef __WIN32__
+    UnmapViewOfFile(map->base);
+    CloseHandle(map->handle);
+#else
+    munmap(map->base, map->size);
+#endif
+    map->base = NULL;
+    map->size = 0;
+}
+
+/**
+ * \brief Maps the whole file at path read-only into memory.
+ *
+ * Empty files cannot be mapped. May be called without holding the GIL.
+ *
+ * \returns 0 on success, -1 with the SDL error set if the file could not be
+ *          mapped.
+ */
+static int
+PyCSDL2_MapFile(const char *path, PyCSDL2_FileMapping *map)
+{
+#ifdef __WIN32__
+    HANDLE file;
+    LARGE_INTEGER size;
+
+    map->base = NULL;
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                       NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return SDL_SetError("Couldn't open %s", path);
+
+    if (!GetFileSizeEx(file, &size) ||
+        (Uint64) size.QuadPart > (size_t) -1) {
+        CloseHandle(file);
+        return SDL_SetError("Couldn't map %s", path);
+    }
+
+    map->handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!map->handle)
+        return SDL_SetError("Couldn't map %s", path);
+
+    map->base = MapViewOfFile(map->handle, FILE_MAP_READ, 0, 0, 0);
+    if (!map->base) {
+        CloseHandle(map->handle);
+        return SDL_SetError("Couldn't map %s", path);
+    }
+    map->size = (size_t) size.QuadPart;
+#else
+    int fd;
+    struct stat st;
+    void *base;
+
+    map->base = NULL;
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return SDL_SetError("Couldn't open %s", path);
+
+    if (fstat(fd, &st) || (Uint64) st.st_size > (size_t) -1) {
+        close(fd);
+        return SDL_SetError("Couldn't map %s", path);
+    }
+
+    base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return SDL_SetError("Couldn't map %s", path);
+
+    map->base = base;
+    map->size = (size_t) st.st_size;
+#endif
+    return 0;
+}
+
 /** @} */
 
 /**
@@ -0,0 +1,214 @@
+"""benchmark the audio callback paths on SDL's disk or dummy audio driver
+
+Run from the repository root after building csdl2 in place::
+
+    python3 -m test.bench_audio [--driver disk|dummy] [--seconds N]
+
+Opens a playback device for each way of feeding it (a Python callback, an
+SDL_AudioRingBuffer, an SDL_AudioMixer and an SDL_AudioResampler), renders N
+seconds of audio through it, and prints the results as JSON.
+
+The disk driver needs no sound card. It is run without its write delay, so it
+calls the audio callback as fast as it can and the measurements show the cost
+of the callback path. The dummy driver calls the callback in real time, so it
+shows the cost of playing N seconds of audio.
+
+For each path, reports:
+
+* ``callbacks_per_sec``: Audio callbacks per second of wall time.
+* ``cpu_per_audio_sec``: CPU seconds used by the process for each second of
+  audio.
+* ``gil_wait_max_us``, ``call_max_us``: The longest time spent waiting for the
+  GIL and in the callback, in microseconds. Native paths never take the GIL,
+  so their GIL wait is always 0.
+* ``call_p99_us``: The 99th percentile time spent in the callback, in
+  microseconds.
+"""
+import argparse
+import distutils.util
+import json
+import math
+import os
+import os.path
+import sys
+import tempfile
+import time
+
+
+if __name__ == '__main__':
+    plat_specifier = 'lib.{0}-{1}'.format(distutils.util.get_platform(),
+                                          sys.version[0:3])
+    tests_dir = os.path.dirname(os.path.abspath(__file__))
+    sys.path.insert(0, os.path.join(tests_dir, '..', 'build', plat_specifier))
+
+
+from csdl2 import *  # noqa
+
+
+CHANNELS = 2
+FRAME_SIZE = 2 * CHANNELS
+
+
+def tone(freq, rate, frames):
+    "Returns `frames` stereo S16 frames of a sine wave"
+    samples = bytearray(frames * FRAME_SIZE)
+    view = memoryview(samples).cast('h')
+    for i in range(frames):
+        x = int(8000 * math.sin(2 * math.pi * freq * i / rate))
+        view[2 * i] = view[2 * i + 1] = x
+    return samples
+
+
+def pow2(x):
+    "Returns the next power of two which is at least `x`"
+    return 1 << (x - 1).bit_length()
+
+
+def python_path(args):
+    "Fills the buffer from a Python callback"
+    data = bytes(tone(440, args.freq, args.freq))
+
+    def callback(userdata, stream, length):
+        pos = callback.pos
+        if pos + length > len(data):
+            pos = 0
+        memoryview(stream)[:] = data[pos:pos + length]
+        callback.pos = pos + length
+    callback.pos = 0
+    return callback, []
+
+
+def ring_path(args):
+    "Copies the buffer out of an SDL_AudioRingBuffer filled up front"
+    frames = int(args.freq * args.seconds) + 2 * args.samples
+    ring = SDL_AudioRingBuffer(pow2(frames * FRAME_SIZE))
+    SDL_AudioRingBufferWrite(ring, tone(440, args.freq, frames))
+    return ring, [ring]
+
+
+def mixer_path(args):
+    "Mixes looping voices with an SDL_AudioMixer"
+    mixer = SDL_AudioMixer(args.voices, AUDIO_S16SYS, CHANNELS)
+    data = tone(440, args.freq, args.freq)
+    for i in range(args.voices):
+        SDL_AudioMixerPlay(mixer, i, data, gain=1 / args.voices, loop=True)
+    return mixer, [data]
+
+
+def resampler_path(args):
+    "Resamples from 44100 Hz with an SDL_AudioResampler"
+    src_rate = 44100
+    frames = int(src_rate * args.seconds) + 2 * args.samples + 256
+    ring = SDL_AudioRingBuffer(pow2(frames * FRAME_SIZE))
+    SDL_AudioRingBufferWrite(ring, tone(440, src_rate, frames))
+    rs = SDL_AudioResampler(src_rate, args.freq, CHANNELS, AUDIO_S16SYS,
+                            source=ring)
+    return rs, [ring]
+
+
+paths = [('python', python_path), ('ring', ring_path),
+         ('mixer', mixer_path), ('resampler', resampler_path)]
+
+
+def bench(path, args, outfile):
+    "Renders args.seconds of audio through the path and returns the results"
+    callback, keepalive = path(args)
+    spec = SDL_AudioSpec(freq=args.freq, format=AUDIO_S16SYS,
+                         channels=CHANNELS, samples=args.samples,
+                         callback=callback)
+    dev = SDL_OpenAudioDevice(None, False, spec, None, 0)
+    chunk = spec.samples * FRAME_SIZE
+    target = int(args.freq * args.seconds) * FRAME_SIZE
+    # A paused device still writes silence to the output file, so only count
+    # what was written while it was playing. Changing the pause state with the
+    # device locked keeps the audio thread from filling a buffer meanwhile.
+    SDL_LockAudioDevice(dev)
+    SDL_PauseAudioDevice(dev, False)
+    start_size = os.path.getsize(outfile) if args.driver == 'disk' else 0
+    start_cpu = time.process_time()
+    start = time.perf_counter()
+    SDL_UnlockAudioDevice(dev)
+    if args.driver == 'disk':
+        # The disk driver writes every buffer to the output file
+        while os.path.getsize(outfile) - start_size < target:
+            time.sleep(0.001)
+    else:
+        time.sleep(args.seconds)
+    SDL_LockAudioDevice(dev)
+    SDL_PauseAudioDevice(dev, True)
+    elapsed = time.perf_counter() - start
+    cpu = time.process_time() - start_cpu
+    end_size = os.path.getsize(outfile) if args.driver == 'disk' else 0
+    SDL_UnlockAudioDevice(dev)
+    stats = SDL_GetAudioDeviceStats(dev)
+    SDL_CloseAudioDevice(dev)
+
+    if args.driver == 'disk':
+        callbacks = (end_size - start_size) // chunk
+        audio_seconds = callbacks * spec.samples / spec.freq
+    else:
+        callbacks = stats['callbacks']
+        audio_seconds = elapsed
+    return {
+        'callbacks': callbacks,
+        'audio_seconds': audio_seconds,
+        'wall_seconds': elapsed,
+        'callbacks_per_sec': callbacks / elapsed,
+        'cpu_per_audio_sec': cpu / audio_seconds,
+        'gil_wait_max_us': stats['gil_wait_max'],
+        'call_max_us': stats['call_max'],
+        'call_p99_us': stats['call_p99'],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--driver', choices=('disk', 'dummy'),
+                        default='disk', help='SDL audio driver to use')
+    parser.add_argument('--seconds', type=float, default=10.0,
+                        help='seconds of audio rendered for each path')
+    parser.add_argument('--freq', type=int, default=48000,
+                        help='output sample rate')
+    parser.add_argument('--samples', type=int, default=1024,
+                        help='audio buffer size in sample frames')
+    parser.add_argument('--voices', type=int, default=8,
+                        help='voices played by the mixer')
+    parser.add_argument('--output', help='write the JSON to this file')
+    args = parser.parse_args()
+
+    fd, outfile = tempfile.mkstemp(suffix='.raw')
+    os.close(fd)
+    os.environ['SDL_DISKAUDIOFILE'] = outfile
+    os.environ['SDL_DISKAUDIODELAY'] = '0'
+    os.environ['SDL_AUDIODRIVER'] = args.driver
+    results = {}
+    try:
+        SDL_InitSubSystem(SDL_INIT_AUDIO)
+        try:
+            for name, path in paths:
+                # The disk driver truncates the file when opening the device
+                results[name] = bench(path, args, outfile)
+        finally:
+            SDL_QuitSubSystem(SDL_INIT_AUDIO)
+    finally:
+        os.remove(outfile)
+
+    report = {
+        'driver': args.driver,
+        'freq': args.freq,
+        'samples': args.samples,
+        'channels': CHANNELS,
+        'format': 'AUDIO_S16SYS',
+        'seconds': args.seconds,
+        'paths': results,
+    }
+    text = json.dumps(report, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text + '\n')
+    else:
+        print(text)
+
+
+if __name__ == '__main__':
+    main()
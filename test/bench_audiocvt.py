@@ -0,0 +1,86 @@
+"""benchmark SDL_ConvertAudio() fast paths against SDL's scalar converters
+
+Run from the repository root after building csdl2 in place::
+
+    python3 -m test.bench_audiocvt [--seconds N] [--threads N]
+
+For each conversion, prints the throughput in MB of source data per second
+when using SDL's own converters (PYCSDL2_AUDIOCVT_SIMD=none), the SSE2 and
+AVX2 kernels, and the AVX2 kernels split across threads.
+"""
+import argparse
+import distutils.util
+import os
+import os.path
+import sys
+import time
+
+
+if __name__ == '__main__':
+    plat_specifier = 'lib.{0}-{1}'.format(distutils.util.get_platform(),
+                                          sys.version[0:3])
+    tests_dir = os.path.dirname(os.path.abspath(__file__))
+    sys.path.insert(0, os.path.join(tests_dir, '..', 'build', plat_specifier))
+
+
+from csdl2 import *  # noqa
+
+
+conversions = [
+    ('S16 -> F32', AUDIO_S16SYS, 2, AUDIO_F32SYS, 2),
+    ('F32 -> S16', AUDIO_F32SYS, 2, AUDIO_S16SYS, 2),
+    ('U8 -> S16', AUDIO_U8, 2, AUDIO_S16SYS, 2),
+    ('S16 -> U8', AUDIO_S16SYS, 2, AUDIO_U8, 2),
+    ('S16LSB -> S16MSB', AUDIO_S16LSB, 2, AUDIO_S16MSB, 2),
+    ('S16 mono -> stereo', AUDIO_S16SYS, 1, AUDIO_S16SYS, 2),
+    ('S16 stereo -> mono', AUDIO_S16SYS, 2, AUDIO_S16SYS, 1),
+    ('S16 mono -> F32 stereo', AUDIO_S16SYS, 1, AUDIO_F32SYS, 2),
+]
+
+
+def bench(conversion, size, simd, threads, seconds):
+    "Returns the conversion throughput in MB/s"
+    name, src_format, src_channels, dst_format, dst_channels = conversion
+    os.environ['PYCSDL2_AUDIOCVT_SIMD'] = simd
+    os.environ['PYCSDL2_AUDIOCVT_THREADS'] = str(threads)
+    cvt = SDL_AudioCVT()
+    SDL_BuildAudioCVT(cvt, src_format, src_channels, 44100,
+                      dst_format, dst_channels, 44100)
+    buf = bytearray(size * cvt.len_mult)
+    runs = 0
+    start = time.perf_counter()
+    while True:
+        # Converting in place changes the data, but not the amount of work
+        cvt.len = size
+        cvt.buf = buf
+        SDL_ConvertAudio(cvt)
+        runs += 1
+        elapsed = time.perf_counter() - start
+        if elapsed >= seconds:
+            return size * runs / elapsed / 1e6
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--size', type=int, default=16 * 1024 * 1024,
+                        help='source buffer size in bytes')
+    parser.add_argument('--seconds', type=float, default=0.5,
+                        help='time spent on each measurement')
+    parser.add_argument('--threads', type=int, default=4,
+                        help='threads for the threaded measurement')
+    args = parser.parse_args()
+
+    columns = [('scalar', 'none', 1), ('sse2', 'sse2', 1),
+               ('avx2', 'avx2', 1),
+               ('avx2 x{0}'.format(args.threads), 'avx2', args.threads)]
+    print('{0:24}'.format('MB/s') +
+          ''.join('{0:>12}'.format(c[0]) for c in columns))
+    for conversion in conversions:
+        results = [bench(conversion, args.size, simd, threads, args.seconds)
+                   for _, simd, threads in columns]
+        print('{0:24}'.format(conversion[0]) +
+              ''.join('{0:12.1f}'.format(x) for x in results))
+
+
+if __name__ == '__main__':
+    main()
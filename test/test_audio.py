@@ -7,6 +7,13 @@ import threading
 import struct
 import io
 import tempfile
+import array
+import time
+import ctypes
+import random
+import math
+import gc
+import weakref
 
 
 tests_dir = os.path.dirname(os.path.abspath(__file__))
@@ -373,6 +380,106 @@ class TestAudioDevice(unittest.TestCase):
         self.assertRaises(TypeError, type, 'testtype', (SDL_AudioDevice,), {})
 
 
+class TestAudioRingBuffer(unittest.TestCase):
+    """Tests SDL_AudioRingBuffer class"""
+
+    def test_size_rounded(self):
+        "size is rounded up to the next power of two"
+        self.assertEqual(SDL_AudioRingBuffer(1000).size, 1024)
+        self.assertEqual(SDL_AudioRingBuffer(4096).size, 4096)
+
+    def test_invalid_size(self):
+        "Raises ValueError on invalid size"
+        self.assertRaises(ValueError, SDL_AudioRingBuffer, 0)
+        self.assertRaises(ValueError, SDL_AudioRingBuffer, 2**31)
+
+    def test_initial(self):
+        "Is initially empty"
+        x = SDL_AudioRingBuffer(16)
+        self.assertEqual(x.queued, 0)
+        self.assertEqual(x.underruns, 0)
+        self.assertEqual(x.overruns, 0)
+        self.assertEqual(x.high_water, 0)
+
+    def test_readonly(self):
+        "Attributes are readonly"
+        x = SDL_AudioRingBuffer(16)
+        self.assertRaises(AttributeError, setattr, x, 'size', 32)
+        self.assertRaises(AttributeError, setattr, x, 'queued', 1)
+        self.assertRaises(AttributeError, setattr, x, 'underruns', 1)
+        self.assertRaises(AttributeError, setattr, x, 'overruns', 1)
+        self.assertRaises(AttributeError, setattr, x, 'high_water', 1)
+
+
+class TestAudioMixer(unittest.TestCase):
+    """Tests SDL_AudioMixer class"""
+
+    def test_defaults(self):
+        "Defaults to stereo AUDIO_S16SYS"
+        x = SDL_AudioMixer(8)
+        self.assertEqual(x.voices, 8)
+        self.assertEqual(x.format, AUDIO_S16SYS)
+        self.assertEqual(x.channels, 2)
+
+    def test_invalid(self):
+        "Raises ValueError on invalid arguments"
+        self.assertRaises(ValueError, SDL_AudioMixer, 0)
+        self.assertRaises(ValueError, SDL_AudioMixer, 8, AUDIO_U8)
+        self.assertRaises(ValueError, SDL_AudioMixer, 8, AUDIO_S16SYS, 6)
+
+    def test_readonly(self):
+        "Attributes are readonly"
+        x = SDL_AudioMixer(8)
+        self.assertRaises(AttributeError, setattr, x, 'voices', 1)
+        self.assertRaises(AttributeError, setattr, x, 'format', AUDIO_U8)
+        self.assertRaises(AttributeError, setattr, x, 'channels', 1)
+
+
+class TestAudioResampler(unittest.TestCase):
+    """Tests SDL_AudioResampler class"""
+
+    def test_defaults(self):
+        "Defaults to AUDIO_F32SYS and 32 taps without a source"
+        x = SDL_AudioResampler(44100, 48000, 2)
+        self.assertEqual(x.src_rate, 44100)
+        self.assertEqual(x.dst_rate, 48000)
+        self.assertEqual(x.channels, 2)
+        self.assertEqual(x.format, AUDIO_F32SYS)
+        self.assertEqual(x.taps, 32)
+        self.assertIs(x.source, None)
+
+    def test_source(self):
+        "source can be a SDL_AudioRingBuffer"
+        ring = SDL_AudioRingBuffer(1024)
+        x = SDL_AudioResampler(44100, 48000, 2, source=ring)
+        self.assertIs(x.source, ring)
+        self.assertRaises(TypeError, SDL_AudioResampler, 44100, 48000, 2,
+                          source=bytearray(4))
+
+    def test_decimation_taps(self):
+        "The filter is widened when decimating"
+        x = SDL_AudioResampler(48000, 8000, 1, taps=32)
+        self.assertEqual(x.taps, 192)
+
+    def test_invalid(self):
+        "Raises ValueError on invalid arguments"
+        self.assertRaises(ValueError, SDL_AudioResampler, 0, 48000, 2)
+        self.assertRaises(ValueError, SDL_AudioResampler, 44100, -1, 2)
+        self.assertRaises(ValueError, SDL_AudioResampler, 44100, 48000, 0)
+        self.assertRaises(ValueError, SDL_AudioResampler, 44100, 48000, 9)
+        self.assertRaises(ValueError, SDL_AudioResampler, 44100, 48000, 2,
+                          AUDIO_U8)
+        self.assertRaises(ValueError, SDL_AudioResampler, 44100, 48000, 2,
+                          taps=4)
+
+    def test_readonly(self):
+        "Attributes are readonly"
+        x = SDL_AudioResampler(44100, 48000, 2)
+        self.assertRaises(AttributeError, setattr, x, 'src_rate', 1)
+        self.assertRaises(AttributeError, setattr, x, 'taps', 8)
+        self.assertRaises(AttributeError, setattr, x, 'source', None)
+
+
 class TestAUDIO_BITSIZE(unittest.TestCase):
     "Tests SDL_AUDIO_BITSIZE()"
 
@@ -557,6 +664,25 @@ class TestOpenAudio(unittest.TestCase):
         # invalidated.
         self.assertRaises(ValueError, len, self.data)
 
+    def test_reopen(self):
+        "The same desired spec can be used after closing the device"
+        SDL_OpenAudio(self.desired, self.obtained)
+        SDL_CloseAudio()
+        SDL_OpenAudio(self.desired, self.obtained)
+        SDL_PauseAudio(False)
+        with self.cv:
+            self.cv.wait_for(lambda: self.called, 3)
+        self.assertIs(self.called, True)
+        SDL_CloseAudio()
+        self.called = None
+        dev = SDL_OpenAudioDevice(None, False, self.desired, self.obtained,
+                                  0)
+        SDL_PauseAudioDevice(dev, False)
+        with self.cv:
+            self.cv.wait_for(lambda: self.called, 3)
+        self.assertIs(self.called, True)
+        SDL_CloseAudioDevice(dev)
+
 
 class TestGetNumAudioDevices(unittest.TestCase):
     "Tests SDL_GetNumAudioDevices()"
@@ -649,6 +775,595 @@ class TestOpenAudioDevice(unittest.TestCase):
         self.assertRaises(ValueError, len, self.data)
 
 
+class TestAudioRingBufferWrite(unittest.TestCase):
+    "Tests SDL_AudioRingBufferWrite()"
+
+    def setUp(self):
+        self.ring = SDL_AudioRingBuffer(16)
+
+    def test_returns_written(self):
+        "Returns the number of bytes written"
+        self.assertEqual(SDL_AudioRingBufferWrite(self.ring, b'1234'), 4)
+        self.assertEqual(self.ring.queued, 4)
+
+    def test_partial(self):
+        "Only writes as much as there is free space"
+        self.assertEqual(SDL_AudioRingBufferWrite(self.ring, bytes(10)), 10)
+        self.assertEqual(SDL_AudioRingBufferWrite(self.ring, bytes(10)), 6)
+        self.assertEqual(SDL_AudioRingBufferWrite(self.ring, bytes(10)), 0)
+        self.assertEqual(self.ring.queued, 16)
+
+    def test_buffer(self):
+        "Accepts any buffer object"
+        data = array.array('h', [1, 2, 3])
+        self.assertEqual(SDL_AudioRingBufferWrite(self.ring, data), 6)
+
+    def test_invalid_type(self):
+        "Raises TypeError on invalid type"
+        self.assertRaises(TypeError, SDL_AudioRingBufferWrite, None, b'')
+        self.assertRaises(TypeError, SDL_AudioRingBufferWrite, self.ring, 42)
+
+
+class TestAudioRingBufferPeek(unittest.TestCase):
+    """Tests SDL_AudioRingBufferPeek() and SDL_AudioRingBufferConsume()"""
+
+    def setUp(self):
+        self.ring = SDL_AudioRingBuffer(16)
+
+    def peek(self):
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        return bytes(a), bytes(b)
+
+    def test_empty(self):
+        "Returns two empty memoryviews when nothing is queued"
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        self.assertIs(type(a), memoryview)
+        self.assertIs(type(b), memoryview)
+        self.assertEqual(len(a), 0)
+        self.assertEqual(len(b), 0)
+
+    def test_peek(self):
+        "Returns the queued data without consuming it"
+        SDL_AudioRingBufferWrite(self.ring, b'abcdef')
+        self.assertEqual(self.peek(), (b'abcdef', b''))
+        self.assertEqual(self.ring.queued, 6)
+
+    def test_wrap(self):
+        "Data which wraps around is split across the two views"
+        SDL_AudioRingBufferWrite(self.ring, bytes(12))
+        SDL_AudioRingBufferConsume(self.ring, 12)
+        SDL_AudioRingBufferWrite(self.ring, b'0123456789')
+        self.assertEqual(self.peek(), (b'0123', b'456789'))
+
+    def test_readonly(self):
+        "The views are read-only"
+        SDL_AudioRingBufferWrite(self.ring, b'abcd')
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        self.assertTrue(a.readonly)
+        self.assertTrue(b.readonly)
+
+    def test_released_on_consume(self):
+        "SDL_AudioRingBufferConsume() releases the views"
+        SDL_AudioRingBufferWrite(self.ring, b'abcd')
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        c, d = SDL_AudioRingBufferPeek(self.ring)
+        SDL_AudioRingBufferConsume(self.ring, 2)
+        for x in (a, b, c, d):
+            self.assertRaises(ValueError, bytes, x)
+        self.assertEqual(self.peek(), (b'cd', b''))
+
+    def test_consume_exported(self):
+        "Raises BufferError if the data is still exported"
+        SDL_AudioRingBufferWrite(self.ring, b'abcd')
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        s = a[1:]
+        self.assertRaises(BufferError, SDL_AudioRingBufferConsume, self.ring,
+                          4)
+        self.assertEqual(self.ring.queued, 4)
+        self.assertEqual(bytes(s), b'bcd')
+        s.release()
+        SDL_AudioRingBufferConsume(self.ring, 4)
+        self.assertEqual(self.ring.queued, 0)
+
+    def test_keeps_ring_alive(self):
+        "The views keep the ring buffer alive"
+        SDL_AudioRingBufferWrite(self.ring, b'abcd')
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        del self.ring
+        self.assertEqual(bytes(a), b'abcd')
+
+    def test_gc(self):
+        "The ring buffer is collected once the views are gone"
+        SDL_AudioRingBufferWrite(self.ring, b'abcd')
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        ref = weakref.ref(self.ring)
+        del self.ring, a, b
+        gc.collect()
+        self.assertIsNone(ref())
+
+    def test_consume(self):
+        "SDL_AudioRingBufferConsume() removes data from the front"
+        SDL_AudioRingBufferWrite(self.ring, b'abcdef')
+        self.assertIs(SDL_AudioRingBufferConsume(self.ring, 2), None)
+        self.assertEqual(self.ring.queued, 4)
+        self.assertEqual(self.peek(), (b'cdef', b''))
+
+    def test_consume_too_much(self):
+        "Raises ValueError when consuming more than is queued"
+        SDL_AudioRingBufferWrite(self.ring, b'abc')
+        self.assertRaises(ValueError, SDL_AudioRingBufferConsume, self.ring,
+                          4)
+
+
+class TestAudioRingBufferCapture(unittest.TestCase):
+    """Tests filling a SDL_AudioRingBuffer from the capture callback"""
+
+    def setUp(self):
+        self.ring = SDL_AudioRingBuffer(16)
+
+    def test_capture(self):
+        "Captured data is queued"
+        _csdl2test.audio_ring_capture(self.ring, b'abcd')
+        _csdl2test.audio_ring_capture(self.ring, b'efgh')
+        self.assertEqual(self.ring.queued, 8)
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        self.assertEqual(bytes(a), b'abcdefgh')
+        self.assertEqual(self.ring.overruns, 0)
+
+    def test_overruns(self):
+        "Data which does not fit is dropped and counted"
+        _csdl2test.audio_ring_capture(self.ring, bytes(range(12)))
+        _csdl2test.audio_ring_capture(self.ring, bytes(range(12, 24)))
+        self.assertEqual(self.ring.overruns, 1)
+        self.assertEqual(self.ring.queued, 16)
+        a, b = SDL_AudioRingBufferPeek(self.ring)
+        self.assertEqual(bytes(a), bytes(range(16)))
+
+    def test_high_water(self):
+        "high_water is the largest amount of data ever queued"
+        _csdl2test.audio_ring_capture(self.ring, bytes(10))
+        SDL_AudioRingBufferConsume(self.ring, 8)
+        _csdl2test.audio_ring_capture(self.ring, bytes(4))
+        self.assertEqual(self.ring.queued, 6)
+        self.assertEqual(self.ring.high_water, 10)
+
+
+class TestOpenAudioDeviceRingBuffer(unittest.TestCase):
+    """Tests SDL_OpenAudioDevice() with a SDL_AudioRingBuffer"""
+
+    @classmethod
+    def setUpClass(cls):
+        if not has_audio:
+            raise unittest.SkipTest('No audio support')
+
+    def setUp(self):
+        self.ring = SDL_AudioRingBuffer(65536)
+        self.desired = SDL_AudioSpec(freq=44100, format=AUDIO_S16SYS,
+                                     channels=1, samples=512,
+                                     callback=self.ring)
+
+    def wait_for(self, predicate, timeout=3):
+        deadline = time.monotonic() + timeout
+        while not predicate() and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+    def test_drains(self):
+        "Audio device drains the ring buffer"
+        SDL_AudioRingBufferWrite(self.ring, bytes(4096))
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        self.wait_for(lambda: self.ring.queued == 0)
+        self.assertEqual(self.ring.queued, 0)
+
+    def test_underruns(self):
+        "Underruns are counted when the ring buffer is empty"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        self.wait_for(lambda: self.ring.underruns > 0)
+        self.assertGreater(self.ring.underruns, 0)
+
+    def test_silence(self):
+        "silence is taken from the audio format"
+        self.desired.format = AUDIO_U8
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertEqual(self.ring.silence, 0x80)
+
+    def test_attached_once(self):
+        "Can only be attached to one audio device at a time"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+        SDL_CloseAudioDevice(dev)
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+
+    def test_capture(self):
+        "Can be used with capture devices"
+        try:
+            dev = SDL_OpenAudioDevice(None, True, self.desired, None, 0)
+        except RuntimeError:
+            # The driver has no capture support. The ring buffer must still
+            # be released.
+            dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        else:
+            self.assertRaises(ValueError, SDL_AudioRingBufferWrite,
+                              self.ring, bytes(4))
+            SDL_AudioRingBufferPeek(self.ring)
+
+    def test_playback_roles(self):
+        "Python cannot consume from a ring buffer played by a device"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertRaises(ValueError, SDL_AudioRingBufferPeek, self.ring)
+        self.assertRaises(ValueError, SDL_AudioRingBufferConsume, self.ring,
+                          0)
+
+    def test_callback(self):
+        "callback is still the ring buffer"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertIs(self.desired.callback, self.ring)
+
+
+class TestAudioMixerMix(unittest.TestCase):
+    "Tests SDL_AudioMixerMix() and the SDL_AudioMixer voice functions"
+
+    def setUp(self):
+        self.mixer = SDL_AudioMixer(4, AUDIO_S16SYS, 2)
+
+    def mix(self, frames):
+        out = array.array('h', bytes(frames * 4))
+        SDL_AudioMixerMix(self.mixer, out)
+        return out.tolist()
+
+    def test_silence(self):
+        "Outputs silence when no voices are playing"
+        self.assertEqual(self.mix(4), [0] * 8)
+
+    def test_play_mono(self):
+        "Mono voices are played on both channels"
+        data = array.array('h', [100, 200])
+        SDL_AudioMixerPlay(self.mixer, 0, data, channels=1)
+        self.assertEqual(self.mix(3), [100, 100, 200, 200, 0, 0])
+        self.assertFalse(SDL_AudioMixerIsPlaying(self.mixer, 0))
+
+    def test_sum(self):
+        "Voices are summed and clamped"
+        SDL_AudioMixerPlay(self.mixer, 0, array.array('h', [100, -100]))
+        SDL_AudioMixerPlay(self.mixer, 1, array.array('h', [20, 30000]))
+        SDL_AudioMixerPlay(self.mixer, 2, array.array('h', [0, 30000]))
+        self.assertEqual(self.mix(1), [120, 32767])
+
+    def test_gain_pan(self):
+        "gain and pan are applied"
+        data = array.array('h', [1000])
+        SDL_AudioMixerPlay(self.mixer, 0, data, channels=1, gain=0.5,
+                           pan=1.0)
+        self.assertEqual(self.mix(1), [0, 500])
+        SDL_AudioMixerPlay(self.mixer, 0, data, channels=1)
+        SDL_AudioMixerSetParams(self.mixer, 0, gain=1.0, pan=-0.5)
+        self.assertEqual(self.mix(1), [1000, 500])
+
+    def test_loop(self):
+        "Looping voices jump back to loop_start"
+        data = array.array('h', [1, 2, 3])
+        SDL_AudioMixerPlay(self.mixer, 0, data, channels=1, loop=True,
+                           loop_start=1)
+        self.assertEqual(self.mix(6)[::2], [1, 2, 3, 2, 3, 2])
+        self.assertTrue(SDL_AudioMixerIsPlaying(self.mixer, 0))
+
+    def test_stop(self):
+        "Stopped voices are silent"
+        data = array.array('h', [1] * 8)
+        SDL_AudioMixerPlay(self.mixer, 0, data, loop=True)
+        self.mix(1)
+        SDL_AudioMixerStop(self.mixer, 0)
+        self.assertEqual(self.mix(1), [0, 0])
+        self.assertFalse(SDL_AudioMixerIsPlaying(self.mixer, 0))
+
+    def test_buffer_released(self):
+        "Buffers are released once the voice stops using them"
+        data = bytearray(8)
+        SDL_AudioMixerPlay(self.mixer, 0, data)
+        self.assertRaises(BufferError, data.extend, b'1')
+        SDL_AudioMixerStop(self.mixer, 0)
+        self.mix(1)
+        SDL_AudioMixerIsPlaying(self.mixer, 0)
+        data.extend(b'1')
+
+    def test_float(self):
+        "Supports AUDIO_F32SYS"
+        mixer = SDL_AudioMixer(1, AUDIO_F32SYS, 1)
+        SDL_AudioMixerPlay(mixer, 0, array.array('f', [0.25, 2.0]))
+        out = array.array('f', bytes(8))
+        SDL_AudioMixerMix(mixer, out)
+        self.assertEqual(out.tolist(), [0.25, 1.0])
+
+    def test_invalid(self):
+        "Raises ValueError on invalid arguments"
+        data = bytes(8)
+        self.assertRaises(ValueError, SDL_AudioMixerPlay, self.mixer, 4, data)
+        self.assertRaises(ValueError, SDL_AudioMixerPlay, self.mixer, 0, data,
+                          pan=2.0)
+        self.assertRaises(ValueError, SDL_AudioMixerPlay, self.mixer, 0, data,
+                          loop=True, loop_start=2)
+        self.assertRaises(ValueError, SDL_AudioMixerStop, self.mixer, -1)
+
+    def test_unattached(self):
+        "Commands are applied at once without an audio device"
+        data = bytearray(8)
+        SDL_AudioMixerPlay(self.mixer, 0, data, loop=True)
+        self.assertTrue(SDL_AudioMixerIsPlaying(self.mixer, 0))
+        SDL_AudioMixerStop(self.mixer, 0)
+        self.assertFalse(SDL_AudioMixerIsPlaying(self.mixer, 0))
+        data.extend(b'1')
+        for i in range(1000):
+            SDL_AudioMixerSetParams(self.mixer, 0)
+
+
+class TestAudioResamplerProcess(unittest.TestCase):
+    "Tests SDL_AudioResamplerProcess() and SDL_AudioResamplerFlush()"
+
+    def sine(self, rate, frames, freq=1000.0):
+        return [math.sin(2 * math.pi * freq * i / rate) for i in range(frames)]
+
+    def resample(self, rs, data, chunks=()):
+        out = []
+        for n in chunks:
+            out.append(SDL_AudioResamplerProcess(rs, data[:n]))
+            data = data[n:]
+        out.append(SDL_AudioResamplerProcess(rs, data))
+        out.append(SDL_AudioResamplerFlush(rs))
+        return b''.join(out)
+
+    def test_length(self):
+        "Produces ceil(frames * dst_rate / src_rate) frames in total"
+        for src_rate, dst_rate in ((44100, 48000), (48000, 44100),
+                                   (22050, 48000), (48000, 8000)):
+            rs = SDL_AudioResampler(src_rate, dst_rate, 2)
+            out = self.resample(rs, bytes(8 * 1000))
+            self.assertEqual(len(out), 8 * math.ceil(1000 * dst_rate /
+                                                     src_rate))
+
+    def test_sine(self):
+        "A resampled sine wave stays within 1e-3 of the ideal one"
+        rs = SDL_AudioResampler(44100, 48000, 1)
+        data = array.array('f', self.sine(44100, 4410)).tobytes()
+        out = array.array('f', self.resample(rs, data))
+        expected = self.sine(48000, len(out))
+        for i in range(100, len(out) - 100):
+            self.assertAlmostEqual(out[i], expected[i], delta=1e-3)
+
+    def test_chunks(self):
+        "Output does not depend on how the input is split up"
+        data = array.array('f', self.sine(44100, 5000)).tobytes()
+        a = self.resample(SDL_AudioResampler(44100, 48000, 1), data)
+        b = self.resample(SDL_AudioResampler(44100, 48000, 1), data,
+                          (4, 28, 400, 4000))
+        self.assertEqual(a, b)
+
+    def test_s16(self):
+        "AUDIO_S16SYS data is resampled"
+        rs = SDL_AudioResampler(8000, 16000, 2, AUDIO_S16SYS)
+        data = array.array('h', [16384, -16384] * 400).tobytes()
+        out = array.array('h', self.resample(rs, data))
+        self.assertEqual(len(out), 1600)
+        self.assertEqual(out[800:804].tolist(), [16384, -16384] * 2)
+
+    def test_partial_frame(self):
+        "Raises ValueError if data contains a partial sample frame"
+        rs = SDL_AudioResampler(44100, 48000, 2)
+        self.assertRaises(ValueError, SDL_AudioResamplerProcess, rs,
+                          bytes(12))
+
+    def test_reset(self):
+        "SDL_AudioResamplerReset() discards the stream"
+        rs = SDL_AudioResampler(44100, 48000, 1)
+        data = array.array('f', self.sine(44100, 1000)).tobytes()
+        a = SDL_AudioResamplerProcess(rs, data)
+        SDL_AudioResamplerReset(rs)
+        self.assertEqual(SDL_AudioResamplerProcess(rs, data), a)
+
+
+class TestOpenAudioDeviceMixer(unittest.TestCase):
+    """Tests SDL_OpenAudioDevice() with a SDL_AudioMixer"""
+
+    @classmethod
+    def setUpClass(cls):
+        if not has_audio:
+            raise unittest.SkipTest('No audio support')
+
+    def setUp(self):
+        self.mixer = SDL_AudioMixer(4, AUDIO_S16SYS, 1)
+        self.desired = SDL_AudioSpec(freq=44100, format=AUDIO_S16SYS,
+                                     channels=1, samples=512,
+                                     callback=self.mixer)
+
+    def wait_for(self, predicate, timeout=3):
+        deadline = time.monotonic() + timeout
+        while not predicate() and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+    def test_commands(self):
+        "Audio device processes the commands"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        SDL_AudioMixerPlay(self.mixer, 0, bytes(2048), loop=True)
+        self.wait_for(lambda: SDL_AudioMixerIsPlaying(self.mixer, 0))
+        self.assertTrue(SDL_AudioMixerIsPlaying(self.mixer, 0))
+        SDL_AudioMixerStop(self.mixer, 0)
+        self.wait_for(lambda: not SDL_AudioMixerIsPlaying(self.mixer, 0))
+        self.assertFalse(SDL_AudioMixerIsPlaying(self.mixer, 0))
+
+    def test_queue_full(self):
+        "Raises RuntimeError when the command queue is full"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        with self.assertRaises(RuntimeError):
+            for i in range(1000):
+                SDL_AudioMixerSetParams(self.mixer, 0)
+        SDL_CloseAudioDevice(dev)
+        SDL_AudioMixerSetParams(self.mixer, 0)
+
+    def test_format_mismatch(self):
+        "Raises ValueError if the format does not match"
+        self.desired.channels = 2
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+    def test_mix_attached(self):
+        "SDL_AudioMixerMix() fails while attached"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertRaises(ValueError, SDL_AudioMixerMix, self.mixer,
+                          bytearray(4))
+        SDL_CloseAudioDevice(dev)
+        SDL_AudioMixerMix(self.mixer, bytearray(4))
+
+
+class TestOpenAudioDeviceResampler(unittest.TestCase):
+    """Tests SDL_OpenAudioDevice() with a SDL_AudioResampler"""
+
+    @classmethod
+    def setUpClass(cls):
+        if not has_audio:
+            raise unittest.SkipTest('No audio support')
+
+    def setUp(self):
+        self.ring = SDL_AudioRingBuffer(65536)
+        self.rs = SDL_AudioResampler(22050, 44100, 1, AUDIO_S16SYS,
+                                     source=self.ring)
+        self.desired = SDL_AudioSpec(freq=44100, format=AUDIO_S16SYS,
+                                     channels=1, samples=512,
+                                     callback=self.rs)
+
+    def wait_for(self, predicate, timeout=3):
+        deadline = time.monotonic() + timeout
+        while not predicate() and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+    def test_drains(self):
+        "Audio device drains the source ring buffer"
+        SDL_AudioRingBufferWrite(self.ring, bytes(4096))
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        self.wait_for(lambda: self.ring.queued == 0)
+        self.assertEqual(self.ring.queued, 0)
+
+    def test_claims_source(self):
+        "The source ring buffer cannot be used by another audio device"
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.desired.callback = self.ring
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+        self.assertRaises(ValueError, SDL_AudioResamplerProcess, self.rs,
+                          bytes(2))
+        SDL_CloseAudioDevice(dev)
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+
+    def test_no_source(self):
+        "Raises ValueError if the resampler has no source"
+        self.desired.callback = SDL_AudioResampler(22050, 44100, 1,
+                                                   AUDIO_S16SYS)
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+    def test_mismatch(self):
+        "Raises ValueError if the audio format does not match"
+        self.desired.freq = 48000
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+    def test_capture(self):
+        "Cannot be used with capture devices"
+        self.assertRaises(ValueError, SDL_OpenAudioDevice, None, True,
+                          self.desired, None, 0)
+
+
+class TestOpenAudioDeviceForeign(unittest.TestCase):
+    """Tests SDL_OpenAudioDevice() with foreign callback pointers"""
+
+    @classmethod
+    def setUpClass(cls):
+        if not has_audio:
+            raise unittest.SkipTest('No audio support')
+
+    def setUp(self):
+        self.desired = SDL_AudioSpec(freq=44100, format=AUDIO_S16SYS,
+                                     channels=1, samples=512)
+
+    def wait_for(self, predicate, timeout=3):
+        deadline = time.monotonic() + timeout
+        while not predicate() and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+    def test_capsule(self):
+        "Calls a PyCapsule callback with a buffer userdata"
+        counter = bytearray(4)
+        self.desired.callback = _csdl2test.audio_callback_capsule()
+        self.desired.userdata = counter
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        self.assertRaises(BufferError, counter.extend, b'1')
+        SDL_PauseAudioDevice(dev, False)
+        self.wait_for(lambda: any(counter))
+        self.assertTrue(any(counter))
+        SDL_CloseAudioDevice(dev)
+        counter.extend(b'1')
+
+    def test_ctypes(self):
+        "Calls a ctypes function pointer callback"
+        called = threading.Event()
+
+        @ctypes.CFUNCTYPE(None, ctypes.c_void_p,
+                          ctypes.POINTER(ctypes.c_uint8), ctypes.c_int)
+        def callback(userdata, stream, length):
+            ctypes.memset(stream, 0, length)
+            if userdata == 42:
+                called.set()
+
+        self.desired.callback = callback
+        self.desired.userdata = ctypes.c_void_p(42)
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        self.assertTrue(called.wait(3))
+
+    def test_keeps_alive(self):
+        "Keeps the callback objects alive while the device is open"
+        callback = _csdl2test.audio_callback_capsule()
+        counter = bytearray(4)
+        self.desired.callback = callback
+        self.desired.userdata = counter
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        refs = sys.getrefcount(callback)
+        self.desired.callback = None
+        self.desired.userdata = None
+        self.assertEqual(sys.getrefcount(callback), refs - 1)
+        del dev
+        self.assertEqual(sys.getrefcount(callback), refs - 2)
+
+    def test_capsule_name(self):
+        "Raises TypeError if the capsule is not named SDL_AudioCallback"
+        capsule_new = ctypes.pythonapi.PyCapsule_New
+        capsule_new.restype = ctypes.py_object
+        capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p,
+                                ctypes.c_void_p]
+        self.desired.callback = capsule_new(id(self), b'other', None)
+        self.assertRaises(TypeError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+        self.desired.callback = capsule_new(id(self), None, None)
+        self.assertRaises(TypeError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+    def test_invalid_userdata(self):
+        "Raises TypeError if userdata cannot be converted to a pointer"
+        self.desired.callback = _csdl2test.audio_callback_capsule()
+        self.desired.userdata = 42
+        self.assertRaises(TypeError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+    def test_readonly_userdata(self):
+        "Raises BufferError if userdata is a read-only buffer"
+        self.desired.callback = _csdl2test.audio_callback_capsule()
+        self.desired.userdata = b'1234'
+        self.assertRaises(BufferError, SDL_OpenAudioDevice, None, False,
+                          self.desired, None, 0)
+
+
 class TestGetAudioStatus(unittest.TestCase):
     "Tests SDL_GetAudioStatus()"
 
@@ -707,6 +1422,95 @@ class TestGetAudioDeviceStatus(unittest.TestCase):
         self.assertRaises(ValueError, SDL_GetAudioDeviceStatus, self.dev)
 
 
+class TestGetAudioDeviceStats(unittest.TestCase):
+    "Tests SDL_GetAudioDeviceStats() and SDL_ResetAudioDeviceStats()"
+
+    keys = {'callbacks', 'overruns', 'gil_wait_total', 'gil_wait_max',
+            'gil_wait_p99', 'call_total', 'call_max', 'call_p99'}
+
+    def setUp(self):
+        if not has_audio:
+            raise unittest.SkipTest('No audio support')
+        self.delay = 0
+        self.desired = SDL_AudioSpec(freq=44100, format=AUDIO_S16SYS,
+                                     channels=1, samples=512,
+                                     callback=self.callback)
+        self.dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+
+    def tearDown(self):
+        del self.dev
+
+    def callback(self, userdata, data, length):
+        time.sleep(self.delay)
+
+    def wait_for(self, predicate, timeout=3):
+        deadline = time.monotonic() + timeout
+        while not predicate() and time.monotonic() < deadline:
+            time.sleep(0.01)
+
+    def test_initial(self):
+        "All statistics start at zero"
+        stats = SDL_GetAudioDeviceStats(self.dev)
+        self.assertEqual(set(stats), self.keys)
+        self.assertEqual(set(stats.values()), {0})
+
+    def test_callbacks(self):
+        "Callbacks into Python are counted and timed"
+        SDL_PauseAudioDevice(self.dev, False)
+        self.wait_for(lambda: SDL_GetAudioDeviceStats(self.dev)['callbacks']
+                      >= 5)
+        SDL_PauseAudioDevice(self.dev, True)
+        stats = SDL_GetAudioDeviceStats(self.dev)
+        self.assertGreaterEqual(stats['callbacks'], 5)
+        for name in ('gil_wait', 'call'):
+            self.assertLessEqual(stats[name + '_p99'], stats[name + '_max'])
+            self.assertLessEqual(stats[name + '_max'],
+                                 stats[name + '_total'])
+
+    def test_overruns(self):
+        "Callbacks which take longer than their buffer are counted"
+        # 512 frames at 44100Hz last about 11.6ms
+        self.delay = 0.03
+        SDL_PauseAudioDevice(self.dev, False)
+        self.wait_for(lambda: SDL_GetAudioDeviceStats(self.dev)['overruns']
+                      >= 2)
+        SDL_PauseAudioDevice(self.dev, True)
+        stats = SDL_GetAudioDeviceStats(self.dev)
+        self.assertGreaterEqual(stats['overruns'], 2)
+        self.assertGreaterEqual(stats['call_max'], 25000)
+        self.assertGreaterEqual(stats['call_p99'], 25000 * 7 // 8)
+
+    def test_native(self):
+        "Native callbacks are timed and never wait for the GIL"
+        SDL_CloseAudioDevice(self.dev)
+        ring = SDL_AudioRingBuffer(4096)
+        self.desired.callback = ring
+        dev = SDL_OpenAudioDevice(None, False, self.desired, None, 0)
+        SDL_PauseAudioDevice(dev, False)
+        self.wait_for(lambda: SDL_GetAudioDeviceStats(dev)['callbacks'] >= 5)
+        SDL_PauseAudioDevice(dev, True)
+        stats = SDL_GetAudioDeviceStats(dev)
+        SDL_CloseAudioDevice(dev)
+        self.assertGreaterEqual(stats['callbacks'], 5)
+        self.assertEqual(stats['gil_wait_total'], 0)
+        self.assertLessEqual(stats['call_max'], stats['call_total'])
+
+    def test_reset(self):
+        "SDL_ResetAudioDeviceStats() clears the statistics"
+        SDL_PauseAudioDevice(self.dev, False)
+        self.wait_for(lambda: SDL_GetAudioDeviceStats(self.dev)['callbacks'])
+        SDL_PauseAudioDevice(self.dev, True)
+        self.assertIs(SDL_ResetAudioDeviceStats(self.dev), None)
+        stats = SDL_GetAudioDeviceStats(self.dev)
+        self.assertEqual(set(stats.values()), {0})
+
+    def test_closed(self):
+        "Raises ValueError if the device has been closed"
+        SDL_CloseAudioDevice(self.dev)
+        self.assertRaises(ValueError, SDL_GetAudioDeviceStats, self.dev)
+        self.assertRaises(ValueError, SDL_ResetAudioDeviceStats, self.dev)
+
+
 class TestPauseAudio(unittest.TestCase):
     "Tests SDL_PauseAudio()"
 
@@ -882,6 +1686,452 @@ class TestFreeWAV(unittest.TestCase):
         self.assertRaises(ValueError, SDL_FreeWAV, self.buf)
 
 
+def wave_file(fmt_chunk, data, extra=b''):
+    "Builds a WAVE file from a fmt chunk body and audio data."
+    chunks = (struct.pack('<4sI', b'fmt ', len(fmt_chunk)) + fmt_chunk +
+              extra + struct.pack('<4sI', b'data', len(data)) + data)
+    return struct.pack('<4sI4s', b'RIFF', 4 + len(chunks), b'WAVE') + chunks
+
+
+def wave_fmt(tag, num_channels, sample_rate, bits_per_sample):
+    "Builds the body of a 16-byte fmt chunk."
+    block_align = num_channels * bits_per_sample // 8
+    return struct.pack('<HHIIHH', tag, num_channels, sample_rate,
+                       sample_rate * block_align, block_align,
+                       bits_per_sample)
+
+
+def rwops_from_bytes(data):
+    "Returns a SDL_RWops reading from data, and the file object behind it."
+    f = io.BytesIO(data)
+    rwops = SDL_AllocRW()
+    rwops.size = lambda a: len(f.getbuffer())
+    rwops.read = lambda a, b, c, d: f.readinto(b) // c
+    rwops.seek = lambda a, b, c: f.seek(b, c)
+    rwops.close = lambda a: SDL_FreeRW(a)
+    return rwops, f
+
+
+class TestWAVStream(unittest.TestCase):
+    "Tests SDL_WAVStream class"
+
+    def test_pcm16(self):
+        "Parses the format and length of 16-bit PCM data"
+        data = bytes(range(256)) * 4
+        rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 2, 22050, 16),
+                                              data))
+        x = SDL_WAVStream(rwops)
+        self.assertIs(x.src, rwops)
+        self.assertEqual(x.spec.freq, 22050)
+        self.assertEqual(x.spec.format, AUDIO_S16LSB)
+        self.assertEqual(x.spec.channels, 2)
+        self.assertEqual(x.frame_size, 4)
+        self.assertEqual(x.frames, 256)
+        self.assertEqual(x.position, 0)
+
+    def test_formats(self):
+        "Maps PCM and float encodings to SDL audio formats"
+        for tag, bits, fmt in ((1, 8, AUDIO_U8), (1, 32, AUDIO_S32LSB),
+                               (3, 32, AUDIO_F32LSB)):
+            with self.subTest(tag=tag, bits=bits):
+                rwops, f = rwops_from_bytes(wave_file(wave_fmt(tag, 1, 8000,
+                                                               bits),
+                                                      bytes(64)))
+                self.assertEqual(SDL_WAVStream(rwops).spec.format, fmt)
+
+    def test_extensible(self):
+        "Reads the format tag of WAVE_FORMAT_EXTENSIBLE from its subformat"
+        fmt_chunk = (wave_fmt(0xFFFE, 2, 48000, 32) +
+                     struct.pack('<HHI', 22, 32, 3) +
+                     struct.pack('<H14s', 3, b'\x00\x00\x00\x00\x10\x00\x80'
+                                 b'\x00\x00\xaa\x00\x38\x9b\x71'))
+        rwops, f = rwops_from_bytes(wave_file(fmt_chunk, bytes(80)))
+        x = SDL_WAVStream(rwops)
+        self.assertEqual(x.spec.format, AUDIO_F32LSB)
+        self.assertEqual(x.frames, 10)
+
+    def test_skips_chunks(self):
+        "Skips unknown chunks, including their pad byte"
+        extra = struct.pack('<4sI', b'LIST', 3) + b'abc\x00'
+        data = bytes(range(16))
+        rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 1, 8000, 8), data,
+                                              extra))
+        x = SDL_WAVStream(rwops)
+        buf = bytearray(16)
+        self.assertEqual(SDL_WAVStreamRead(x, buf, 16), 16)
+        self.assertEqual(buf, data)
+
+    def test_skips_chunks_unseekable(self):
+        "Skips unknown chunks by reading if the data source cannot seek"
+        extra = struct.pack('<4sI', b'LIST', 300) + bytes(300)
+        data = bytes(range(16))
+        for seek in (None, lambda a, b, c: io.BytesIO().fileno()):
+            with self.subTest(seek=seek):
+                rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 1, 8000,
+                                                               8),
+                                                      data, extra))
+                rwops.seek = seek
+                x = SDL_WAVStream(rwops)
+                buf = bytearray(16)
+                self.assertEqual(SDL_WAVStreamRead(x, buf, 16), 16)
+                self.assertEqual(buf, data)
+
+    def test_bufsize(self):
+        "bufsize is rounded up to whole frames"
+        rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 2, 8000, 16),
+                                              bytes(64)))
+        self.assertEqual(SDL_WAVStream(rwops, 10).bufsize, 12)
+        f.seek(0)
+        self.assertEqual(SDL_WAVStream(rwops).bufsize, 65536)
+        self.assertRaises(ValueError, SDL_WAVStream, rwops, 0)
+
+    def test_invalid(self):
+        "Raises ValueError on files which cannot be streamed"
+        adpcm = wave_file(wave_fmt(2, 1, 8000, 4), bytes(64))
+        for data in (b'', b'RIFF\x04\x00\x00\x00AVI ', adpcm,
+                     wave_file(wave_fmt(1, 1, 8000, 8), b'')[:-8]):
+            with self.subTest(data=data):
+                rwops, f = rwops_from_bytes(data)
+                self.assertRaises(ValueError, SDL_WAVStream, rwops)
+
+    def test_read_error(self):
+        "Exceptions raised by the data source are propagated"
+        rwops = SDL_AllocRW()
+
+        def read(a, b, c, d):
+            raise KeyError()
+
+        rwops.read = read
+        self.assertRaises(KeyError, SDL_WAVStream, rwops)
+
+    def test_readonly(self):
+        "Attributes are readonly"
+        rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 1, 8000, 8),
+                                              bytes(8)))
+        x = SDL_WAVStream(rwops)
+        self.assertRaises(AttributeError, setattr, x, 'src', None)
+        self.assertRaises(AttributeError, setattr, x, 'frames', 1)
+        self.assertRaises(AttributeError, setattr, x, 'position', 1)
+        self.assertRaises(AttributeError, setattr, x, 'bufsize', 1)
+
+
+class TestWAVStreamRead(unittest.TestCase):
+    "Tests SDL_WAVStreamRead()"
+
+    def setUp(self):
+        rng = random.Random(6)
+        self.data = bytes(rng.getrandbits(8) for i in range(4000))
+        self.rwops, self.f = rwops_from_bytes(
+            wave_file(wave_fmt(1, 2, 44100, 16), self.data))
+
+    def test_chunks(self):
+        "Reads of any size return the data chunk in order"
+        x = SDL_WAVStream(self.rwops, 64)
+        out = bytearray()
+        buf = bytearray(4 * 37)
+        sizes = [1, 37, 5, 16, 17, 2]
+        i = 0
+        while True:
+            n = SDL_WAVStreamRead(x, buf, sizes[i % len(sizes)])
+            if not n:
+                break
+            out += buf[:n * 4]
+            i += 1
+            self.assertEqual(x.position, len(out) // 4)
+        self.assertEqual(out, self.data)
+        self.assertEqual(SDL_WAVStreamRead(x, buf, 1), 0)
+
+    def test_constant_memory(self):
+        "Reads go through a read-ahead buffer of bufsize bytes"
+        requests = []
+        read = self.rwops.read
+        self.rwops.read = lambda a, b, c, d: (requests.append(d),
+                                              read(a, b, c, d))[1]
+        x = SDL_WAVStream(self.rwops, 256)
+        del requests[:]
+        buf = bytearray(4)
+        for i in range(100):
+            SDL_WAVStreamRead(x, buf, 1)
+        self.assertEqual(requests, [256, 256])
+        self.assertEqual(x.position, 100)
+
+    def test_large_read(self):
+        "Reads larger than the buffer go straight to the data source"
+        x = SDL_WAVStream(self.rwops, 64)
+        buf = bytearray(len(self.data) + 16)
+        self.assertEqual(SDL_WAVStreamRead(x, buf, 1004), 1000)
+        self.assertEqual(buf[:len(self.data)], self.data)
+
+    def test_truncated(self):
+        "A truncated data chunk ends at the last whole frame"
+        rwops, f = rwops_from_bytes(wave_file(wave_fmt(1, 2, 44100, 16),
+                                              self.data)[:-6])
+        x = SDL_WAVStream(rwops)
+        self.assertEqual(x.frames, 1000)
+        buf = bytearray(len(self.data))
+        self.assertEqual(SDL_WAVStreamRead(x, buf, 1000), 998)
+        self.assertEqual(buf[:998 * 4], self.data[:998 * 4])
+
+    def test_buffer_too_small(self):
+        "Raises ValueError if the buffer cannot hold the frames"
+        x = SDL_WAVStream(self.rwops)
+        self.assertRaises(ValueError, SDL_WAVStreamRead, x, bytearray(7), 2)
+        self.assertRaises(TypeError, SDL_WAVStreamRead, x, bytes(8), 2)
+
+    def test_freed(self):
+        "Raises ValueError if the SDL_RWops has been freed"
+        x = SDL_WAVStream(self.rwops)
+        SDL_FreeRW(self.rwops)
+        self.assertRaises(ValueError, SDL_WAVStreamRead, x, bytearray(4), 1)
+
+    def test_error(self):
+        "Exceptions raised by the data source are propagated"
+        x = SDL_WAVStream(self.rwops)
+
+        def read(a, b, c, d):
+            raise KeyError()
+
+        self.rwops.read = read
+        self.assertRaises(KeyError, SDL_WAVStreamRead, x, bytearray(4), 1)
+
+
+class TestWAVStreamSeek(unittest.TestCase):
+    "Tests SDL_WAVStreamSeek()"
+
+    def setUp(self):
+        self.data = bytes(i % 251 for i in range(4000))
+        self.rwops, self.f = rwops_from_bytes(
+            wave_file(wave_fmt(1, 2, 44100, 16), self.data))
+        self.stream = SDL_WAVStream(self.rwops, 64)
+
+    def read(self, frames):
+        buf = bytearray(frames * 4)
+        n = SDL_WAVStreamRead(self.stream, buf, frames)
+        return bytes(buf[:n * 4])
+
+    def test_seek(self):
+        "The next read starts at the given frame"
+        self.read(10)
+        for frame in (500, 3, 999, 0, 1000):
+            with self.subTest(frame=frame):
+                self.assertIs(SDL_WAVStreamSeek(self.stream, frame), None)
+                self.assertEqual(self.stream.position, frame)
+                self.assertEqual(self.read(4),
+                                 self.data[frame * 4:frame * 4 + 16])
+
+    def test_within_buffer(self):
+        "Seeks within the read-ahead buffer do not touch the data source"
+        self.read(2)
+        self.rwops.seek = None
+        SDL_WAVStreamSeek(self.stream, 0)
+        self.assertEqual(self.read(16), self.data[:64])
+
+    def test_out_of_range(self):
+        "Raises ValueError when seeking past the end"
+        self.assertRaises(ValueError, SDL_WAVStreamSeek, self.stream, 1001)
+
+
+class TestLoadWAVCached(unittest.TestCase):
+    """Tests for SDL_LoadWAVCached()"""
+
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+        self.src = os.path.join(self.dir.name, 'test.wav')
+        self.cache = os.path.join(self.dir.name, 'test.cache')
+        self.wave = wave_file(wave_fmt(1, 1, 8000, 8), bytes(range(256)))
+        with open(self.src, 'wb') as f:
+            f.write(self.wave)
+        self.spec = SDL_AudioSpec(freq=8000, format=AUDIO_S16LSB,
+                                  channels=2)
+
+    def tearDown(self):
+        # Handle "directory not empty" errors on Windows by attempting 3 times
+        for i in range(3):
+            try:
+                self.dir.cleanup()
+            except OSError:
+                continue
+            break
+
+    def converted(self):
+        "Returns the data converted with SDL_ConvertAudio()"
+        spec, buf, size = SDL_LoadWAV(self.src)
+        cvt = SDL_AudioCVT()
+        SDL_BuildAudioCVT(cvt, spec.format, spec.channels, spec.freq,
+                          self.spec.format, self.spec.channels,
+                          self.spec.freq)
+        data = bytearray(size * cvt.len_mult)
+        data[:size] = buf
+        cvt.buf = data
+        cvt.len = size
+        SDL_ConvertAudio(cvt)
+        return bytes(data[:cvt.len_cvt])
+
+    def test_return(self):
+        "Returns a (SDL_AudioSpec, SDL_WAVCacheBuf, int) tuple"
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertIs(type(spec), SDL_AudioSpec)
+        self.assertEqual(spec.freq, 8000)
+        self.assertEqual(spec.format, AUDIO_S16LSB)
+        self.assertEqual(spec.channels, 2)
+        self.assertEqual(type(buf).__name__, 'SDL_WAVCacheBuf')
+        self.assertEqual(size, 256 * 4)
+
+    def test_converts(self):
+        "The data is converted to the format of spec"
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_readonly(self):
+        "The buffer is read-only"
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertTrue(memoryview(buf).readonly)
+
+    def test_creates_cache(self):
+        "Writes the converted data into the cache file"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        with open(self.cache, 'rb') as f:
+            data = f.read()
+        self.assertEqual(data[:8], b'PYCSDL2W')
+        self.assertEqual(data[64:64 + 256 * 4], self.converted())
+
+    def patch_cache(self):
+        "Changes the audio data in the cache file"
+        with open(self.cache, 'r+b') as f:
+            f.seek(64)
+            f.write(b'\x01\x02\x03\x04')
+
+    def test_hit(self):
+        "Maps the cache file when it matches"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.patch_cache()
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(bytes(memoryview(buf)[:4]), b'\x01\x02\x03\x04')
+        self.assertEqual(size, 256 * 4)
+
+    def test_spec_changed(self):
+        "Converts again when the target spec is different"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.patch_cache()
+        self.spec.channels = 1
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(spec.channels, 1)
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_source_changed(self):
+        "Converts again when the source is different"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.patch_cache()
+        st = os.stat(self.src)
+        with open(self.src, 'wb') as f:
+            f.write(wave_file(wave_fmt(1, 1, 8000, 8), bytes(256)))
+        os.utime(self.src, ns=(st.st_atime_ns, st.st_mtime_ns + 10**9))
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_hit_not_read(self):
+        "Does not read a file source on a cache hit"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        st = os.stat(self.src)
+        with open(self.src, 'wb') as f:
+            f.write(b'\0' * len(self.wave))
+        os.utime(self.src, ns=(st.st_atime_ns, st.st_mtime_ns))
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(size, 256 * 4)
+
+    def test_invalid_cache(self):
+        "Replaces a cache file which is not valid"
+        with open(self.cache, 'wb') as f:
+            f.write(b'garbage')
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_no_temporary_files(self):
+        "Leaves only the cache file behind"
+        SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(sorted(os.listdir(self.dir.name)),
+                         ['test.cache', 'test.wav'])
+
+    def test_rwops(self):
+        "src can be a SDL_RWops identified by key"
+        rwops, f = rwops_from_bytes(self.wave)
+        spec, buf, size = SDL_LoadWAVCached(rwops, self.spec, self.cache,
+                                            'v1')
+        self.assertEqual(bytes(buf), self.converted())
+        self.patch_cache()
+        rwops, f = rwops_from_bytes(self.wave)
+        spec, buf, size = SDL_LoadWAVCached(rwops, self.spec, self.cache,
+                                            b'v1')
+        self.assertEqual(bytes(memoryview(buf)[:4]), b'\x01\x02\x03\x04')
+
+    def test_rwops_hit_not_read(self):
+        "Does not read a SDL_RWops on a cache hit"
+        rwops, f = rwops_from_bytes(self.wave)
+        SDL_LoadWAVCached(rwops, self.spec, self.cache, key='v1')
+        rwops = SDL_AllocRW()
+        rwops.read = lambda a, b, c, d: 1 // 0
+        rwops.seek = lambda a, b, c: 1 // 0
+        rwops.close = lambda a: SDL_FreeRW(a)
+        spec, buf, size = SDL_LoadWAVCached(rwops, self.spec, self.cache,
+                                            key='v1')
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_key_changed(self):
+        "Converts again when the key is different"
+        rwops, f = rwops_from_bytes(self.wave)
+        SDL_LoadWAVCached(rwops, self.spec, self.cache, key='v1')
+        self.patch_cache()
+        rwops, f = rwops_from_bytes(self.wave)
+        spec, buf, size = SDL_LoadWAVCached(rwops, self.spec, self.cache,
+                                            key='v2')
+        self.assertEqual(bytes(buf), self.converted())
+
+    def test_rwops_no_key(self):
+        "Raises ValueError when src is a SDL_RWops and key is not given"
+        rwops, f = rwops_from_bytes(self.wave)
+        self.assertRaises(ValueError, SDL_LoadWAVCached, rwops, self.spec,
+                          self.cache)
+
+    def test_bad_key(self):
+        "Raises TypeError when key is not a str or bytes"
+        self.assertRaises(TypeError, SDL_LoadWAVCached, self.src, self.spec,
+                          self.cache, 42)
+
+    def test_rwops_raises(self):
+        "Propagates exceptions raised by a SDL_RWops"
+        rwops = SDL_AllocRW()
+        rwops.size = lambda a: 1000
+        rwops.read = lambda a, b, c, d: 1 // 0
+        rwops.seek = lambda a, b, c: 0
+        rwops.close = lambda a: SDL_FreeRW(a)
+        self.assertRaises(ZeroDivisionError, SDL_LoadWAVCached, rwops,
+                          self.spec, self.cache, key='v1')
+
+    def test_no_conversion(self):
+        "Works when the source is already in the format of spec"
+        self.spec.format = AUDIO_U8
+        self.spec.channels = 1
+        spec, buf, size = SDL_LoadWAVCached(self.src, self.spec, self.cache)
+        self.assertEqual(bytes(buf), bytes(range(256)))
+
+    def test_bad_src(self):
+        "Raises TypeError when src is not a str or SDL_RWops"
+        self.assertRaises(TypeError, SDL_LoadWAVCached, 42, self.spec,
+                          self.cache)
+
+    def test_missing_src(self):
+        "Raises RuntimeError when the source cannot be opened"
+        self.assertRaises(RuntimeError, SDL_LoadWAVCached,
+                          os.path.join(self.dir.name, 'missing.wav'),
+                          self.spec, self.cache)
+
+    def test_invalid_src(self):
+        "Raises RuntimeError when the source is not a WAVE file"
+        rwops, f = rwops_from_bytes(b'garbage')
+        self.assertRaises(RuntimeError, SDL_LoadWAVCached, rwops, self.spec,
+                          self.cache, 'v1')
+
+
 class TestBuildAudioCVT(unittest.TestCase):
     "Tests for SDL_BuildAudioCVT()"
 
@@ -927,6 +2177,111 @@ class TestConvertAudio(unittest.TestCase):
         self.assertRaises(BufferError, SDL_ConvertAudio, self.cvt)
 
 
+class TestConvertAudioFastPath(unittest.TestCase):
+    """Tests for the vectorized kernels used by SDL_ConvertAudio().
+
+    The output must be identical to that of SDL's own converters, which are
+    used when the PYCSDL2_AUDIOCVT_SIMD hint is "none".
+    """
+
+    hints = ('PYCSDL2_AUDIOCVT_SIMD', 'PYCSDL2_AUDIOCVT_THREADS')
+
+    conversions = [
+        (AUDIO_S16SYS, 2, AUDIO_F32SYS, 2),
+        (AUDIO_F32SYS, 2, AUDIO_S16SYS, 2),
+        (AUDIO_U8, 2, AUDIO_S16SYS, 2),
+        (AUDIO_S16SYS, 2, AUDIO_U8, 2),
+        (AUDIO_S16LSB, 2, AUDIO_S16MSB, 2),
+        (AUDIO_S16MSB, 2, AUDIO_S16LSB, 2),
+        (AUDIO_S16SYS, 1, AUDIO_S16SYS, 2),
+        (AUDIO_S16SYS, 2, AUDIO_S16SYS, 1),
+        (AUDIO_U8, 1, AUDIO_U8, 2),
+        (AUDIO_U8, 2, AUDIO_U8, 1),
+        (AUDIO_F32SYS, 1, AUDIO_F32SYS, 2),
+        (AUDIO_F32SYS, 2, AUDIO_F32SYS, 1),
+        (AUDIO_S16SYS, 1, AUDIO_F32SYS, 2),
+        (AUDIO_S16SYS, 2, AUDIO_F32SYS, 1),
+        (AUDIO_F32SYS, 2, AUDIO_S16SYS, 1),
+        (AUDIO_U8, 1, AUDIO_S16SYS, 2),
+        (AUDIO_S16SYS, 2, AUDIO_U8, 1),
+        (AUDIO_S16SYS, 6, AUDIO_F32SYS, 6),
+    ]
+
+    def setUp(self):
+        self.saved = {k: os.environ.get(k) for k in self.hints}
+        self.rand = random.Random(0)
+
+    def tearDown(self):
+        for k, v in self.saved.items():
+            if v is None:
+                os.environ.pop(k, None)
+            else:
+                os.environ[k] = v
+
+    def samples(self, fmt, n):
+        "Returns n random samples of format fmt, including extreme values"
+        if fmt == AUDIO_U8:
+            return bytes(self.rand.randrange(256) for i in range(n))
+        elif fmt == AUDIO_F32SYS:
+            x = [self.rand.choice([self.rand.uniform(-1, 1), 1.0, -1.0, 0.0])
+                 for i in range(n)]
+            return array.array('f', x).tobytes()
+        else:
+            x = [self.rand.choice([self.rand.randrange(-32768, 32768), -32768,
+                                   32767, -1, 0]) for i in range(n)]
+            return array.array('h', x).tobytes()
+
+    def convert(self, conversion, data, simd, threads='1'):
+        src_format, src_channels, dst_format, dst_channels = conversion
+        os.environ['PYCSDL2_AUDIOCVT_SIMD'] = simd
+        os.environ['PYCSDL2_AUDIOCVT_THREADS'] = threads
+        cvt = SDL_AudioCVT()
+        SDL_BuildAudioCVT(cvt, src_format, src_channels, 44100,
+                          dst_format, dst_channels, 44100)
+        cvt.len = len(data)
+        buf = bytearray(len(data) * cvt.len_mult)
+        buf[:len(data)] = data
+        cvt.buf = buf
+        SDL_ConvertAudio(cvt)
+        return bytes(buf[:cvt.len_cvt])
+
+    def check(self, conversion, frames, simd, threads='1'):
+        src_format = conversion[0]
+        if src_format == AUDIO_S16MSB:
+            src_format = AUDIO_S16LSB
+        data = self.samples(src_format, frames * conversion[1])
+        expected = self.convert(conversion, data, 'none')
+        self.assertEqual(self.convert(conversion, data, simd, threads),
+                         expected)
+
+    def test_sse2(self):
+        "SSE2 kernels give the same output as SDL"
+        for conversion in self.conversions:
+            for frames in (1, 7, 16, 33, 1000):
+                with self.subTest(conversion=conversion, frames=frames):
+                    self.check(conversion, frames, 'sse2')
+
+    def test_avx2(self):
+        "AVX2 kernels give the same output as SDL"
+        for conversion in self.conversions:
+            for frames in (1, 7, 16, 33, 1000):
+                with self.subTest(conversion=conversion, frames=frames):
+                    self.check(conversion, frames, 'avx2')
+
+    def test_threads(self):
+        "Converting large buffers with multiple threads gives the same output"
+        for conversion in self.conversions[:5]:
+            with self.subTest(conversion=conversion):
+                self.check(conversion, 300000, 'avx2', '4')
+
+    def test_partial_frame(self):
+        "Buffers ending with a partial sample frame give the same output"
+        conversion = (AUDIO_S16SYS, 2, AUDIO_F32SYS, 1)
+        data = self.samples(AUDIO_S16SYS, 21)
+        self.assertEqual(self.convert(conversion, data, 'avx2'),
+                         self.convert(conversion, data, 'none'))
+
+
 class TestMixAudio(unittest.TestCase):
     "Tests for SDL_MixAudio()"
 
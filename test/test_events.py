@@ -1,7 +1,14 @@
 """test bindings in src/events.h"""
+import asyncio
+import ctypes
 import distutils.util
 import os.path
+import select
+import struct
 import sys
+import tempfile
+import threading
+import time
 import unittest
 import weakref
 
@@ -15,9 +22,15 @@ if __name__ == '__main__':
     sys.path.insert(0, os.path.join(tests_dir, '..', 'build', plat_specifier))
 
 
+import csdl2  # noqa
 from csdl2 import *  # noqa
 import _csdl2test  # noqa
 
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
 
 class TestEventsConstants(unittest.TestCase):
     """Tests for the availability of constants and their values"""
@@ -386,6 +399,209 @@ class TestMouseMotionEvent(unittest.TestCase):
         setattr(self.ev, 'yrel', 42.1)
 
 
+class TestEventViews(unittest.TestCase):
+    """Tests the views of the SDL_Event union members"""
+
+    members = [('common', 'SDL_CommonEvent'),
+               ('window', 'SDL_WindowEvent'),
+               ('key', 'SDL_KeyboardEvent'),
+               ('edit', 'SDL_TextEditingEvent'),
+               ('text', 'SDL_TextInputEvent'),
+               ('motion', 'SDL_MouseMotionEvent'),
+               ('button', 'SDL_MouseButtonEvent'),
+               ('wheel', 'SDL_MouseWheelEvent'),
+               ('jaxis', 'SDL_JoyAxisEvent'),
+               ('jball', 'SDL_JoyBallEvent'),
+               ('jhat', 'SDL_JoyHatEvent'),
+               ('jbutton', 'SDL_JoyButtonEvent'),
+               ('jdevice', 'SDL_JoyDeviceEvent'),
+               ('caxis', 'SDL_ControllerAxisEvent'),
+               ('cbutton', 'SDL_ControllerButtonEvent'),
+               ('cdevice', 'SDL_ControllerDeviceEvent'),
+               ('quit', 'SDL_QuitEvent'),
+               ('user', 'SDL_UserEvent'),
+               ('syswm', 'SDL_SysWMEvent'),
+               ('tfinger', 'SDL_TouchFingerEvent'),
+               ('mgesture', 'SDL_MultiGestureEvent'),
+               ('dgesture', 'SDL_DollarGestureEvent'),
+               ('drop', 'SDL_DropEvent')]
+
+    # (member, field, value, offset, struct format)
+    fields = [('window', 'windowID', 0xdeadbeef, 8, 'I'),
+              ('window', 'event', 200, 12, 'B'),
+              ('window', 'data2', -42, 20, 'i'),
+              ('key', 'state', 1, 12, 'B'),
+              ('key', 'repeat', 1, 13, 'B'),
+              ('edit', 'start', -3, 44, 'i'),
+              ('edit', 'length', 7, 48, 'i'),
+              ('button', 'button', 3, 16, 'B'),
+              ('button', 'y', -100, 24, 'i'),
+              ('wheel', 'x', -5, 16, 'i'),
+              ('jaxis', 'which', -1, 8, 'i'),
+              ('jaxis', 'value', -32768, 16, 'h'),
+              ('jball', 'yrel', 32767, 18, 'h'),
+              ('jhat', 'value', 8, 13, 'B'),
+              ('cbutton', 'button', 14, 12, 'B'),
+              ('user', 'code', -7, 12, 'i'),
+              ('tfinger', 'fingerId', -2 ** 62, 16, 'q'),
+              ('tfinger', 'pressure', 0.5, 40, 'f'),
+              ('mgesture', 'numFingers', 0xffff, 32, 'H'),
+              ('dgesture', 'numFingers', 0xffffffff, 24, 'I')]
+
+    def setUp(self):
+        self.ev = SDL_Event()
+
+    def test_types(self):
+        "Each member is a view of the right type"
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                self.assertIs(type(getattr(self.ev, name)),
+                              globals()[typename])
+
+    def test_cached(self):
+        "Each member returns the same view every time"
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                self.assertIs(getattr(self.ev, name), getattr(self.ev, name))
+
+    def test_readonly(self):
+        "Members cannot be set"
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                self.assertRaises(AttributeError, setattr, self.ev, name, 42)
+
+    def test_shared_memory(self):
+        "All views share the SDL_Event memory"
+        self.ev.type = SDL_KEYDOWN
+        self.ev.common.timestamp = 1234
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                view = getattr(self.ev, name)
+                self.assertEqual(view.type, SDL_KEYDOWN)
+                self.assertEqual(view.timestamp, 1234)
+
+    def test_buffer(self):
+        "Views export writable buffers at the start of the SDL_Event"
+        mem = memoryview(self.ev)
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                view = memoryview(getattr(self.ev, name))
+                self.assertFalse(view.readonly)
+                self.assertLessEqual(view.nbytes, mem.nbytes)
+                view[0] = 42
+                self.assertEqual(mem[0], 42)
+
+    def test_outlives_event(self):
+        "A view keeps the SDL_Event memory alive"
+        self.ev.type = 42
+        view = self.ev.key
+        del self.ev
+        self.assertEqual(view.type, 42)
+
+    def test_new(self):
+        "A view can be created on its own, zero-initialized"
+        for name, typename in self.members:
+            with self.subTest(name=name):
+                view = globals()[typename]()
+                mem = memoryview(view)
+                self.assertEqual(mem.tobytes(), bytes(mem.nbytes))
+
+    def test_fields(self):
+        "Fields are read from and written to the SDL_Event memory"
+        for name, field, value, offset, fmt in self.fields:
+            with self.subTest(name=name, field=field):
+                ev = SDL_Event()
+                view = getattr(ev, name)
+                self.assertEqual(getattr(view, field), 0)
+                setattr(view, field, value)
+                self.assertEqual(getattr(view, field), value)
+                self.assertEqual(struct.unpack_from(fmt, ev, offset)[0],
+                                 value)
+
+    def test_fields_overflow(self):
+        "Integer fields raise OverflowError for values out of range"
+        self.assertRaises(OverflowError, setattr, self.ev.window, 'event',
+                          256)
+        self.assertRaises(OverflowError, setattr, self.ev.key, 'repeat', -1)
+        self.assertRaises(OverflowError, setattr, self.ev.jaxis, 'value',
+                          32768)
+        self.assertRaises(OverflowError, setattr, self.ev.jball, 'xrel',
+                          -32769)
+        self.assertRaises(OverflowError, setattr, self.ev.mgesture,
+                          'numFingers', 0x10000)
+        self.assertRaises(OverflowError, setattr, self.ev.user, 'code',
+                          2 ** 31)
+
+    def test_fields_non_int(self):
+        "Integer fields reject non-integers"
+        self.assertRaises(TypeError, setattr, self.ev.window, 'event', 1.0)
+        self.assertRaises(TypeError, setattr, self.ev.tfinger, 'x', 'a')
+
+    def test_fields_no_delete(self):
+        "Fields cannot be deleted"
+        self.assertRaises(AttributeError, delattr, self.ev.window, 'event')
+
+    def test_keysym(self):
+        "key.keysym is a cached SDL_Keysym view into the SDL_Event"
+        keysym = self.ev.key.keysym
+        self.assertIs(type(keysym), SDL_Keysym)
+        self.assertIs(self.ev.key.keysym, keysym)
+        self.assertEqual(memoryview(keysym).nbytes, 16)
+        keysym.scancode = 4
+        keysym.sym = 97
+        keysym.mod = 0x40
+        self.assertEqual(struct.unpack_from('iiH', self.ev, 16),
+                         (4, 97, 0x40))
+        self.assertEqual(self.ev.key.keysym.sym, 97)
+
+    def test_keysym_readonly(self):
+        "key.keysym cannot be set"
+        self.assertRaises(AttributeError, setattr, self.ev.key, 'keysym', 42)
+
+    def test_text(self):
+        "text.text and edit.text are UTF-8 strings in the SDL_Event"
+        self.ev.text.text = 'h\u00e9llo'
+        self.assertEqual(self.ev.text.text, 'h\u00e9llo')
+        self.assertEqual(self.ev.edit.text, 'h\u00e9llo')
+        self.assertEqual(bytes(self.ev)[12:19], b'h\xc3\xa9llo\0')
+
+    def test_text_full(self):
+        "text fields hold up to 31 bytes"
+        self.ev.text.text = 'x' * 31
+        self.assertEqual(self.ev.text.text, 'x' * 31)
+        self.assertRaises(ValueError, setattr, self.ev.text, 'text', 'x' * 32)
+        self.assertRaises(TypeError, setattr, self.ev.text, 'text', b'x')
+
+    def test_user_data(self):
+        "user.data1 and user.data2 are pointers as ints"
+        self.ev.user.data1 = 0x1234
+        self.assertEqual(self.ev.user.data1, 0x1234)
+        self.assertEqual(self.ev.user.data2, 0)
+
+    def test_drop_file(self):
+        "drop.file is None unless the event is a SDL_DROPFILE"
+        self.ev.text.text = 'garbage'
+        self.assertIsNone(self.ev.drop.file)
+        self.ev.type = SDL_DROPFILE
+        self.ev.text.text = ''
+        size = struct.calcsize('P')
+        memoryview(self.ev)[8:8 + size] = bytes(size)
+        self.assertIsNone(self.ev.drop.file)
+        self.assertRaises(AttributeError, setattr, self.ev.drop, 'file', 'a')
+
+    def test_drop_file_forged(self):
+        "drop.file does not follow a pointer written from Python"
+        self.ev.type = SDL_DROPFILE
+        self.ev.user.windowID = 0x1234
+        self.ev.user.code = 0x10
+        self.assertIsNone(self.ev.drop.file)
+
+    def test_syswm_msg_readonly(self):
+        "syswm.msg is a readonly int"
+        self.assertEqual(self.ev.syswm.msg, 0)
+        self.assertRaises(AttributeError, setattr, self.ev.syswm, 'msg', 1)
+
+
 class Test_SDL_Event(unittest.TestCase):
     """Tests csdl2.SDL_Event"""
 
@@ -467,6 +683,64 @@ class Test_SDL_Event(unittest.TestCase):
         self.assertEqual(self.ev.motion.type, 42)
 
 
+class TestEventPool(unittest.TestCase):
+    """Tests the free list of SDL_Event objects"""
+
+    def test_stats(self):
+        "SDL_GetEventPoolStats() returns a dict of ints"
+        stats = SDL_GetEventPoolStats()
+        self.assertEqual(sorted(stats), ['capacity', 'free', 'hits',
+                                         'misses'])
+        for value in stats.values():
+            self.assertIs(type(value), int)
+        self.assertLessEqual(stats['free'], stats['capacity'])
+
+    def test_reuse(self):
+        "Deallocated events are reused"
+        ev = SDL_Event()
+        del ev
+        before = SDL_GetEventPoolStats()
+        for i in range(100):
+            ev = SDL_Event()
+            del ev
+        after = SDL_GetEventPoolStats()
+        self.assertEqual(after['hits'] - before['hits'], 100)
+        self.assertEqual(after['misses'], before['misses'])
+
+    def test_bounded(self):
+        "The free list holds at most capacity events"
+        events = [SDL_Event() for i in range(200)]
+        del events
+        stats = SDL_GetEventPoolStats()
+        self.assertEqual(stats['free'], stats['capacity'])
+
+    def test_reused_zeroed(self):
+        "Reused events are zeroed and have no cached views"
+        ev = SDL_Event()
+        ev.type = 42
+        key = ev.key
+        key.keysym.sym = 97
+        ref = weakref.ref(ev)
+        del ev
+        self.assertIsNone(ref())
+        for i in range(SDL_GetEventPoolStats()['capacity'] + 1):
+            ev = SDL_Event()
+            self.assertEqual(memoryview(ev).tobytes(),
+                             bytes(memoryview(ev).nbytes))
+            self.assertIsNot(ev.key, key)
+
+    def test_view_outlives_event(self):
+        "Views keep the memory of their event after it is reused"
+        ev = SDL_Event()
+        ev.type = 42
+        motion = ev.motion
+        del ev
+        events = [SDL_Event() for i in range(10)]
+        for ev in events:
+            ev.type = 7
+        self.assertEqual(motion.type, 42)
+
+
 class Test_SDL_PumpEvents(unittest.TestCase):
     """Tests SDL_PumpEvents"""
 
@@ -656,6 +930,1001 @@ class Test_SDL_PollEvent(unittest.TestCase):
         SDL_PushEvent(ev_src)
         self.assertRaises(BufferError, SDL_PollEvent, ev_dst)
 
+    def test_drop_file(self):
+        "Copies the file of a SDL_DROPFILE event into the SDL_Event"
+        name = ctypes.create_string_buffer(b'song.wav')
+        ev_src, ev_dst = SDL_Event(), SDL_Event()
+        ev_src.type = SDL_DROPFILE
+        struct.pack_into('P', ev_src, 8, ctypes.addressof(name))
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        SDL_PushEvent(ev_src)
+        self.assertIsNone(ev_src.drop.file)
+        self.assertTrue(SDL_PollEvent(ev_dst))
+        name.value = b'other'
+        self.assertEqual(ev_dst.drop.file, 'song.wav')
+        struct.pack_into('P', ev_dst, 8, 0x10)
+        self.assertEqual(ev_dst.drop.file, 'song.wav')
+        ev_src.type = SDL_USEREVENT
+        SDL_PushEvent(ev_src)
+        self.assertTrue(SDL_PollEvent(ev_dst))
+        ev_dst.type = SDL_DROPFILE
+        self.assertIsNone(ev_dst.drop.file)
+
+
+class Test_SDL_WaitEvent(unittest.TestCase):
+    """Tests SDL_WaitEvent()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def test_SDL_Event(self):
+        "Removes the pending event and stores it in the SDL_Event"
+        ev_src, ev_dst = SDL_Event(), SDL_Event()
+        ev_src.type = SDL_USEREVENT
+        SDL_PushEvent(ev_src)
+        self.assertIsNone(SDL_WaitEvent(ev_dst))
+        self.assertEqual(ev_dst.type, SDL_USEREVENT)
+        self.assertFalse(SDL_PollEvent(None))
+
+    def test_none(self):
+        "Leaves the event in the queue if event is None"
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        SDL_PushEvent(ev)
+        self.assertIsNone(SDL_WaitEvent(None))
+        self.assertTrue(SDL_PollEvent(None))
+
+    def test_readonly_buffer(self):
+        "Raises BufferError with readonly buffer"
+        ev = memoryview(SDL_Event()).tobytes()
+        self.assertRaises(BufferError, SDL_WaitEvent, ev)
+
+    def test_buffer_wrong_size(self):
+        "Raises BufferError with writable buffer of wrong size"
+        self.assertRaises(BufferError, SDL_WaitEvent, bytearray(1))
+
+
+class Test_SDL_WaitEventTimeout(unittest.TestCase):
+    """Tests SDL_WaitEventTimeout()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def test_event(self):
+        "Returns True and stores the pending event"
+        ev_src, ev_dst = SDL_Event(), SDL_Event()
+        ev_src.type = SDL_USEREVENT
+        SDL_PushEvent(ev_src)
+        self.assertIs(SDL_WaitEventTimeout(ev_dst, 1000), True)
+        self.assertEqual(ev_dst.type, SDL_USEREVENT)
+
+    def test_timeout(self):
+        "Returns False when no event arrives before the timeout"
+        self.assertIs(SDL_WaitEventTimeout(SDL_Event(), 20), False)
+
+    def test_releases_gil(self):
+        "Other Python threads run while waiting"
+        ran = threading.Event()
+        thread = threading.Timer(0.05, ran.set)
+        thread.start()
+        try:
+            SDL_WaitEventTimeout(None, 200)
+            self.assertTrue(ran.is_set())
+        finally:
+            thread.join()
+
+    def test_wakes_on_push(self):
+        "Returns when another thread pushes an event"
+        def push():
+            ev = SDL_Event()
+            ev.type = SDL_USEREVENT
+            SDL_PushEvent(ev)
+        thread = threading.Timer(0.05, push)
+        thread.start()
+        try:
+            ev = SDL_Event()
+            self.assertTrue(SDL_WaitEventTimeout(ev, 5000))
+            self.assertEqual(ev.type, SDL_USEREVENT)
+        finally:
+            thread.join()
+
+    def test_buffer_wrong_size(self):
+        "Raises BufferError with writable buffer of wrong size"
+        self.assertRaises(BufferError, SDL_WaitEventTimeout, bytearray(1),
+                          0)
+
+    def test_timeout_non_int(self):
+        "Raises TypeError if timeout is not an int"
+        self.assertRaises(TypeError, SDL_WaitEventTimeout, None, 1.0)
+
+
+class Test_SDL_PollEvents(unittest.TestCase):
+    """Tests SDL_PollEvents()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        self.size = len(memoryview(SDL_Event()))
+
+    def tearDown(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def push(self, *types):
+        for t in types:
+            ev = SDL_Event()
+            ev.type = t
+            SDL_PushEvent(ev)
+
+    def types(self, buf, n):
+        return [struct.unpack_from('I', buf, i * self.size)[0]
+                for i in range(n)]
+
+    def test_empty(self):
+        "Returns 0 when there are no events"
+        buf = bytearray(self.size * 4)
+        self.assertEqual(SDL_PollEvents(buf), 0)
+
+    def test_drain(self):
+        "Stores the events in order, and removes them from the queue"
+        self.push(SDL_USEREVENT, SDL_USEREVENT + 1, SDL_USEREVENT + 2)
+        buf = bytearray(self.size * 4)
+        self.assertEqual(SDL_PollEvents(buf), 3)
+        self.assertEqual(self.types(buf, 3), [SDL_USEREVENT,
+                                              SDL_USEREVENT + 1,
+                                              SDL_USEREVENT + 2])
+        self.assertFalse(SDL_PollEvent(None))
+
+    def test_capacity(self):
+        "Stores at most as many events as fit in the buffer"
+        self.push(SDL_USEREVENT, SDL_USEREVENT + 1, SDL_USEREVENT + 2)
+        buf = bytearray(self.size * 2)
+        self.assertEqual(SDL_PollEvents(buf), 2)
+        self.assertEqual(SDL_PollEvents(buf), 1)
+        self.assertEqual(self.types(buf, 1), [SDL_USEREVENT + 2])
+
+    def test_max(self):
+        "Stores at most max events"
+        self.push(SDL_USEREVENT, SDL_USEREVENT + 1, SDL_USEREVENT + 2)
+        buf = bytearray(self.size * 4)
+        self.assertEqual(SDL_PollEvents(buf, 1), 1)
+        self.assertEqual(SDL_PollEvents(buf, max=0), 0)
+        self.assertEqual(SDL_PollEvents(buf, None), 2)
+
+    def test_max_too_large(self):
+        "Raises BufferError when max events do not fit in the buffer"
+        buf = bytearray(self.size * 2)
+        self.assertRaises(BufferError, SDL_PollEvents, buf, 3)
+
+    def test_max_negative(self):
+        "Raises ValueError when max is negative"
+        buf = bytearray(self.size * 2)
+        self.assertRaises(ValueError, SDL_PollEvents, buf, -1)
+
+    def test_SDL_Event(self):
+        "Works with a single SDL_Event"
+        self.push(SDL_USEREVENT)
+        ev = SDL_Event()
+        self.assertEqual(SDL_PollEvents(ev), 1)
+        self.assertEqual(ev.type, SDL_USEREVENT)
+
+    def test_readonly_buffer(self):
+        "Raises BufferError with readonly buffer"
+        self.assertRaises(BufferError, SDL_PollEvents, bytes(self.size))
+
+    def test_buffer_wrong_size(self):
+        "Raises BufferError if the buffer size is not a multiple of SDL_Event"
+        self.assertRaises(BufferError, SDL_PollEvents,
+                          bytearray(self.size + 1))
+
+
+class Test_SDL_PollEventColumns(unittest.TestCase):
+    """Tests SDL_EventColumns and SDL_PollEventColumns()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def tearDown(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def test_new(self):
+        "Creates empty columns"
+        cols = SDL_EventColumns(8)
+        self.assertEqual(cols.capacity, 8)
+        self.assertEqual(cols.count, 0)
+        self.assertEqual(len(cols.types), 0)
+        self.assertRaises(ValueError, SDL_EventColumns, 0)
+        self.assertRaises(ValueError, SDL_EventColumns, -1)
+
+    def test_drain(self):
+        "Drains the event queue into the columns"
+        ev = SDL_Event()
+        ev.type = SDL_MOUSEMOTION
+        ev.motion.windowID = 3
+        ev.motion.state = 1
+        ev.motion.x, ev.motion.y = 10, -20
+        ev.motion.xrel, ev.motion.yrel = 1, -2
+        SDL_PushEvent(ev)
+        ev = SDL_Event()
+        ev.type = SDL_KEYDOWN
+        ev.key.windowID = 4
+        ev.key.state = SDL_PRESSED
+        ev.key.keysym.sym = SDLK_a
+        ev.key.keysym.scancode = SDL_SCANCODE_A
+        ev.key.keysym.mod = KMOD_LSHIFT
+        SDL_PushEvent(ev)
+        ev = SDL_Event()
+        ev.type = SDL_MOUSEBUTTONUP
+        ev.button.button = 3
+        ev.button.x, ev.button.y = 5, 6
+        SDL_PushEvent(ev)
+        ev = SDL_Event()
+        ev.type = SDL_MOUSEWHEEL
+        ev.wheel.x, ev.wheel.y = -1, 3
+        SDL_PushEvent(ev)
+        SDL_PushUserEvents(SDL_USEREVENT, [-7])
+
+        cols = SDL_EventColumns(8)
+        self.assertEqual(SDL_PollEventColumns(cols), 5)
+        self.assertEqual(cols.count, 5)
+        self.assertEqual(list(cols.types),
+                         [SDL_MOUSEMOTION, SDL_KEYDOWN, SDL_MOUSEBUTTONUP,
+                          SDL_MOUSEWHEEL, SDL_USEREVENT])
+        self.assertEqual(len(cols.timestamps), 5)
+        self.assertEqual(list(cols.window_ids[:2]), [3, 4])
+        self.assertEqual(list(cols.x), [10, 0, 5, 0, 0])
+        self.assertEqual(list(cols.y), [-20, 0, 6, 0, 0])
+        self.assertEqual(list(cols.xrel), [1, 0, 0, -1, 0])
+        self.assertEqual(list(cols.yrel), [-2, 0, 0, 3, 0])
+        self.assertEqual(list(cols.keys), [0, SDLK_a, 0, 0, 0])
+        self.assertEqual(list(cols.scancodes), [0, SDL_SCANCODE_A, 0, 0, 0])
+        self.assertEqual(list(cols.mods), [0, KMOD_LSHIFT, 0, 0, 0])
+        self.assertEqual(list(cols.buttons), [0, 0, 3, 0, 0])
+        self.assertEqual(list(cols.states),
+                         [1, SDL_PRESSED, SDL_RELEASED, 0, 0])
+        self.assertEqual(list(cols.codes), [0, 0, 0, 0, -7])
+        self.assertFalse(SDL_PollEvent(None))
+
+    def test_capacity(self):
+        "Stores at most capacity events, leaving the rest queued"
+        SDL_PushUserEvents(SDL_USEREVENT, range(100))
+        cols = SDL_EventColumns(70)
+        self.assertEqual(SDL_PollEventColumns(cols), 70)
+        self.assertEqual(list(cols.codes), list(range(70)))
+        self.assertEqual(SDL_PollEventColumns(cols), 30)
+        self.assertEqual(list(cols.codes), list(range(70, 100)))
+        self.assertEqual(SDL_PollEventColumns(cols), 0)
+        self.assertEqual(len(cols.codes), 0)
+
+    def test_buffer(self):
+        "Columns are read-only typed buffers"
+        SDL_PushUserEvents(SDL_USEREVENT, [1, 2])
+        cols = SDL_EventColumns(4)
+        SDL_PollEventColumns(cols)
+        view = memoryview(cols.codes)
+        self.assertEqual(view.format, 'i')
+        self.assertEqual(view.tolist(), [1, 2])
+        self.assertTrue(view.readonly)
+        self.assertEqual(memoryview(cols.mods).format, 'H')
+        self.assertEqual(memoryview(cols.buttons).format, 'B')
+
+    def test_keeps_alive(self):
+        "A column keeps its SDL_EventColumns alive"
+        cols = SDL_EventColumns(4)
+        ref = weakref.ref(cols)
+        types = cols.types
+        del cols
+        self.assertIsNotNone(ref())
+        del types
+        self.assertIsNone(ref())
+
+    @unittest.skipIf(numpy is None, 'numpy is not installed')
+    def test_numpy(self):
+        "Columns can be wrapped by NumPy arrays"
+        SDL_PushUserEvents(SDL_USEREVENT, [3, 4])
+        cols = SDL_EventColumns(4)
+        SDL_PollEventColumns(cols)
+        self.assertEqual(numpy.frombuffer(cols.codes, numpy.int32).tolist(),
+                         [3, 4])
+
+
+class Test_SDL_EVENT_DTYPE(unittest.TestCase):
+    """Tests SDL_EVENT_DTYPE"""
+
+    formats = {'u1': 'B', 'u2': 'H', 'u4': 'I', 'i4': 'i', 'i8': 'q',
+               'f4': 'f'}
+
+    def field(self, buf, name):
+        i = SDL_EVENT_DTYPE['names'].index(name)
+        fmt = self.formats[SDL_EVENT_DTYPE['formats'][i]]
+        return struct.unpack_from(fmt, buf, SDL_EVENT_DTYPE['offsets'][i])[0]
+
+    def test_keys(self):
+        "Is a dict in the form accepted by numpy.dtype()"
+        self.assertEqual(sorted(SDL_EVENT_DTYPE), ['formats', 'itemsize',
+                                                   'names', 'offsets'])
+        n = len(SDL_EVENT_DTYPE['names'])
+        self.assertEqual(len(SDL_EVENT_DTYPE['formats']), n)
+        self.assertEqual(len(SDL_EVENT_DTYPE['offsets']), n)
+        self.assertEqual(len(set(SDL_EVENT_DTYPE['names'])), n)
+
+    def test_itemsize(self):
+        "itemsize is the size of SDL_Event"
+        self.assertEqual(SDL_EVENT_DTYPE['itemsize'],
+                         len(memoryview(SDL_Event())))
+
+    def test_fields_fit(self):
+        "All fields are within SDL_Event"
+        for fmt, off in zip(SDL_EVENT_DTYPE['formats'],
+                            SDL_EVENT_DTYPE['offsets']):
+            size = struct.calcsize(self.formats[fmt])
+            self.assertLessEqual(off + size, SDL_EVENT_DTYPE['itemsize'])
+
+    def test_motion(self):
+        "Mouse motion fields match SDL_MouseMotionEvent"
+        ev = SDL_Event()
+        m = ev.motion
+        m.type, m.timestamp, m.windowID, m.which = SDL_MOUSEMOTION, 1, 2, 3
+        m.state, m.x, m.y, m.xrel, m.yrel = 4, 5, -6, 7, -8
+        buf = memoryview(ev)
+        self.assertEqual(self.field(buf, 'type'), SDL_MOUSEMOTION)
+        self.assertEqual(self.field(buf, 'timestamp'), 1)
+        self.assertEqual(self.field(buf, 'windowID'), 2)
+        self.assertEqual(self.field(buf, 'motion_which'), 3)
+        self.assertEqual(self.field(buf, 'motion_state'), 4)
+        self.assertEqual(self.field(buf, 'motion_x'), 5)
+        self.assertEqual(self.field(buf, 'motion_y'), -6)
+        self.assertEqual(self.field(buf, 'motion_xrel'), 7)
+        self.assertEqual(self.field(buf, 'motion_yrel'), -8)
+
+    @unittest.skipIf(numpy is None, 'numpy is not installed')
+    def test_numpy(self):
+        "Can be used as a NumPy dtype with SDL_PollEvents()"
+        SDL_Init(SDL_INIT_EVENTS)
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        for t in (SDL_USEREVENT, SDL_USEREVENT + 1):
+            ev = SDL_Event()
+            ev.type = t
+            SDL_PushEvent(ev)
+        events = numpy.zeros(4, dtype=SDL_EVENT_DTYPE)
+        n = SDL_PollEvents(events)
+        self.assertEqual(n, 2)
+        self.assertEqual(list(events['type'][:n]),
+                         [SDL_USEREVENT, SDL_USEREVENT + 1])
+
+
+class Test_SDL_PushUserEvents(unittest.TestCase):
+    """Tests SDL_PushUserEvents() and SDL_TakeUserEventPayloads()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        self.size = len(memoryview(SDL_Event()))
+
+    def tearDown(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def get_events(self, n=64):
+        events = bytearray(self.size * n)
+        count = SDL_PeepEvents(events, n, SDL_GETEVENT, SDL_FIRSTEVENT,
+                               SDL_LASTEVENT)
+        return events, count
+
+    def test_codes(self):
+        "Pushes a user event for each code, in order"
+        self.assertEqual(SDL_PushUserEvents(SDL_USEREVENT, [5, -1, 7]), 3)
+        events, count = self.get_events()
+        self.assertEqual(count, 3)
+        for i, code in enumerate([5, -1, 7]):
+            ev_type, = struct.unpack_from('I', events, i * self.size)
+            ev_code, = struct.unpack_from('i', events, i * self.size + 12)
+            self.assertEqual((ev_type, ev_code), (SDL_USEREVENT, code))
+
+    def test_empty(self):
+        "Pushing no events returns 0"
+        self.assertEqual(SDL_PushUserEvents(SDL_USEREVENT, []), 0)
+        self.assertFalse(SDL_PollEvent(None))
+
+    def test_payloads(self):
+        "Payloads are returned by SDL_TakeUserEventPayloads()"
+        payloads = [object(), 'two', None]
+        SDL_PushUserEvents(SDL_USEREVENT + 1, [1, 2, 3], payloads)
+        events, count = self.get_events()
+        taken = SDL_TakeUserEventPayloads(events, count)
+        self.assertEqual(len(taken), 3)
+        for a, b in zip(taken, payloads):
+            self.assertIs(a, b)
+
+    def test_take_once(self):
+        "A payload can only be taken once"
+        SDL_PushUserEvents(SDL_USEREVENT, [1], ['payload'])
+        ev = SDL_Event()
+        self.assertTrue(SDL_PollEvent(ev))
+        self.assertEqual(SDL_TakeUserEventPayloads(ev), ['payload'])
+        self.assertEqual(SDL_TakeUserEventPayloads(ev), [None])
+        self.assertEqual(ev.user.data1, 0)
+
+    def test_payload_released(self):
+        "Taking a payload releases the reference held for it"
+        class Payload:
+            pass
+        payload = Payload()
+        ref = weakref.ref(payload)
+        SDL_PushUserEvents(SDL_USEREVENT, [1], [payload])
+        del payload
+        self.assertIsNotNone(ref())
+        ev = SDL_Event()
+        SDL_PollEvent(ev)
+        SDL_TakeUserEventPayloads(ev)
+        self.assertIsNone(ref())
+
+    def test_no_payload(self):
+        "Events without a payload give None"
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        ev.user.data1 = 1
+        SDL_PushEvent(ev)
+        SDL_PollEvent(ev)
+        self.assertEqual(SDL_TakeUserEventPayloads(ev), [None])
+        self.assertEqual(ev.user.data1, 1)
+
+    def test_take_count(self):
+        "Only the first count events are looked at"
+        SDL_PushUserEvents(SDL_USEREVENT, [1, 2], ['a', 'b'])
+        events, count = self.get_events(4)
+        self.assertEqual(SDL_TakeUserEventPayloads(events, 1), ['a'])
+        self.assertEqual(SDL_TakeUserEventPayloads(events, 2), [None, 'b'])
+        self.assertRaises(ValueError, SDL_TakeUserEventPayloads, events, 5)
+        self.assertRaises(BufferError, SDL_TakeUserEventPayloads,
+                          bytearray(1))
+
+    def test_from_thread(self):
+        "Python threads can push events"
+        thread = threading.Thread(target=SDL_PushUserEvents,
+                                  args=(SDL_USEREVENT, range(10)))
+        thread.start()
+        thread.join()
+        events, count = self.get_events()
+        self.assertEqual(count, 10)
+
+    def test_mismatched_payloads(self):
+        "Raises ValueError if payloads and codes differ in length"
+        self.assertRaises(ValueError, SDL_PushUserEvents, SDL_USEREVENT,
+                          [1, 2], ['a'])
+
+    def test_invalid_type(self):
+        "Raises RuntimeError for types which are not user events"
+        self.assertRaises(RuntimeError, SDL_PushUserEvents, SDL_KEYDOWN, [1])
+        self.assertFalse(SDL_PollEvent(None))
+
+    def test_invalid_code(self):
+        "Raises for codes which are not Sint32"
+        self.assertRaises(OverflowError, SDL_PushUserEvents, SDL_USEREVENT,
+                          [2 ** 31])
+        self.assertRaises(TypeError, SDL_PushUserEvents, SDL_USEREVENT,
+                          [1.0])
+        self.assertRaises(TypeError, SDL_PushUserEvents, SDL_USEREVENT, 1)
+
+    def test_c_api(self):
+        "C extensions can push events without the GIL"
+        self.assertEqual(_csdl2test.push_user_events(SDL_USEREVENT, 3), 3)
+        events, count = self.get_events()
+        self.assertEqual(count, 3)
+        data1, = struct.unpack_from('P', events, 2 * self.size + 16)
+        self.assertEqual(data1, 3)
+        self.assertEqual(SDL_TakeUserEventPayloads(events, count),
+                         [None] * 3)
+
+
+@unittest.skipIf(sys.platform == 'win32', 'not supported on Windows')
+class Test_SDL_EventNotifier(unittest.TestCase):
+    """Tests SDL_EventNotifier"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        self.notifier = SDL_EventNotifier()
+
+    def tearDown(self):
+        SDL_EventNotifierClose(self.notifier)
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def readable(self, timeout=0):
+        r, w, x = select.select([self.notifier.fd], [], [], timeout)
+        return bool(r)
+
+    def push(self):
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        SDL_PushEvent(ev)
+
+    def test_idle(self):
+        "Is not readable while the queue is empty"
+        self.assertIs(type(self.notifier.fd), int)
+        self.assertFalse(self.readable())
+
+    def test_push_event(self):
+        "Is readable after SDL_PushEvent() until cleared"
+        self.push()
+        self.assertTrue(self.readable())
+        self.push()
+        SDL_EventNotifierClear(self.notifier)
+        self.assertFalse(self.readable())
+        self.push()
+        self.assertTrue(self.readable())
+
+    def test_push_user_events(self):
+        "Is readable after SDL_PushUserEvents()"
+        SDL_PushUserEvents(SDL_USEREVENT, [1, 2])
+        self.assertTrue(self.readable())
+
+    def test_peep_events(self):
+        "Is readable after SDL_PeepEvents() with SDL_ADDEVENT"
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        SDL_PeepEvents(ev, 1, SDL_ADDEVENT, 0, 0)
+        self.assertTrue(self.readable())
+
+    def test_close_other(self):
+        "Closing a notifier does not stop the others from being signalled"
+        notifier = SDL_EventNotifier()
+        SDL_EventNotifierClose(notifier)
+        self.push()
+        self.assertTrue(self.readable())
+
+    def test_quit(self):
+        "Is signalled again by notifiers created after SDL_Quit()"
+        SDL_EventNotifierClose(self.notifier)
+        SDL_Quit()
+        SDL_Init(SDL_INIT_EVENTS)
+        self.notifier = SDL_EventNotifier()
+        self.push()
+        self.assertTrue(self.readable())
+
+    def test_cleared_before_queued(self):
+        "SDL_PushEvent() signals again once the event is queued"
+        try:
+            sdl = ctypes.CDLL(csdl2.__file__)
+            sdl.SDL_AddEventWatch
+        except (OSError, AttributeError):
+            raise unittest.SkipTest('SDL functions not exported by csdl2')
+        drained = []
+
+        # Event watches added last run first, so add this one before the
+        # watch of the notifiers to run it after the notifiers are signalled
+        @ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p)
+        def watch(userdata, event):
+            SDL_EventNotifierClear(self.notifier)
+            drained.append(SDL_PollEvent(None))
+            return 0
+
+        SDL_EventNotifierClose(self.notifier)
+        SDL_Quit()
+        SDL_Init(SDL_INIT_EVENTS)
+        sdl.SDL_AddEventWatch(watch, None)
+        try:
+            self.notifier = SDL_EventNotifier()
+            self.push()
+        finally:
+            sdl.SDL_DelEventWatch(watch, None)
+        self.assertEqual(drained, [False])
+        self.assertTrue(self.readable())
+
+    def test_thread(self):
+        "Wakes a select() waiting on it from another thread"
+        timer = threading.Timer(0.05, self.push)
+        timer.start()
+        try:
+            self.assertTrue(self.readable(5))
+        finally:
+            timer.join()
+
+    def test_queued(self):
+        "Is readable when created while events are queued"
+        self.push()
+        notifier = SDL_EventNotifier()
+        r, w, x = select.select([notifier.fd], [], [], 0)
+        self.assertTrue(r)
+        SDL_EventNotifierClose(notifier)
+
+    def test_close(self):
+        "Cannot be used after it is closed"
+        SDL_EventNotifierClose(self.notifier)
+        SDL_EventNotifierClose(self.notifier)
+        self.assertRaises(ValueError, getattr, self.notifier, 'fd')
+        self.assertRaises(ValueError, SDL_EventNotifierClear, self.notifier)
+        self.push()
+
+    def test_asyncio(self):
+        "Can be awaited with an asyncio reader"
+        async def next_events(events):
+            loop = asyncio.get_running_loop()
+            while True:
+                SDL_EventNotifierClear(self.notifier)
+                n = SDL_PeepEvents(events, 16, SDL_GETEVENT,
+                                   SDL_FIRSTEVENT, SDL_LASTEVENT)
+                if n:
+                    return n
+                ready = loop.create_future()
+                loop.add_reader(self.notifier.fd, ready.set_result, None)
+                try:
+                    await asyncio.wait_for(ready, 0.01)
+                except asyncio.TimeoutError:
+                    SDL_PumpEvents()
+                finally:
+                    loop.remove_reader(self.notifier.fd)
+
+        events = bytearray(len(memoryview(SDL_Event())) * 16)
+        thread = threading.Timer(0.05, SDL_PushUserEvents,
+                                 (SDL_USEREVENT, [1, 2, 3]))
+        thread.start()
+        try:
+            n = asyncio.run(asyncio.wait_for(next_events(events), 5))
+        finally:
+            thread.join()
+        self.assertEqual(n, 3)
+
+
+class Test_SDL_EventState(unittest.TestCase):
+    """Tests SDL_EventState()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def tearDown(self):
+        SDL_EventState(SDL_USEREVENT, SDL_ENABLE)
+
+    def test_query(self):
+        "Returns SDL_ENABLE for enabled events"
+        self.assertEqual(SDL_EventState(SDL_USEREVENT, SDL_QUERY), SDL_ENABLE)
+
+    def test_disable(self):
+        "Returns the previous state and disables the event type"
+        self.assertEqual(SDL_EventState(SDL_USEREVENT, SDL_DISABLE),
+                         SDL_ENABLE)
+        self.assertEqual(SDL_EventState(SDL_USEREVENT, SDL_QUERY),
+                         SDL_DISABLE)
+        self.assertEqual(SDL_EventState(SDL_USEREVENT, SDL_ENABLE),
+                         SDL_DISABLE)
+
+    def test_disable_flushes(self):
+        "Disabling an event type removes its queued events"
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        SDL_PushEvent(ev)
+        SDL_EventState(SDL_USEREVENT, SDL_IGNORE)
+        self.assertFalse(SDL_PollEvent(None))
+
+
+class Test_SDL_EventCoalescing(unittest.TestCase):
+    """Tests SDL_EventCoalescing()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def tearDown(self):
+        SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_DISABLE)
+        SDL_EventCoalescing(SDL_MOUSEWHEEL, SDL_DISABLE)
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+
+    def push_motion(self, x, y, xrel, yrel, windowID=1, which=0):
+        ev = SDL_Event()
+        ev.type = SDL_MOUSEMOTION
+        ev.motion.windowID = windowID
+        ev.motion.which = which
+        ev.motion.x, ev.motion.y = x, y
+        ev.motion.xrel, ev.motion.yrel = xrel, yrel
+        SDL_PushEvent(ev)
+
+    def push_wheel(self, x, y):
+        ev = SDL_Event()
+        ev.type = SDL_MOUSEWHEEL
+        ev.wheel.x, ev.wheel.y = x, y
+        SDL_PushEvent(ev)
+
+    def push_user(self):
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        SDL_PushEvent(ev)
+
+    def poll_all(self):
+        events = []
+        ev = SDL_Event()
+        while SDL_PollEvent(ev):
+            events.append(ev)
+            ev = SDL_Event()
+        return events
+
+    def test_state(self):
+        "Returns the previous state"
+        self.assertEqual(SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_QUERY),
+                         SDL_DISABLE)
+        self.assertEqual(SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_ENABLE),
+                         SDL_DISABLE)
+        self.assertEqual(SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_QUERY),
+                         SDL_ENABLE)
+        self.assertEqual(SDL_EventCoalescing(SDL_MOUSEWHEEL, SDL_QUERY),
+                         SDL_DISABLE)
+
+    def test_invalid_type(self):
+        "Raises ValueError for events which cannot be coalesced"
+        self.assertRaises(ValueError, SDL_EventCoalescing, SDL_KEYDOWN,
+                          SDL_ENABLE)
+
+    def test_invalid_state(self):
+        "Raises ValueError for an invalid state"
+        self.assertRaises(ValueError, SDL_EventCoalescing, SDL_MOUSEMOTION,
+                          42)
+
+    def test_disabled(self):
+        "Motion events are not merged when disabled"
+        self.push_motion(1, 1, 1, 1)
+        self.push_motion(2, 2, 1, 1)
+        self.assertEqual(len(self.poll_all()), 2)
+
+    def test_motion(self):
+        "Consecutive motion events are merged"
+        SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_ENABLE)
+        self.push_motion(10, 20, 1, 2)
+        self.push_motion(11, 22, 1, 2)
+        self.push_motion(15, 19, 4, -3)
+        events = self.poll_all()
+        self.assertEqual(len(events), 1)
+        motion = events[0].motion
+        self.assertEqual((motion.x, motion.y), (15, 19))
+        self.assertEqual((motion.xrel, motion.yrel), (6, 1))
+
+    def test_motion_not_consecutive(self):
+        "Motion events separated by another event are not merged"
+        SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_ENABLE)
+        self.push_motion(1, 1, 1, 1)
+        self.push_motion(2, 2, 1, 1)
+        self.push_user()
+        self.push_motion(3, 3, 1, 1)
+        self.push_motion(4, 4, 1, 1)
+        events = self.poll_all()
+        self.assertEqual([ev.type for ev in events],
+                         [SDL_MOUSEMOTION, SDL_USEREVENT, SDL_MOUSEMOTION])
+        self.assertEqual(events[0].motion.x, 2)
+        self.assertEqual(events[0].motion.xrel, 2)
+        self.assertEqual(events[2].motion.x, 4)
+        self.assertEqual(events[2].motion.xrel, 2)
+
+    def test_motion_other_window(self):
+        "Motion events of different windows or mice are not merged"
+        SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_ENABLE)
+        self.push_motion(1, 1, 1, 1, windowID=1)
+        self.push_motion(2, 2, 1, 1, windowID=2)
+        self.push_motion(3, 3, 1, 1, windowID=2, which=1)
+        events = self.poll_all()
+        self.assertEqual([ev.motion.x for ev in events], [1, 2, 3])
+
+    def test_wheel(self):
+        "Consecutive wheel events are merged if enabled"
+        SDL_EventCoalescing(SDL_MOUSEWHEEL, SDL_ENABLE)
+        self.push_wheel(0, 1)
+        self.push_wheel(1, 2)
+        self.push_motion(1, 1, 1, 1)
+        self.push_motion(2, 2, 1, 1)
+        events = self.poll_all()
+        self.assertEqual(len(events), 3)
+        self.assertEqual((events[0].wheel.x, events[0].wheel.y), (1, 3))
+
+    def test_quit_resets(self):
+        "SDL_Quit() removes the filter and resets the state"
+        SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_ENABLE)
+        SDL_Quit()
+        SDL_Init(SDL_INIT_EVENTS)
+        self.assertEqual(SDL_EventCoalescing(SDL_MOUSEMOTION, SDL_QUERY),
+                         SDL_DISABLE)
+
+
+class TestEventRecording(unittest.TestCase):
+    """Tests SDL_StartEventRecording() and SDL_EventReplay"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def setUp(self):
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)
+        fd, self.path = tempfile.mkstemp(suffix='.events')
+        os.close(fd)
+
+    def tearDown(self):
+        try:
+            SDL_StopEventRecording()
+        except ValueError:
+            pass
+        os.remove(self.path)
+
+    def push_user(self, code):
+        ev = SDL_Event()
+        ev.type = SDL_USEREVENT
+        ev.user.code = code
+        SDL_PushEvent(ev)
+
+    def record(self, codes):
+        "Records user events with the given codes, each dequeued on its own"
+        SDL_StartEventRecording(self.path)
+        ev = SDL_Event()
+        for code in codes:
+            self.push_user(code)
+            self.assertTrue(SDL_PollEvent(ev))
+        return SDL_StopEventRecording()
+
+    def replayed_codes(self):
+        events = bytearray(len(memoryview(SDL_Event())) * 64)
+        n = SDL_PeepEvents(events, 64, SDL_GETEVENT, SDL_FIRSTEVENT,
+                           SDL_LASTEVENT)
+        size = len(events) // 64
+        return [struct.unpack_from('i', events, i * size + 12)[0]
+                for i in range(n)]
+
+    def test_header(self):
+        "The log starts with the magic, version and record size"
+        self.assertEqual(self.record([]), 0)
+        with open(self.path, 'rb') as f:
+            data = f.read()
+        self.assertEqual(len(data), 16)
+        self.assertEqual(data[:8], b'PYCSDL2E')
+        self.assertEqual(struct.unpack_from('=II', data, 8),
+                         (1, 8 + len(memoryview(SDL_Event()))))
+
+    def test_records(self):
+        "Every dequeued event is recorded with a time"
+        self.assertEqual(self.record([1, 2, 3]), 3)
+        replay = SDL_EventReplay(self.path)
+        self.assertEqual(replay.count, 3)
+        self.assertEqual(replay.pos, 0)
+        self.assertGreaterEqual(replay.duration, 0.0)
+
+    def test_not_recording(self):
+        "Events are not recorded unless recording"
+        self.record([1])
+        self.push_user(2)
+        self.assertTrue(SDL_PollEvent(SDL_Event()))
+        self.assertEqual(SDL_EventReplay(self.path).count, 1)
+
+    def test_peek_not_recorded(self):
+        "Events which are only peeked at are not recorded"
+        SDL_StartEventRecording(self.path)
+        self.push_user(1)
+        events = SDL_Event()
+        self.assertEqual(SDL_PeepEvents(events, 1, SDL_PEEKEVENT,
+                                        SDL_FIRSTEVENT, SDL_LASTEVENT), 1)
+        self.assertTrue(SDL_PollEvent(None))
+        self.assertEqual(SDL_PeepEvents(events, 1, SDL_GETEVENT,
+                                        SDL_FIRSTEVENT, SDL_LASTEVENT), 1)
+        self.assertEqual(SDL_StopEventRecording(), 1)
+
+    def test_poll_events(self):
+        "Events dequeued by SDL_PollEvents() are recorded"
+        SDL_StartEventRecording(self.path)
+        for code in range(5):
+            self.push_user(code)
+        events = bytearray(len(memoryview(SDL_Event())) * 8)
+        self.assertEqual(SDL_PollEvents(events), 5)
+        self.assertEqual(SDL_StopEventRecording(), 5)
+
+    def test_replay(self):
+        "Replayed events are added to the queue in order"
+        self.record([10, 20, 30])
+        replay = SDL_EventReplay(self.path)
+        self.assertEqual(SDL_EventReplayPump(replay, replay.duration), 3)
+        self.assertEqual(replay.pos, 3)
+        self.assertEqual(self.replayed_codes(), [10, 20, 30])
+        self.assertEqual(SDL_EventReplayPump(replay, 1e9), 0)
+
+    def test_replay_schedule(self):
+        "Only events recorded up to the time are added"
+        SDL_StartEventRecording(self.path)
+        self.push_user(1)
+        SDL_PollEvent(SDL_Event())
+        time.sleep(0.05)
+        self.push_user(2)
+        SDL_PollEvent(SDL_Event())
+        SDL_StopEventRecording()
+        replay = SDL_EventReplay(self.path)
+        self.assertGreaterEqual(replay.duration, 0.05)
+        self.assertEqual(SDL_EventReplayPump(replay, 0.025), 1)
+        self.assertEqual(self.replayed_codes(), [1])
+        self.assertEqual(SDL_EventReplayPump(replay, replay.duration), 1)
+        self.assertEqual(self.replayed_codes(), [2])
+
+    def test_replay_real_time(self):
+        "time=None replays in real time from the first call"
+        self.record([1])
+        replay = SDL_EventReplay(self.path)
+        time.sleep(0.01)
+        SDL_EventReplayPump(replay)
+        deadline = time.time() + 1
+        while replay.pos < replay.count and time.time() < deadline:
+            SDL_EventReplayPump(replay)
+        self.assertEqual(replay.pos, 1)
+
+    def test_replay_negative_time(self):
+        "Raises ValueError for a negative time"
+        self.record([1])
+        replay = SDL_EventReplay(self.path)
+        self.assertRaises(ValueError, SDL_EventReplayPump, replay, -1.0)
+
+    def test_replay_invalid_time(self):
+        "Raises ValueError for a time which is not finite or too large"
+        self.record([1])
+        replay = SDL_EventReplay(self.path)
+        for t in (float('nan'), float('inf'), 1e11):
+            self.assertRaises(ValueError, SDL_EventReplayPump, replay, t)
+        self.assertEqual(SDL_EventReplayPump(replay, 1e10), 1)
+
+    def test_drop_file_cleared(self):
+        "The file pointer of SDL_DROPFILE events is not recorded"
+        SDL_StartEventRecording(self.path)
+        ev = SDL_Event()
+        ev.type = SDL_DROPFILE
+        SDL_PeepEvents(ev, 1, SDL_ADDEVENT, 0, 0)
+        SDL_PeepEvents(ev, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)
+        SDL_StopEventRecording()
+        with open(self.path, 'rb') as f:
+            data = f.read()
+        size = struct.calcsize('P')
+        self.assertEqual(data[16 + 8 + 8:16 + 8 + 8 + size], bytes(size))
+
+    def test_already_recording(self):
+        "Raises ValueError if already recording"
+        SDL_StartEventRecording(self.path)
+        self.assertRaises(ValueError, SDL_StartEventRecording, self.path)
+
+    def test_stop_not_recording(self):
+        "Raises ValueError if not recording"
+        self.assertRaises(ValueError, SDL_StopEventRecording)
+
+    def test_invalid_log(self):
+        "SDL_EventReplay raises ValueError for files which are not event logs"
+        with open(self.path, 'wb') as f:
+            f.write(b'not an event log')
+        self.assertRaises(ValueError, SDL_EventReplay, self.path)
+
+    def test_truncated_log(self):
+        "SDL_EventReplay raises ValueError for truncated event logs"
+        self.record([1])
+        with open(self.path, 'r+b') as f:
+            f.truncate(20)
+        self.assertRaises(ValueError, SDL_EventReplay, self.path)
+
+    def test_missing_log(self):
+        "SDL_EventReplay raises RuntimeError for missing files"
+        self.assertRaises(RuntimeError, SDL_EventReplay,
+                          self.path + '.missing')
+
 
 class TestMouseMotionEventCreate(unittest.TestCase):
     "Tests PyCSDL2_MouseMotionEventCreate()"
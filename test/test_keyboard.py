@@ -0,0 +1,59 @@
+"""test bindings in src/keyboard.h"""
+import distutils.util
+import os.path
+import sys
+import unittest
+
+
+tests_dir = os.path.dirname(os.path.abspath(__file__))
+
+
+if __name__ == '__main__':
+    plat_specifier = 'lib.{0}-{1}'.format(distutils.util.get_platform(),
+                                          sys.version[0:3])
+    sys.path.insert(0, os.path.join(tests_dir, '..', 'build', plat_specifier))
+
+
+from csdl2 import *  # noqa
+
+
+
+class Test_SDL_GetKeyboardState(unittest.TestCase):
+    """Tests SDL_GetKeyboardState()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def test_len(self):
+        "Has an entry for each scancode"
+        self.assertEqual(len(SDL_GetKeyboardState()), SDL_NUM_SCANCODES)
+
+    def test_released(self):
+        "No keys are pressed without a keyboard"
+        state = SDL_GetKeyboardState()
+        self.assertEqual(state[SDL_SCANCODE_A], 0)
+        self.assertEqual(bytes(state), bytes(SDL_NUM_SCANCODES))
+
+    def test_same_object(self):
+        "Returns the same buffer every time"
+        self.assertIs(SDL_GetKeyboardState(), SDL_GetKeyboardState())
+
+    def test_readonly(self):
+        "Is a read-only buffer of bytes"
+        state = SDL_GetKeyboardState()
+        view = memoryview(state)
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.format, 'B')
+        self.assertRaises(TypeError, state.__setitem__, SDL_SCANCODE_A, 1)
+
+
+class Test_SDL_GetModState(unittest.TestCase):
+    """Tests SDL_GetModState()"""
+
+    def test_returns_int(self):
+        self.assertIs(type(SDL_GetModState()), int)
+
+
+if __name__ == '__main__':
+    unittest.main()
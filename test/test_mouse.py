@@ -0,0 +1,88 @@
+"""test bindings in src/mouse.h"""
+import distutils.util
+import os.path
+import sys
+import unittest
+
+
+tests_dir = os.path.dirname(os.path.abspath(__file__))
+
+
+if __name__ == '__main__':
+    plat_specifier = 'lib.{0}-{1}'.format(distutils.util.get_platform(),
+                                          sys.version[0:3])
+    sys.path.insert(0, os.path.join(tests_dir, '..', 'build', plat_specifier))
+
+
+from csdl2 import *  # noqa
+
+
+
+class TestMouseConstants(unittest.TestCase):
+    "Test value of constants defined in SDL_mouse.h"
+
+    def test_SDL_BUTTON(self):
+        self.assertEqual(SDL_BUTTON_LEFT, 1)
+        self.assertEqual(SDL_BUTTON_MIDDLE, 2)
+        self.assertEqual(SDL_BUTTON_RIGHT, 3)
+        self.assertEqual(SDL_BUTTON_X1, 4)
+        self.assertEqual(SDL_BUTTON_X2, 5)
+
+    def test_SDL_BUTTON_MASK(self):
+        self.assertEqual(SDL_BUTTON_LMASK, 1 << 0)
+        self.assertEqual(SDL_BUTTON_MMASK, 1 << 1)
+        self.assertEqual(SDL_BUTTON_RMASK, 1 << 2)
+        self.assertEqual(SDL_BUTTON_X1MASK, 1 << 3)
+        self.assertEqual(SDL_BUTTON_X2MASK, 1 << 4)
+
+
+class Test_SDL_GetMouseState(unittest.TestCase):
+    """Tests SDL_GetMouseState()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def test_returns_tuple(self):
+        "Returns a (buttons, x, y) tuple"
+        state = SDL_GetMouseState()
+        self.assertIs(type(state), tuple)
+        self.assertEqual(len(state), 3)
+        for x in state:
+            self.assertIs(type(x), int)
+
+
+class Test_SDL_GetInputSnapshot(unittest.TestCase):
+    """Tests SDL_GetInputSnapshot()"""
+
+    @classmethod
+    def setUpClass(cls):
+        SDL_Init(SDL_INIT_EVENTS)
+
+    def test_new(self):
+        "Creates a new SDL_InputSnapshot"
+        snapshot = SDL_GetInputSnapshot()
+        self.assertIs(type(snapshot), SDL_InputSnapshot)
+        self.assertEqual((snapshot.buttons, snapshot.x, snapshot.y),
+                         SDL_GetMouseState())
+        self.assertEqual(snapshot.mod, SDL_GetModState())
+
+    def test_fill(self):
+        "Fills and returns the given SDL_InputSnapshot"
+        snapshot = SDL_InputSnapshot()
+        self.assertIs(SDL_GetInputSnapshot(snapshot), snapshot)
+        self.assertEqual((snapshot.buttons, snapshot.x, snapshot.y),
+                         SDL_GetMouseState())
+
+    def test_readonly(self):
+        "Attributes are read-only"
+        snapshot = SDL_InputSnapshot()
+        self.assertRaises(AttributeError, setattr, snapshot, 'x', 1)
+
+    def test_invalid_type(self):
+        "Raises TypeError if snapshot is not an SDL_InputSnapshot"
+        self.assertRaises(TypeError, SDL_GetInputSnapshot, 42)
+
+
+if __name__ == '__main__':
+    unittest.main()
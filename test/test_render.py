@@ -2,6 +2,8 @@
 import distutils.util
 import os.path
 import sys
+import threading
+import time
 import unittest
 import weakref
 import array
@@ -1713,6 +1715,109 @@ class TestRenderCopy(unittest.TestCase):
                           None)
 
 
+class TestRenderCopyBatch(unittest.TestCase):
+    "Tests SDL_RenderCopyBatch()"
+
+    @staticmethod
+    def rects(*rects):
+        return b''.join(bytes(memoryview(SDL_Rect(*r))) for r in rects)
+
+    def setUp(self):
+        self.rdr = self.create_renderer()
+        self.rdr2 = self.create_renderer()
+        self.tex = self.create_texture(self.rdr)
+        self.src = [(0, 0, 8, 8), (0, 0, 0, 0), (8, 4, 4, 8)]
+        self.dst = [(0, 0, 8, 8), (8, 8, 16, 16), (20, 2, 10, 5)]
+
+    def create_renderer(self):
+        sf = SDL_CreateRGBSurface(0, 32, 32, 32, 0xff0000, 0xff00, 0xff, 0)
+        return SDL_CreateSoftwareRenderer(sf)
+
+    def create_texture(self, rdr):
+        tex = SDL_CreateTexture(rdr, SDL_PIXELFORMAT_ARGB8888,
+                                SDL_TEXTUREACCESS_STATIC, 16, 16)
+        SDL_UpdateTexture(tex, None, bytes(range(256)) * 4, 64)
+        return tex
+
+    def read_pixels(self, rdr):
+        pixels = bytearray(32 * 32 * 4)
+        SDL_RenderReadPixels(rdr, None, SDL_PIXELFORMAT_ARGB8888, pixels,
+                             32 * 4)
+        return pixels
+
+    def expected(self):
+        "Renders the rects with SDL_RenderCopy() on a renderer of its own"
+        rdr = self.create_renderer()
+        tex = self.create_texture(rdr)
+        for src, dst in zip(self.src, self.dst):
+            SDL_RenderCopy(rdr, tex, SDL_Rect(*src) if any(src) else None,
+                           SDL_Rect(*dst))
+        return self.read_pixels(rdr)
+
+    def test_separate(self):
+        "Copies with separate source and destination arrays"
+        x = SDL_RenderCopyBatch(self.rdr, self.tex, self.rects(*self.src),
+                                self.rects(*self.dst), 3)
+        self.assertIs(x, None)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_interleaved(self):
+        "Copies with interleaved source and destination rects"
+        pairs = [r for pair in zip(self.src, self.dst) for r in pair]
+        SDL_RenderCopyBatch(self.rdr, self.tex, bytearray(self.rects(*pairs)),
+                            None, 3)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_srcrects_none(self):
+        "srcrects can be None to copy the entire texture"
+        self.src = [(0, 0, 0, 0)] * 3
+        SDL_RenderCopyBatch(self.rdr, self.tex, None, self.rects(*self.dst),
+                            3)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_count_zero(self):
+        "Copies nothing if count is 0"
+        SDL_RenderCopyBatch(self.rdr, self.tex, b'', b'', 0)
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.read_pixels(self.rdr2))
+
+    def test_buffer_too_small(self):
+        "Raises BufferError if an array is too small"
+        self.assertRaises(BufferError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, self.rects(*self.src[:2]),
+                          self.rects(*self.dst), 3)
+        self.assertRaises(BufferError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, self.rects(*self.src),
+                          self.rects(*self.dst[:2]), 3)
+        self.assertRaises(BufferError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, self.rects(*self.src), None, 2)
+
+    def test_invalid_value(self):
+        "Raises ValueError on a negative count or no rects at all"
+        self.assertRaises(ValueError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, b'', b'', -1)
+        self.assertRaises(ValueError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, None, None, 0)
+
+    def test_renderer_mismatch(self):
+        "Raises RuntimeError if the texture's renderer is not `renderer`"
+        self.assertRaises(RuntimeError, SDL_RenderCopyBatch, self.rdr2,
+                          self.tex, None, self.rects(*self.dst), 3)
+
+    def test_destroyed_texture(self):
+        "Raises ValueError if the texture has already been destroyed"
+        SDL_DestroyTexture(self.tex)
+        self.assertRaises(ValueError, SDL_RenderCopyBatch, self.rdr,
+                          self.tex, None, self.rects(*self.dst), 3)
+
+    def test_invalid_type(self):
+        "Raises TypeError on invalid type"
+        self.assertRaises(TypeError, SDL_RenderCopyBatch, self.rdr, self.tex,
+                          42, None, 0)
+        self.assertRaises(TypeError, SDL_RenderCopyBatch, self.rdr, self.tex,
+                          None, b'', None)
+
+
 class TestRenderCopyEx(unittest.TestCase):
     """Tests SDL_RenderCopyEx()"""
 
@@ -1781,6 +1886,115 @@ class TestRenderCopyEx(unittest.TestCase):
                           None, None, 0, None, SDL_FLIP_NONE)
 
 
+class TestRenderCopyExBatch(unittest.TestCase):
+    "Tests SDL_RenderCopyExBatch()"
+
+    rects = staticmethod(TestRenderCopyBatch.rects)
+    create_renderer = TestRenderCopyBatch.create_renderer
+    create_texture = TestRenderCopyBatch.create_texture
+    read_pixels = TestRenderCopyBatch.read_pixels
+
+    @staticmethod
+    def points(*points):
+        return b''.join(bytes(memoryview(SDL_Point(*p))) for p in points)
+
+    def setUp(self):
+        self.rdr = self.create_renderer()
+        self.rdr2 = self.create_renderer()
+        self.tex = self.create_texture(self.rdr)
+        self.src = [(0, 0, 8, 8), (0, 0, 0, 0), (8, 4, 4, 8)]
+        self.dst = [(2, 2, 8, 8), (8, 8, 16, 16), (20, 2, 10, 5)]
+        self.angles = [30.0, 0.0, 90.0]
+        self.centers = [(0, 0), (8, 8), (5, 2)]
+        self.flips = [SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL,
+                      SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL]
+
+    def expected(self, centers=True):
+        "Renders with SDL_RenderCopyEx() on a renderer of its own"
+        rdr = self.create_renderer()
+        tex = self.create_texture(rdr)
+        for src, dst, angle, center, flip in zip(self.src, self.dst,
+                                                 self.angles, self.centers,
+                                                 self.flips):
+            SDL_RenderCopyEx(rdr, tex, SDL_Rect(*src) if any(src) else None,
+                             SDL_Rect(*dst), angle,
+                             SDL_Point(*center) if centers else None, flip)
+        return self.read_pixels(rdr)
+
+    def batch(self, angles_type='d', **kwargs):
+        args = {'srcrects': self.rects(*self.src),
+                'dstrects': self.rects(*self.dst),
+                'angles': array.array(angles_type, self.angles),
+                'centers': self.points(*self.centers),
+                'flips': bytes(self.flips), 'count': 3}
+        args.update(kwargs)
+        return SDL_RenderCopyExBatch(self.rdr, self.tex, **args)
+
+    def test_doubles(self):
+        "Copies with an array of double angles"
+        self.assertIs(self.batch(), None)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_floats(self):
+        "Copies with an array of float angles"
+        self.batch('f')
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_interleaved(self):
+        "Copies with interleaved source and destination rects"
+        pairs = [r for pair in zip(self.src, self.dst) for r in pair]
+        self.batch(srcrects=self.rects(*pairs), dstrects=None)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_none(self):
+        "angles, centers and flips can be None"
+        self.batch(angles=None, centers=None, flips=None)
+        self.angles = [0.0] * 3
+        self.flips = [SDL_FLIP_NONE] * 3
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.expected(centers=False))
+
+    def test_buffer_too_small(self):
+        "Raises BufferError if an array is too small"
+        self.assertRaises(BufferError, self.batch,
+                          angles=array.array('d', self.angles[:2]))
+        self.assertRaises(BufferError, self.batch,
+                          centers=self.points(*self.centers[:2]))
+        self.assertRaises(BufferError, self.batch,
+                          flips=bytes(self.flips[:2]))
+        self.assertRaises(BufferError, self.batch,
+                          dstrects=self.rects(*self.dst[:2]))
+
+    def test_invalid_angles(self):
+        "Raises TypeError if angles is not an array of floats or doubles"
+        self.assertRaises(TypeError, self.batch, angles=bytes(24))
+        self.assertRaises(TypeError, self.batch,
+                          angles=array.array('i', [0, 0, 0]))
+
+    def test_invalid_flips(self):
+        "Raises TypeError or ValueError on invalid flips"
+        self.assertRaises(TypeError, self.batch,
+                          flips=array.array('i', [0, 0, 0]))
+        self.assertRaises(ValueError, self.batch, flips=bytes([0, 4, 0]))
+
+    def test_invalid_flip_draws_nothing(self):
+        "Nothing is drawn if any item is invalid"
+        self.assertRaises(ValueError, self.batch, flips=bytes([0, 0, 0xff]))
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.read_pixels(self.rdr2))
+
+    def test_renderer_mismatch(self):
+        "Raises RuntimeError if the texture's renderer is not `renderer`"
+        self.assertRaises(RuntimeError, SDL_RenderCopyExBatch, self.rdr2,
+                          self.tex, None, self.rects(*self.dst), None, None,
+                          None, 3)
+
+    def test_destroyed_texture(self):
+        "Raises ValueError if the texture has already been destroyed"
+        SDL_DestroyTexture(self.tex)
+        self.assertRaises(ValueError, self.batch)
+
+
 class TestRenderReadPixels(unittest.TestCase):
     "Tests SDL_RenderReadPixels()"
 
@@ -1880,6 +2094,569 @@ class TestRenderPresent(unittest.TestCase):
         self.assertRaises(ValueError, SDL_RenderPresent, self.rdr)
 
 
+class TestRenderList(unittest.TestCase):
+    "Tests recording into SDL_RenderList"
+
+    rects = staticmethod(TestRenderCopyBatch.rects)
+    points = staticmethod(TestRenderCopyExBatch.points)
+    create_renderer = TestRenderCopyBatch.create_renderer
+    create_texture = TestRenderCopyBatch.create_texture
+
+    def setUp(self):
+        self.list = SDL_RenderList()
+        self.rdr = self.create_renderer()
+        self.tex = self.create_texture(self.rdr)
+
+    def test_empty(self):
+        "A new list is empty"
+        self.assertEqual(len(self.list), 0)
+
+    def test_returns_index(self):
+        "Recording functions return the index of the entry"
+        l = self.list
+        self.assertEqual(SDL_RenderListSetRenderDrawColor(l, 1, 2, 3, 4), 0)
+        self.assertEqual(SDL_RenderListSetRenderDrawBlendMode(
+            l, SDL_BLENDMODE_BLEND), 1)
+        self.assertEqual(SDL_RenderListRenderClear(l), 2)
+        self.assertEqual(SDL_RenderListRenderDrawPoints(
+            l, self.points((1, 1)), 1), 3)
+        self.assertEqual(SDL_RenderListRenderDrawLines(
+            l, self.points((0, 0), (4, 4)), 2), 4)
+        self.assertEqual(SDL_RenderListRenderDrawRects(
+            l, self.rects((0, 0, 4, 4)), 1), 5)
+        self.assertEqual(SDL_RenderListRenderFillRects(l, None, 0), 6)
+        self.assertEqual(SDL_RenderListRenderCopy(l, self.tex, None, None), 7)
+        self.assertEqual(SDL_RenderListRenderCopyEx(
+            l, self.tex, None, None, 45.0, None, SDL_FLIP_NONE), 8)
+        self.assertEqual(SDL_RenderListRenderSetViewport(l, None), 9)
+        self.assertEqual(SDL_RenderListRenderSetClipRect(
+            l, SDL_Rect(0, 0, 8, 8)), 10)
+        self.assertEqual(len(l), 11)
+
+    def test_patch(self):
+        "Entries can be overwritten by index"
+        SDL_RenderListRenderClear(self.list)
+        SDL_RenderListRenderClear(self.list)
+        self.assertEqual(SDL_RenderListRenderFillRects(
+            self.list, self.rects((0, 0, 1, 1)), 1, index=1), 1)
+        self.assertEqual(SDL_RenderListRenderClear(self.list, index=-2), 0)
+        self.assertEqual(len(self.list), 2)
+
+    def test_index_out_of_range(self):
+        "Raises IndexError if the index is out of range"
+        self.assertRaises(IndexError, SDL_RenderListRenderClear, self.list,
+                          index=0)
+        SDL_RenderListRenderClear(self.list)
+        self.assertRaises(IndexError, SDL_RenderListRenderClear, self.list,
+                          index=1)
+        self.assertRaises(IndexError, SDL_RenderListRenderClear, self.list,
+                          index=-2)
+
+    def test_reset(self):
+        "SDL_RenderListReset() removes all entries"
+        SDL_RenderListRenderCopy(self.list, self.tex, None, None)
+        self.assertIs(SDL_RenderListReset(self.list), None)
+        self.assertEqual(len(self.list), 0)
+
+    def test_keeps_texture_alive(self):
+        "The list keeps references to the textures it uses"
+        ref = weakref.ref(self.tex)
+        SDL_RenderListRenderCopy(self.list, self.tex, None, None)
+        del self.tex
+        self.assertIsNotNone(ref())
+        SDL_RenderListReset(self.list)
+        self.assertIsNone(ref())
+
+    def test_buffer_too_small(self):
+        "Raises BufferError if an array is too small"
+        self.assertRaises(BufferError, SDL_RenderListRenderDrawPoints,
+                          self.list, self.points((1, 1)), 2)
+        self.assertRaises(BufferError, SDL_RenderListRenderFillRects,
+                          self.list, self.rects((0, 0, 1, 1)), 2)
+        self.assertEqual(len(self.list), 0)
+
+    def test_negative_count(self):
+        "Raises ValueError if count is negative"
+        self.assertRaises(ValueError, SDL_RenderListRenderDrawLines,
+                          self.list, b'', -1)
+
+    def test_destroyed_texture(self):
+        "Raises ValueError if the texture has been destroyed"
+        SDL_DestroyTexture(self.tex)
+        self.assertRaises(ValueError, SDL_RenderListRenderCopy, self.list,
+                          self.tex, None, None)
+
+    def test_invalid_type(self):
+        "Raises TypeError on invalid type"
+        self.assertRaises(TypeError, SDL_RenderListRenderClear, 42)
+        self.assertRaises(TypeError, SDL_RenderListRenderCopy, self.list, 42,
+                          None, None)
+        self.assertRaises(TypeError, SDL_RenderListRenderClear, self.list,
+                          index='0')
+
+
+class TestRenderListExecute(unittest.TestCase):
+    "Tests SDL_RenderListExecute()"
+
+    rects = staticmethod(TestRenderCopyBatch.rects)
+    points = staticmethod(TestRenderCopyExBatch.points)
+    create_renderer = TestRenderCopyBatch.create_renderer
+    create_texture = TestRenderCopyBatch.create_texture
+    read_pixels = TestRenderCopyBatch.read_pixels
+
+    def setUp(self):
+        self.list = SDL_RenderList()
+        self.rdr = self.create_renderer()
+        self.tex = self.create_texture(self.rdr)
+
+    def record(self, l, tex, fill=(0, 0, 4, 4)):
+        "Records a scene with every kind of command"
+        SDL_RenderListSetRenderDrawColor(l, 10, 20, 30, 255)
+        SDL_RenderListRenderClear(l)
+        SDL_RenderListSetRenderDrawBlendMode(l, SDL_BLENDMODE_NONE)
+        SDL_RenderListSetRenderDrawColor(l, 200, 0, 0, 255)
+        SDL_RenderListRenderFillRects(l, self.rects(fill, (8, 8, 2, 2)), 2)
+        SDL_RenderListSetRenderDrawColor(l, 0, 200, 0, 255)
+        SDL_RenderListRenderDrawRects(l, self.rects((4, 4, 10, 6)), 1)
+        SDL_RenderListRenderDrawLines(l, self.points((0, 31), (31, 20)), 2)
+        SDL_RenderListRenderDrawPoints(l, self.points((30, 1), (29, 2)), 2)
+        SDL_RenderListRenderCopy(l, tex, SDL_Rect(0, 0, 8, 8),
+                                 SDL_Rect(16, 0, 8, 8))
+        SDL_RenderListRenderCopyEx(l, tex, None, SDL_Rect(16, 16, 12, 8),
+                                   30.0, None, SDL_FLIP_HORIZONTAL)
+        SDL_RenderListRenderSetClipRect(l, SDL_Rect(0, 0, 16, 16))
+        SDL_RenderListRenderSetViewport(l, SDL_Rect(2, 2, 20, 20))
+        SDL_RenderListRenderFillRects(l, None, 0)
+
+    def direct(self, rdr, tex, fill=(0, 0, 4, 4)):
+        "Renders the scene of record() with direct calls"
+        SDL_SetRenderDrawColor(rdr, 10, 20, 30, 255)
+        SDL_RenderClear(rdr)
+        SDL_SetRenderDrawBlendMode(rdr, SDL_BLENDMODE_NONE)
+        SDL_SetRenderDrawColor(rdr, 200, 0, 0, 255)
+        SDL_RenderFillRects(rdr, self.rects(fill, (8, 8, 2, 2)), 2)
+        SDL_SetRenderDrawColor(rdr, 0, 200, 0, 255)
+        SDL_RenderDrawRects(rdr, self.rects((4, 4, 10, 6)), 1)
+        SDL_RenderDrawLines(rdr, self.points((0, 31), (31, 20)), 2)
+        SDL_RenderDrawPoints(rdr, self.points((30, 1), (29, 2)), 2)
+        SDL_RenderCopy(rdr, tex, SDL_Rect(0, 0, 8, 8), SDL_Rect(16, 0, 8, 8))
+        SDL_RenderCopyEx(rdr, tex, None, SDL_Rect(16, 16, 12, 8), 30.0, None,
+                         SDL_FLIP_HORIZONTAL)
+        SDL_RenderSetClipRect(rdr, SDL_Rect(0, 0, 16, 16))
+        SDL_RenderSetViewport(rdr, SDL_Rect(2, 2, 20, 20))
+        SDL_RenderFillRect(rdr, None)
+
+    def expected(self, **kwargs):
+        rdr = self.create_renderer()
+        self.direct(rdr, self.create_texture(rdr), **kwargs)
+        return self.read_pixels(rdr)
+
+    def test_execute(self):
+        "Renders the same as calling the functions directly"
+        self.record(self.list, self.tex)
+        self.assertIs(SDL_RenderListExecute(self.rdr, self.list), None)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_execute_twice(self):
+        "A list can be executed many times"
+        self.record(self.list, self.tex)
+        SDL_RenderListExecute(self.rdr, self.list)
+        SDL_RenderSetViewport(self.rdr, None)
+        SDL_RenderSetClipRect(self.rdr, None)
+        SDL_RenderListExecute(self.rdr, self.list)
+        self.assertEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_patch(self):
+        "Patched entries are used by the next execution"
+        self.record(self.list, self.tex)
+        SDL_RenderListRenderFillRects(self.list,
+                                      self.rects((20, 20, 3, 3), (1, 9, 2, 2)),
+                                      2, index=4)
+        SDL_RenderListExecute(self.rdr, self.list)
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.expected(fill=(20, 20, 3, 3)))
+        self.assertNotEqual(self.read_pixels(self.rdr), self.expected())
+
+    def test_empty(self):
+        "Executing an empty list does nothing"
+        SDL_RenderListExecute(self.rdr, self.list)
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.read_pixels(self.create_renderer()))
+
+    def test_zero_count(self):
+        "Commands drawing zero points, lines or rects do nothing"
+        SDL_RenderListRenderDrawPoints(self.list, self.points(), 0)
+        SDL_RenderListRenderDrawLines(self.list, self.points(), 0)
+        SDL_RenderListRenderDrawRects(self.list, self.rects(), 0)
+        SDL_RenderListRenderFillRects(self.list, self.rects(), 0)
+        SDL_RenderListExecute(self.rdr, self.list)
+        self.assertEqual(self.read_pixels(self.rdr),
+                         self.read_pixels(self.create_renderer()))
+
+    def test_renderer_mismatch(self):
+        "Raises RuntimeError if a texture's renderer is not `renderer`"
+        SDL_RenderListRenderCopy(self.list, self.tex, None, None)
+        self.assertRaises(RuntimeError, SDL_RenderListExecute,
+                          self.create_renderer(), self.list)
+
+    def test_destroyed_texture(self):
+        "Raises ValueError if a texture has been destroyed"
+        SDL_RenderListRenderClear(self.list)
+        SDL_RenderListRenderCopy(self.list, self.tex, None, None)
+        SDL_DestroyTexture(self.tex)
+        self.assertRaises(ValueError, SDL_RenderListExecute, self.rdr,
+                          self.list)
+
+    def test_destroyed_renderer(self):
+        "Raises ValueError if the renderer has been destroyed"
+        SDL_DestroyRenderer(self.rdr)
+        self.assertRaises(ValueError, SDL_RenderListExecute, self.rdr,
+                          self.list)
+
+    def test_record_while_executing(self):
+        "Raises ValueError when recording into a list being executed"
+        for i in range(2000):
+            SDL_RenderListRenderFillRects(self.list, None, 0)
+        errors = []
+        done = threading.Event()
+
+        def record():
+            while not done.is_set():
+                try:
+                    SDL_RenderListRenderClear(self.list, index=0)
+                except ValueError as e:
+                    errors.append(e)
+        thread = threading.Thread(target=record)
+        thread.start()
+        try:
+            for i in range(20):
+                SDL_RenderListExecute(self.rdr, self.list)
+        finally:
+            done.set()
+            thread.join()
+        self.assertTrue(errors)
+
+    def test_invalid_type(self):
+        "Raises TypeError on invalid type"
+        self.assertRaises(TypeError, SDL_RenderListExecute, self.rdr, 42)
+        self.assertRaises(TypeError, SDL_RenderListExecute, 42, self.list)
+
+
+class TestTextureAtlas(unittest.TestCase):
+    "Tests SDL_TextureAtlas"
+
+    def setUp(self):
+        self.sf = SDL_CreateRGBSurface(0, 64, 64, 32, 0xff0000, 0xff00, 0xff,
+                                       0)
+        self.rdr = SDL_CreateSoftwareRenderer(self.sf)
+
+    @staticmethod
+    def surface(w, h, seed=0):
+        "Returns an opaque ARGB surface filled with a pattern"
+        pixels = bytearray(w * h * 4)
+        for i in range(w * h):
+            pixels[4 * i:4 * i + 4] = bytes(((i * 7 + seed) % 256,
+                                             (i * 13 + seed) % 256,
+                                             (i + seed * 5) % 256, 0xff))
+        sf = SDL_CreateRGBSurfaceFrom(pixels, w, h, 32, w * 4, 0xff0000,
+                                      0xff00, 0xff, 0xff000000)
+        return sf, pixels
+
+    @staticmethod
+    def rects(atlas):
+        "Returns the rects of the atlas as (x, y, w, h) tuples"
+        v = memoryview(atlas.rects).cast('i')
+        return [tuple(v[i:i + 4]) for i in range(0, len(v), 4)]
+
+    def read_page(self, page):
+        "Copies the page texture to the renderer and returns its pixels"
+        SDL_SetTextureBlendMode(page, SDL_BLENDMODE_NONE)
+        SDL_RenderCopy(self.rdr, page, None, None)
+        pixels = bytearray(64 * 64 * 4)
+        SDL_RenderReadPixels(self.rdr, None, SDL_PIXELFORMAT_ARGB8888, pixels,
+                             64 * 4)
+        return pixels
+
+    def assertPacked(self, atlas, padding=0):
+        "Checks that the item rects are in bounds and do not overlap"
+        rects = self.rects(atlas)
+        pages = memoryview(atlas.item_pages).cast('i').tolist()
+        self.assertEqual(len(rects), atlas.count)
+        self.assertEqual(len(pages), atlas.count)
+        for i, (x, y, w, h) in enumerate(rects):
+            self.assertTrue(0 <= pages[i] < len(atlas.pages))
+            self.assertTrue(x >= 0 and y >= 0)
+            self.assertTrue(x + w <= atlas.width and y + h <= atlas.height)
+            for j in range(i):
+                if pages[i] != pages[j]:
+                    continue
+                x2, y2, w2, h2 = rects[j]
+                self.assertTrue(x + w + padding <= x2 or
+                                x2 + w2 + padding <= x or
+                                y + h + padding <= y2 or
+                                y2 + h2 + padding <= y,
+                                (rects[i], rects[j]))
+
+    def test_new(self):
+        "Creates an empty atlas"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 32, padding=1)
+        self.assertIs(type(atlas), SDL_TextureAtlas)
+        self.assertEqual(atlas.width, 64)
+        self.assertEqual(atlas.height, 32)
+        self.assertEqual(atlas.padding, 1)
+        self.assertEqual(atlas.format, SDL_PIXELFORMAT_ARGB8888)
+        self.assertEqual(atlas.count, 0)
+        self.assertEqual(atlas.pages, ())
+        self.assertEqual(atlas.rects, b'')
+        self.assertEqual(atlas.item_pages, b'')
+
+    def test_new_invalid(self):
+        "Raises ValueError on invalid sizes, padding or formats"
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 0, 32)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 32, -1)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 32, 32,
+                          padding=-1)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 32, 32,
+                          SDL_PIXELFORMAT_YV12)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 32, 32,
+                          SDL_PIXELFORMAT_INDEX8)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 32, 32,
+                          SDL_PIXELFORMAT_INDEX1LSB)
+        self.assertRaises(ValueError, SDL_TextureAtlas, self.rdr, 1 << 15,
+                          1 << 15)
+        self.assertRaises(TypeError, SDL_TextureAtlas, 42, 32, 32)
+
+    def test_insert(self):
+        "Packs items without overlaps and keeps their sizes"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 64)
+        sizes = [(10, 20), (30, 5), (16, 16), (7, 9), (20, 20), (1, 1)]
+        sfs = [self.surface(w, h)[0] for w, h in sizes]
+        self.assertEqual(SDL_TextureAtlasInsert(atlas, sfs), 0)
+        self.assertEqual(atlas.count, len(sizes))
+        self.assertEqual(len(atlas.pages), 1)
+        self.assertIs(type(atlas.pages[0]), SDL_Texture)
+        self.assertEqual([r[2:] for r in self.rects(atlas)], sizes)
+        self.assertPacked(atlas)
+
+    def test_padding(self):
+        "Leaves padding between items"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 64, padding=2)
+        sfs = [self.surface(9, 9)[0] for i in range(20)]
+        SDL_TextureAtlasInsert(atlas, sfs)
+        self.assertPacked(atlas, padding=2)
+
+    def test_incremental(self):
+        "Later inserts return the index of their first item"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 64)
+        self.assertEqual(SDL_TextureAtlasInsert(atlas, [self.surface(8, 8)[0],
+                         self.surface(4, 4)[0]]), 0)
+        self.assertEqual(SDL_TextureAtlasInsert(atlas, []), 2)
+        self.assertEqual(SDL_TextureAtlasInsert(atlas,
+                                                [self.surface(16, 8)[0]]), 2)
+        self.assertEqual(atlas.count, 3)
+        self.assertEqual([r[2:] for r in self.rects(atlas)],
+                         [(8, 8), (4, 4), (16, 8)])
+        self.assertPacked(atlas)
+
+    def test_pixels(self):
+        "The pages hold the pixels of the items, including earlier ones"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 64)
+        items = [self.surface(12, 7, 1), self.surface(5, 20, 2)]
+        SDL_TextureAtlasInsert(atlas, [sf for sf, pixels in items])
+        items.append(self.surface(30, 10, 3))
+        SDL_TextureAtlasInsert(atlas, [items[2][0]])
+        page = self.read_page(atlas.pages[0])
+        for (sf, src), (x, y, w, h) in zip(items, self.rects(atlas)):
+            for row in range(h):
+                start = ((y + row) * 64 + x) * 4
+                got = page[start:start + w * 4]
+                want = src[row * w * 4:(row + 1) * w * 4]
+                # The renderer target has no alpha channel
+                self.assertEqual(got[0::4], want[0::4])
+                self.assertEqual(got[1::4], want[1::4])
+                self.assertEqual(got[2::4], want[2::4])
+
+    def test_pages(self):
+        "Adds pages when the items do not fit in one"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        SDL_TextureAtlasInsert(atlas, [self.surface(20, 20)[0]
+                                       for i in range(3)])
+        self.assertEqual(len(atlas.pages), 3)
+        self.assertEqual(memoryview(atlas.item_pages).cast('i').tolist(),
+                         [0, 1, 2])
+        self.assertPacked(atlas)
+        stats = SDL_TextureAtlasGetStats(atlas)
+        self.assertEqual(stats, {'pages': 3, 'items': 3,
+                                 'used_pixels': 3 * 20 * 20,
+                                 'total_pixels': 3 * 32 * 32,
+                                 'occupancy': 1200 / 3072})
+
+    def test_stats_empty(self):
+        "Returns zeros for an empty atlas"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        self.assertEqual(SDL_TextureAtlasGetStats(atlas),
+                         {'pages': 0, 'items': 0, 'used_pixels': 0,
+                          'total_pixels': 0, 'occupancy': 0.0})
+
+    def test_insert_invalid(self):
+        "Raises ValueError and inserts nothing if an item does not fit"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        sfs = [self.surface(8, 8)[0], self.surface(33, 8)[0]]
+        self.assertRaises(ValueError, SDL_TextureAtlasInsert, atlas, sfs)
+        self.assertEqual(atlas.count, 0)
+        self.assertEqual(atlas.pages, ())
+        sf = SDL_CreateRGBSurface(0, 0, 0, 32, 0, 0, 0, 0)
+        self.assertRaises(ValueError, SDL_TextureAtlasInsert, atlas, [sf])
+
+    def test_insert_failed(self):
+        "Undoes the packing of every item if an item cannot be blitted"
+        atlas = SDL_TextureAtlas(self.rdr, 64, 64)
+        SDL_TextureAtlasInsert(atlas, [self.surface(40, 40)[0]])
+        # SDL cannot blit from 4-bit surfaces
+        bad = SDL_CreateRGBSurface(0, 4, 4, 4, 0, 0, 0, 0)
+        for sf in (self.surface(8, 8, 5)[0], self.surface(40, 40, 5)[0]):
+            self.assertRaises(RuntimeError, SDL_TextureAtlasInsert, atlas,
+                              [sf, bad])
+            self.assertEqual(atlas.count, 1)
+            self.assertEqual(len(atlas.pages), 1)
+            self.assertEqual(SDL_TextureAtlasGetStats(atlas)['used_pixels'],
+                             40 * 40)
+        self.assertEqual(SDL_TextureAtlasInsert(atlas, []), 1)
+        page = self.read_page(atlas.pages[0])
+        for row in range(8):
+            start = (row * 64 + 40) * 4
+            got = page[start:start + 8 * 4]
+            # The renderer target has no alpha channel
+            self.assertEqual(got[0::4] + got[1::4] + got[2::4], bytes(24))
+        SDL_TextureAtlasInsert(atlas, [self.surface(8, 8)[0]])
+        self.assertEqual(self.rects(atlas)[1], (40, 0, 8, 8))
+        self.assertPacked(atlas)
+
+    def test_insert_destroyed_renderer(self):
+        "Raises ValueError if the renderer has been destroyed"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        SDL_DestroyRenderer(self.rdr)
+        self.assertRaises(ValueError, SDL_TextureAtlasInsert, atlas,
+                          [self.surface(8, 8)[0]])
+
+    def test_insert_concurrent(self):
+        "Concurrent inserts into one atlas do not share items"
+        atlas = SDL_TextureAtlas(self.rdr, 16, 16)
+        sf = self.surface(8, 8)[0]
+        indices = []
+
+        def insert():
+            for i in range(100):
+                try:
+                    indices.append(SDL_TextureAtlasInsert(atlas, [sf] * 5))
+                except ValueError:
+                    pass
+        threads = [threading.Thread(target=insert) for i in range(2)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(sorted(indices), list(range(0, atlas.count, 5)))
+        pages = memoryview(atlas.item_pages).cast('i')
+        items = set(zip(pages, self.rects(atlas)))
+        self.assertEqual(len(items), atlas.count)
+
+    def test_insert_invalid_type(self):
+        "Raises TypeError on invalid types"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        self.assertRaises(TypeError, SDL_TextureAtlasInsert, 42, [])
+        self.assertRaises(TypeError, SDL_TextureAtlasInsert, atlas, 42)
+        self.assertRaises(TypeError, SDL_TextureAtlasInsert, atlas, [42])
+        self.assertRaises(TypeError, SDL_TextureAtlasGetStats, 42)
+
+    def test_gc(self):
+        "The atlas can be garbage collected with its pages"
+        atlas = SDL_TextureAtlas(self.rdr, 32, 32)
+        SDL_TextureAtlasInsert(atlas, [self.surface(8, 8)[0]])
+        ref = weakref.ref(atlas)
+        del atlas
+        self.assertIsNone(ref())
+
+
+class TestRenderThreads(unittest.TestCase):
+    "Tests rendering from threads while the GIL is released"
+
+    def setUp(self):
+        self.sf = SDL_CreateRGBSurface(0, 256, 256, 32, 0, 0, 0, 0)
+        self.rdr = SDL_CreateSoftwareRenderer(self.sf)
+        self.tex = SDL_CreateTexture(self.rdr, SDL_PIXELFORMAT_RGB332,
+                                     SDL_TEXTUREACCESS_STATIC, 16, 16)
+
+    def test_worker_thread(self):
+        "Renderer calls can be made from another thread"
+        def draw():
+            SDL_RenderClear(self.rdr)
+            SDL_UpdateTexture(self.tex, None, b'\xff' * 16 * 16, 16)
+            SDL_RenderCopy(self.rdr, self.tex, None, None)
+            SDL_RenderPresent(self.rdr)
+        thread = threading.Thread(target=draw)
+        thread.start()
+        thread.join()
+        pixels = bytearray(256 * 256)
+        SDL_RenderReadPixels(self.rdr, None, SDL_PIXELFORMAT_RGB332, pixels,
+                             256)
+        self.assertEqual(pixels, b'\xff' * 256 * 256)
+
+    def test_concurrent_draws(self):
+        "Concurrent calls on one renderer are serialized"
+        def draw():
+            for i in range(200):
+                SDL_RenderFillRect(self.rdr, None)
+                SDL_RenderCopyEx(self.rdr, self.tex, None, None, 45.0, None,
+                                 SDL_FLIP_NONE)
+        threads = [threading.Thread(target=draw) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+    def test_destroy_while_drawing(self):
+        "Destroying the renderer waits for calls in other threads"
+        errors = []
+
+        def draw():
+            try:
+                while True:
+                    SDL_RenderFillRect(self.rdr, None)
+                    SDL_RenderCopy(self.rdr, self.tex, None, None)
+            except ValueError as e:
+                errors.append(e)
+        thread = threading.Thread(target=draw)
+        thread.start()
+        time.sleep(0.01)
+        SDL_DestroyTexture(self.tex)
+        SDL_DestroyRenderer(self.rdr)
+        thread.join()
+        self.assertEqual(len(errors), 1)
+
+    def test_drop_while_drawing(self):
+        "Dropping a texture waits for calls in other threads"
+        done = threading.Event()
+
+        def draw():
+            while not done.is_set():
+                SDL_RenderCopyEx(self.rdr, self.tex, None, None, 45.0, None,
+                                 SDL_FLIP_NONE)
+                SDL_RenderPresent(self.rdr)
+        thread = threading.Thread(target=draw)
+        thread.start()
+        try:
+            for i in range(200):
+                tex = SDL_CreateTexture(self.rdr, SDL_PIXELFORMAT_RGB332,
+                                        SDL_TEXTUREACCESS_STATIC, 16, 16)
+                SDL_UpdateTexture(tex, None, b'\xff' * 16 * 16, 16)
+                del tex
+        finally:
+            done.set()
+            thread.join()
+        SDL_RenderCopy(self.rdr, self.tex, None, None)
+
+
 class TestDestroyTexture(unittest.TestCase):
     "Tests SDL_DestroyTexture()"
 